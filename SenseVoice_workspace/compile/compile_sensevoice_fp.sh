@@ -2,11 +2,16 @@
 set -ex
 
 # Compile SenseVoice TFLite to DLA format
-# Usage: ./compile_sensevoice_fp.sh <TFLITE_PATH> <PLATFORM> <NEURON_SDK_PATH>
+# Usage: ./compile_sensevoice_fp.sh <TFLITE_PATH> <PLATFORM> <NEURON_SDK_PATH> [MODEL_NAME]
+#   MODEL_NAME: output name prefix, use "sensevoice_packed" for the packed-batch model
+#               and keep "_fp16out" for a model exported with main.py --fp16_output
+#               ("_fp16in" / "_int8in" for main.py --input_type float16 / int8)
+#               ("_top<k>" for main.py --top_k k, the top-k output head)
 
 TFLITE_PATH=${1:-"../model_prepare/model/sensevoice_complete.tflite"}
 PLATFORM=${2:-"MT6899"}
 NEURON_SDK_PATH=${3:-"/home/xh/projects/MTK/0_Toolkits/neuropilot-sdk-basic-8.0.10-build20251029/neuron_sdk"}
+MODEL_NAME=${4:-"sensevoice"}
 
 echo "================================================================"
 echo "SenseVoice TFLite -> DLA Compilation"
@@ -57,7 +62,7 @@ echo "NUM MDLA: ${NUM_MDLA}"
 echo ""
 
 # Output file
-OUTPUT_FILE="sensevoice_${PLATFORM}.dla"
+OUTPUT_FILE="${MODEL_NAME}_${PLATFORM}.dla"
 
 # Compile command
 ncc-tflite \
@@ -72,11 +77,11 @@ ncc-tflite \
     --fc-to-conv \
     -d ${OUTPUT_FILE} \
     ${TFLITE_PATH} \
-    2>&1 | tee compile_sensevoice_${PLATFORM}.log
+    2>&1 | tee compile_${MODEL_NAME}_${PLATFORM}.log
 
 echo ""
 echo "================================================================"
 echo "Compilation completed successfully!"
 echo "Output: ${OUTPUT_FILE}"
-echo "Log: compile_sensevoice_${PLATFORM}.log"
+echo "Log: compile_${MODEL_NAME}_${PLATFORM}.log"
 echo "================================================================"
@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""
+Convert a token-level ARPA n-gram model (words = SenseVoice vocabulary
+tokens) into the quantized binary trie (.svlm) that the C++ NgramLm mmaps.
+
+Layout (little-endian), must match LmFileHeader / LmEntry / LmLeaf in ngram_lm.h:
+    header    : magic "SVLM", version, order, num_words, bos_id, eos_id,
+                reserved x2, level_offset u64 x 6, level_count u32 x 6  (128 bytes)
+    codebooks : order x {prob f32 x 256, backoff f32 x 256}, natural log
+    level 1   : num_words + 1 LmEntry, indexed by token id (last = sentinel)
+    level k   : count + 1 LmEntry {word u16, prob u8, backoff u8, first_child u32},
+                sorted by (parent, word); children of entry i are
+                [first_child(i), first_child(i + 1)) of level k + 1
+    level N   : count LmLeaf {word u16, prob u8, reserved u8}
+Probability index 255 marks an n-gram that only exists as a context. Tokens
+the ARPA does not cover keep index 255 in level 1 and are skipped by the
+decoder (prompt tokens like <|zh|>), unless the model has <unk>.
+
+Usage:
+    python3 arpa2lm.py --arpa lm_3gram.arpa --tokens ../models/sensevoice-small/tokens.txt -o lm.svlm
+"""
+
+import argparse
+import bisect
+import math
+import struct
+
+from tokens2bin import load_tokens_json, load_tokens_txt
+
+LM_MAGIC = b'SVLM'
+LM_VERSION = 1
+MAX_ORDER = 6
+ABSENT = 255
+LN10 = math.log(10.0)
+
+
+def parse_arpa(path, token_to_id, bos_id, eos_id):
+    """返回 grams[k] = {(id, ...): (ln_prob, ln_backoff)}, 含词表外 token 的 n-gram 被丢弃"""
+    grams = {}
+    order = 0
+    current = 0
+    dropped = 0
+    with open(path, 'r', encoding='utf-8') as f:
+        for line in f:
+            line = line.strip()
+            if not line:
+                continue
+            if line.startswith('ngram '):
+                n = int(line[6:].split('=')[0])
+                order = max(order, n)
+                continue
+            if line.startswith('\\'):
+                current = int(line[1]) if line.endswith('-grams:') else 0
+                continue
+            if current == 0:
+                continue
+            parts = line.split()
+            prob = float(parts[0])
+            words = parts[1:1 + current]
+            backoff = float(parts[1 + current]) if len(parts) > 1 + current else 0.0
+            ids = []
+            for w in words:
+                if w == '<s>':
+                    ids.append(bos_id)
+                elif w == '</s>':
+                    ids.append(eos_id)
+                elif w in token_to_id:
+                    ids.append(token_to_id[w])
+                else:
+                    ids = None
+                    break
+            if ids is None:
+                dropped += 1
+                continue
+            grams.setdefault(current, {})[tuple(ids)] = (prob * LN10, backoff * LN10)
+    if order > MAX_ORDER:
+        raise ValueError(f'order {order} > {MAX_ORDER}')
+    return grams, order, dropped
+
+
+def build_codebook(values, size):
+    """按分位数分箱, 每箱取均值"""
+    values = sorted(values)
+    if not values:
+        return [0.0]
+    unique = sorted(set(values))
+    if len(unique) <= size:
+        return unique
+    centers = []
+    for b in range(size):
+        lo = b * len(values) // size
+        hi = max(lo + 1, (b + 1) * len(values) // size)
+        chunk = values[lo:hi]
+        centers.append(sum(chunk) / len(chunk))
+    return sorted(set(centers))
+
+
+def quantizer(codebook):
+    mids = [(a + b) / 2 for a, b in zip(codebook, codebook[1:])]
+    return lambda v: bisect.bisect_left(mids, v)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert a token-level ARPA LM to the SenseVoice .svlm trie')
+    parser.add_argument('--arpa', type=str, required=True,
+                        help='ARPA file whose words are SenseVoice tokens')
+    parser.add_argument('--tokens', type=str, required=True,
+                        help='Vocabulary: tokens.txt or tokens.json')
+    parser.add_argument('-o', '--output', type=str, required=True,
+                        help='Output .svlm path')
+    args = parser.parse_args()
+
+    vocab = load_tokens_json(args.tokens) if args.tokens.endswith('.json') else load_tokens_txt(args.tokens)
+    token_to_id = {t: i for i, t in sorted(vocab.items())}
+    num_tokens = max(vocab) + 1
+    bos_id = token_to_id.get('<s>', num_tokens)
+    eos_id = token_to_id.get('</s>', max(num_tokens, bos_id + 1))
+    num_words = max(num_tokens, bos_id + 1, eos_id + 1)
+    if num_words > 0xFFFF:
+        raise ValueError('token ids must fit in 16 bits')
+
+    grams, order, dropped = parse_arpa(args.arpa, token_to_id, bos_id, eos_id)
+    if order == 0 or 1 not in grams:
+        raise ValueError('no n-grams found')
+
+    # Every context of an n-gram must exist one level up for the trie walk
+    for k in range(order, 1, -1):
+        for ids in list(grams.get(k, {})):
+            grams.setdefault(k - 1, {}).setdefault(ids[:-1], (None, 0.0))
+
+    unk = grams[1].get((token_to_id['<unk>'],)) if '<unk>' in token_to_id else None
+
+    codebooks = []
+    for k in range(1, order + 1):
+        probs = [p for p, _ in grams.get(k, {}).values() if p is not None]
+        backoffs = [b for _, b in grams.get(k, {}).values()]
+        codebooks.append((build_codebook(probs, ABSENT), build_codebook(backoffs, 256)))
+
+    levels = []
+    for k in range(1, order + 1):
+        q_prob = quantizer(codebooks[k - 1][0])
+        q_backoff = quantizer(codebooks[k - 1][1])
+        if k == 1:
+            keys = [(i,) for i in range(num_words)]
+        else:
+            keys = sorted(grams.get(k, {}))
+        children = sorted(grams.get(k + 1, {})) if k < order else []
+
+        data = bytearray()
+        child = 0
+        for ids in keys:
+            prob, backoff = grams[k].get(ids, (None, 0.0))
+            if k == 1 and prob is None and unk is not None and not vocab.get(ids[0], '<').startswith('<'):
+                prob = unk[0]
+            pq = ABSENT if prob is None else q_prob(prob)
+            if k == order:
+                data += struct.pack('<HBB', ids[-1], pq, 0)
+                continue
+            while child < len(children) and children[child][:-1] < ids:
+                child += 1
+            data += struct.pack('<HBBI', ids[-1], pq, q_backoff(backoff), child)
+        if k < order:
+            data += struct.pack('<HBBI', 0, ABSENT, 0, len(children))  # Sentinel
+        levels.append((len(keys), data))
+
+    header_bytes = 128
+    codebook_bytes = order * 2 * 256 * 4
+    offset = header_bytes + codebook_bytes
+    offsets = []
+    for _, data in levels:
+        offset = (offset + 7) // 8 * 8
+        offsets.append(offset)
+        offset += len(data)
+
+    with open(args.output, 'wb') as f:
+        f.write(struct.pack('<4sIIIiiII', LM_MAGIC, LM_VERSION, order, num_words, bos_id, eos_id, 0, 0))
+        f.write(struct.pack(f'<{MAX_ORDER}Q', *(offsets + [0] * (MAX_ORDER - order))))
+        f.write(struct.pack(f'<{MAX_ORDER}I', *([n for n, _ in levels] + [0] * (MAX_ORDER - order))))
+        f.write(b'\0' * (header_bytes - f.tell()))
+        for prob_book, backoff_book in codebooks:
+            f.write(struct.pack('<256f', *(prob_book + [0.0] * (256 - len(prob_book)))))
+            f.write(struct.pack('<256f', *(backoff_book + [0.0] * (256 - len(backoff_book)))))
+        for (count, data), level_offset in zip(levels, offsets):
+            f.write(b'\0' * (level_offset - f.tell()))
+            f.write(data)
+        total = f.tell()
+
+    counts = ', '.join(f'{k}-gram {len(grams.get(k, {}))}' for k in range(1, order + 1))
+    print(f"Wrote {args.output}: order {order}, {counts}, dropped {dropped} n-grams "
+          f"with unknown tokens, {total} bytes (format v{LM_VERSION})")
+
+
+if __name__ == '__main__':
+    main()
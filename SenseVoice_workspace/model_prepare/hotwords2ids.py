@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""
+Encode a hotword list with the SenseVoice BPE model so the C++ HotwordGraph
+uses exactly the model's segmentation (without ids it falls back to a
+longest match over the vocabulary).
+
+Input : one phrase per line, optional boost after a tab
+Output: <phrase>\t<boost>\t<id> <id> ...   (format of HotwordGraph::Load)
+
+Usage:
+    python3 hotwords2ids.py -i hotwords.txt -o hotwords_ids.txt \\
+        --bpe ../models/sensevoice-small/chn_jpn_yue_eng_ko_spectok.bpe.model
+"""
+
+import argparse
+
+import sentencepiece as spm
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Encode hotwords into SenseVoice token ids')
+    parser.add_argument('-i', '--input', type=str, required=True,
+                        help='Hotword list, one phrase per line ("phrase[\\tboost]")')
+    parser.add_argument('-o', '--output', type=str, required=True,
+                        help='Output file for HotwordGraph::Load')
+    parser.add_argument('--bpe', type=str, required=True,
+                        help='BPE model (chn_jpn_yue_eng_ko_spectok.bpe.model)')
+    args = parser.parse_args()
+
+    sp = spm.SentencePieceProcessor(model_file=args.bpe)
+
+    count = 0
+    with open(args.input, 'r', encoding='utf-8') as fin, \
+            open(args.output, 'w', encoding='utf-8') as fout:
+        for line in fin:
+            line = line.rstrip('\r\n')
+            if not line or line.startswith('#'):
+                continue
+            phrase, _, boost = line.partition('\t')
+            ids = sp.encode(phrase.strip(), out_type=int)
+            if not ids:
+                print(f"跳过无法编码的热词: {phrase}")
+                continue
+            fout.write(f"{phrase}\t{boost}\t{' '.join(str(i) for i in ids)}\n")
+            count += 1
+
+    print(f"Wrote {args.output}: {count} hotwords")
+
+
+if __name__ == '__main__':
+    main()
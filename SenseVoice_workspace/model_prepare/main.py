@@ -75,6 +75,21 @@ def parse_args():
     parser.add_argument('--text_norm', type=str, default="woitn",
                         choices=["withitn", "woitn"],
                         help="Text normalization mode (default: woitn)")
+    parser.add_argument('--batch', type=int, default=1,
+                        help="Batch dimension of the exported model (default: 1)")
+    parser.add_argument('--packed', action='store_true',
+                        help="Export the packed-batch variant (several utterances per window)")
+    parser.add_argument('--fp16_output', action='store_true',
+                        help="Export with float16 logits (model name gets the '_fp16out' suffix)")
+    parser.add_argument('--input_type', type=str, default="float32",
+                        choices=["float32", "float16", "int8"],
+                        help="Features input precision; float16 / int8 leave CMVN to the host "
+                             "(model name gets the '_fp16in' / '_int8in' suffix)")
+    parser.add_argument('--int8_clip', type=float, default=8.0,
+                        help="int8 input: largest normalized feature magnitude, step = clip / 127 (default: 8.0)")
+    parser.add_argument('--top_k', type=int, default=0,
+                        help="Export a top-k output head: k log-probs and token ids per row instead of "
+                             "the full logits (model name gets the '_top<k>' suffix, default: 0 = logits)")
     args = parser.parse_args()
     return args
 
@@ -170,6 +185,104 @@ def save_model_complete(model, audio_features, language_id, event_id, event_type
     return model_file
 
 
+INPUT_SUFFIX = {"float32": "", "float16": "_fp16in", "int8": "_int8in"}
+
+
+def set_input_type(model, args):
+    """Reduced-precision input: CMVN moves to the host, the model widens the features"""
+    model.input_type = args.input_type
+    model.input_scale = args.int8_clip / 127.0
+    if args.input_type != "float32":
+        print(f"Features input: {args.input_type}, CMVN applied on the host (am.mvn)")
+    if args.input_type == "int8":
+        print(f"  int8 step: {model.input_scale:.6f} (clip {args.int8_clip}), "
+              f"set ModelConfig::input_scale or make_bundle.py --input_scale to it")
+
+
+def set_output_head(model, args):
+    """Full logits (float32 / float16) or the top-k head; returns the model name suffix"""
+    if args.top_k < 0 or args.top_k > 256:
+        print(f"Error: --top_k must be within 0..256, got {args.top_k}")
+        sys.exit(1)
+    if args.top_k > 0 and args.fp16_output:
+        # Token ids above 2048 are not exact in float16
+        print("Error: --top_k writes token ids next to the values and needs float32 output, drop --fp16_output")
+        sys.exit(1)
+    model.output_fp16 = args.fp16_output
+    model.top_k = args.top_k
+    if args.top_k > 0:
+        print(f"Output head: top-{args.top_k} log-probs and token ids per row")
+        return f"_top{args.top_k}"
+    return "_fp16out" if args.fp16_output else ""
+
+
+def encode_example(x, input_type, scale=1.0):
+    """Example input in the exported precision (int8: steps of scale)"""
+    if input_type == "int8":
+        return torch.clamp(torch.round(x / scale), -127, 127).to(torch.int8)
+    if input_type == "float16":
+        return x.half()
+    return x
+
+
+def create_packed_inputs(utterance_frames, window_rows=170, gap_rows=5):
+    """
+    Build example inputs for the packed-batch model
+
+    Each utterance takes [4 prompt rows | its frames]; neighbours are
+    separated by gap_rows masked rows.
+
+    Returns:
+        features [1, window_rows, 560], segment_ids [1, window_rows], prompt_role [1, window_rows, 4]
+    """
+    features = torch.zeros(1, window_rows, 560)
+    segment_ids = torch.zeros(1, window_rows)
+    prompt_role = torch.zeros(1, window_rows, 4)
+
+    row = 0
+    for k, num_frames in enumerate(utterance_frames):
+        if k > 0:
+            row += gap_rows
+        assert row + 4 + num_frames <= window_rows, "utterances do not fit into one window"
+        for p in range(4):
+            prompt_role[0, row + p, p] = 1.0
+        features[0, row + 4:row + 4 + num_frames] = torch.randn(num_frames, 560)
+        segment_ids[0, row:row + 4 + num_frames] = k + 1
+        row += 4 + num_frames
+
+    return features, segment_ids, prompt_role
+
+
+def save_model_packed(model, model_name="sensevoice_packed", example_inputs=None):
+    """
+    Save the packed-batch SenseVoice model as TorchScript
+
+    Args:
+        model: SenseVoiceSmallPacked model
+        model_name: Output model name
+        example_inputs: (features, segment_ids, prompt_role) to trace with
+    """
+    if not os.path.exists('model'):
+        os.mkdir('model')
+
+    model_file = f'model/{model_name}.pt'
+    print(f"Saving TorchScript to: {model_file}")
+
+    if not os.path.isfile(model_file):
+        model = model.cpu()
+        model.eval()
+
+        # Three short utterances are enough to trace the mask construction
+        if example_inputs is None:
+            example_inputs = create_packed_inputs([40, 50, 56])
+        with torch.no_grad():
+            save_torchscript(model, model_file, example_inputs)
+    else:
+        print(f"{model_file} already exists.")
+
+    return model_file
+
+
 def inference_pytorch_custom(model, audio_path, language="en", text_norm="woitn"):
     """
     Run PyTorch inference with our custom model
@@ -287,23 +400,56 @@ def main(args):
             print("="*80)
             inference_pytorch_funasr(args.audio_path)
 
+    elif args.mode == "SAVE_PT" and args.packed:
+        # Packed-batch variant: one 170-row window shared by several utterances
+        print("Loading packed SenseVoice model...")
+        model = create_sensevoice_model(args.model_path, packed=True)
+        output_suffix = set_output_head(model, args)
+        set_input_type(model, args)
+        print("✅ Model loaded successfully\n")
+
+        features, segment_ids, prompt_role = create_packed_inputs([40, 50, 56])
+        features = encode_example(features, args.input_type, model.input_scale)
+        segment_ids = encode_example(segment_ids, args.input_type)
+        prompt_role = encode_example(prompt_role, args.input_type)
+        print(f"\nModel inputs (packed window):")
+        print(f"  - Features: {features.shape} [1, 170, 560]")
+        print(f"  - Segment IDs: {segment_ids.shape} [1, 170]")
+        print(f"  - Prompt role: {prompt_role.shape} [1, 170, 4]")
+
+        print("\nTesting forward pass...")
+        with torch.no_grad():
+            logits = model(features, segment_ids, prompt_role)
+        print(f"Output shape: {logits.shape} {logits.dtype} "
+              f"(expected: [1, 170, {2 * args.top_k if args.top_k > 0 else 25055}])")
+
+        print("\nSaving model to TorchScript...")
+        model_name = "sensevoice_packed" + INPUT_SUFFIX[args.input_type] + output_suffix
+        model_file = save_model_packed(model, model_name,
+                                       (features, segment_ids, prompt_role))
+        print(f"✅ Model saved to: {model_file}")
+        print(f"\n📌 Note: convert with pt2tflite.py --packed, the DLA name must contain 'sensevoice_packed'")
+
     elif args.mode == "SAVE_PT":
         # Load custom model
         print("Loading custom SenseVoice model...")
         model = create_sensevoice_model(args.model_path)
+        output_suffix = set_output_head(model, args)
+        set_input_type(model, args)
         print("✅ Model loaded successfully\n")
 
         # Use FIXED shape for 10-second audio (166 frames)
         print("Using FIXED input shape for 10-second audio...")
         fixed_frames = 166  # 10s audio: (16000*10 - 400)/160 + 1 = 998 fbank frames -> (998-7)/6+1 = 166 LFR frames
-        features = torch.randn(1, fixed_frames, 560)  # Dummy features for tracing
+        features = torch.randn(args.batch, fixed_frames, 560)  # Dummy features for tracing
+        features = encode_example(features, args.input_type, model.input_scale)
 
         # Create prompt parameters (4 separate scalar inputs)
         prompt = create_prompt(language=args.language, text_norm=args.text_norm)
         language_id, event_id, event_type_id, text_norm_id = prompt
 
         print(f"\nModel inputs (FIXED for 10s audio):")
-        print(f"  - Features: {features.shape} [1, 166, 560]")
+        print(f"  - Features: {features.shape} [{args.batch}, 166, 560]")
         print(f"  - Language ID: {language_id}")
         print(f"  - Event ID: {event_id}")
         print(f"  - Event Type ID: {event_type_id}")
@@ -314,13 +460,26 @@ def main(args):
         model.eval()
         with torch.no_grad():
             logits = model(features, language_id, event_id, event_type_id, text_norm_id)
-        print(f"Output shape: {logits.shape} (expected: [1, 170, 25055])")
+        print(f"Output shape: {logits.shape} {logits.dtype} "
+              f"(expected: [{args.batch}, 170, {2 * args.top_k if args.top_k > 0 else 25055}])")
 
         # Save to TorchScript
         print("\nSaving model to TorchScript...")
-        model_file = save_model_complete(model, features, language_id, event_id, event_type_id, text_norm_id, "sensevoice_complete")
+        model_name = "sensevoice_complete" if args.batch == 1 else f"sensevoice_complete_b{args.batch}"
+        model_name += INPUT_SUFFIX[args.input_type] + output_suffix
+        model_file = save_model_complete(model, features, language_id, event_id, event_type_id, text_norm_id, model_name)
         print(f"✅ Model saved to: {model_file}")
-        print(f"\n📌 Note: Model is traced with FIXED shape [1, 166, 560] for 10-second audio")
+        print(f"\n📌 Note: Model is traced with FIXED shape [{args.batch}, 166, 560] for 10-second audio")
+        if args.batch > 1:
+            print(f"📌 Convert with pt2tflite.py --batch {args.batch} and set ModelConfig::batch_size = {args.batch}")
+        if args.fp16_output:
+            print(f"📌 Logits are float16: keep '_fp16out' in the DLA name (compile_sensevoice_fp.sh MODEL_NAME)")
+        if args.top_k > 0:
+            print(f"📌 Output is the top-{args.top_k} head [values | ids]: keep '{output_suffix}' in the DLA name "
+                  f"(compile_sensevoice_fp.sh MODEL_NAME)")
+        if args.input_type != "float32":
+            print(f"📌 Features are {args.input_type} after host CMVN: keep '{INPUT_SUFFIX[args.input_type]}' in the DLA name "
+                  f"and deploy am.mvn (ModelConfig::cmvn_path or make_bundle.py --cmvn)")
 
     elif args.mode == "CHECK_TFLITE":
         if args.tflite_file_path is None:
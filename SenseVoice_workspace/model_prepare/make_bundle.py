@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""
+Pack a compiled SenseVoice DLA, its vocabulary and the model constants into
+one bundle file (.svb) that the C++ side maps once (ModelBundle).
+
+Layout (little-endian), must match BundleFileHeader / BundleSection in model_bundle.h:
+    header   : magic "SVBN", version u32, num_sections u32, reserved u32,
+               file_bytes u64, reserved u64                      (32 bytes)
+    sections : num_sections x {type u32, reserved u32, offset u64, size u64}
+    payload  : each section starts on a 4 KB boundary
+               1 = DLA, 2 = vocabulary (tokens.bin format), 3 = metadata ("key=value" lines),
+               4 = CMVN (float32 [2, feat_dim]: neg_mean, inv_stddev; reduced-precision inputs only)
+
+Usage:
+    python3 make_bundle.py --dla sensevoice_MT8371.dla \\
+        --tokens ../models/sensevoice-small/tokens.txt -o sensevoice_MT8371.svb
+    python3 make_bundle.py --dla sensevoice_packed_MT8371.dla --packed \\
+        --tokens ../models/sensevoice-small/tokens.json -o sensevoice_packed_MT8371.svb
+    python3 make_bundle.py --dla sensevoice_int8in_MT8371.dla --input_scale 0.0629921 \\
+        --cmvn ../models/sensevoice-small/am.mvn \\
+        --tokens ../models/sensevoice-small/tokens.txt -o sensevoice_int8in_MT8371.svb
+    python3 make_bundle.py --dla sensevoice_complete_top16_MT8371.dla \
+        --tokens ../models/sensevoice-small/tokens.txt -o sensevoice_top16_MT8371.svb
+"""
+
+import argparse
+import os
+import re
+import struct
+
+from tokens2bin import VOCAB_VERSION, build_binary, load_tokens_json, load_tokens_txt
+
+BUNDLE_MAGIC = b'SVBN'
+BUNDLE_VERSION = 1
+
+SECTION_DLA = 1
+SECTION_VOCAB = 2
+SECTION_METADATA = 3
+SECTION_CMVN = 4
+
+SECTION_ALIGN = 4096
+NUM_PROMPT_TOKENS = 4
+
+
+def load_vocab_section(path):
+    """tokens.bin 直接使用, tokens.txt/tokens.json 先转换 (同时算出各语言的 token 区间)"""
+    if path.endswith('.bin'):
+        with open(path, 'rb') as f:
+            data = f.read()
+        if data[:4] != b'SVTK':
+            raise ValueError(f'{path} is not a tokens.bin file')
+        version = struct.unpack_from('<I', data, 4)[0]
+        if version != VOCAB_VERSION:
+            raise ValueError(f'{path} has format v{version}, expected v{VOCAB_VERSION} (re-run tokens2bin.py)')
+        return data
+    vocab = load_tokens_json(path) if path.endswith('.json') else load_tokens_txt(path)
+    data, _, _ = build_binary(vocab)
+    return data
+
+
+def load_cmvn_section(path, feat_dim):
+    """am.mvn (Kaldi nnet: <AddShift> = -mean, <Rescale> = 1/stddev) -> float32 [2, feat_dim]"""
+    with open(path, 'r', encoding='utf-8') as f:
+        content = f.read()
+    rows = []
+    for tag in ('<AddShift>', '<Rescale>'):
+        start = content.find('[', content.find(tag))
+        end = content.find(']', start)
+        if content.find(tag) < 0 or start < 0 or end < 0:
+            raise ValueError(f'{path}: no {tag} vector')
+        values = [float(v) for v in content[start + 1:end].split()]
+        if len(values) != feat_dim:
+            raise ValueError(f'{path}: {tag} has {len(values)} values, expected {feat_dim}')
+        rows.append(values)
+    return struct.pack(f'<{2 * feat_dim}f', *rows[0], *rows[1])
+
+
+def format_shapes(shapes):
+    return ';'.join('x'.join(str(d) for d in shape) for shape in shapes)
+
+
+def build_metadata(args, vocab_size):
+    """与 GetModelInfo 中的固定形状一致 (batch 1, batch 维由 batch_size 给出)"""
+    output_frames = args.input_frames + NUM_PROMPT_TOKENS
+    if args.packed:
+        input_shapes = [[1, output_frames, args.feat_dim], [1, output_frames],
+                        [1, output_frames, NUM_PROMPT_TOKENS]]
+    else:
+        input_shapes = [[1, args.input_frames, args.feat_dim], [1], [1], [1], [1]]
+    # Top-k head: k log-probs then k token ids per row
+    output_width = 2 * args.top_k if args.top_k > 0 else vocab_size
+    output_shapes = [[1, output_frames, output_width]]
+
+    meta = {
+        'name': args.name or os.path.splitext(os.path.basename(args.dla))[0],
+        'input_frames': args.input_frames,
+        'vocab_size': vocab_size,
+        'input_feat_dim': args.feat_dim,
+        'lfr_window_size': args.lfr_m,
+        'lfr_window_shift': args.lfr_n,
+        'sample_rate': 16000,
+        'num_mel_bins': args.feat_dim // args.lfr_m,
+        'batch_size': args.batch,
+        'packed': int(args.packed),
+        'input_shapes': format_shapes(input_shapes),
+        'output_shapes': format_shapes(output_shapes),
+        'input_type': args.input_type,
+        'output_type': 'float16' if args.fp16_output else 'float32',
+    }
+    if args.input_type == 'int8':
+        meta['input_scale'] = args.input_scale
+    return ''.join(f'{k}={v}\n' for k, v in meta.items()).encode('utf-8')
+
+
+def write_bundle(path, sections):
+    table_bytes = 32 + 24 * len(sections)
+    offset = table_bytes
+    layout = []
+    for section_type, data in sections:
+        offset = (offset + SECTION_ALIGN - 1) // SECTION_ALIGN * SECTION_ALIGN
+        layout.append((section_type, offset, len(data)))
+        offset += len(data)
+    file_bytes = offset
+
+    with open(path, 'wb') as f:
+        f.write(struct.pack('<4sIIIQQ', BUNDLE_MAGIC, BUNDLE_VERSION, len(sections), 0, file_bytes, 0))
+        for section_type, section_offset, size in layout:
+            f.write(struct.pack('<IIQQ', section_type, 0, section_offset, size))
+        for (section_type, data), (_, section_offset, _) in zip(sections, layout):
+            f.write(b'\0' * (section_offset - f.tell()))
+            f.write(data)
+    return file_bytes
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Pack SenseVoice DLA + vocabulary + metadata into one bundle')
+    parser.add_argument('--dla', type=str, required=True,
+                        help='Compiled DLA file')
+    parser.add_argument('--tokens', type=str, required=True,
+                        help='Vocabulary: tokens.txt, tokens.json or tokens.bin')
+    parser.add_argument('-o', '--output', type=str, required=True,
+                        help='Output bundle (.svb) path')
+    parser.add_argument('--name', type=str, default=None,
+                        help='Model name stored in the metadata (default: DLA file name)')
+    parser.add_argument('--input_frames', type=int, default=166,
+                        help='LFR frames per window the DLA was compiled with (default: 166)')
+    parser.add_argument('--feat_dim', type=int, default=560,
+                        help='LFR feature dim (default: 560 = 80 x 7)')
+    parser.add_argument('--lfr_m', type=int, default=7,
+                        help='LFR window size (default: 7)')
+    parser.add_argument('--lfr_n', type=int, default=6,
+                        help='LFR window shift (default: 6)')
+    parser.add_argument('--batch', type=int, default=1,
+                        help='Batch dimension the DLA was compiled with (default: 1)')
+    parser.add_argument('--packed', action='store_true',
+                        help='DLA is the packed-batch model')
+    parser.add_argument('--fp16_output', action='store_true',
+                        help="DLA writes float16 logits (default: detected from '_fp16out' in the DLA name)")
+    parser.add_argument('--input_type', type=str, default=None, choices=['float32', 'float16', 'int8'],
+                        help="Features input type (default: detected from '_fp16in' / '_int8in' in the DLA name)")
+    parser.add_argument('--input_scale', type=float, default=8.0 / 127.0,
+                        help='int8 input step the model was exported with (main.py --int8_clip / 127)')
+    parser.add_argument('--cmvn', type=str, default=None,
+                        help='am.mvn, required for float16 / int8 inputs (CMVN runs on the host)')
+    parser.add_argument('--top_k', type=int, default=None,
+                        help="DLA has the top-k output head (default: detected from '_top<k>' in the DLA name)")
+    args = parser.parse_args()
+    dla_name = os.path.basename(args.dla)
+    args.fp16_output = args.fp16_output or '_fp16out' in dla_name
+    if args.top_k is None:
+        match = re.search(r'_top(\d+)', dla_name)
+        args.top_k = int(match.group(1)) if match else 0
+    if args.top_k > 0 and args.fp16_output:
+        parser.error('the top-k head writes float32 (token ids), it cannot be combined with float16 output')
+    if args.input_type is None:
+        args.input_type = 'float16' if '_fp16in' in dla_name else 'int8' if '_int8in' in dla_name else 'float32'
+    if args.input_type != 'float32' and args.cmvn is None:
+        parser.error(f'--cmvn am.mvn is required for {args.input_type} inputs')
+
+    with open(args.dla, 'rb') as f:
+        dla = f.read()
+    vocab = load_vocab_section(args.tokens)
+    vocab_size = struct.unpack_from('<I', vocab, 8)[0]  # num_entries
+    metadata = build_metadata(args, vocab_size)
+
+    sections = [
+        (SECTION_METADATA, metadata),
+        (SECTION_VOCAB, vocab),
+    ]
+    if args.input_type != 'float32':
+        sections.append((SECTION_CMVN, load_cmvn_section(args.cmvn, args.feat_dim)))
+    sections.append((SECTION_DLA, dla))
+    file_bytes = write_bundle(args.output, sections)
+
+    print(metadata.decode('utf-8'), end='')
+    print(f"Wrote {args.output}: DLA {len(dla)} bytes, vocabulary {len(vocab)} bytes, "
+          f"{file_bytes} bytes total (format v{BUNDLE_VERSION})")
+
+
+if __name__ == '__main__':
+    main()
@@ -167,25 +167,27 @@ def load_pretrained_weights(model, model_dir):
     return model
 
 
-def create_sensevoice_model(model_dir):
+def create_sensevoice_model(model_dir, packed=False):
     """
     Create SenseVoice model with pretrained weights and CMVN
 
     Args:
         model_dir: Path to sensevoice-small directory
+        packed: Create the packed-batch variant (SenseVoiceSmallPacked)
 
     Returns:
         model: Complete SenseVoiceSmall model ready for inference
     """
-    from torch_model import SenseVoiceSmall
+    from torch_model import SenseVoiceSmall, SenseVoiceSmallPacked
 
     # Load CMVN parameters
     cmvn_file = os.path.join(model_dir, "am.mvn")
     neg_mean, inv_stddev = load_cmvn(cmvn_file)
 
     # Create model
-    print("Creating SenseVoiceSmall model...")
-    model = SenseVoiceSmall(neg_mean, inv_stddev)
+    model_class = SenseVoiceSmallPacked if packed else SenseVoiceSmall
+    print(f"Creating {model_class.__name__} model...")
+    model = model_class(neg_mean, inv_stddev)
 
     # Load pretrained weights
     model = load_pretrained_weights(model, model_dir)
@@ -4,6 +4,13 @@ Convert SenseVoice PyTorch/TorchScript model to TFLite/MLIR
 
 Usage:
     python3 pt2tflite.py -i model/sensevoice_complete.pt -o model/sensevoice_complete.tflite --float 1
+
+A model saved with main.py --fp16_output (name ends in '_fp16out') casts its
+logits to float16 inside the graph; the converted model keeps that output type.
+A model saved with main.py --input_type float16 / int8 (name contains '_fp16in' /
+'_int8in') takes every input in that type: the executors use one input type.
+A model saved with main.py --top_k k (name contains '_top<k>') ends in log_softmax +
+topk and writes float32 [..., 2k]: k log-probs, then their token ids.
 """
 
 import argparse
@@ -21,10 +28,25 @@ def main():
                         help='Output TFLite/MLIR file path')
     parser.add_argument('--float', type=int, default=1,
                         help='Use float32 (1) or quantize (0). Default: 1')
-    parser.add_argument('--input_shapes', type=str, default="[[1,166,560],[1],[1],[1],[1]]",
+    parser.add_argument('--input_shapes', type=str, default=None,
                         help='Input shapes as string. Default: [[1,166,560],[1],[1],[1],[1]] for 10s audio with 4 scalar prompt inputs')
+    parser.add_argument('--batch', type=int, default=1,
+                        help='Batch dimension of the features input (default: 1)')
+    parser.add_argument('--packed', action='store_true',
+                        help='Packed-batch model: inputs are [[1,170,560],[1,170],[1,170,4]] (features, segment_ids, prompt_role)')
     args = parser.parse_args()
 
+    if args.input_shapes is None:
+        args.input_shapes = "[[1,170,560],[1,170],[1,170,4]]" if args.packed else f"[[{args.batch},166,560],[1],[1],[1],[1]]"
+    name = os.path.basename(args.input)
+    reduced_type = torch.float16 if '_fp16in' in name else torch.int8 if '_int8in' in name else None
+    if args.packed:
+        input_types = [reduced_type or torch.float32] * 3  # features + segment ids + prompt roles
+    elif reduced_type is not None:
+        input_types = [reduced_type] * 5  # features + 4 prompt scalars, all in the reduced type
+    else:
+        input_types = [torch.float32, torch.int32, torch.int32, torch.int32, torch.int32]  # 5 inputs: features + 4 prompt scalars
+
     print(f"\n{'='*80}")
     print(f"SenseVoice TorchScript to TFLite Conversion")
     print(f"{'='*80}\n")
@@ -54,7 +76,7 @@ def main():
         converter = mtk_converter.PyTorchConverter.from_script_module_file(
             args.input,
             input_shapes=input_shapes,
-            input_types=[torch.float32, torch.int32, torch.int32, torch.int32, torch.int32],  # 5 inputs: features + 4 prompt scalars
+            input_types=input_types,
         )
 
         # Set quantization mode
@@ -86,8 +108,9 @@ def main():
         # Print model info
         print(f"\nModel Information:")
         print(f"  Input shapes: {input_shapes}")
-        print(f"  Input types: [float32, int32, int32, int32, int32]")
-        print(f"  Output: CTC logits [1, T+4, 25055]")
+        print(f"  Input types: {[str(t).replace('torch.', '') for t in input_types]}")
+        output_type = 'float16' if '_fp16out' in name else 'float32'
+        print(f"  Output: CTC logits [{args.batch}, {'170' if args.packed else 'T+4'}, 25055] {output_type}")
 
     except Exception as e:
         print(f"\n❌ Error during conversion: {e}")
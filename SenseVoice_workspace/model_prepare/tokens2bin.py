@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+"""
+Convert the SenseVoice vocabulary (tokens.txt / tokens.json) to the binary
+tokens.bin format that the C++ Tokenizer mmaps without parsing.
+
+Layout (little-endian), must match VocabFileHeader / VocabEntry in tokenizer.h:
+    header   : magic "SVTK", version, num_entries, num_tokens, blank_id,
+               index_slots, arena_bytes, num_language_ranges  (8 x 4 bytes)
+    entries  : num_entries x {token_offset u32, display_offset u32,
+               token_length u16, display_length u16, flags u32}
+    index    : index_slots x u32, FNV-1a open addressing of id + 1 (0 = empty)
+    ranges   : num_language_ranges x {language i32, begin i32, end i32},
+               allowed token ids per language (Tokenizer::LanguageTokens)
+    arena    : raw tokens and display forms (U+2581 -> ' '), back to back
+
+Usage:
+    python3 tokens2bin.py -i ../models/sensevoice-small/tokens.txt -o tokens.bin
+    python3 tokens2bin.py -i ../models/sensevoice-small/tokens.json -o tokens.bin
+"""
+
+import argparse
+import json
+import struct
+
+VOCAB_MAGIC = b'SVTK'
+VOCAB_VERSION = 2
+
+ENTRY_VALID = 1 << 0
+ENTRY_SPECIAL = 1 << 1
+
+MAX_TOKEN_ID = 1 << 22
+SPACE_MARKER = '▁'
+
+# 与 tokenizer.cpp 的 CodepointScript / kLanguageScripts 一致
+SCRIPT_LATIN = 1 << 0
+SCRIPT_HAN = 1 << 1
+SCRIPT_KANA = 1 << 2
+SCRIPT_HANGUL = 1 << 3
+
+# (prompt 语言 id, 允许的文字): zh, en, yue, ja, ko
+LANGUAGE_SCRIPTS = [
+    (3, SCRIPT_HAN | SCRIPT_LATIN),
+    (4, SCRIPT_LATIN),
+    (7, SCRIPT_HAN | SCRIPT_LATIN),
+    (11, SCRIPT_HAN | SCRIPT_KANA | SCRIPT_LATIN),
+    (12, SCRIPT_HANGUL | SCRIPT_LATIN),
+]
+
+
+def load_tokens_txt(path):
+    """读取 "token id" 格式, 与 Tokenizer::LoadText 规则一致 (后出现的行覆盖)"""
+    vocab = {}
+    with open(path, 'r', encoding='utf-8') as f:
+        for line in f:
+            line = line.rstrip('\r\n')
+            if not line:
+                continue
+            sep = line.rfind(' ')
+            if sep < 0:
+                sep = line.rfind('\t')
+            if sep < 0:
+                continue
+            token = line[:sep].rstrip(' \t')
+            try:
+                token_id = int(line[sep + 1:].lstrip(' \t'))
+            except ValueError:
+                continue
+            vocab[token_id] = token
+    return vocab
+
+
+def load_tokens_json(path):
+    """读取 JSON 列表 (下标即 id) 或 {token: id} 字典"""
+    with open(path, 'r', encoding='utf-8') as f:
+        data = json.load(f)
+    if isinstance(data, list):
+        return {i: token for i, token in enumerate(data)}
+    return {int(token_id): token for token, token_id in data.items()}
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def codepoint_script(c):
+    if (ord('A') <= c <= ord('Z') or ord('a') <= c <= ord('z') or
+            (0xC0 <= c <= 0x24F and c not in (0xD7, 0xF7)) or
+            0xFF21 <= c <= 0xFF3A or 0xFF41 <= c <= 0xFF5A):
+        return SCRIPT_LATIN
+    if (0x4E00 <= c <= 0x9FFF or 0x3400 <= c <= 0x4DBF or 0xF900 <= c <= 0xFAFF or
+            0x20000 <= c <= 0x2FFFF or 0x3005 <= c <= 0x3007):
+        return SCRIPT_HAN
+    if 0x3040 <= c <= 0x30FF or 0x31F0 <= c <= 0x31FF or 0xFF66 <= c <= 0xFF9F:
+        return SCRIPT_KANA
+    if 0xAC00 <= c <= 0xD7AF or 0x1100 <= c <= 0x11FF or 0x3130 <= c <= 0x318F:
+        return SCRIPT_HANGUL
+    return 0
+
+
+def language_ranges(vocab, num_entries, blank_id):
+    """每种语言可输出的 token id 区间 [begin, end), 与 Tokenizer::BuildLanguageTokens 一致:
+    字母全部属于该语言文字的 token, 加上数字、标点、blank、特殊 token 和空缺 id"""
+    scripts = [0] * num_entries
+    for token_id, token in vocab.items():
+        if token_id != blank_id and token != '' and token[0] != '<':
+            for ch in token:
+                scripts[token_id] |= codepoint_script(ord(ch))
+
+    ranges = []
+    for language, allowed in LANGUAGE_SCRIPTS:
+        begin = None
+        for token_id in range(num_entries + 1):
+            ok = token_id < num_entries and not (scripts[token_id] & ~allowed)
+            if ok and begin is None:
+                begin = token_id
+            elif not ok and begin is not None:
+                ranges.append((language, begin, token_id))
+                begin = None
+    return ranges
+
+
+def build_binary(vocab):
+    vocab = {i: t for i, t in vocab.items()
+             if 0 <= i < MAX_TOKEN_ID and len(t.encode('utf-8')) <= 0xFFFF}
+    if not vocab:
+        raise ValueError('empty vocabulary')
+
+    num_entries = max(vocab) + 1
+    entries = [(0, 0, 0, 0, 0)] * num_entries
+    arena = bytearray()
+    raw = {}
+    for token_id in sorted(vocab):
+        token = vocab[token_id]
+        token_bytes = token.encode('utf-8')
+        special = token == '' or token[0] == '<'
+        display_bytes = b'' if special else token.replace(SPACE_MARKER, ' ').encode('utf-8')
+
+        token_offset = len(arena)
+        arena += token_bytes
+        display_offset = len(arena)
+        arena += display_bytes
+        flags = ENTRY_VALID | (ENTRY_SPECIAL if special else 0)
+        entries[token_id] = (token_offset, display_offset, len(token_bytes), len(display_bytes), flags)
+        raw[token_id] = token_bytes
+
+    # Reverse lookup table, same probing as Tokenizer::TokenToId
+    slots = 1
+    while slots < len(vocab) * 2:
+        slots <<= 1
+    index = [0] * slots
+    for token_id in sorted(vocab):
+        slot = fnv1a(raw[token_id]) & (slots - 1)
+        while index[slot] != 0 and raw[index[slot] - 1] != raw[token_id]:
+            slot = (slot + 1) & (slots - 1)
+        index[slot] = token_id + 1  # 重复 token 映射到最大的 id
+
+    token_to_id = {t: i for i, t in sorted(vocab.items())}
+    blank_id = token_to_id.get('<blank>', token_to_id.get('<blk>', 0))
+    ranges = language_ranges(vocab, num_entries, blank_id)
+
+    out = bytearray()
+    out += struct.pack('<4sIIIiIII', VOCAB_MAGIC, VOCAB_VERSION, num_entries, len(vocab),
+                       blank_id, slots, len(arena), len(ranges))
+    for e in entries:
+        out += struct.pack('<IIHHI', *e)
+    out += struct.pack(f'<{slots}I', *index)
+    for r in ranges:
+        out += struct.pack('<iii', *r)
+    out += arena
+    return bytes(out), len(vocab), blank_id
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert SenseVoice tokens.txt/tokens.json to binary tokens.bin')
+    parser.add_argument('-i', '--input', type=str, required=True,
+                        help='Input tokens.txt ("token id" per line) or tokens.json')
+    parser.add_argument('-o', '--output', type=str, required=True,
+                        help='Output tokens.bin file path')
+    args = parser.parse_args()
+
+    if args.input.endswith('.json'):
+        vocab = load_tokens_json(args.input)
+    else:
+        vocab = load_tokens_txt(args.input)
+
+    data, num_tokens, blank_id = build_binary(vocab)
+    with open(args.output, 'wb') as f:
+        f.write(data)
+
+    print(f"Wrote {args.output}: {num_tokens} tokens, blank_id={blank_id}, "
+          f"{len(data)} bytes (format v{VOCAB_VERSION})")
+
+
+if __name__ == '__main__':
+    main()
@@ -40,9 +40,10 @@ class SinusoidalPositionEncoder(nn.Module):
         encoding = torch.cat([torch.sin(scaled_time), torch.cos(scaled_time)], dim=2)
         return encoding.type(dtype)
 
-    def forward(self, x):
+    def forward(self, x, positions=None):
         batch_size, timesteps, input_dim = x.size()
-        positions = torch.arange(1, timesteps + 1, device=x.device)[None, :]
+        if positions is None:
+            positions = torch.arange(1, timesteps + 1, device=x.device)[None, :]
         position_encoding = self.encode(positions, input_dim, x.dtype).to(x.device)
 
         return x + position_encoding
@@ -367,26 +368,37 @@ class SenseVoiceEncoderSmall(nn.Module):
         self.after_norm = LayerNorm(self.output_size)
         self.tp_norm = LayerNorm(self.output_size)
 
-    def forward(self, xs_pad: torch.Tensor):
-        masks = None
-
+    def forward(
+        self,
+        xs_pad: torch.Tensor,
+        masks: torch.Tensor = None,
+        att_masks: torch.Tensor = None,
+        positions: torch.Tensor = None,
+    ):
+        """
+        Args:
+          xs_pad: (batch, T, 560)
+          masks: (batch, 1, T) 1 for valid rows, 0 for padding; None = all valid
+          att_masks: (batch, T, T) extra attention mask (block-diagonal for packed input)
+          positions: (batch, T) position ids for the sinusoidal encoding
+        """
         xs_pad *= self.output_size**0.5
 
-        xs_pad = self.embed(xs_pad)
+        xs_pad = self.embed(xs_pad, positions)
 
         # forward encoder1
         for layer_idx, encoder_layer in enumerate(self.encoders0):
-            encoder_outs = encoder_layer(xs_pad, masks)
+            encoder_outs = encoder_layer(xs_pad, masks, mask_att_chunk_encoder=att_masks)
             xs_pad, masks = encoder_outs[0], encoder_outs[1]
 
         for layer_idx, encoder_layer in enumerate(self.encoders):
-            encoder_outs = encoder_layer(xs_pad, masks)
+            encoder_outs = encoder_layer(xs_pad, masks, mask_att_chunk_encoder=att_masks)
             xs_pad, masks = encoder_outs[0], encoder_outs[1]
 
         xs_pad = self.after_norm(xs_pad)
 
         for layer_idx, encoder_layer in enumerate(self.tp_encoders):
-            encoder_outs = encoder_layer(xs_pad, masks)
+            encoder_outs = encoder_layer(xs_pad, masks, mask_att_chunk_encoder=att_masks)
             xs_pad, masks = encoder_outs[0], encoder_outs[1]
 
         xs_pad = self.tp_norm(xs_pad)
@@ -507,16 +519,49 @@ class SenseVoiceSmall(nn.Module):
         self.event_type_prompt = torch.nn.Parameter(torch.zeros(1, self.input_size))
         self.text_norm_prompt = torch.nn.Parameter(torch.zeros(1, self.input_size))
 
+        # fp16-output variant: logits leave the model as float16, halving the
+        # readback; set before tracing (main.py --fp16_output)
+        self.output_fp16 = False
+
+        # Reduced-precision input variant (main.py --input_type): the host applies
+        # CMVN while gathering the LFR frames and writes float16, or int8 steps of
+        # input_scale, so the graph only widens the features; set before tracing
+        self.input_type = "float32"
+        self.input_scale = 1.0
+
+        # Top-k output head (main.py --top_k): per row the k best log-probs and
+        # their token ids instead of the full 25055-wide logits; 0 keeps the logits
+        self.top_k = 0
+
+    def normalize_features(self, x):
+        """CMVN in the graph, or widen the host-normalized reduced-precision features"""
+        if self.input_type == "int8":
+            return x.float() * self.input_scale
+        if self.input_type == "float16":
+            return x.float()
+        return (x + self.neg_mean) * self.inv_stddev
+
+    def output_head(self, logits):
+        """Full logits (float16 with output_fp16), or [values | ids] of the top_k log-probs"""
+        if self.top_k > 0:
+            log_probs = F.log_softmax(logits, dim=-1)
+            values, indices = torch.topk(log_probs, self.top_k, dim=-1)  # descending
+            # One float32 tensor [..., 2k]: ids < 2^24 are exact as floats
+            return torch.cat([values, indices.float()], dim=-1)
+        if self.output_fp16:
+            return logits.half()
+        return logits
+
     def forward(self, x, language_id, event_id, event_type_id, text_norm_id):
         """
         Args:
-            x: Audio features [1, T, 560]
+            x: Audio features [B, T, 560] (B = 1, or N for a batch-N export)
             language_id: Language ID [1] (scalar, not used in forward, only for compatibility)
             event_id: Event ID [1] (scalar, not used in forward)
             event_type_id: Event type ID [1] (scalar, not used in forward)
             text_norm_id: Text normalization ID [1] (scalar, not used in forward)
         Returns:
-            logits: CTC output [1, T+4, 25055]
+            logits: CTC output [B, T+4, 25055] ([B, T+4, 2k] with top_k)
         """
         # Ensure inputs are tensors (but we won't use them for lookup)
         if not isinstance(language_id, torch.Tensor):
@@ -547,17 +592,69 @@ class SenseVoiceSmall(nn.Module):
             self.event_type_prompt,    # [1, 560]
             self.text_norm_prompt      # [1, 560]
         ], dim=0).unsqueeze(0)  # [1, 4, 560]
+        input_query = input_query.expand(x.size(0), -1, -1)  # [B, 4, 560] for batch-N exports
 
-        # CMVN normalization
-        x = (x + self.neg_mean) * self.inv_stddev
+        # CMVN normalization (already applied on the host for reduced-precision inputs)
+        x = self.normalize_features(x)
 
         # Concatenate prompt + features
-        x = torch.cat((input_query, x), dim=1)  # [1, T+4, 560]
+        x = torch.cat((input_query, x), dim=1)  # [B, T+4, 560]
 
         # Encoder
-        encoder_out = self.encoder(x)  # [1, T+4, 512]
+        encoder_out = self.encoder(x)  # [B, T+4, 512]
 
         # CTC output layer
-        logits = self.ctc.ctc_lo(encoder_out)  # [1, T+4, 25055]
+        logits = self.ctc.ctc_lo(encoder_out)  # [B, T+4, 25055]
 
-        return logits
+        return self.output_head(logits)
+
+
+class SenseVoiceSmallPacked(SenseVoiceSmall):
+    """
+    Packed-batch SenseVoice model: several short utterances share one window.
+
+    The host lays each utterance out as [4 prompt rows | its LFR frames] and
+    separates neighbours with at least 5 masked rows, so the FSMN memory block
+    (kernel 11) never reaches across an utterance boundary. Attention is made
+    block-diagonal from segment_ids and positions restart at 1 for every
+    utterance, so each one is encoded as if it had been run on its own.
+    """
+    def forward(self, x, segment_ids, prompt_role):
+        """
+        Args:
+            x: Audio features [1, T, 560] (prompt and gap rows are ignored)
+            segment_ids: Utterance index per row [1, T], 1..N for utterance rows, 0 for gap/padding
+            prompt_role: One-hot prompt slot per row [1, T, 4], all zero for feature rows
+        Returns:
+            logits: CTC output [1, T, 25055] ([1, T, 2k] with top_k)
+        """
+        prompts = torch.cat([
+            self.language_prompt,
+            self.event_prompt,
+            self.event_type_prompt,
+            self.text_norm_prompt
+        ], dim=0)  # [4, 560]
+
+        # CMVN normalization, then put the prompt vectors on the prompt rows;
+        # reduced-precision variants take the ids and roles in the same type
+        x = self.normalize_features(x)
+        if self.input_type != "float32":
+            segment_ids = segment_ids.float()
+            prompt_role = prompt_role.float()
+        is_prompt = torch.sum(prompt_role, dim=-1, keepdim=True)  # [1, T, 1]
+        x = x * (1.0 - is_prompt) + torch.matmul(prompt_role, prompts)
+
+        # Row validity and block-diagonal attention mask
+        valid = (segment_ids > 0).float()  # [1, T]
+        masks = valid.unsqueeze(1)  # [1, 1, T]
+        same = torch.eq(segment_ids.unsqueeze(2), segment_ids.unsqueeze(1)).float()  # [1, T, T]
+
+        # Position of each row inside its own utterance (1-based)
+        timesteps = x.size(1)
+        lower = torch.tril(torch.ones(timesteps, timesteps, device=x.device))
+        positions = torch.sum(same * lower.unsqueeze(0), dim=-1)  # [1, T]
+
+        encoder_out = self.encoder(x, masks, same, positions)  # [1, T, 512]
+        logits = self.ctc.ctc_lo(encoder_out)  # [1, T, 25055]
+
+        return self.output_head(logits)
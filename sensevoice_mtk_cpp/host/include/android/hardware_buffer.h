@@ -0,0 +1,54 @@
+/* Host build stand-in for <android/hardware_buffer.h>
+ *
+ * There is no AHardwareBuffer on a Linux host: allocation always fails, so
+ * Memory::CreateNeuronMemory reports the error like on a device without
+ * the allocator. The host build force-includes this header (see
+ * CMakeLists.txt) because NeuronAdapter.h only includes it on Android.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AHardwareBuffer AHardwareBuffer;
+
+typedef struct AHardwareBuffer_Desc {
+    uint32_t width;
+    uint32_t height;
+    uint32_t layers;
+    uint32_t format;
+    uint64_t usage;
+    uint32_t stride;
+    uint32_t rfu0;
+    uint64_t rfu1;
+} AHardwareBuffer_Desc;
+
+typedef struct ARect {
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+} ARect;
+
+enum {
+    AHARDWAREBUFFER_FORMAT_BLOB = 0x21,
+};
+
+enum {
+    AHARDWAREBUFFER_USAGE_CPU_READ_RARELY = 2UL,
+    AHARDWAREBUFFER_USAGE_CPU_WRITE_RARELY = 2UL << 4,
+};
+
+int AHardwareBuffer_allocate(const AHardwareBuffer_Desc* desc, AHardwareBuffer** outBuffer);
+void AHardwareBuffer_release(AHardwareBuffer* buffer);
+int AHardwareBuffer_lock(AHardwareBuffer* buffer, uint64_t usage, int32_t fence,
+                         const ARect* rect, void** outVirtualAddress);
+int AHardwareBuffer_unlock(AHardwareBuffer* buffer, int32_t* fence);
+
+#ifdef __cplusplus
+}
+#endif
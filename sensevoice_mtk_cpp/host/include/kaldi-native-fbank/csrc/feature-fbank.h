@@ -0,0 +1,45 @@
+/* Host build stand-in for kaldi-native-fbank: fbank options
+ *
+ * Same option structs and defaults as kaldi-native-fbank, so
+ * AudioFrontend compiles unchanged. The computation lives in
+ * host/src/online_fbank.cpp.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace knf {
+
+struct FrameExtractionOptions {
+    float samp_freq = 16000.0f;
+    float frame_shift_ms = 10.0f;
+    float frame_length_ms = 25.0f;
+    float dither = 1.0f;
+    float preemph_coeff = 0.97f;
+    bool remove_dc_offset = true;
+    std::string window_type = "povey";  // povey, hamming, hanning, rectangular
+    bool round_to_power_of_two = true;
+    float blackman_coeff = 0.42f;
+    bool snip_edges = true;
+};
+
+struct MelBanksOptions {
+    int32_t num_bins = 25;
+    float low_freq = 20.0f;
+    float high_freq = 0.0f;  // <= 0: offset from the Nyquist frequency
+};
+
+struct FbankOptions {
+    FrameExtractionOptions frame_opts;
+    MelBanksOptions mel_opts;
+    bool use_energy = false;
+    float energy_floor = 0.0f;
+    bool raw_energy = true;
+    bool htk_compat = false;
+    bool use_log_fbank = true;
+    bool use_power = true;
+};
+
+}  // namespace knf
@@ -0,0 +1,54 @@
+/* Host build stand-in for kaldi-native-fbank: online fbank
+ *
+ * Kaldi fbank pipeline (DC removal, pre-emphasis, window, FFT power
+ * spectrum, triangular mel banks, log) with the OnlineFbank interface the
+ * frontend uses. Written for host tests and benches: it follows the Kaldi
+ * formulas but is not bit-exact with the library used on device.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "kaldi-native-fbank/csrc/feature-fbank.h"
+
+namespace knf {
+
+class OnlineFbank {
+public:
+    explicit OnlineFbank(const FbankOptions& opts);
+
+    // Samples are appended; frames are computed once their window is complete
+    void AcceptWaveform(float sampling_rate, const float* waveform, int32_t n);
+
+    // With snip_edges = false the last frames (reflected past the end) are added
+    void InputFinished();
+
+    int32_t NumFramesReady() const { return static_cast<int32_t>(frames_.size() / dim_); }
+
+    // num_bins log mel energies (one more, first, with use_energy)
+    const float* GetFrame(int32_t frame) const { return frames_.data() + static_cast<size_t>(frame) * dim_; }
+
+private:
+    void ComputeFrames(int32_t num_frames);
+    void ComputeFrame(int32_t frame, float* out);
+
+    FbankOptions opts_;
+    int32_t frame_length_ = 0;
+    int32_t frame_shift_ = 0;
+    int32_t fft_size_ = 0;
+    size_t dim_ = 0;
+    bool finished_ = false;
+    uint32_t dither_seed_ = 1;
+
+    std::vector<float> waveform_;
+    std::vector<float> frames_;
+    std::vector<float> window_;
+    std::vector<int32_t> bank_first_;           // First FFT bin of each mel bank
+    std::vector<std::vector<float>> bank_weights_;
+    std::vector<float> fft_re_;
+    std::vector<float> fft_im_;
+};
+
+}  // namespace knf
@@ -0,0 +1,18 @@
+/* Host build stand-in for <sys/system_properties.h>
+ *
+ * No Android properties on a host: every property reads as unset.
+ */
+
+#pragma once
+
+#define PROP_VALUE_MAX 92
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int __system_property_get(const char* name, char* value);
+
+#ifdef __cplusplus
+}
+#endif
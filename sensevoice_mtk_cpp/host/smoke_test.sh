@@ -0,0 +1,60 @@
+#!/bin/bash
+#
+# Host smoke test: start sensevoice_server on the CPU stand-in model with a
+# temporary socket, run sensevoice_loadgen against it over both transports,
+# then check that SIGTERM drains the server cleanly.
+#
+# Usage: smoke_test.sh <sensevoice_server> <sensevoice_loadgen> <tokens.txt>
+#
+
+set -u
+
+SERVER="$1"
+LOADGEN="$2"
+TOKENS="$3"
+
+WORK_DIR="$(mktemp -d)"
+SOCKET="$WORK_DIR/sensevoice.sock"
+SERVER_PID=""
+
+cleanup() {
+    if [ -n "$SERVER_PID" ] && kill -0 "$SERVER_PID" 2>/dev/null; then
+        kill -KILL "$SERVER_PID" 2>/dev/null
+    fi
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+fail() {
+    echo "FAIL: $1"
+    echo "--- server log ---"
+    tail -n 30 "$WORK_DIR/server.log"
+    exit 1
+}
+
+# easylogging writes its log file into the working directory
+cd "$WORK_DIR" || exit 1
+
+# HostExecutor picks the model shapes from the file name, nothing is read.
+# 2 requests in flight, 32 queued, 2 ms simulated model latency
+"$SERVER" sensevoice_host.dla "$TOKENS" "$SOCKET" 2 32 host:2000 > server.log 2>&1 &
+SERVER_PID=$!
+
+for _ in $(seq 100); do
+    [ -S "$SOCKET" ] && break
+    kill -0 "$SERVER_PID" 2>/dev/null || fail "server exited during startup"
+    sleep 0.1
+done
+[ -S "$SOCKET" ] || fail "server socket did not appear"
+
+# 20 requests, 4 clients, 2 s of synthetic audio
+"$LOADGEN" "$SOCKET" 20 4 2 auto socket || fail "loadgen over the socket transport"
+"$LOADGEN" "$SOCKET" 20 4 2 auto shm || fail "loadgen over the shm transport"
+
+kill -TERM "$SERVER_PID"
+wait "$SERVER_PID"
+STATUS=$?
+SERVER_PID=""
+[ "$STATUS" -eq 0 ] || fail "server exited with status $STATUS after SIGTERM"
+
+echo "PASS"
@@ -0,0 +1,58 @@
+/* Host build stand-ins for the Android system calls the executors link against */
+
+#include <android/hardware_buffer.h>
+#include <android/log.h>
+#include <sys/system_properties.h>
+
+#include <cstdarg>
+#include <cstdio>
+
+extern "C" {
+
+int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    static const char kLevels[] = "??VDIWEFS";
+    std::fprintf(stderr, "%c/%s: ", (prio >= 0 && prio <= ANDROID_LOG_SILENT) ? kLevels[prio] : '?',
+                 tag ? tag : "");
+    va_list args;
+    va_start(args, fmt);
+    int written = std::vfprintf(stderr, fmt, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+    return written;
+}
+
+int __system_property_get(const char* name, char* value) {
+    (void)name;
+    value[0] = '\0';
+    return 0;
+}
+
+int AHardwareBuffer_allocate(const AHardwareBuffer_Desc* desc, AHardwareBuffer** outBuffer) {
+    (void)desc;
+    *outBuffer = nullptr;
+    return -1;
+}
+
+void AHardwareBuffer_release(AHardwareBuffer* buffer) {
+    (void)buffer;
+}
+
+int AHardwareBuffer_lock(AHardwareBuffer* buffer, uint64_t usage, int32_t fence,
+                         const ARect* rect, void** outVirtualAddress) {
+    (void)buffer;
+    (void)usage;
+    (void)fence;
+    (void)rect;
+    *outVirtualAddress = nullptr;
+    return -1;
+}
+
+int AHardwareBuffer_unlock(AHardwareBuffer* buffer, int32_t* fence) {
+    (void)buffer;
+    if (fence) {
+        *fence = -1;
+    }
+    return -1;
+}
+
+}  // extern "C"
@@ -0,0 +1,220 @@
+/* Host build stand-in for kaldi-native-fbank: online fbank implementation */
+
+#include "kaldi-native-fbank/csrc/online-feature.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace knf {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+double MelScale(double freq) {
+    return 1127.0 * std::log(1.0 + freq / 700.0);
+}
+
+// In-place radix-2 complex FFT, size a power of two
+void Fft(std::vector<float>* re, std::vector<float>* im) {
+    const size_t n = re->size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap((*re)[i], (*re)[j]);
+            std::swap((*im)[i], (*im)[j]);
+        }
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const double angle = -2.0 * kPi / static_cast<double>(len);
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < len / 2; ++k) {
+                const float wr = static_cast<float>(std::cos(angle * k));
+                const float wi = static_cast<float>(std::sin(angle * k));
+                const size_t a = i + k;
+                const size_t b = a + len / 2;
+                const float xr = (*re)[b] * wr - (*im)[b] * wi;
+                const float xi = (*re)[b] * wi + (*im)[b] * wr;
+                (*re)[b] = (*re)[a] - xr;
+                (*im)[b] = (*im)[a] - xi;
+                (*re)[a] += xr;
+                (*im)[a] += xi;
+            }
+        }
+    }
+}
+
+}  // namespace
+
+OnlineFbank::OnlineFbank(const FbankOptions& opts) : opts_(opts) {
+    const FrameExtractionOptions& f = opts_.frame_opts;
+    frame_length_ = static_cast<int32_t>(f.samp_freq * 0.001f * f.frame_length_ms);
+    frame_shift_ = static_cast<int32_t>(f.samp_freq * 0.001f * f.frame_shift_ms);
+    fft_size_ = frame_length_;
+    if (f.round_to_power_of_two) {
+        fft_size_ = 1;
+        while (fft_size_ < frame_length_) {
+            fft_size_ <<= 1;
+        }
+    }
+    dim_ = static_cast<size_t>(opts_.mel_opts.num_bins) + (opts_.use_energy ? 1 : 0);
+
+    window_.resize(frame_length_);
+    const double a = 2.0 * kPi / (frame_length_ - 1);
+    for (int32_t i = 0; i < frame_length_; ++i) {
+        double w = 1.0;
+        if (f.window_type == "hanning") {
+            w = 0.5 - 0.5 * std::cos(a * i);
+        } else if (f.window_type == "hamming") {
+            w = 0.54 - 0.46 * std::cos(a * i);
+        } else if (f.window_type == "povey") {
+            w = std::pow(0.5 - 0.5 * std::cos(a * i), 0.85);
+        } else if (f.window_type == "blackman") {
+            w = f.blackman_coeff - 0.5 * std::cos(a * i) + (0.5 - f.blackman_coeff) * std::cos(2 * a * i);
+        }
+        window_[i] = static_cast<float>(w);
+    }
+
+    // Triangular banks, equally spaced on the mel scale
+    const MelBanksOptions& m = opts_.mel_opts;
+    const double nyquist = 0.5 * f.samp_freq;
+    const double high = m.high_freq > 0.0f ? m.high_freq : nyquist + m.high_freq;
+    const double mel_low = MelScale(m.low_freq);
+    const double mel_delta = (MelScale(high) - mel_low) / (m.num_bins + 1);
+    const int32_t num_fft_bins = fft_size_ / 2;
+    const double fft_bin_width = f.samp_freq / fft_size_;
+    bank_first_.assign(m.num_bins, 0);
+    bank_weights_.assign(m.num_bins, {});
+    for (int32_t b = 0; b < m.num_bins; ++b) {
+        const double left = mel_low + b * mel_delta;
+        const double center = left + mel_delta;
+        const double right = center + mel_delta;
+        int32_t first = -1;
+        for (int32_t i = 0; i < num_fft_bins; ++i) {
+            const double mel = MelScale(fft_bin_width * i);
+            if (mel <= left || mel >= right) {
+                continue;
+            }
+            const double weight = mel <= center ? (mel - left) / (center - left) : (right - mel) / (right - center);
+            if (first < 0) {
+                first = i;
+            }
+            bank_weights_[b].resize(i - first + 1, 0.0f);
+            bank_weights_[b][i - first] = static_cast<float>(weight);
+        }
+        bank_first_[b] = std::max(first, 0);
+    }
+    fft_re_.resize(fft_size_);
+    fft_im_.resize(fft_size_);
+}
+
+void OnlineFbank::AcceptWaveform(float sampling_rate, const float* waveform, int32_t n) {
+    (void)sampling_rate;
+    if (finished_ || n <= 0) {
+        return;
+    }
+    waveform_.insert(waveform_.end(), waveform, waveform + n);
+    if (opts_.frame_opts.snip_edges) {
+        const int64_t samples = static_cast<int64_t>(waveform_.size());
+        ComputeFrames(samples < frame_length_ ? 0
+                                              : static_cast<int32_t>(1 + (samples - frame_length_) / frame_shift_));
+    }
+}
+
+void OnlineFbank::InputFinished() {
+    finished_ = true;
+    if (!opts_.frame_opts.snip_edges) {
+        const int64_t samples = static_cast<int64_t>(waveform_.size());
+        ComputeFrames(static_cast<int32_t>((samples + frame_shift_ / 2) / frame_shift_));
+    }
+}
+
+void OnlineFbank::ComputeFrames(int32_t num_frames) {
+    for (int32_t frame = NumFramesReady(); frame < num_frames; ++frame) {
+        frames_.resize(frames_.size() + dim_);
+        ComputeFrame(frame, frames_.data() + frames_.size() - dim_);
+    }
+}
+
+void OnlineFbank::ComputeFrame(int32_t frame, float* out) {
+    const FrameExtractionOptions& f = opts_.frame_opts;
+    const int64_t samples = static_cast<int64_t>(waveform_.size());
+    int64_t start = static_cast<int64_t>(frame) * frame_shift_;
+    if (!f.snip_edges) {
+        start += frame_shift_ / 2 - frame_length_ / 2;
+    }
+
+    std::fill(fft_re_.begin(), fft_re_.end(), 0.0f);
+    std::fill(fft_im_.begin(), fft_im_.end(), 0.0f);
+    for (int32_t i = 0; i < frame_length_; ++i) {
+        // Reflect at both ends (only reached with snip_edges = false)
+        int64_t s = start + i;
+        while (s < 0 || s >= samples) {
+            s = s < 0 ? -s - 1 : 2 * samples - 1 - s;
+        }
+        fft_re_[i] = waveform_[static_cast<size_t>(s)];
+    }
+
+    if (f.dither != 0.0f) {
+        for (int32_t i = 0; i < frame_length_; ++i) {
+            dither_seed_ = dither_seed_ * 1664525u + 1013904223u;
+            const float u1 = (static_cast<float>(dither_seed_ >> 8) + 1.0f) / 16777217.0f;
+            dither_seed_ = dither_seed_ * 1664525u + 1013904223u;
+            const float u2 = static_cast<float>(dither_seed_ >> 8) / 16777216.0f;
+            fft_re_[i] += f.dither * std::sqrt(-2.0f * std::log(u1)) * std::cos(2.0f * static_cast<float>(kPi) * u2);
+        }
+    }
+    if (f.remove_dc_offset) {
+        double mean = 0.0;
+        for (int32_t i = 0; i < frame_length_; ++i) {
+            mean += fft_re_[i];
+        }
+        mean /= frame_length_;
+        for (int32_t i = 0; i < frame_length_; ++i) {
+            fft_re_[i] -= static_cast<float>(mean);
+        }
+    }
+    float log_energy = 0.0f;
+    if (opts_.use_energy && opts_.raw_energy) {
+        double energy = 0.0;
+        for (int32_t i = 0; i < frame_length_; ++i) {
+            energy += static_cast<double>(fft_re_[i]) * fft_re_[i];
+        }
+        log_energy = static_cast<float>(std::log(std::max(energy, static_cast<double>(FLT_EPSILON))));
+    }
+    if (f.preemph_coeff != 0.0f) {
+        for (int32_t i = frame_length_ - 1; i > 0; --i) {
+            fft_re_[i] -= f.preemph_coeff * fft_re_[i - 1];
+        }
+        fft_re_[0] -= f.preemph_coeff * fft_re_[0];
+    }
+    for (int32_t i = 0; i < frame_length_; ++i) {
+        fft_re_[i] *= window_[i];
+    }
+
+    Fft(&fft_re_, &fft_im_);
+    for (int32_t i = 0; i <= fft_size_ / 2; ++i) {
+        const float power = fft_re_[i] * fft_re_[i] + fft_im_[i] * fft_im_[i];
+        fft_re_[i] = opts_.use_power ? power : std::sqrt(power);
+    }
+
+    float* mel = out;
+    if (opts_.use_energy) {
+        *mel++ = opts_.energy_floor > 0.0f ? std::max(log_energy, std::log(opts_.energy_floor)) : log_energy;
+    }
+    for (size_t b = 0; b < bank_weights_.size(); ++b) {
+        const float* spectrum = fft_re_.data() + bank_first_[b];
+        float energy = 0.0f;
+        for (size_t i = 0; i < bank_weights_[b].size(); ++i) {
+            energy += bank_weights_[b][i] * spectrum[i];
+        }
+        mel[b] = opts_.use_log_fbank ? std::log(std::max(energy, FLT_EPSILON)) : energy;
+    }
+}
+
+}  // namespace knf
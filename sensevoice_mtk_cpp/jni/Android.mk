@@ -102,6 +102,7 @@ include $(CLEAR_VARS)
 LOCAL_MODULE := executor
 
 LOCAL_SRC_FILES := src/executor/ExecutorFactory.cpp \
+                   src/executor/HostExecutor.cpp \
                    src/executor/NeuronExecutor.cpp \
                    src/executor/NeuronUsdkExecutor.cpp
 
@@ -124,9 +125,19 @@ include $(CLEAR_VARS)
 LOCAL_MODULE := sensevoice_core
 
 LOCAL_SRC_FILES := src/sensevoice/src/audio_frontend.cpp \
+                   src/sensevoice/src/vad.cpp \
                    src/sensevoice/src/tokenizer.cpp \
+                   src/sensevoice/src/ctc_beam_search.cpp \
+                   src/sensevoice/src/hotwords.cpp \
+                   src/sensevoice/src/ngram_lm.cpp \
+                   src/sensevoice/src/keyword_spotter.cpp \
                    src/sensevoice/src/sensevoice_model.cpp \
-                   src/sensevoice/src/sensevoice.cpp
+                   src/sensevoice/src/batch_queue.cpp \
+                   src/sensevoice/src/model_scheduler.cpp \
+                   src/sensevoice/src/thread_pool.cpp \
+                   src/sensevoice/src/model_bundle.cpp \
+                   src/sensevoice/src/sensevoice.cpp \
+                   src/sensevoice/src/recognition_server.cpp
 
 LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
                     $(LOCAL_PATH)/src/sensevoice/include \
@@ -169,3 +180,298 @@ LOCAL_STATIC_LIBRARIES := sensevoice_core \
                           kissfft-float
 
 include $(BUILD_EXECUTABLE)
+
+#######################
+# Decode benchmark (greedy vs beam search on dumped logits)
+#######################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sensevoice_decode_bench
+
+LOCAL_SRC_FILES := src/sensevoice/src/decode_bench.cpp
+
+LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
+                    $(LOCAL_PATH)/src/sensevoice/include
+
+LOCAL_CFLAGS := $(APP_CPPFLAGS)
+
+LOCAL_LDLIBS := -llog
+
+LOCAL_STATIC_LIBRARIES := sensevoice_core \
+                          easyloggingpp
+
+include $(BUILD_EXECUTABLE)
+
+#######################
+# Keyword spotting benchmark (KeywordSpotter vs decode + string match on dumped logits)
+#######################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sensevoice_kws_bench
+
+LOCAL_SRC_FILES := src/sensevoice/src/kws_bench.cpp
+
+LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
+                    $(LOCAL_PATH)/src/sensevoice/include
+
+LOCAL_CFLAGS := $(APP_CPPFLAGS)
+
+LOCAL_LDLIBS := -llog
+
+LOCAL_STATIC_LIBRARIES := sensevoice_core \
+                          easyloggingpp
+
+include $(BUILD_EXECUTABLE)
+
+#######################
+# Resident recognition server (Unix domain socket)
+#######################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sensevoice_server
+
+LOCAL_SRC_FILES := src/sensevoice/src/server_main.cpp
+
+LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
+                    $(LOCAL_PATH)/src/sensevoice/include \
+                    $(KALDI_FBANK_PATH)/include
+
+LOCAL_CFLAGS := $(APP_CPPFLAGS)
+
+LOCAL_LDLIBS := -llog \
+                -landroid \
+                -ldl
+
+LOCAL_STATIC_LIBRARIES := sensevoice_core \
+                          easyloggingpp \
+                          executor \
+                          utils \
+                          neuron \
+                          profiler \
+                          kaldi-native-fbank-core \
+                          kissfft-float
+
+include $(BUILD_EXECUTABLE)
+
+#######################
+# Interactive latency under batch load (ModelScheduler)
+#######################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sensevoice_sched_bench
+
+LOCAL_SRC_FILES := src/sensevoice/src/sched_bench.cpp
+
+LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
+                    $(LOCAL_PATH)/src/sensevoice/include \
+                    $(KALDI_FBANK_PATH)/include
+
+LOCAL_CFLAGS := $(APP_CPPFLAGS)
+
+LOCAL_LDLIBS := -llog \
+                -landroid \
+                -ldl
+
+LOCAL_STATIC_LIBRARIES := sensevoice_core \
+                          easyloggingpp \
+                          executor \
+                          utils \
+                          neuron \
+                          profiler \
+                          kaldi-native-fbank-core \
+                          kissfft-float
+
+include $(BUILD_EXECUTABLE)
+
+#######################
+# Long audio windows across executions (wall-clock speedup)
+#######################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sensevoice_long_bench
+
+LOCAL_SRC_FILES := src/sensevoice/src/long_bench.cpp
+
+LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
+                    $(LOCAL_PATH)/src/sensevoice/include \
+                    $(KALDI_FBANK_PATH)/include
+
+LOCAL_CFLAGS := $(APP_CPPFLAGS)
+
+LOCAL_LDLIBS := -llog \
+                -landroid \
+                -ldl
+
+LOCAL_STATIC_LIBRARIES := sensevoice_core \
+                          easyloggingpp \
+                          executor \
+                          utils \
+                          neuron \
+                          profiler \
+                          kaldi-native-fbank-core \
+                          kissfft-float
+
+include $(BUILD_EXECUTABLE)
+
+#######################
+# Back-to-back throughput with ping-pong I/O sets
+#######################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sensevoice_io_bench
+
+LOCAL_SRC_FILES := src/sensevoice/src/io_bench.cpp
+
+LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
+                    $(LOCAL_PATH)/src/sensevoice/include \
+                    $(KALDI_FBANK_PATH)/include
+
+LOCAL_CFLAGS := $(APP_CPPFLAGS)
+
+LOCAL_LDLIBS := -llog \
+                -landroid \
+                -ldl
+
+LOCAL_STATIC_LIBRARIES := sensevoice_core \
+                          easyloggingpp \
+                          executor \
+                          utils \
+                          neuron \
+                          profiler \
+                          kaldi-native-fbank-core \
+                          kissfft-float
+
+include $(BUILD_EXECUTABLE)
+
+#######################
+# Classification-only readback (prompt rows vs full logits)
+#######################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sensevoice_classify_bench
+
+LOCAL_SRC_FILES := src/sensevoice/src/classify_bench.cpp
+
+LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
+                    $(LOCAL_PATH)/src/sensevoice/include \
+                    $(KALDI_FBANK_PATH)/include
+
+LOCAL_CFLAGS := $(APP_CPPFLAGS)
+
+LOCAL_LDLIBS := -llog \
+                -landroid \
+                -ldl
+
+LOCAL_STATIC_LIBRARIES := sensevoice_core \
+                          easyloggingpp \
+                          executor \
+                          utils \
+                          neuron \
+                          profiler \
+                          kaldi-native-fbank-core \
+                          kissfft-float
+
+include $(BUILD_EXECUTABLE)
+
+#######################
+# Load generator for sensevoice_server (QPS, p50/p99 latency)
+#######################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sensevoice_loadgen
+
+LOCAL_SRC_FILES := src/sensevoice/src/loadgen.cpp
+
+LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
+                    $(LOCAL_PATH)/src/sensevoice/include \
+                    $(KALDI_FBANK_PATH)/include
+
+LOCAL_CFLAGS := $(APP_CPPFLAGS)
+
+LOCAL_LDLIBS := -llog
+
+LOCAL_STATIC_LIBRARIES := sensevoice_core \
+                          easyloggingpp \
+                          kaldi-native-fbank-core \
+                          kissfft-float
+
+include $(BUILD_EXECUTABLE)
+
+#######################
+# Feature benchmark (host CMVN, float16 / int8 model inputs)
+#######################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sensevoice_feature_bench
+
+LOCAL_SRC_FILES := src/sensevoice/src/feature_bench.cpp
+
+LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
+                    $(LOCAL_PATH)/src/sensevoice/include \
+                    $(KALDI_FBANK_PATH)/include
+
+LOCAL_CFLAGS := $(APP_CPPFLAGS)
+
+LOCAL_LDLIBS := -llog
+
+LOCAL_STATIC_LIBRARIES := sensevoice_core \
+                          easyloggingpp \
+                          kaldi-native-fbank-core \
+                          kissfft-float
+
+include $(BUILD_EXECUTABLE)
+
+#######################
+# Tokenizer benchmark (arena vocabulary vs the id/token hash maps)
+#######################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sensevoice_tokenizer_bench
+
+LOCAL_SRC_FILES := src/sensevoice/src/tokenizer_bench.cpp
+
+LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
+                    $(LOCAL_PATH)/src/sensevoice/include
+
+LOCAL_CFLAGS := $(APP_CPPFLAGS)
+
+LOCAL_LDLIBS := -llog
+
+LOCAL_STATIC_LIBRARIES := sensevoice_core \
+                          easyloggingpp
+
+include $(BUILD_EXECUTABLE)
+
+#######################
+# VAD benchmark (NPU runs saved on a corpus)
+#######################
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sensevoice_vad_bench
+
+LOCAL_SRC_FILES := src/sensevoice/src/vad_bench.cpp
+
+LOCAL_C_INCLUDES := $(GLOBAL_C_INCLUDES) \
+                    $(LOCAL_PATH)/src/sensevoice/include
+
+LOCAL_CFLAGS := $(APP_CPPFLAGS)
+
+LOCAL_LDLIBS := -llog
+
+LOCAL_STATIC_LIBRARIES := sensevoice_core \
+                          easyloggingpp \
+                          kaldi-native-fbank-core \
+                          kissfft-float
+
+include $(BUILD_EXECUTABLE)
@@ -36,7 +36,11 @@
 #pragma once
 
 #include <stdint.h>
+#include <atomic>
 #include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -68,16 +72,48 @@ typedef enum {
     kInt4 = 18,
 } ExecutorDataType;
 
+// Reads an output tensor straight out of the I/O memory instead of the copy
+// into TensorBuffer::data, e.g. to convert it or summarize its rows on the
+// single pass over them; src holds TensorBuffer::bytes bytes
+using OutputReader = std::function<void(const void* src)>;
+
 struct TensorBuffer {
     void* data;
     size_t bytes;  // Size in bytes
     ExecutorDataType type;
+    const OutputReader* reader = nullptr;  // Outputs only: replaces the copy into data
 };
 
 typedef enum {
     kExecutorSizeError = SIZE_MAX,
 } ExecutorStatusCode;
 
+// Input tensors written into the I/O memory and skipped as unchanged
+struct InputCopyStats {
+    uint64_t written = 0;
+    uint64_t skipped = 0;
+    uint64_t skippedBytes = 0;
+};
+
+// File name of a model path: model layouts are recognized by it, so that
+// directory names (e.g. /data/sensevoice/) don't select one
+inline std::string ModelFileName(const std::string& modelPath) {
+    const size_t slash = modelPath.find_last_of("/\\");
+    return slash == std::string::npos ? modelPath : modelPath.substr(slash + 1);
+}
+
+// Compiled network already in memory (e.g. a section of a mapped model
+// bundle) and its I/O description, used instead of opening the model path.
+// The buffer must stay valid until the executor is constructed.
+struct ModelBlob {
+    const void* data = nullptr;
+    size_t size = 0;
+    std::vector<std::vector<uint32_t>> inputShape;   // Batch-1 shapes
+    std::vector<std::vector<uint32_t>> outputShape;
+    ExecutorDataType inputType = kFloat32;
+    ExecutorDataType outputType = kFloat32;
+};
+
 class Executor {
 public:
     Executor(const std::string& name) : kName(name) {}
@@ -99,8 +135,42 @@ public:
 
     virtual bool SetInput(size_t index, TensorBuffer buffer) = 0;
 
+    // Set the actual shape of a dynamic-shape input before the next run.
+    // I/O buffers stay sized for the maximum shape; callers then pass
+    // TensorBuffers covering only the active prefix. Returns false when the
+    // executor or the model doesn't support it (caller falls back to padding).
+    virtual bool SetInputShape(size_t index, const std::vector<uint32_t>& dims) {
+        UNUSED(index);
+        UNUSED(dims);
+        return false;
+    }
+
     virtual bool GetOutput(size_t index, TensorBuffer buffer) = 0;
 
+    // Another execution of the same compiled network with its own I/O memory,
+    // so that runs can be in flight on several MDLA cores at once. The clone
+    // may share the network with this executor, which must outlive it.
+    // Returns nullptr when the executor can't be cloned.
+    virtual std::unique_ptr<Executor> Clone() { return nullptr; }
+
+    // Use num I/O buffer sets (ping-pong with 2). RunForMultipleInputsOutputs
+    // may then be called from num threads at once: each call writes its
+    // inputs into a free set and reads its outputs back from it while the
+    // device computes another set; only the computes run one at a time.
+    // Set up before the first run; returns false when the executor keeps a
+    // single set.
+    virtual bool SetNumIOSets(uint32_t num) { return num == 1; }
+
+    virtual uint32_t GetNumIOSets() { return 1; }
+
+    InputCopyStats GetInputCopyStats() const {
+        InputCopyStats stats;
+        stats.written = mInputsWritten.load();
+        stats.skipped = mInputsSkipped.load();
+        stats.skippedBytes = mInputBytesSkipped.load();
+        return stats;
+    }
+
     virtual void SetAllowFp16PrecisionForFp32(bool allow) = 0;
 
     virtual void SetNumThreads(uint32_t num) = 0;
@@ -122,11 +192,63 @@ public:
 
 
 protected:
+    // Hand an output tensor over from the I/O memory: to its reader, else by copy
+    static void ReadOutput(const TensorBuffer& buffer, const void* src) {
+        if (buffer.reader != nullptr) {
+            (*buffer.reader)(src);
+        } else {
+            memcpy(buffer.data, src, buffer.bytes);
+        }
+    }
+
+    // Inputs up to this size (prompt ids, packed-window masks) are compared
+    // with what the I/O set holds; larger ones always differ in practice
+    static constexpr size_t kTrackedInputBytes = 4096;
+
+    // Track the inputs of num I/O sets, all unknown (before the first run)
+    void ResetInputTracking(size_t num) {
+        mLastInputs.assign(num, {});
+    }
+
+    // Whether input index of I/O set `set` has to be written for this run.
+    // A tracked input equal to the set's copy is skipped; otherwise the new
+    // value is recorded, so the caller must write it. Each set is used by
+    // one run at a time, which needs no lock here.
+    bool InputChanged(size_t set, size_t index, const TensorBuffer& buffer) {
+        if (buffer.bytes > kTrackedInputBytes || set >= mLastInputs.size()) {
+            mInputsWritten++;
+            return true;
+        }
+        std::vector<std::vector<uint8_t>>& last = mLastInputs[set];
+        if (index >= last.size()) {
+            last.resize(index + 1);
+        }
+        const uint8_t* data = static_cast<const uint8_t*>(buffer.data);
+        std::vector<uint8_t>& held = last[index];
+        if (!held.empty() && held.size() == buffer.bytes &&
+            memcmp(held.data(), data, buffer.bytes) == 0) {
+            mInputsSkipped++;
+            mInputBytesSkipped += buffer.bytes;
+            return false;
+        }
+        held.assign(data, data + buffer.bytes);
+        mInputsWritten++;
+        return true;
+    }
+
     bool mInitiated = false;
 
     const std::string kName;
 
 private:
+    std::vector<std::vector<std::vector<uint8_t>>> mLastInputs;  // [set][input], tracked only
+
+    std::atomic<uint64_t> mInputsWritten{0};
+
+    std::atomic<uint64_t> mInputsSkipped{0};
+
+    std::atomic<uint64_t> mInputBytesSkipped{0};
+
     DISALLOW_COPY_AND_ASSIGN(Executor);
 };
 
@@ -34,6 +34,7 @@
  */
 
 #include "ExecutorFactory.h"
+#include "HostExecutor.h"
 #include "NeuronExecutor.h"
 #include "NeuronUsdkExecutor.h"
 #include "common/Log.h"
@@ -46,14 +47,28 @@ std::unique_ptr<Executor> ExecutorFactory::CreateExecutor(ExecutorType type,
                                                           const std::string& name,
                                                           const std::string& modelPath,
                                                           const std::string& kOptions,
-                                                          const std::vector<uint32_t>& reusedSize
+                                                          const std::vector<uint32_t>& reusedSize,
+                                                          uint32_t batchSize,
+                                                          const ModelBlob* blob
                                                           ) {
     switch (type) {
         case ExecutorType::NeuronRuntime:
-            return std::unique_ptr<Executor>(new NeuronExecutor(name, modelPath, kOptions));
+            return std::unique_ptr<Executor>(new NeuronExecutor(name, modelPath, kOptions, blob));
             break;
         case ExecutorType::NeuronUsdk:
-            return std::unique_ptr<Executor>(new NeuronUsdkExecutor(name, modelPath, kOptions, reusedSize));
+            if (blob != nullptr) {
+                return std::unique_ptr<Executor>(new NeuronUsdkExecutor(
+                    name, modelPath, kOptions, reusedSize,
+                    blob->inputShape, ToNeuronType(blob->inputType),
+                    blob->outputShape, ToNeuronType(blob->outputType),
+                    batchSize, blob->data, blob->size));
+            }
+            return std::unique_ptr<Executor>(new NeuronUsdkExecutor(name, modelPath, kOptions, reusedSize,
+                                                                    {}, NEURON_INT32, {}, NEURON_INT32,
+                                                                    batchSize));
+            break;
+        case ExecutorType::Host:
+            return std::unique_ptr<Executor>(new HostExecutor(name, modelPath, batchSize, blob));
             break;
         default:
             LOG(FATAL) << "Unknown type:" << static_cast<int32_t>(type);
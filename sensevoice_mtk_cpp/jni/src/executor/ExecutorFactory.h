@@ -46,8 +46,9 @@
 namespace mtk::neuropilot {
 
 enum class ExecutorType : uint8_t {
-    NeuronRuntime = 0,
+    NeuronRuntime = 0,  // NeuronRuntime API, shapes read from the DLA (dynamic shapes)
     NeuronUsdk,
+    Host,  // CPU stand-in with the same shapes, no NPU required (tests)
 };
 
 class ExecutorFactory {
@@ -59,7 +60,9 @@ public:
     std::unique_ptr<Executor> CreateExecutor(ExecutorType type, const std::string& name,
                                              const std::string& modelPath,
                                              const std::string& kOptions = "",
-                                             const std::vector<uint32_t>& reusedSize = {}
+                                             const std::vector<uint32_t>& reusedSize = {},
+                                             uint32_t batchSize = 1,
+                                             const ModelBlob* blob = nullptr
                                              );
 
 private:
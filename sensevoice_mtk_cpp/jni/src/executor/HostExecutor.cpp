@@ -0,0 +1,326 @@
+/* Host Executor Implementation
+ *
+ * Deterministic CPU stand-in for the NPU executors.
+ */
+
+#include "HostExecutor.h"
+#include "common/Log.h"
+#include "utils/MemAllocator.h"
+#include "NeuronUsdkExecutor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace mtk::neuropilot {
+
+// 1.0 as an IEEE half, the one-hot logit of fp16-output models
+static constexpr uint16_t kHalfOne = 0x3C00;
+
+// Rows of at most 2 x 256 values are a top-k head (main.py --top_k caps k at
+// 256): k log-probs, then their token ids out of the SenseVoice vocabulary
+static constexpr uint32_t kMaxTopKWidth = 512;
+static constexpr uint32_t kTopKVocab = 25055;
+
+// Input value at index: float32, IEEE half or the raw int8 step
+static float ReadInput(const uint8_t* data, size_t index, int type) {
+    if (type == NEURON_TENSOR_QUANT8_ASYMM_SIGNED) {
+        return static_cast<float>(reinterpret_cast<const int8_t*>(data)[index]);
+    }
+    if (type == NEURON_TENSOR_FLOAT16) {
+        const uint16_t h = reinterpret_cast<const uint16_t*>(data)[index];
+        const int exponent = (h >> 10) & 0x1F;
+        const int mantissa = h & 0x3FF;
+        float v = exponent == 0 ? std::ldexp(static_cast<float>(mantissa), -24)
+                : exponent == 31 ? (mantissa ? NAN : INFINITY)
+                : std::ldexp(static_cast<float>(mantissa | 0x400), exponent - 25);
+        return (h & 0x8000) ? -v : v;
+    }
+    return reinterpret_cast<const float*>(data)[index];
+}
+
+HostExecutor::HostExecutor(const std::string& name, const std::string& modelPath,
+                           uint32_t batchSize, const ModelBlob* blob)
+        : Executor(name), kModelPath(modelPath), kBatchSize(batchSize > 0 ? batchSize : 1) {
+    if (blob != nullptr) {
+        mInputSize = blob->inputShape;
+        mOutputSize = blob->outputShape;
+        mInputType = ToNeuronType(blob->inputType);
+        mOutputType = ToNeuronType(blob->outputType);
+    }
+    mInitiated = Initialize();
+}
+
+HostExecutor::HostExecutor(const HostExecutor* source)
+        : Executor(source->kName), kModelPath(source->kModelPath), kBatchSize(source->kBatchSize),
+          mInputSize(source->mInputSize), mOutputSize(source->mOutputSize),
+          mReusedSize(source->mReusedSize), mInputType(source->mInputType),
+          mOutputType(source->mOutputType), mBaseLatencyUs(source->mBaseLatencyUs),
+          mPerItemLatencyUs(source->mPerItemLatencyUs) {
+    // Shapes already carry the batch dimension
+    mActiveInputSize = mInputSize;
+    AllocateIOSet();
+    ResetInputTracking(1);
+    mInitiated = source->mInitiated;
+}
+
+std::unique_ptr<Executor> HostExecutor::Clone() {
+    return std::unique_ptr<Executor>(new HostExecutor(this));
+}
+
+bool HostExecutor::Load(const std::string& modelPath) {
+    UNUSED(modelPath);
+    return false;
+}
+
+bool HostExecutor::Initialize() {
+    LOG(INFO) << "HostExecutor initialize for model " << kModelPath;
+
+    if ((mInputSize.empty() || mOutputSize.empty()) &&
+        !GetModelInfo(kModelPath, mInputSize, mOutputSize, mReusedSize,
+                      mInputType, mOutputType)) {
+        LOG(ERROR) << "Get Model Shape Fail";
+        return false;
+    }
+
+    // Same batch convention as NeuronUsdkExecutor
+    if (kBatchSize > 1) {
+        for (auto& shape : mInputSize) {
+            if (shape.size() > 1) {
+                shape[0] = kBatchSize;
+            }
+        }
+        for (auto& shape : mOutputSize) {
+            if (shape.size() > 1) {
+                shape[0] = kBatchSize;
+            }
+        }
+    }
+
+    mActiveInputSize = mInputSize;
+    AllocateIOSet();
+    ResetInputTracking(1);
+    return true;
+}
+
+void HostExecutor::AllocateIOSet() {
+    IOSet set;
+    for (size_t i = 0; i < mInputSize.size(); i++) {
+        set.inputs.emplace_back(GetInputTensorSize(i), 0);
+    }
+    for (size_t i = 0; i < mOutputSize.size(); i++) {
+        set.outputs.emplace_back(GetOutputTensorSize(i), 0);
+    }
+    mIOSets.push_back(std::move(set));
+    mFreeIOSets.push_back(mIOSets.size() - 1);
+}
+
+bool HostExecutor::SetNumIOSets(uint32_t num) {
+    if (!mInitiated || num == 0) {
+        return false;
+    }
+    if (num <= mIOSets.size()) {
+        return num == mIOSets.size();
+    }
+    std::lock_guard<std::mutex> lock(mIOSetMutex);
+    while (mIOSets.size() < num) {
+        AllocateIOSet();
+    }
+    ResetInputTracking(mIOSets.size());
+    return true;
+}
+
+bool HostExecutor::RunForMultipleInputsOutputs(const std::vector<TensorBuffer>& inputs,
+                                               const std::vector<TensorBuffer>& outputs) {
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (i >= mInputSize.size() || inputs[i].bytes > GetInputTensorSize(i)) {
+            LOG(WARNING) << "Invalid input tensor index: " << i;
+            return false;
+        }
+    }
+    for (size_t i = 0; i < outputs.size(); i++) {
+        if (i >= mOutputSize.size() || outputs[i].bytes > GetOutputTensorSize(i)) {
+            LOG(WARNING) << "Invalid output tensor index:" << i;
+            return false;
+        }
+    }
+
+    const size_t index = AcquireIOSet();
+    IOSet& set = mIOSets[index];
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (InputChanged(index, i, inputs[i])) {
+            memcpy(set.inputs[i].data(), inputs[i].data, inputs[i].bytes);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mComputeMutex);
+        auto start = std::chrono::steady_clock::now();
+        Compute(&set);
+
+        auto latency = std::chrono::microseconds(mBaseLatencyUs + mPerItemLatencyUs * kBatchSize);
+        std::this_thread::sleep_until(start + latency);
+    }
+
+    for (size_t i = 0; i < outputs.size(); i++) {
+        ReadOutput(outputs[i], set.outputs[i].data());
+    }
+
+    ReleaseIOSet(index);
+    mRunCount++;
+    return true;
+}
+
+size_t HostExecutor::AcquireIOSet(size_t wanted) {
+    std::unique_lock<std::mutex> lock(mIOSetMutex);
+    if (wanted == SIZE_MAX) {
+        mIOSetCv.wait(lock, [this] { return !mFreeIOSets.empty(); });
+        const size_t index = mFreeIOSets.back();
+        mFreeIOSets.pop_back();
+        return index;
+    }
+    auto held = [&] { return std::find(mFreeIOSets.begin(), mFreeIOSets.end(), wanted); };
+    mIOSetCv.wait(lock, [&] { return held() != mFreeIOSets.end(); });
+    mFreeIOSets.erase(held());
+    return wanted;
+}
+
+void HostExecutor::ReleaseIOSet(size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(mIOSetMutex);
+        mFreeIOSets.push_back(index);
+    }
+    // Waiters may want a particular set
+    mIOSetCv.notify_all();
+}
+
+void HostExecutor::Compute(IOSet* set) {
+    const bool halfOutput = mOutputType == NEURON_TENSOR_FLOAT16;
+    const bool reducedInput = mInputType == NEURON_TENSOR_FLOAT16 ||
+                              mInputType == NEURON_TENSOR_QUANT8_ASYMM_SIGNED;
+    if (mInputSize.empty() || mOutputSize.empty() ||
+        mInputSize[0].size() != 3 || mOutputSize[0].size() != 3 ||
+        (GetNeuronTypeSize(mInputType) != sizeof(float) && !reducedInput) ||
+        (GetNeuronTypeSize(mOutputType) != sizeof(float) && !halfOutput)) {
+        LOG(ERROR) << "HostExecutor only supports float [N, T, D] -> [N, T', V] models";
+        return;
+    }
+
+    const uint32_t batch = mActiveInputSize[0][0];
+    const uint32_t inRows = mActiveInputSize[0][1];
+    const uint32_t inDim = mActiveInputSize[0][2];
+    const uint32_t width = mOutputSize[0][2];
+    const bool topK = width <= kMaxTopKWidth && width % 2 == 0 && !halfOutput;
+    const uint32_t vocab = topK ? kTopKVocab : width;
+    // Output rows ahead of the input rows are prompt rows (4 for the plain model, 0 when packed)
+    const uint32_t offset = mOutputSize[0][1] > mInputSize[0][1] ? mOutputSize[0][1] - mInputSize[0][1] : 0;
+    const uint32_t outRows = inRows + offset;
+
+    const uint8_t* in = set->inputs[0].data();
+    float* out = reinterpret_cast<float*>(set->outputs[0].data());
+    uint16_t* halfOut = reinterpret_cast<uint16_t*>(set->outputs[0].data());
+    std::memset(set->outputs[0].data(), 0, set->outputs[0].size());
+
+    for (uint32_t b = 0; b < batch; b++) {
+        for (uint32_t r = 0; r < outRows; r++) {
+            uint32_t token = r < offset ? vocab - offset + r : 0;
+            if (r >= offset) {
+                float v = ReadInput(in, (static_cast<size_t>(b) * inRows + (r - offset)) * inDim, mInputType);
+                if (v >= 1.0f && v < static_cast<float>(vocab) && std::floor(v) == v) {
+                    token = static_cast<uint32_t>(v);
+                }
+            }
+            if (topK) {
+                // The token at log(0.9), fillers far below it
+                const uint32_t k = width / 2;
+                float* row = out + (static_cast<size_t>(b) * outRows + r) * width;
+                row[0] = std::log(0.9f);
+                row[k] = static_cast<float>(token);
+                for (uint32_t j = 1, id = 1; j < k; j++, id++) {
+                    id += id == token ? 1 : 0;
+                    row[j] = -10.0f - static_cast<float>(j);
+                    row[k + j] = static_cast<float>(id);
+                }
+                continue;
+            }
+            const size_t index = (static_cast<size_t>(b) * outRows + r) * vocab + token;
+            if (halfOutput) {
+                halfOut[index] = kHalfOne;
+            } else {
+                out[index] = 1.0f;
+            }
+        }
+    }
+}
+
+size_t HostExecutor::GetInputTensorSize(size_t index) {
+    auto size = GetNeuronTypeSize(mInputType);
+    if (index < mInputSize.size() && size) {
+        size_t s = 1;
+        for (auto i : mInputSize[index]) {
+            s *= i;
+        }
+        return s * size;
+    } else {
+        return kExecutorSizeError;
+    }
+}
+
+size_t HostExecutor::GetOutputTensorSize(size_t index) {
+    auto size = GetNeuronTypeSize(mOutputType);
+    if (index < mOutputSize.size() && size) {
+        size_t s = 1;
+        for (auto i : mOutputSize[index]) {
+            s *= i;
+        }
+        return s * size;
+    } else {
+        return kExecutorSizeError;
+    }
+}
+
+bool HostExecutor::SetInput(size_t index, TensorBuffer buffer) {
+    if (mIOSets.empty() || index >= mIOSets[0].inputs.size() ||
+        buffer.bytes > mIOSets[0].inputs[index].size()) {
+        LOG(WARNING) << "Invalid input tensor index: " << index;
+        return false;
+    }
+    AcquireIOSet(0);
+    if (InputChanged(0, index, buffer)) {
+        memcpy(mIOSets[0].inputs[index].data(), buffer.data, buffer.bytes);
+    }
+    ReleaseIOSet(0);
+    return true;
+}
+
+bool HostExecutor::SetInputShape(size_t index, const std::vector<uint32_t>& dims) {
+    if (index >= mInputSize.size() || dims.size() != mInputSize[index].size()) {
+        LOG(WARNING) << "Invalid input shape for index: " << index;
+        return false;
+    }
+    for (size_t d = 0; d < dims.size(); d++) {
+        if (dims[d] == 0 || dims[d] > mInputSize[index][d]) {
+            LOG(WARNING) << "Input shape exceeds the compiled shape at dim " << d;
+            return false;
+        }
+    }
+    mActiveInputSize[index] = dims;
+    return true;
+}
+
+bool HostExecutor::GetOutput(size_t index, TensorBuffer buffer) {
+    if (mIOSets.empty() || index >= mIOSets[0].outputs.size() ||
+        buffer.bytes > mIOSets[0].outputs[index].size()) {
+        LOG(WARNING) << "Invalid output tensor index:" << index;
+        return false;
+    }
+    AcquireIOSet(0);
+    ReadOutput(buffer, mIOSets[0].outputs[index].data());
+    ReleaseIOSet(0);
+    return true;
+}
+
+}  // namespace mtk::neuropilot
@@ -0,0 +1,133 @@
+/* Host Executor
+ *
+ * CPU stand-in for the NPU executors, used to run the batching and packing
+ * paths without a device. Tensor shapes come from GetModelInfo() exactly as
+ * for NeuronUsdkExecutor (including the batch dimension), and the output is
+ * deterministic: every output frame gets a one-hot logit at the token id
+ * held in the first feature of the matching input frame (blank when that
+ * value is not a valid id). Prompt rows ahead of the frames (plain model)
+ * get the last ids of the vocabulary, one per row, so they decode as
+ * metadata like the real model's. fp16-output models get the same logits as
+ * IEEE halves; float16 / int8 inputs are read as halves / raw int8 steps.
+ * Top-k heads (rows of at most 512 values) put the same token first.
+ * Each run sleeps for a simulated NPU latency.
+ * Dynamic input shapes are emulated: output rows follow the active input.
+ * With several I/O sets the copies of one run overlap the simulated compute
+ * of another, as on NeuronUsdkExecutor.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Executor.h"
+
+namespace mtk::neuropilot {
+
+class HostExecutor : public Executor {
+public:
+    // blob: shapes and types come from it instead of GetModelInfo (data is unused)
+    explicit HostExecutor(const std::string& name, const std::string& modelPath,
+                          uint32_t batchSize = 1, const ModelBlob* blob = nullptr);
+
+    virtual ~HostExecutor() {}
+
+    virtual bool Load(const std::string& modelPath) override;
+
+    virtual bool RunForMultipleInputsOutputs(const std::vector<TensorBuffer>& inputs,
+                                             const std::vector<TensorBuffer>& outputs) override;
+
+    virtual size_t GetInputTensorSize(size_t index) override;
+
+    virtual size_t GetOutputTensorSize(size_t index) override;
+
+    virtual bool SetInput(size_t index, TensorBuffer buffer) override;
+
+    // Any shape of the same rank that fits the compiled maximum is accepted
+    virtual bool SetInputShape(size_t index, const std::vector<uint32_t>& dims) override;
+
+    virtual bool GetOutput(size_t index, TensorBuffer buffer) override;
+
+    // Same shapes and simulated latency; runs of the clones overlap like MDLA cores
+    virtual std::unique_ptr<Executor> Clone() override;
+
+    virtual bool SetNumIOSets(uint32_t num) override;
+
+    virtual uint32_t GetNumIOSets() override { return static_cast<uint32_t>(mIOSets.size()); }
+
+    virtual void SetAllowFp16PrecisionForFp32(bool allow) override { UNUSED(allow); }
+
+    virtual void SetNumThreads(uint32_t num) override { UNUSED(num); }
+
+    // Simulated latency per run: baseUs + perItemUs * batch size
+    void SetSimulatedLatency(uint32_t baseUs, uint32_t perItemUs) {
+        mBaseLatencyUs = baseUs;
+        mPerItemLatencyUs = perItemUs;
+    }
+
+    // Number of completed runs
+    uint64_t GetRunCount() const { return mRunCount.load(); }
+
+private:
+    explicit HostExecutor(const HostExecutor* source);
+
+    bool Initialize();
+
+    struct IOSet {
+        std::vector<std::vector<uint8_t>> inputs;
+        std::vector<std::vector<uint8_t>> outputs;
+    };
+
+    void AllocateIOSet();
+
+    // Wait for a free I/O set (or for set `wanted`) and hold it, so that its
+    // memory and its input tracking only change under one caller at a time
+    size_t AcquireIOSet(size_t wanted = SIZE_MAX);
+
+    void ReleaseIOSet(size_t index);
+
+    void Compute(IOSet* set);
+
+private:
+    const std::string kModelPath;
+
+    const uint32_t kBatchSize = 1;
+
+    std::vector<std::vector<uint32_t>> mInputSize;
+
+    std::vector<std::vector<uint32_t>> mOutputSize;
+
+    std::vector<std::vector<uint32_t>> mActiveInputSize;
+
+    std::vector<uint32_t> mReusedSize;
+
+    int mInputType = 0;
+
+    int mOutputType = 0;
+
+    std::vector<IOSet> mIOSets;  // Set 0 is used by SetInput/GetOutput, held like a run
+
+    std::vector<size_t> mFreeIOSets;
+
+    std::mutex mIOSetMutex;
+
+    std::condition_variable mIOSetCv;
+
+    std::mutex mComputeMutex;  // The simulated device runs one set at a time
+
+    uint32_t mBaseLatencyUs = 0;
+
+    uint32_t mPerItemLatencyUs = 0;
+
+    std::atomic<uint64_t> mRunCount{0};
+
+private:
+    DISALLOW_COPY_AND_ASSIGN(HostExecutor);
+};
+
+}  // namespace mtk::neuropilot
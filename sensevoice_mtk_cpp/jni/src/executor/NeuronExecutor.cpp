@@ -90,14 +90,20 @@ bool NeuronExecutor::Initialize() {
         return false;
     }
 
-    if (mNeuronRuntimeLib->LoadNetworkFromFile(mRuntime, kModelPath.c_str()) !=
-        NEURONRUNTIME_NO_ERROR) {
-        LOG(ERROR) << "Failed to load network from file: " << kModelPath;
+    int loadErr = mDlaBuffer != nullptr
+        ? mNeuronRuntimeLib->LoadNetworkFromBuffer(mRuntime, mDlaBuffer, mDlaSize)
+        : mNeuronRuntimeLib->LoadNetworkFromFile(mRuntime, kModelPath.c_str());
+    if (loadErr != NEURONRUNTIME_NO_ERROR) {
+        LOG(ERROR) << "Failed to load network from " << (mDlaBuffer ? "buffer: " : "file: ") << kModelPath;
         mNeuronRuntimeLib->Release(mRuntime);
         mRuntime = nullptr;
         return false;
     }
 
+    return SetupRuntime();
+}
+
+bool NeuronExecutor::SetupRuntime() {
     LOG(INFO) << "NeuronExecutor get QoS data: " << mGetQoSData;
 
     mQosOptions.powerPolicy = NEURONRUNTIME_POWER_POLICY_SUSTAINABLE;
@@ -148,6 +154,7 @@ bool NeuronExecutor::Initialize() {
         i++;
     }
 
+    ResetInputTracking(1);
     return true;
 }
 
@@ -172,16 +179,48 @@ bool NeuronExecutor::SetInput(size_t index, TensorBuffer buffer) {
         LOG(WARNING) << "Invalid input tensor index: " << index;
         return false;
     }
-    memcpy(mInputMemory[index].GetAddr(), buffer.data, buffer.bytes);
+    if (InputChanged(0, index, buffer)) {
+        memcpy(mInputMemory[index].GetAddr(), buffer.data, buffer.bytes);
+    }
+    return true;
+}
+
+bool NeuronExecutor::SetInputShape(size_t index, const std::vector<uint32_t>& dims) {
+    if (index >= mInputMemory.size()) {
+        LOG(WARNING) << "Invalid input tensor index: " << index;
+        return false;
+    }
+    std::vector<uint32_t> shape(dims);
+    int err = mNeuronRuntimeLib->SetInputShape(mRuntime, index, shape.data(),
+                                               static_cast<uint32_t>(shape.size()));
+    if (err != NEURONRUNTIME_NO_ERROR) {
+        LOG(WARNING) << "NeuronRuntime_setInputShape rejected input " << index << " (err " << err << ")";
+        return false;
+    }
     return true;
 }
 
+std::unique_ptr<Executor> NeuronExecutor::Clone() {
+    void* runtime = nullptr;
+    int err = mNeuronRuntimeLib->Clone(mRuntime, &runtime);
+    if (err != NEURONRUNTIME_NO_ERROR || runtime == nullptr) {
+        LOG(WARNING) << "NeuronRuntime_clone failed (err " << err << ")";
+        return nullptr;
+    }
+    std::unique_ptr<Executor> clone(new NeuronExecutor(kName, kModelPath, mNeuronRuntimeLib, runtime));
+    if (!clone->Initialized()) {
+        LOG(ERROR) << "Failed to set up the cloned Neuron runtime";
+        return nullptr;
+    }
+    return clone;
+}
+
 bool NeuronExecutor::GetOutput(size_t index, TensorBuffer buffer) {
     if (index >= mOutputMemory.size()) {
         LOG(WARNING) << "Invalid output tensor index:" << index;
         return false;
     }
-    memcpy(buffer.data, mOutputMemory[index].GetAddr(), buffer.bytes);
+    ReadOutput(buffer, mOutputMemory[index].GetAddr());
     return true;
 }
 
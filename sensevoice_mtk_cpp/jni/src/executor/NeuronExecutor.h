@@ -56,6 +56,15 @@ public:
         mInitiated = Initialize();
     }
 
+    // blob: compiled network already in memory, loaded with loadNetworkFromBuffer
+    // (shapes still come from the DLA itself)
+    explicit NeuronExecutor(const std::string& name, const std::string& modelPath,
+                            const std::string& options, const ModelBlob* blob)
+        : Executor(name), kModelPath(modelPath), kOptions(options),
+          mDlaBuffer(blob ? blob->data : nullptr), mDlaSize(blob ? blob->size : 0) {
+        mInitiated = Initialize();
+    }
+
     virtual ~NeuronExecutor();
 
     virtual bool Load(const std::string& modelPath) override;
@@ -69,15 +78,31 @@ public:
 
     virtual bool SetInput(size_t index, TensorBuffer buffer) override;
 
+    virtual bool SetInputShape(size_t index, const std::vector<uint32_t>& dims) override;
+
     virtual bool GetOutput(size_t index, TensorBuffer buffer) override;
 
+    // NeuronRuntime_clone: the clone shares the constant data of the loaded network
+    virtual std::unique_ptr<Executor> Clone() override;
+
     virtual void SetAllowFp16PrecisionForFp32(bool allow) override;
 
     virtual void SetNumThreads(uint32_t num) override { UNUSED(num); }
 
 private:
+    // Clone: takes over a runtime made by NeuronRuntime_clone
+    NeuronExecutor(const std::string& name, const std::string& modelPath,
+                   std::shared_ptr<NeuronRuntimeLibrary> library, void* runtime)
+        : Executor(name), kModelPath(modelPath), mNeuronRuntimeLib(std::move(library)),
+          mRuntime(runtime) {
+        mInitiated = SetupRuntime();
+    }
+
     bool Initialize();
 
+    // QoS options and I/O memory of a loaded runtime
+    bool SetupRuntime();
+
 private:
     const std::string kModelPath;
 
@@ -91,6 +116,10 @@ private:
 
     std::vector<Memory> mOutputMemory;
 
+    const void* mDlaBuffer = nullptr;
+
+    size_t mDlaSize = 0;
+
     bool mGetQoSData = true;
 
     QoSOptions mQosOptions = {};
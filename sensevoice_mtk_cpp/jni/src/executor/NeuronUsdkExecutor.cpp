@@ -40,6 +40,8 @@
 #include <sys/mman.h> 
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <string>
@@ -78,19 +80,51 @@ uint32_t GetNeuronTypeSize(int type) {
     return size;
 }
 
+int ToNeuronType(ExecutorDataType type) {
+    switch (type) {
+        case kFloat32:
+            return NEURON_TENSOR_FLOAT32;
+        case kFloat16:
+            return NEURON_TENSOR_FLOAT16;
+        case kInt32:
+            return NEURON_TENSOR_INT32;
+        case kInt16:
+            return NEURON_TENSOR_QUANT16_SYMM;
+        case kInt8:
+            return NEURON_TENSOR_QUANT8_ASYMM_SIGNED;
+        case kBool:
+            return NEURON_TENSOR_BOOL8;
+        default:
+            LOG(ERROR) << "No Neuron type for executor type " << static_cast<int>(type);
+            return -1;
+    }
+}
+
 bool GetModelInfo(const std::string& modelPath,
                   std::vector<std::vector<uint32_t>>& input,
                   std::vector<std::vector<uint32_t>>& output,
                   std::vector<uint32_t>& reused_size,
                   int &inputType,
                   int &outputType) {
+    const std::string name = ModelFileName(modelPath);
 
-    if (modelPath.find("text_encoder") != std::string::npos) {
+    if (name.find("text_encoder") != std::string::npos) {
         input = {{1, 77}, {1, 1}};
         output = {{1, 77, 768}, {1, 768}};
         inputType = NEURON_TENSOR_INT32;
         outputType = NEURON_TENSOR_FLOAT32;
-    } else if (modelPath.find("sensevoice") != std::string::npos) {
+    } else if (name.find("sensevoice_packed") != std::string::npos) {
+        // Packed-batch SenseVoice: several utterances share one 170-row window
+        // Input 0: features [1, 170, 560] float32 (prompt and gap rows ignored)
+        // Input 1: segment ids [1, 170] float32 (1..N per utterance, 0 = masked)
+        // Input 2: prompt roles [1, 170, 4] float32 (one-hot on prompt rows)
+        // Output: CTC logits [1, 170, 25055] float32
+        input = {{1, 170, 560}, {1, 170}, {1, 170, 4}};
+        output = {{1, 170, 25055}};
+        inputType = NEURON_TENSOR_FLOAT32;
+        outputType = NEURON_TENSOR_FLOAT32;
+        LOG(INFO) << "Using packed SenseVoice model configuration";
+    } else if (name.find("sensevoice") != std::string::npos) {
         // SenseVoice model configuration
         // Input 0: Audio features [1, 166, 560] float32 (10s audio after subsampling)
         // Input 1-4: prompt IDs [1] int32 (language_id, event_id, event_type_id, text_norm_id)
@@ -104,23 +138,67 @@ bool GetModelInfo(const std::string& modelPath,
         LOG(ERROR) << "Couldn't find the shape info for model";
         return false;
     }
+
+    // fp16-output export (main.py --fp16_output): same shapes, float16 logits
+    if (name.find("sensevoice") != std::string::npos &&
+        name.find("_fp16out") != std::string::npos) {
+        outputType = NEURON_TENSOR_FLOAT16;
+        LOG(INFO) << "Model writes float16 logits";
+    }
+
+    // Reduced-precision input export (main.py --input_type): every input in
+    // that type, features already CMVN-normalized on the host
+    if (name.find("sensevoice") != std::string::npos &&
+        name.find("_fp16in") != std::string::npos) {
+        inputType = NEURON_TENSOR_FLOAT16;
+        LOG(INFO) << "Model takes float16 inputs";
+    } else if (name.find("sensevoice") != std::string::npos &&
+               name.find("_int8in") != std::string::npos) {
+        inputType = NEURON_TENSOR_QUANT8_ASYMM_SIGNED;
+        LOG(INFO) << "Model takes int8 inputs";
+    }
+
+    // Top-k output head (main.py --top_k): k log-probs then their k token ids per row
+    const size_t topPos = name.find("_top");
+    if (name.find("sensevoice") != std::string::npos && topPos != std::string::npos) {
+        const int topK = std::atoi(name.c_str() + topPos + 4);
+        if (topK > 0) {
+            output[0].back() = 2 * static_cast<uint32_t>(topK);
+            LOG(INFO) << "Model writes the top-" << topK << " head";
+        }
+    }
     return true;
 }
 
 
 NeuronUsdkExecutor::NeuronUsdkExecutor(const std::string& name, const std::string& modelPath, const std::string& kOptions, const std::vector<uint32_t>& reusedSize,
                                        std::vector<std::vector<uint32_t>> inputShape, int inputType,
-                                       std::vector<std::vector<uint32_t>> outputShape, int outputType)
+                                       std::vector<std::vector<uint32_t>> outputShape, int outputType,
+                                       uint32_t batchSize, const void* dlaBuffer, size_t dlaSize)
         : Executor(name), kModelPath(modelPath), kOptions(kOptions), mInputSize(inputShape), mOutputSize(outputShape), mReusedSize(reusedSize),
-          mInputType(inputType), mOutputType(outputType) {
+          mInputType(inputType), mOutputType(outputType), kBatchSize(batchSize > 0 ? batchSize : 1),
+          mDlaBuffer(dlaBuffer), mDlaSize(dlaSize) {
     mInitiated = Initialize();
 }
 
+NeuronUsdkExecutor::NeuronUsdkExecutor(const NeuronUsdkExecutor* source)
+        : Executor(source->kName), kModelPath(source->kModelPath), kOptions(source->kOptions),
+          mInputSize(source->mInputSize), mOutputSize(source->mOutputSize),
+          mReusedSize(source->mReusedSize), mInputType(source->mInputType),
+          mOutputType(source->mOutputType), mCompilation(source->mCompilation),
+          kBatchSize(source->kBatchSize), mBatchedCompilation(source->mBatchedCompilation),
+          mSharedCompilation(true) {
+    mInitiated = CreateExecution() && SetupIO();
+}
+
 NeuronUsdkExecutor::~NeuronUsdkExecutor() {
     if (mExecution != nullptr) {
         NeuronExecution_free(mExecution);
         mExecution = nullptr;
     }
+    if (mSharedCompilation) {
+        return;
+    }
     if (mCompilation != nullptr) {
         NeuronCompilation_free(mCompilation);
         mCompilation = nullptr;
@@ -136,13 +214,16 @@ bool NeuronUsdkExecutor::Load(const std::string& modelPath) { return false; }
 bool NeuronUsdkExecutor::RunForMultipleInputsOutputs(const std::vector<TensorBuffer>& inputs,
                                                      const std::vector<TensorBuffer>& outputs) {
     LOG(INFO) << "NeuronUsdkExecutor RunForMultipleInputsOutputs";
-    // Set input
-    // since 3rd, 4th inputs of unet are fixed, skip SetInput() to save memcpy
-    size_t setSize = inputs.size() < 2 ? inputs.size() : 2 ;
-    for (size_t i = 0; i < setSize; i++) {
-        SetInput(i, inputs[i]);
+    if (!mInitiated) {
+        LOG(ERROR) << "NeuronUsdkExecutor not initialized";
+        return false;
+    }
+    if (mIOSets.size() > 1) {
+        return RunWithIOSets(inputs, outputs);
     }
 
+    // Set input
+    WriteInputs(0, inputs);
 
     // Inference
     if (NeuronExecution_compute(mExecution) != NEURON_NO_ERROR) {
@@ -158,6 +239,68 @@ bool NeuronUsdkExecutor::RunForMultipleInputsOutputs(const std::vector<TensorBuf
     return true;
 }
 
+bool NeuronUsdkExecutor::RunWithIOSets(const std::vector<TensorBuffer>& inputs,
+                                       const std::vector<TensorBuffer>& outputs) {
+    const size_t index = AcquireIOSet();
+    IOSet& set = mIOSets[index];
+
+    // Filled while the previous run computes on the other set
+    WriteInputs(index, inputs);
+
+    bool success;
+    {
+        std::lock_guard<std::mutex> lock(mComputeMutex);
+        if (mBoundIOSet != index) {
+            BindIOSet(index);
+        }
+        success = NeuronExecution_compute(mExecution) == NEURON_NO_ERROR;
+    }
+
+    // Drained while the next run computes
+    if (success) {
+        for (size_t i = 0; i < outputs.size() && i < set.outputs.size(); i++) {
+            ReadOutput(outputs[i], set.outputs[i].GetAddr());
+        }
+    } else {
+        LOG(ERROR) << "NeuronUsdkExecutor fail to inference";
+    }
+
+    ReleaseIOSet(index);
+    return success;
+}
+
+size_t NeuronUsdkExecutor::AcquireIOSet(size_t wanted) {
+    std::unique_lock<std::mutex> lock(mIOSetMutex);
+    if (wanted == SIZE_MAX) {
+        mIOSetCv.wait(lock, [this] { return !mFreeIOSets.empty(); });
+        const size_t index = mFreeIOSets.back();
+        mFreeIOSets.pop_back();
+        return index;
+    }
+    auto held = [&] { return std::find(mFreeIOSets.begin(), mFreeIOSets.end(), wanted); };
+    mIOSetCv.wait(lock, [&] { return held() != mFreeIOSets.end(); });
+    mFreeIOSets.erase(held());
+    return wanted;
+}
+
+void NeuronUsdkExecutor::ReleaseIOSet(size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(mIOSetMutex);
+        mFreeIOSets.push_back(index);
+    }
+    // Waiters may want a particular set
+    mIOSetCv.notify_all();
+}
+
+void NeuronUsdkExecutor::WriteInputs(size_t set, const std::vector<TensorBuffer>& inputs) {
+    std::vector<Memory>& memory = mIOSets[set].inputs;
+    for (size_t i = 0; i < inputs.size() && i < memory.size(); i++) {
+        if (InputChanged(set, i, inputs[i])) {
+            memcpy(memory[i].GetAddr(), inputs[i].data, inputs[i].bytes);
+        }
+    }
+}
+
 bool NeuronUsdkExecutor::Initialize() {
     LOG(INFO) << "NeuronUsdkExecutor initialize from model " << kModelPath;
 
@@ -168,6 +311,30 @@ bool NeuronUsdkExecutor::Initialize() {
         return false;
     }
 
+    // Batch-N DLA: features/logits carry the batch dim, scalar prompt inputs stay [1]
+    if (kBatchSize > 1) {
+        for (auto& shape : mInputSize) {
+            if (shape.size() > 1) {
+                shape[0] = kBatchSize;
+            }
+        }
+        for (auto& shape : mOutputSize) {
+            if (shape.size() > 1) {
+                shape[0] = kBatchSize;
+            }
+        }
+        LOG(INFO) << "Batch size: " << kBatchSize;
+    }
+
+    if (mDlaBuffer != nullptr) {
+        // Compiled network handed over in memory (bundle section), no file to open
+        if (!LoadDla(mDlaBuffer, mDlaSize)) {
+            LOG(ERROR) << "load dla fail";
+            return false;
+        }
+        return SetupIO();
+    }
+
     int fd = open(kModelPath.c_str(), O_RDONLY);
     if (fd == -1) {
         LOG(ERROR) << "Open dla file fail";
@@ -199,6 +366,27 @@ bool NeuronUsdkExecutor::Initialize() {
         LOG(ERROR) << "close fail";
     }
 
+    return SetupIO();
+}
+
+bool NeuronUsdkExecutor::SetupIO() {
+    mIOSets.emplace_back();
+    if (!AllocateIOSet(&mIOSets[0])) {
+        return false;
+    }
+    for (size_t i = 0; i < mIOSets[0].inputs.size(); i++) {
+        LOG(INFO) << "Input " << i << " size: " << mIOSets[0].inputs[i].GetSize();
+    }
+    for (size_t i = 0; i < mIOSets[0].outputs.size(); i++) {
+        LOG(INFO) << "Output " << i << " size: " << mIOSets[0].outputs[i].GetSize();
+    }
+    BindIOSet(0);
+    mFreeIOSets = {0};
+    ResetInputTracking(1);
+    return true;
+}
+
+bool NeuronUsdkExecutor::AllocateIOSet(IOSet* set) {
     size_t i = 0;
     std::string identifier = std::to_string(__COUNTER__) + "_input_";
     while (true) {
@@ -206,11 +394,11 @@ bool NeuronUsdkExecutor::Initialize() {
         if (size == kExecutorSizeError) {
             break;
         }
-        mInputMemory.emplace_back(Memory::Kind::NEURON_MEMORY, size, identifier + std::to_string(i));
-        NeuronExecution_setInputFromMemory(mExecution, i, NULL, mInputMemory[i].GetNeuronMemory(),
-                                           0, mInputMemory[i].GetSize());
-
-        LOG(INFO) << "Input " << i << " size: " << size;
+        set->inputs.emplace_back(Memory::Kind::NEURON_MEMORY, size, identifier + std::to_string(i));
+        if (set->inputs.back().GetAddr() == nullptr) {
+            LOG(ERROR) << "Allocate input " << i << " memory fail";
+            return false;
+        }
         i++;
     }
 
@@ -221,16 +409,58 @@ bool NeuronUsdkExecutor::Initialize() {
         if (size == kExecutorSizeError) {
             break;
         }
-        mOutputMemory.emplace_back(Memory::Kind::NEURON_MEMORY, size, identifier + std::to_string(i));
-        NeuronExecution_setOutputFromMemory(mExecution, i, NULL, mOutputMemory[i].GetNeuronMemory(),
-                                           0, mOutputMemory[i].GetSize());
-        LOG(INFO) << "Output " << i << " size: " << size;
+        set->outputs.emplace_back(Memory::Kind::NEURON_MEMORY, size, identifier + std::to_string(i));
+        if (set->outputs.back().GetAddr() == nullptr) {
+            LOG(ERROR) << "Allocate output " << i << " memory fail";
+            return false;
+        }
         i++;
     }
     return true;
 }
 
-bool NeuronUsdkExecutor::LoadDla(void* buffer, size_t size) {
+void NeuronUsdkExecutor::BindIOSet(size_t index) {
+    const IOSet& set = mIOSets[index];
+    for (size_t i = 0; i < set.inputs.size(); i++) {
+        NeuronExecution_setInputFromMemory(mExecution, i, NULL, set.inputs[i].GetNeuronMemory(),
+                                           0, set.inputs[i].GetSize());
+    }
+    for (size_t i = 0; i < set.outputs.size(); i++) {
+        NeuronExecution_setOutputFromMemory(mExecution, i, NULL, set.outputs[i].GetNeuronMemory(),
+                                            0, set.outputs[i].GetSize());
+    }
+
+    if (mBatchedCompilation && NeuronExecution_setBatchDone(mExecution) != NEURON_NO_ERROR) {
+        LOG(WARNING) << "NeuronExecution_setBatchDone fail";
+    }
+    mBoundIOSet = index;
+}
+
+bool NeuronUsdkExecutor::SetNumIOSets(uint32_t num) {
+    if (!mInitiated || num == 0) {
+        return false;
+    }
+    // Sets can't be dropped while runs may hold them
+    if (num <= mIOSets.size()) {
+        return num == mIOSets.size();
+    }
+
+    std::lock_guard<std::mutex> lock(mIOSetMutex);
+    while (mIOSets.size() < num) {
+        IOSet set;
+        if (!AllocateIOSet(&set)) {
+            LOG(WARNING) << "Could not allocate I/O set " << mIOSets.size() + 1;
+            return false;
+        }
+        mIOSets.push_back(std::move(set));
+        mFreeIOSets.push_back(mIOSets.size() - 1);
+    }
+    ResetInputTracking(mIOSets.size());
+    LOG(INFO) << "I/O sets: " << mIOSets.size();
+    return true;
+}
+
+bool NeuronUsdkExecutor::LoadDla(const void* buffer, size_t size) {
     int err = NeuronModel_create(&mModel);
 
     std::vector<uint32_t> inputNode;
@@ -240,9 +470,10 @@ bool NeuronUsdkExecutor::LoadDla(void* buffer, size_t size) {
         uint32_t inputNum = mInputSize[i].size();
         const uint32_t *dimsInput = mInputSize[i].data();
 
+        // int8 inputs are raw steps, the graph applies the feature scale
         NeuronOperandType tensorInputType;
         tensorInputType.type = mInputType;
-        tensorInputType.scale = 0.0f;
+        tensorInputType.scale = mInputType == NEURON_TENSOR_QUANT8_ASYMM_SIGNED ? 1.0f : 0.0f;
         tensorInputType.zeroPoint = 0;
         tensorInputType.dimensionCount = inputNum;
         tensorInputType.dimensions = dimsInput;
@@ -322,7 +553,20 @@ bool NeuronUsdkExecutor::LoadDla(void* buffer, size_t size) {
         return false;
     }
 
-    if (NeuronCompilation_createWithOptions(mModel, &mCompilation,
+    // Batched compilation lets the runtime spread the batch over a runner pool;
+    // older runtimes don't export it, so fall back to a normal compilation
+    if (kBatchSize > 1) {
+        if (NeuronCompilation_createForBatch(mModel, &mCompilation) == NEURON_NO_ERROR) {
+            mBatchedCompilation = true;
+            LOG(INFO) << "Using batched compilation";
+        } else {
+            LOG(WARNING) << "NeuronCompilation_createForBatch not available, using normal compilation";
+            mCompilation = nullptr;
+        }
+    }
+
+    if (!mBatchedCompilation &&
+        NeuronCompilation_createWithOptions(mModel, &mCompilation,
                                             kOptions.c_str()) != NEURON_NO_ERROR) {
         LOG(ERROR) << "NeuronCompilation_create fail";
         return false;
@@ -339,6 +583,10 @@ bool NeuronUsdkExecutor::LoadDla(void* buffer, size_t size) {
         LOG(ERROR) << "NeuronCompilation_finish fail";
         return false;
     };
+    return CreateExecution();
+}
+
+bool NeuronUsdkExecutor::CreateExecution() {
     if (NeuronExecution_create(mCompilation, &mExecution) != NEURON_NO_ERROR) {
         LOG(ERROR) << "NeuronExecution_create fail";
         return false;
@@ -348,9 +596,30 @@ bool NeuronUsdkExecutor::LoadDla(void* buffer, size_t size) {
         LOG(ERROR) << "NeuronExecution_setBoostHint fail";
         return false;
     };
+
+    if (mBatchedCompilation) {
+        uint8_t runners = static_cast<uint8_t>(std::min<uint32_t>(kBatchSize, UINT8_MAX));
+        if (NeuronExecution_setRunnerPoolSize(mExecution, runners) != NEURON_NO_ERROR) {
+            LOG(WARNING) << "NeuronExecution_setRunnerPoolSize(" << static_cast<int>(runners) << ") fail";
+        } else {
+            LOG(INFO) << "Runner pool size: " << static_cast<int>(runners);
+        }
+    }
     return true;
 }
 
+std::unique_ptr<Executor> NeuronUsdkExecutor::Clone() {
+    if (!mInitiated) {
+        return nullptr;
+    }
+    std::unique_ptr<Executor> clone(new NeuronUsdkExecutor(this));
+    if (!clone->Initialized()) {
+        LOG(ERROR) << "Failed to create a second execution of " << kModelPath;
+        return nullptr;
+    }
+    return clone;
+}
+
 size_t NeuronUsdkExecutor::GetInputTensorSize(size_t index) {
     auto size = GetNeuronTypeSize(mInputType);
     if (index < mInputSize.size() && size) {
@@ -378,20 +647,26 @@ size_t NeuronUsdkExecutor::GetOutputTensorSize(size_t index) {
 }
 
 bool NeuronUsdkExecutor::SetInput(size_t index, TensorBuffer buffer) {
-    if (index >= mInputMemory.size()) {
+    if (mIOSets.empty() || index >= mIOSets[0].inputs.size()) {
         LOG(WARNING) << "Invalid input tensor index: " << index;
         return false;
     }
-    memcpy(mInputMemory[index].GetAddr(), buffer.data, buffer.bytes);
+    AcquireIOSet(0);
+    if (InputChanged(0, index, buffer)) {
+        memcpy(mIOSets[0].inputs[index].GetAddr(), buffer.data, buffer.bytes);
+    }
+    ReleaseIOSet(0);
     return true;
 }
 
 bool NeuronUsdkExecutor::GetOutput(size_t index, TensorBuffer buffer) {
-    if (index >= mOutputMemory.size()) {
+    if (mIOSets.empty() || index >= mIOSets[0].outputs.size()) {
         LOG(WARNING) << "Invalid output tensor index:" << index;
         return false;
     }
-    memcpy(buffer.data, mOutputMemory[index].GetAddr(), buffer.bytes);
+    AcquireIOSet(0);
+    ReadOutput(buffer, mIOSets[0].outputs[index].GetAddr());
+    ReleaseIOSet(0);
     return true;
 }
 
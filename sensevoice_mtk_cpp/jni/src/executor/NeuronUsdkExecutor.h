@@ -35,19 +35,40 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include "Executor.h"
 #include "neuron/api/NeuronAdapter.h"
 #include "neuron/api/NeuronAdapterShim.h"
 
 namespace mtk::neuropilot {
 
+// Byte size of a Neuron operand type, 0 if unsupported
+uint32_t GetNeuronTypeSize(int type);
+
+// Neuron tensor operand type of an executor data type, -1 if unsupported
+int ToNeuronType(ExecutorDataType type);
+
+// Fixed I/O shapes and types of a known model, looked up by its file name
+// (ModelFileName, the directories are ignored; batch 1)
+bool GetModelInfo(const std::string& modelPath,
+                  std::vector<std::vector<uint32_t>>& input,
+                  std::vector<std::vector<uint32_t>>& output,
+                  std::vector<uint32_t>& reused_size,
+                  int &inputType,
+                  int &outputType);
+
 class NeuronUsdkExecutor : public Executor {
 public:
 
+    // batchSize > 1: the DLA was compiled with batch N, the leading dim of every
+    // non-scalar tensor becomes N and a batched compilation is used when available
+    // dlaBuffer: compiled network already in memory, modelPath is then only a name
     explicit NeuronUsdkExecutor(const std::string& name, const std::string& modelPath, const std::string& kOptions = "", const std::vector<uint32_t>& reusedSize = {},
                                 std::vector<std::vector<uint32_t>> inputShape = {}, int inputType = NEURON_INT32,
-                                std::vector<std::vector<uint32_t>> outputShape = {}, int outputType = NEURON_INT32);
+                                std::vector<std::vector<uint32_t>> outputShape = {}, int outputType = NEURON_INT32,
+                                uint32_t batchSize = 1, const void* dlaBuffer = nullptr, size_t dlaSize = 0);
 
     virtual ~NeuronUsdkExecutor();
 
@@ -64,14 +85,54 @@ public:
 
     virtual bool GetOutput(size_t index, TensorBuffer buffer) override;
 
+    // A second NeuronExecution of the same compilation
+    virtual std::unique_ptr<Executor> Clone() override;
+
+    // Extra sets are bound to the execution in turn, before their compute
+    virtual bool SetNumIOSets(uint32_t num) override;
+
+    virtual uint32_t GetNumIOSets() override { return static_cast<uint32_t>(mIOSets.size()); }
+
     virtual void SetAllowFp16PrecisionForFp32(bool allow) override;
 
     virtual void SetNumThreads(uint32_t num) override { UNUSED(num); }
 
 private:
+    // Clone: a new execution borrowing the source's model and compilation
+    explicit NeuronUsdkExecutor(const NeuronUsdkExecutor* source);
+
     bool Initialize();
 
-    bool LoadDla(void* buffer, size_t size);
+    // Create the execution on mCompilation
+    bool CreateExecution();
+
+    bool LoadDla(const void* buffer, size_t size);
+
+    // Allocate the I/O memory and bind it to the execution
+    bool SetupIO();
+
+    // One set of I/O memory, in tensor order
+    struct IOSet {
+        std::vector<Memory> inputs;
+        std::vector<Memory> outputs;
+    };
+
+    bool AllocateIOSet(IOSet* set);
+
+    void BindIOSet(size_t set);
+
+    // Wait for a free I/O set (or for set `wanted`) and hold it, so that its
+    // memory and its input tracking only change under one caller at a time
+    size_t AcquireIOSet(size_t wanted = SIZE_MAX);
+
+    void ReleaseIOSet(size_t index);
+
+    // Write the inputs that differ from what the set holds
+    void WriteInputs(size_t set, const std::vector<TensorBuffer>& inputs);
+
+    // Ping-pong run: copies outside the compute lock
+    bool RunWithIOSets(const std::vector<TensorBuffer>& inputs,
+                       const std::vector<TensorBuffer>& outputs);
 
 private:
     const std::string kModelPath;
@@ -90,14 +151,32 @@ private:
 
     int mOutputType = NEURON_TENSOR_FLOAT32;
 
-    std::vector<Memory> mInputMemory;
+    std::vector<IOSet> mIOSets;  // Set 0 is bound at setup and used by SetInput/GetOutput, held like a run
+
+    std::vector<size_t> mFreeIOSets;
+
+    std::mutex mIOSetMutex;
+
+    std::condition_variable mIOSetCv;
 
-    std::vector<Memory> mOutputMemory;
+    std::mutex mComputeMutex;  // One compute on the execution at a time
+
+    size_t mBoundIOSet = 0;
 
     NeuronCompilation* mCompilation = nullptr;
 
     NeuronExecution* mExecution = nullptr;
 
+    const uint32_t kBatchSize = 1;
+
+    bool mBatchedCompilation = false;
+
+    bool mSharedCompilation = false;  // Clone: model and compilation belong to the source
+
+    const void* mDlaBuffer = nullptr;
+
+    size_t mDlaSize = 0;
+
 private:
     DISALLOW_COPY_AND_ASSIGN(NeuronUsdkExecutor);
 };
@@ -1,10 +1,13 @@
 /* Audio Frontend for SenseVoice
  *
  * Computes Fbank features and applies LFR (Low Frame Rate) transformation.
+ * For DLAs with reduced-precision inputs the CMVN of am.mvn is applied in
+ * the LFR gather, and the features are encoded as float16 or int8.
  */
 
 #pragma once
 
+#include <string>
 #include <vector>
 #include <cstdint>
 #include <memory>
@@ -12,6 +15,15 @@
 
 namespace sensevoice {
 
+// CMVN of the LFR features (am.mvn): dim d becomes (x + neg_mean[d]) * inv_stddev[d]
+struct CmvnStats {
+    std::vector<float> neg_mean;
+    std::vector<float> inv_stddev;
+
+    bool Empty() const { return neg_mean.empty(); }
+    int32_t Dim() const { return static_cast<int32_t>(neg_mean.size()); }
+};
+
 class AudioFrontend {
 public:
     explicit AudioFrontend(const AudioConfig& config);
@@ -22,19 +34,40 @@ public:
     // Output: fbank features [num_frames, num_mel_bins]
     std::vector<float> ComputeFbank(const std::vector<float>& samples);
 
+    // Compute fbank features from 16-bit PCM
+    // Input: non-owning view of int16 samples, scaled to [-1, 1] chunk by chunk
+    //        as they are fed to the fbank, so no full-size float copy is made
+    // Output: fbank features [num_frames, num_mel_bins]
+    std::vector<float> ComputeFbank(const int16_t* samples, size_t num_samples);
+
     // Apply LFR transformation
     // Input: fbank features [num_frames, 80]
     // Output: LFR features [out_frames, 560]
+    // cmvn (optional, Dim() == 560) is applied while the frames are gathered
     static std::vector<float> ApplyLFR(const std::vector<float>& fbank,
                                        int32_t num_frames,
                                        int32_t feat_dim = 80,
                                        int32_t window_size = 7,
-                                       int32_t window_shift = 6);
+                                       int32_t window_shift = 6,
+                                       const CmvnStats* cmvn = nullptr);
+
+    // Apply LFR to a range of fbank frames (e.g. one VAD segment)
+    // Input: pointer to the first fbank frame of the range [num_frames, feat_dim]
+    static std::vector<float> ApplyLFR(const float* fbank,
+                                       int32_t num_frames,
+                                       int32_t feat_dim = 80,
+                                       int32_t window_size = 7,
+                                       int32_t window_shift = 6,
+                                       const CmvnStats* cmvn = nullptr);
 
     // Full pipeline: audio -> LFR features
     std::vector<float> Process(const std::vector<float>& samples,
                                int32_t* out_num_frames = nullptr);
 
+    // Full pipeline: 16-bit PCM -> LFR features
+    std::vector<float> Process(const int16_t* samples, size_t num_samples,
+                               int32_t* out_num_frames = nullptr);
+
     // Get number of mel bins
     int32_t NumMelBins() const { return config_.num_mel_bins; }
 
@@ -42,6 +75,10 @@ public:
     int32_t SampleRate() const { return config_.sample_rate; }
 
 private:
+    // Fbank -> LFR, shared by the float and int16 pipelines
+    std::vector<float> FbankToLfr(const std::vector<float>& fbank,
+                                  int32_t* out_num_frames) const;
+
     AudioConfig config_;
 
     // Internal state for fbank computation
@@ -49,14 +86,35 @@ private:
     std::unique_ptr<Impl> impl_;
 };
 
+// Utility: Load CMVN from am.mvn (Kaldi nnet text: <AddShift> holds the
+// negated means, <Rescale> the inverse standard deviations)
+bool LoadCmvn(const std::string& filename, CmvnStats* cmvn);
+
+// Reduced-precision encodings of normalized LFR features for the model input
+// float16: IEEE half bit patterns, rounded to nearest even
+void FeaturesToHalf(const float* src, size_t count, uint16_t* dst);
+// int8: round(x / step), saturated to [-127, 127]
+void FeaturesToInt8(const float* src, size_t count, float step, int8_t* dst);
+
 // Utility: Load WAV file and return samples
 bool LoadWavFile(const std::string& filename,
                  std::vector<float>* samples,
                  int32_t* sample_rate);
 
+// Utility: Load 16-bit WAV file without converting to float
+// Returns false for non 16-bit WAV files (use the float overload instead)
+bool LoadWavFile(const std::string& filename,
+                 std::vector<int16_t>* samples,
+                 int32_t* sample_rate);
+
 // Utility: Load raw PCM file (16-bit, mono)
 bool LoadPcmFile(const std::string& filename,
                  std::vector<float>* samples,
                  int32_t expected_sample_rate = 16000);
 
+// Utility: Load raw PCM file (16-bit, mono) without converting to float
+bool LoadPcmFile(const std::string& filename,
+                 std::vector<int16_t>* samples,
+                 int32_t expected_sample_rate = 16000);
+
 }  // namespace sensevoice
@@ -0,0 +1,98 @@
+/* Batch Queue for SenseVoice
+ *
+ * Collects recognition requests from concurrent callers and hands them to
+ * the pipeline in groups, so batch-N and packed models run full batches.
+ * A batch holds requests with the oldest request's language and text norm;
+ * it is flushed once max_requests of those are waiting or the oldest request
+ * has waited max_wait_ms.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "sensevoice_config.h"
+#include "tokenizer.h"
+
+namespace sensevoice {
+
+// A queued utterance, 16kHz mono: owned float samples or a view of 16-bit PCM
+struct BatchUtterance {
+    std::vector<float> samples;    // Normalized to [-1, 1]
+    const int16_t* pcm = nullptr;  // Used instead of samples when set
+    size_t num_pcm = 0;
+
+    size_t NumSamples() const { return pcm ? num_pcm : samples.size(); }
+};
+
+// Flush accounting
+struct BatchQueueStats {
+    int64_t requests = 0;
+    int64_t batches = 0;
+    int64_t full_flushes = 0;      // Flushed because max_requests were waiting
+    int64_t deadline_flushes = 0;  // Flushed because the oldest request reached max_wait_ms
+};
+
+class BatchQueue {
+public:
+    // Runs one batch; all utterances share language/text_norm, one result per utterance
+    using BatchFn = std::function<std::vector<RecognitionResult>(
+        const std::vector<BatchUtterance>& utterances, Language, TextNorm)>;
+
+    BatchQueue(int32_t max_requests, int32_t max_wait_ms, BatchFn run_batch);
+
+    // Stops the worker after the queued requests have been processed
+    ~BatchQueue();
+
+    // Queue one utterance (float samples, 16kHz mono)
+    std::future<RecognitionResult> Submit(std::vector<float> samples,
+                                          Language language,
+                                          TextNorm text_norm);
+
+    // Queue a view of 16-bit PCM (16kHz mono); the samples must stay valid
+    // until the future is ready and are scaled inside the fbank stage
+    std::future<RecognitionResult> Submit(const int16_t* samples,
+                                          size_t num_samples,
+                                          Language language,
+                                          TextNorm text_norm);
+
+    BatchQueueStats GetStats() const;
+
+private:
+    struct Request {
+        BatchUtterance utterance;
+        Language language;
+        TextNorm text_norm;
+        std::chrono::steady_clock::time_point enqueue_time;
+        std::promise<RecognitionResult> promise;
+    };
+
+    std::future<RecognitionResult> Enqueue(BatchUtterance utterance,
+                                           Language language,
+                                           TextNorm text_norm);
+
+    void WorkerLoop();
+
+    // Queued requests that can share a batch with these prompts (mutex_ held)
+    size_t CountMatching(Language language, TextNorm text_norm) const;
+
+    const size_t max_requests_;
+    const std::chrono::milliseconds max_wait_;
+    BatchFn run_batch_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Request> queue_;
+    BatchQueueStats stats_;
+    bool stop_ = false;
+    std::thread worker_;
+};
+
+}  // namespace sensevoice
@@ -0,0 +1,72 @@
+/* Shared helpers for the SenseVoice benchmarks and command-line tools
+ *
+ * Header-only: each tool is its own executable and links sensevoice_core,
+ * so these stay out of the library.
+ */
+
+#pragma once
+
+#include "sensevoice_config.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sensevoice {
+namespace bench {
+
+// Nearest-rank percentile, p in (0, 1]; 0 for an empty set
+inline double Percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(std::ceil(p * values.size())) - 1;
+    return values[std::min(index, values.size() - 1)];
+}
+
+// "usdk" / "runtime" / "host[:<latency_us>]"
+inline bool ParseBackend(const std::string& backend_str, ModelConfig* model) {
+    if (backend_str == "usdk") {
+        model->backend = ModelBackend::NeuronUsdk;
+    } else if (backend_str == "runtime") {
+        model->backend = ModelBackend::NeuronRuntime;
+    } else if (backend_str.compare(0, 4, "host") == 0) {
+        model->backend = ModelBackend::Host;
+        if (backend_str.size() > 5 && backend_str[4] == ':') {
+            model->host_latency_us = std::atoi(backend_str.c_str() + 5);
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Raw float32 [num_frames, vocab_size] model output, as the decode benches read it
+inline bool LoadLogits(const std::string& path, int32_t vocab_size, std::vector<float>* logits,
+                       int32_t* num_frames) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        LOG(ERROR) << "Failed to open logits: " << path;
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(file.tellg());
+    size_t row_bytes = sizeof(float) * vocab_size;
+    if (bytes == 0 || bytes % row_bytes != 0) {
+        LOG(ERROR) << path << ": " << bytes << " bytes is not a multiple of " << vocab_size << " floats";
+        return false;
+    }
+    *num_frames = static_cast<int32_t>(bytes / row_bytes);
+    logits->resize(bytes / sizeof(float));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(logits->data()), bytes);
+    return static_cast<bool>(file);
+}
+
+}  // namespace bench
+}  // namespace sensevoice
@@ -0,0 +1,148 @@
+/* CTC Prefix Beam Search for SenseVoice
+ *
+ * Prefix beam search over the CTC logits. Hypotheses are nodes of a pooled
+ * prefix trie (a prefix is the path from the root), so extending a
+ * hypothesis never copies its token sequence. An optional HotwordGraph
+ * adds a bonus to prefixes that match hotwords, an optional NgramLm adds
+ * the weighted LM score (shallow fusion).
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ngram_lm.h"
+#include "sensevoice_config.h"
+
+namespace sensevoice {
+
+struct CTCDecoderResult;
+class HotwordGraph;
+
+// Beam search parameters
+struct BeamSearchOptions {
+    int32_t beam_size = 8;           // Hypotheses kept after each frame
+    int32_t top_k = 8;               // Tokens expanded per frame (blank is always kept)
+    float prune_threshold = 10.0f;   // Skip tokens this far (logit) below the frame best
+    float lm_weight = 0.3f;          // LM fusion: weight of ln p_lm
+    float lm_token_bonus = 0.0f;     // LM fusion: bonus per LM-scored token (offsets deletions)
+};
+
+// Reusable decoder; the node pool and scratch buffers keep their capacity
+// between calls, so steady-state decoding does not allocate.
+// Not thread-safe: use one instance per decoding thread.
+class PrefixBeamSearch {
+public:
+    PrefixBeamSearch() = default;
+
+    // Decode logits [num_frames, vocab_size]
+    // Frame indices in the result are the frames where each token was first emitted
+    // hotwords and lm may be nullptr; they must stay alive for the duration of the call
+    // allowed_tokens (optional) limits the candidates to those token ranges
+    // block_max (optional, NumMaxBlocks(vocab_size) per frame, CopyRowBlockMax)
+    // lets the candidate scan read only the blocks that reach the frame's cut
+    void Search(const float* logits,
+                int32_t num_frames,
+                int32_t vocab_size,
+                int64_t blank_id,
+                const BeamSearchOptions& options,
+                const HotwordGraph* hotwords,
+                const NgramLm* lm,
+                CTCDecoderResult* result,
+                const std::vector<TokenRange>* allowed_tokens = nullptr,
+                const float* block_max = nullptr);
+
+    // Decode top-k rows [num_frames, 2k] (k log-probs, then their k token ids
+    // as floats) in place. Only the k tokens of a frame are expanded; a blank
+    // outside them scores the mass the k leave over (TopKTailBound)
+    void SearchTopK(const float* rows,
+                    int32_t num_frames,
+                    int32_t k,
+                    int64_t blank_id,
+                    const BeamSearchOptions& options,
+                    const HotwordGraph* hotwords,
+                    const NgramLm* lm,
+                    CTCDecoderResult* result,
+                    const std::vector<TokenRange>* allowed_tokens = nullptr);
+
+    // Trie nodes used by the last search (for stats)
+    size_t NumNodes() const { return nodes_.size(); }
+
+    // Time of the last search split into the per-frame candidate scan over
+    // the logits and the prefix trie bookkeeping (for sensevoice_decode_bench);
+    // only measured while enabled, two clock reads per frame
+    struct Profile {
+        double scan_ms = 0.0;
+        double trie_ms = 0.0;
+    };
+    void EnableProfile(bool enable) { profile_enabled_ = enable; }
+    const Profile& LastProfile() const { return profile_; }
+
+private:
+    // One prefix; scores are log-domain and only meaningful for beam members
+    struct Node {
+        int32_t parent;
+        int32_t token;          // Last token of the prefix (-1 for the root)
+        int32_t frame;          // Frame where the token was emitted
+        int32_t first_child;
+        int32_t next_sibling;
+        int32_t stamp;          // Frame for which next_* are valid
+        uint32_t context_state; // Hotword trie state after this prefix
+        float context_score;    // Hotword bonus collected by this prefix
+        float lm_score;         // Weighted LM score of this prefix
+        float blank;            // Prefix ending in blank
+        float non_blank;        // Prefix ending in its last token
+        float next_blank;
+        float next_non_blank;
+    };
+
+    // Candidate token of the current frame
+    struct Candidate {
+        int32_t token;
+        float score;
+    };
+
+    int32_t NewNode(int32_t parent, int32_t token, int32_t frame);
+    int32_t Child(int32_t parent, int32_t token, int32_t frame);
+
+    // Reset next_* the first time a node is touched in frame t
+    void Touch(int32_t node, int32_t t);
+
+    // Search over rows of row_width values: full logits (top_k 0, row_width
+    // is the vocabulary, block_max optional) or top-k rows (row_width 2 * top_k)
+    void Run(const float* rows, int32_t num_frames, int32_t row_width, int32_t top_k,
+             int64_t blank_id, const BeamSearchOptions& options, const HotwordGraph* hotwords,
+             const NgramLm* lm, CTCDecoderResult* result, const std::vector<TokenRange>* allowed_tokens,
+             const float* block_max);
+
+    // Tokens of the frame worth expanding, scores relative to the frame best
+    // (the best of the allowed tokens, when given); frame_block_max may be nullptr
+    void SelectCandidates(const float* frame_logits, const float* frame_block_max, int32_t vocab_size,
+                          int64_t blank_id, const BeamSearchOptions& options,
+                          const std::vector<TokenRange>* allowed_tokens);
+
+    // SelectCandidates over the k entries of a top-k row
+    void SelectTopKCandidates(const float* row, int32_t k, int64_t blank_id,
+                              const BeamSearchOptions& options,
+                              const std::vector<TokenRange>* allowed_tokens);
+
+    std::vector<Node> nodes_;
+    std::vector<int32_t> beam_;
+    std::vector<int32_t> touched_;
+    std::vector<Candidate> candidates_;
+    std::vector<float> block_top_;  // Largest block maxima of the frame (SelectCandidates)
+    float blank_score_ = 0.0f;
+    const HotwordGraph* hotwords_ = nullptr;
+
+    // LM fusion; the LM context of node i is lm_states_[i], computed once
+    // when the node is created, so every lookup is cached per prefix
+    const NgramLm* lm_ = nullptr;
+    float lm_weight_ = 0.0f;
+    float lm_token_bonus_ = 0.0f;
+    std::vector<NgramLm::State> lm_states_;
+
+    bool profile_enabled_ = false;
+    Profile profile_;
+};
+
+}  // namespace sensevoice
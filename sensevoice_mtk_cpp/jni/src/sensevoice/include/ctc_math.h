@@ -0,0 +1,605 @@
+/* CTC Math Helpers for SenseVoice
+ *
+ * Row-wise argmax and log-softmax over the CTC logits, and the row copy
+ * that records the blank-frame bound on readback. The vocabulary row is
+ * scanned eight floats at a time in two 4-lane registers (NEON on arm64,
+ * SSE2 on x86 host builds), with a polynomial exp instead of libm.
+ *
+ * The kernels also take fp16 rows (IEEE half bit patterns, as an fp16-output
+ * DLA writes them). Those are scanned in place: each load converts four
+ * halves in a register (NEON fcvtl on arm64, F16C on x86 when enabled), so a
+ * row is never widened to float32 in memory and the scan reads half the bytes.
+ *
+ * A top-k head (k log-probs and their token ids per row) is read as it is:
+ * the TopK* helpers look tokens up among the k entries of a row.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define SENSEVOICE_SIMD4 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SENSEVOICE_SIMD4 1
+#endif
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace sensevoice {
+
+// Cephes expf: x = n ln2 + r, exp(r) by a degree-5 polynomial, 2^n through the
+// exponent bits. n comes from the 1.5 * 2^23 rounding trick, so the integer is
+// also the low mantissa bits of the rounded value and needs no conversion
+namespace exp_detail {
+constexpr float kMin = -87.0f;           // exp(kMin) is still a normal float
+constexpr float kLog2e = 1.44269504f;
+constexpr float kRound = 12582912.0f;    // 1.5 * 2^23
+constexpr int32_t kRoundBits = 0x4B400000;
+constexpr float kLn2Hi = 0.693359375f;
+constexpr float kLn2Lo = -2.12194440e-4f;
+constexpr float kP0 = 1.9875691500e-4f;
+constexpr float kP1 = 1.3981999507e-3f;
+constexpr float kP2 = 8.3334519073e-3f;
+constexpr float kP3 = 4.1665795894e-2f;
+constexpr float kP4 = 1.6666665459e-1f;
+constexpr float kP5 = 5.0000001201e-1f;
+}  // namespace exp_detail
+
+// exp(x) for x <= 0, ~2 ulp; inputs below -87 return exp(-87)
+inline float FastExp(float x) {
+    using namespace exp_detail;
+    x = std::max(x, kMin);
+    const float shifted = x * kLog2e + kRound;
+    const float n = shifted - kRound;
+    const float r = x - n * kLn2Hi - n * kLn2Lo;
+    float p = kP0;
+    p = p * r + kP1;
+    p = p * r + kP2;
+    p = p * r + kP3;
+    p = p * r + kP4;
+    p = p * r + kP5;
+    const float y = p * r * r + r + 1.0f;
+    int32_t bits;
+    std::memcpy(&bits, &shifted, sizeof(bits));
+    bits = (bits - kRoundBits + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return y * scale;
+}
+
+// IEEE half (bit pattern) to float, exact
+inline float HalfToFloat(uint16_t h) {
+#if defined(__aarch64__)
+    __fp16 v;
+    std::memcpy(&v, &h, sizeof(v));
+    return static_cast<float>(v);
+#elif defined(__F16C__)
+    return _cvtsh_ss(h);
+#else
+    const uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+    uint32_t exp = (h >> 10) & 0x1Fu;
+    uint32_t mant = h & 0x3FFu;
+    uint32_t bits;
+    if (exp == 0x1Fu) {
+        bits = sign | 0x7F800000u | (mant << 13);       // Inf / NaN
+    } else if (exp != 0) {
+        bits = sign | ((exp + 112) << 23) | (mant << 13);
+    } else if (mant == 0) {
+        bits = sign;
+    } else {
+        // Subnormal: shift the leading one into the implicit bit
+        exp = 113;
+        while (!(mant & 0x400u)) {
+            mant <<= 1;
+            exp--;
+        }
+        bits = sign | (exp << 23) | ((mant & 0x3FFu) << 13);
+    }
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+#endif
+}
+
+// Float to IEEE half (bit pattern), round to nearest even; out of range is +-inf
+inline uint16_t FloatToHalf(float x) {
+#if defined(__aarch64__)
+    const __fp16 v = static_cast<__fp16>(x);
+    uint16_t h;
+    std::memcpy(&h, &v, sizeof(h));
+    return h;
+#elif defined(__F16C__)
+    return static_cast<uint16_t>(_cvtss_sh(x, 0));
+#else
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    const uint32_t abs = bits & 0x7FFFFFFFu;
+    if (abs >= 0x7F800000u) {
+        return sign | 0x7C00u | (abs > 0x7F800000u ? 0x200u : 0u);
+    }
+    if (abs >= 0x477FF000u) {  // >= 65520 rounds to inf
+        return sign | 0x7C00u;
+    }
+    if (abs < 0x38800000u) {   // Below 2^-14: subnormal half
+        if (abs < 0x33000000u) {
+            return sign;
+        }
+        const uint32_t shift = 126 - (abs >> 23);
+        const uint32_t mant = (abs & 0x7FFFFFu) | 0x800000u;
+        uint32_t half = mant >> shift;
+        const uint32_t rest = mant & ((1u << shift) - 1);
+        const uint32_t tie = 1u << (shift - 1);
+        half += (rest > tie || (rest == tie && (half & 1u))) ? 1u : 0u;
+        return static_cast<uint16_t>(sign | half);
+    }
+    const uint32_t rebased = abs - 0x38000000u;
+    return static_cast<uint16_t>(sign | ((rebased + 0xFFFu + ((rebased >> 13) & 1u)) >> 13));
+#endif
+}
+
+// Element value of a float or fp16 row
+inline float ToFloat(float x) { return x; }
+inline float ToFloat(uint16_t h) { return HalfToFloat(h); }
+
+// Copy one element between rows; fp16 to float widens, same type copies as is
+inline void CopyElement(float x, float* out) { *out = x; }
+inline void CopyElement(uint16_t h, float* out) { *out = HalfToFloat(h); }
+inline void CopyElement(uint16_t h, uint16_t* out) { *out = h; }
+
+#if defined(SENSEVOICE_SIMD4)
+namespace simd {
+#if defined(__aarch64__)
+using F32x4 = float32x4_t;
+inline F32x4 Load(const float* p) { return vld1q_f32(p); }
+inline F32x4 Load(const uint16_t* p) { return vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(p))); }
+inline void Store(float* p, F32x4 a) { vst1q_f32(p, a); }
+inline F32x4 Splat(float v) { return vdupq_n_f32(v); }
+inline F32x4 Add(F32x4 a, F32x4 b) { return vaddq_f32(a, b); }
+inline F32x4 Sub(F32x4 a, F32x4 b) { return vsubq_f32(a, b); }
+inline F32x4 Mul(F32x4 a, F32x4 b) { return vmulq_f32(a, b); }
+inline F32x4 Max(F32x4 a, F32x4 b) { return vmaxq_f32(a, b); }
+inline F32x4 MulAdd(F32x4 a, F32x4 b, F32x4 c) { return vfmaq_f32(c, a, b); }  // a * b + c
+inline float ReduceAdd(F32x4 a) { return vaddvq_f32(a); }
+inline float ReduceMax(F32x4 a) { return vmaxvq_f32(a); }
+inline bool AnyGreater(F32x4 a, F32x4 b) { return vmaxvq_u32(vcgtq_f32(a, b)) != 0; }
+// 2^n from the rounded value v = n + 1.5 * 2^23
+inline F32x4 Pow2(F32x4 v) {
+    int32x4_t bits = vsubq_s32(vreinterpretq_s32_f32(v), vdupq_n_s32(exp_detail::kRoundBits - 127));
+    return vreinterpretq_f32_s32(vshlq_n_s32(bits, 23));
+}
+#else
+using F32x4 = __m128;
+inline F32x4 Load(const float* p) { return _mm_loadu_ps(p); }
+#if defined(__F16C__)
+inline F32x4 Load(const uint16_t* p) {
+    return _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+#else
+inline F32x4 Load(const uint16_t* p) {
+    return _mm_setr_ps(HalfToFloat(p[0]), HalfToFloat(p[1]), HalfToFloat(p[2]), HalfToFloat(p[3]));
+}
+#endif
+inline void Store(float* p, F32x4 a) { _mm_storeu_ps(p, a); }
+inline F32x4 Splat(float v) { return _mm_set1_ps(v); }
+inline F32x4 Add(F32x4 a, F32x4 b) { return _mm_add_ps(a, b); }
+inline F32x4 Sub(F32x4 a, F32x4 b) { return _mm_sub_ps(a, b); }
+inline F32x4 Mul(F32x4 a, F32x4 b) { return _mm_mul_ps(a, b); }
+inline F32x4 Max(F32x4 a, F32x4 b) { return _mm_max_ps(a, b); }
+inline F32x4 MulAdd(F32x4 a, F32x4 b, F32x4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline float ReduceAdd(F32x4 a) {
+    float v[4];
+    _mm_storeu_ps(v, a);
+    return (v[0] + v[1]) + (v[2] + v[3]);
+}
+inline float ReduceMax(F32x4 a) {
+    float v[4];
+    _mm_storeu_ps(v, a);
+    return std::max(std::max(v[0], v[1]), std::max(v[2], v[3]));
+}
+inline bool AnyGreater(F32x4 a, F32x4 b) { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)) != 0; }
+inline F32x4 Pow2(F32x4 v) {
+    __m128i bits = _mm_sub_epi32(_mm_castps_si128(v), _mm_set1_epi32(exp_detail::kRoundBits - 127));
+    return _mm_castsi128_ps(_mm_slli_epi32(bits, 23));
+}
+#endif
+
+// FastExp on four lanes
+inline F32x4 Exp(F32x4 x) {
+    using namespace exp_detail;
+    x = Max(x, Splat(kMin));
+    const F32x4 shifted = MulAdd(x, Splat(kLog2e), Splat(kRound));
+    const F32x4 n = Sub(shifted, Splat(kRound));
+    const F32x4 r = Sub(Sub(x, Mul(n, Splat(kLn2Hi))), Mul(n, Splat(kLn2Lo)));
+    F32x4 p = MulAdd(Splat(kP0), r, Splat(kP1));
+    p = MulAdd(p, r, Splat(kP2));
+    p = MulAdd(p, r, Splat(kP3));
+    p = MulAdd(p, r, Splat(kP4));
+    p = MulAdd(p, r, Splat(kP5));
+    const F32x4 y = Add(MulAdd(p, Mul(r, r), r), Splat(1.0f));
+    return Mul(y, Pow2(shifted));
+}
+
+// Store four lanes loaded from src: float rows store the register, fp16 rows
+// copied to fp16 keep their bits
+inline void Copy4(const float* src, F32x4 a, float* out) { (void)src; Store(out, a); }
+inline void Copy4(const uint16_t* src, F32x4 a, float* out) { (void)src; Store(out, a); }
+inline void Copy4(const uint16_t* src, F32x4 a, uint16_t* out) {
+    (void)a;
+    std::memcpy(out, src, 4 * sizeof(uint16_t));
+}
+}  // namespace simd
+#endif
+
+// Index of the first largest element of x[0..n); *max_val receives the value
+// A block is only looked at lane by lane when it holds a new maximum
+// T is float or uint16_t (fp16), here and in the kernels below
+template <typename T>
+inline int32_t RowArgmax(const T* x, int32_t n, float* max_val) {
+    int32_t i = 0;
+    int32_t best_id = 0;
+    float best = -std::numeric_limits<float>::infinity();
+#if defined(SENSEVOICE_SIMD4)
+    simd::F32x4 m = simd::Splat(best);
+    for (; i + 8 <= n; i += 8) {
+        if (!simd::AnyGreater(simd::Max(simd::Load(x + i), simd::Load(x + i + 4)), m)) {
+            continue;
+        }
+        for (int32_t j = i; j < i + 8; ++j) {
+            const float v = ToFloat(x[j]);
+            if (v > best) {
+                best = v;
+                best_id = j;
+            }
+        }
+        m = simd::Splat(best);
+    }
+#endif
+    for (; i < n; ++i) {
+        const float v = ToFloat(x[i]);
+        if (v > best) {
+            best = v;
+            best_id = i;
+        }
+    }
+    *max_val = best;
+    return best_id;
+}
+
+// Largest element of x[begin..end), at least floor
+template <typename T>
+inline float RowMax(const T* x, int32_t begin, int32_t end, float floor) {
+    int32_t i = begin;
+    float max_val = floor;
+#if defined(SENSEVOICE_SIMD4)
+    simd::F32x4 m0 = simd::Splat(floor);
+    simd::F32x4 m1 = m0;
+    for (; i + 8 <= end; i += 8) {
+        m0 = simd::Max(m0, simd::Load(x + i));
+        m1 = simd::Max(m1, simd::Load(x + i + 4));
+    }
+    max_val = simd::ReduceMax(simd::Max(m0, m1));
+#endif
+    for (; i < end; ++i) {
+        max_val = std::max(max_val, ToFloat(x[i]));
+    }
+    return max_val;
+}
+
+// Hand every element of x[begin..end) at or above cut to emit(index, value).
+// Blocks of 8 lying wholly below the cut cost one compare, so on a peaky row
+// with the cut near its maximum (RowMax) this runs at argmax speed
+template <typename T, typename Emit>
+inline void RowAtLeast(const T* x, int32_t begin, int32_t end, float cut, Emit emit) {
+    int32_t i = begin;
+#if defined(SENSEVOICE_SIMD4)
+    // AnyGreater is strict: above the next float below the cut is at or above it
+    const simd::F32x4 c = simd::Splat(std::nextafter(cut, -std::numeric_limits<float>::infinity()));
+    for (; i + 8 <= end; i += 8) {
+        if (!simd::AnyGreater(simd::Max(simd::Load(x + i), simd::Load(x + i + 4)), c)) {
+            continue;
+        }
+        for (int32_t j = i; j < i + 8; ++j) {
+            const float v = ToFloat(x[j]);
+            if (v >= cut) {
+                emit(j, v);
+            }
+        }
+    }
+#endif
+    for (; i < end; ++i) {
+        const float v = ToFloat(x[i]);
+        if (v >= cut) {
+            emit(i, v);
+        }
+    }
+}
+
+// Logits this far below the row maximum are left out of the normalizer:
+// even a full 25k vocabulary of them moves it by less than 3e-3 (nats), and
+// on real rows, where few logits sit near the cutoff, by orders less
+constexpr float kLogSumExpCutoff = 16.0f;
+
+// Running argmax and log-sum-exp of one frame
+struct ArgmaxLogSumExpState {
+    float max_val = -std::numeric_limits<float>::infinity();
+    float sum = 0.0f;       // Sum of exp(x - max_val) so far
+    int32_t argmax = 0;
+};
+
+// Fold x[begin..end) into the state; ranges fed in increasing order keep the
+// argmax on the first largest element, and a maximum found in an earlier
+// range already prunes the later ones
+// The sum is kept relative to the running maximum and rescaled when it grows.
+// CTC rows are peaky, so most 8-float blocks lie entirely below the cutoff
+// and cost one compare instead of eight exps
+template <typename T>
+inline void ArgmaxLogSumExpRange(const T* x, int32_t begin, int32_t end, ArgmaxLogSumExpState* state) {
+    int32_t i = begin;
+    int32_t best_id = state->argmax;
+    float max_val = state->max_val;
+    float sum = state->sum;
+#if defined(SENSEVOICE_SIMD4)
+    simd::F32x4 s0 = simd::Splat(0.0f);
+    simd::F32x4 s1 = s0;
+    simd::F32x4 m = simd::Splat(max_val);
+    simd::F32x4 cut = simd::Splat(max_val - kLogSumExpCutoff);
+    for (; i + 8 <= end; i += 8) {
+        const simd::F32x4 a = simd::Load(x + i);
+        const simd::F32x4 b = simd::Load(x + i + 4);
+        const simd::F32x4 block_max = simd::Max(a, b);
+        if (!simd::AnyGreater(block_max, cut)) {
+            continue;
+        }
+        if (simd::AnyGreater(block_max, m)) {
+            float block_best = max_val;
+            for (int32_t j = i; j < i + 8; ++j) {
+                const float v = ToFloat(x[j]);
+                if (v > block_best) {
+                    block_best = v;
+                    best_id = j;
+                }
+            }
+            const float scale = FastExp(max_val - block_best);
+            const simd::F32x4 rescale = simd::Splat(scale);
+            s0 = simd::Mul(s0, rescale);
+            s1 = simd::Mul(s1, rescale);
+            sum *= scale;
+            max_val = block_best;
+            m = simd::Splat(max_val);
+            cut = simd::Splat(max_val - kLogSumExpCutoff);
+        }
+        s0 = simd::Add(s0, simd::Exp(simd::Sub(a, m)));
+        s1 = simd::Add(s1, simd::Exp(simd::Sub(b, m)));
+    }
+    sum += simd::ReduceAdd(simd::Add(s0, s1));
+#endif
+    for (; i < end; ++i) {
+        const float v = ToFloat(x[i]);
+        if (v > max_val) {
+            sum *= FastExp(max_val - v);
+            max_val = v;
+            best_id = i;
+        }
+        sum += FastExp(v - max_val);
+    }
+    state->argmax = best_id;
+    state->max_val = max_val;
+    state->sum = sum;
+}
+
+// One pass over a frame: the argmax (first largest element) and the
+// log-softmax normalizer log(sum(exp(x[0..n)))); the log-posterior of the
+// argmax is then x[*argmax] - normalizer
+template <typename T>
+inline float ArgmaxLogSumExp(const T* x, int32_t n, int32_t* argmax) {
+    ArgmaxLogSumExpState state;
+    ArgmaxLogSumExpRange(x, 0, n, &state);
+    *argmax = state.argmax;
+    return state.max_val + std::log(state.sum);
+}
+
+// log(sum(exp(x[0..n)))): the log-softmax normalizer of one frame
+template <typename T>
+inline float LogSumExp(const T* x, int32_t n) {
+    int32_t argmax;
+    return ArgmaxLogSumExp(x, n, &argmax);
+}
+
+// Copy x[0..n) to out (no aliasing) and return its largest element, -inf if n <= 0
+// float -> float, fp16 -> fp16, or fp16 -> float (widened on the way)
+template <typename In, typename Out>
+inline float CopyRowMax(const In* x, int32_t n, Out* out) {
+    int32_t i = 0;
+    float best = -std::numeric_limits<float>::infinity();
+#if defined(SENSEVOICE_SIMD4)
+    simd::F32x4 m0 = simd::Splat(best);
+    simd::F32x4 m1 = m0;
+    for (; i + 8 <= n; i += 8) {
+        const simd::F32x4 a = simd::Load(x + i);
+        const simd::F32x4 b = simd::Load(x + i + 4);
+        simd::Copy4(x + i, a, out + i);
+        simd::Copy4(x + i + 4, b, out + i + 4);
+        m0 = simd::Max(m0, a);
+        m1 = simd::Max(m1, b);
+    }
+    best = simd::ReduceMax(simd::Max(m0, m1));
+#endif
+    for (; i < n; ++i) {
+        CopyElement(x[i], out + i);
+        best = std::max(best, ToFloat(x[i]));
+    }
+    return best;
+}
+
+// Copy a logit row and return the largest logit other than x[blank_id]
+// (blank_id outside [0, n): the largest logit)
+template <typename In, typename Out>
+inline float CopyRowBlankBound(const In* x, int32_t n, int32_t blank_id, Out* out) {
+    if (blank_id < 0 || blank_id >= n) {
+        return CopyRowMax(x, n, out);
+    }
+    CopyElement(x[blank_id], out + blank_id);
+    return std::max(CopyRowMax(x, blank_id, out),
+                    CopyRowMax(x + blank_id + 1, n - blank_id - 1, out + blank_id + 1));
+}
+
+// Block maxima of a logit row: the largest logit of every kMaxBlockWidth
+// logits, blank left out. The copy out of the output tensor is memory bound,
+// so they come at almost no cost there (CopyRowBlockMax); their maximum lets
+// the greedy search confirm a blank frame by one compare, and the beam search
+// and the normalizer skip the blocks that cannot matter without reading them
+constexpr int32_t kMaxBlockWidth = 64;
+
+// Block maxima of a row of n logits
+inline int32_t NumMaxBlocks(int32_t n) {
+    return (n + kMaxBlockWidth - 1) / kMaxBlockWidth;
+}
+
+// Copy a logit row and record its block maxima in block_max[NumMaxBlocks(n)]
+template <typename In, typename Out>
+inline void CopyRowBlockMax(const In* x, int32_t n, int32_t blank_id, Out* out, float* block_max) {
+    for (int32_t i = 0; i < n; i += kMaxBlockWidth) {
+        *block_max++ = CopyRowBlankBound(x + i, std::min(kMaxBlockWidth, n - i), blank_id - i, out + i);
+    }
+}
+
+// Blocks of a row of n logits that x[begin..end) covers whole, block maxima
+// [first, last), and the cut ends [begin, head_end) and [tail_begin, end)
+struct MaxBlockSpan {
+    int32_t first;
+    int32_t last;
+    int32_t head_end;
+    int32_t tail_begin;
+};
+
+inline MaxBlockSpan SplitMaxBlocks(int32_t n, int32_t begin, int32_t end) {
+    MaxBlockSpan span;
+    span.first = (begin + kMaxBlockWidth - 1) / kMaxBlockWidth;
+    span.last = end == n ? NumMaxBlocks(n) : end / kMaxBlockWidth;
+    if (span.first >= span.last) {
+        span.first = span.last = 0;
+        span.head_end = span.tail_begin = end;
+    } else {
+        span.head_end = span.first * kMaxBlockWidth;
+        span.tail_begin = std::min(span.last * kMaxBlockWidth, end);
+    }
+    return span;
+}
+
+// Whether blank_id lies in one of the whole blocks of the span
+inline bool InWholeBlock(const MaxBlockSpan& span, int32_t blank_id) {
+    return blank_id >= span.head_end && blank_id < span.tail_begin;
+}
+
+// RowMax() on a row with block maxima: only the cut ends of the range are read
+template <typename T>
+inline float BlockRowMax(const T* x, const float* block_max, int32_t n, int32_t blank_id,
+                         int32_t begin, int32_t end, float floor) {
+    const MaxBlockSpan span = SplitMaxBlocks(n, begin, end);
+    float best = RowMax(block_max, span.first, span.last, floor);
+    best = RowMax(x, begin, span.head_end, best);
+    best = RowMax(x, span.tail_begin, end, best);
+    return InWholeBlock(span, blank_id) ? std::max(best, ToFloat(x[blank_id])) : best;
+}
+
+// RowAtLeast() on a row with block maxima: whole blocks below the cut are not read
+template <typename T, typename Emit>
+inline void BlockRowAtLeast(const T* x, const float* block_max, int32_t n, int32_t blank_id,
+                            int32_t begin, int32_t end, float cut, Emit emit) {
+    const MaxBlockSpan span = SplitMaxBlocks(n, begin, end);
+    RowAtLeast(x, begin, span.head_end, cut, emit);
+    bool blank_read = !InWholeBlock(span, blank_id);
+    RowAtLeast(block_max, span.first, span.last, cut, [&](int32_t b, float) {
+        const int32_t lo = b * kMaxBlockWidth;
+        const int32_t hi = std::min(lo + kMaxBlockWidth, n);
+        blank_read = blank_read || (blank_id >= lo && blank_id < hi);
+        RowAtLeast(x, lo, hi, cut, emit);
+    });
+    RowAtLeast(x, span.tail_begin, end, cut, emit);
+    if (!blank_read && ToFloat(x[blank_id]) >= cut) {
+        emit(blank_id, ToFloat(x[blank_id]));
+    }
+}
+
+// Fold x[begin..end) of a row with block maxima into a log-sum-exp state
+// seeded with the maximum over all ranges fed (state->max_val, from
+// BlockRowMax, sum 0): whole blocks more than kLogSumExpCutoff below it are
+// not read. The argmax is not tracked
+template <typename T>
+inline void BlockLogSumExpRange(const T* x, const float* block_max, int32_t n, int32_t blank_id,
+                                int32_t begin, int32_t end, ArgmaxLogSumExpState* state) {
+    const MaxBlockSpan span = SplitMaxBlocks(n, begin, end);
+    const float cut = state->max_val - kLogSumExpCutoff;
+    ArgmaxLogSumExpRange(x, begin, span.head_end, state);
+    bool blank_read = !InWholeBlock(span, blank_id);
+    RowAtLeast(block_max, span.first, span.last, cut, [&](int32_t b, float) {
+        const int32_t lo = b * kMaxBlockWidth;
+        const int32_t hi = std::min(lo + kMaxBlockWidth, n);
+        blank_read = blank_read || (blank_id >= lo && blank_id < hi);
+        ArgmaxLogSumExpRange(x, lo, hi, state);
+    });
+    ArgmaxLogSumExpRange(x, span.tail_begin, end, state);
+    if (!blank_read && ToFloat(x[blank_id]) >= cut) {
+        state->sum += FastExp(ToFloat(x[blank_id]) - state->max_val);
+    }
+}
+
+// Token id of entry i of a top-k row (k log-probs, then their k token ids as floats)
+inline int32_t TopKId(const float* x, int32_t k, int32_t i) {
+    return static_cast<int32_t>(x[k + i]);
+}
+
+// Entry of a top-k row holding token id, -1 when the token is not among the k
+inline int32_t TopKFind(const float* x, int32_t k, int32_t id) {
+    for (int32_t i = 0; i < k; ++i) {
+        if (TopKId(x, k, i) == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Best entry of a top-k row among the tokens keep(id) accepts, -1 if none
+template <typename Keep>
+inline int32_t TopKArgmax(const float* x, int32_t k, Keep keep) {
+    int32_t best = -1;
+    for (int32_t i = 0; i < k; ++i) {
+        if (keep(TopKId(x, k, i)) && (best < 0 || x[i] > x[best])) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Upper bound on the log-prob of any token outside the k: the mass the k
+// leave over, and never above the k-th value
+inline float TopKTailBound(const float* x, int32_t k) {
+    float mass = 0.0f;
+    float lowest = 0.0f;
+    for (int32_t i = 0; i < k; ++i) {
+        mass += FastExp(x[i]);
+        lowest = i == 0 ? x[i] : std::min(lowest, x[i]);
+    }
+    return std::min(std::log(std::max(1.0f - mass, 1e-10f)), lowest);
+}
+
+// out[v] = x[v] - LogSumExp(x); out may alias x (float rows)
+template <typename T>
+inline void LogSoftmax(const T* x, int32_t n, float* out) {
+    const float norm = LogSumExp(x, n);
+    for (int32_t i = 0; i < n; ++i) {
+        out[i] = ToFloat(x[i]) - norm;
+    }
+}
+
+}  // namespace sensevoice
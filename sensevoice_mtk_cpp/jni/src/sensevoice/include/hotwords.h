@@ -0,0 +1,80 @@
+/* Hotword Biasing for SenseVoice
+ *
+ * Compiles a hotword list (token id sequences) into an Aho-Corasick token
+ * trie that the prefix beam search walks to boost matching hypotheses.
+ * A built graph is immutable, so one instance can be shared by concurrent
+ * decodes and replaced per request.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sensevoice {
+
+class Tokenizer;
+
+// One hotword phrase
+struct Hotword {
+    std::string phrase;              // For logging only
+    std::vector<int64_t> token_ids;  // SentencePiece ids of the phrase
+    float boost = 0.0f;              // Log-score bonus per matched token (0 = default)
+};
+
+class HotwordGraph {
+public:
+    static constexpr uint32_t kRoot = 0;
+    static constexpr float kDefaultBoost = 1.5f;
+
+    HotwordGraph() = default;
+
+    // Build the trie; phrases without tokens are skipped
+    bool Build(const std::vector<Hotword>& hotwords, float default_boost = kDefaultBoost);
+
+    // Load a hotword file, one phrase per line:
+    //   <phrase>[\t<boost>[\t<id> <id> ...]]
+    // Ids are written by SenseVoice_workspace/model_prepare/hotwords2ids.py from
+    // the BPE model; lines without ids are split with the vocabulary (Tokenizer::Encode)
+    bool Load(const std::string& path, const Tokenizer& tokenizer,
+              float default_boost = kDefaultBoost);
+
+    // Follow token from state; *next is the new state
+    // Returns the score change: the bonus of a longer match, or minus the
+    // bonus given so far when a partial match breaks. Every phrase that ends
+    // with token (the matched one and its suffixes in the list) adds its full
+    // bonus, which is kept. Matching continues from the matched node, so a
+    // longer phrase through a completed one still matches.
+    float Advance(uint32_t state, int64_t token, uint32_t* next) const;
+
+    // Bonus of an unfinished match, taken back when decoding ends on it
+    float PendingScore(uint32_t state) const { return nodes_[state].pending; }
+
+    bool Empty() const { return num_phrases_ == 0; }
+    size_t NumPhrases() const { return num_phrases_; }
+    size_t NumNodes() const { return nodes_.size(); }
+
+    // Bytes held by the trie arrays
+    size_t MemoryFootprint() const;
+
+private:
+    // 20 bytes; children of a node are consecutive nodes (BFS order),
+    // sorted by token so a lookup is a binary search over tokens_
+    struct Node {
+        uint32_t first_child;
+        uint32_t fail;         // Longest proper suffix that is also a trie prefix
+        float pending;         // Bonus since the last phrase end on the path from the root
+        float output;          // Bonus of the phrases ending here: this node's and along the output links
+        uint32_t num_children;
+    };
+
+    // Child of node with token, 0 (root) if none
+    uint32_t FindChild(uint32_t node, int64_t token) const;
+
+    std::vector<Node> nodes_;
+    std::vector<int32_t> tokens_;  // Token on the edge into each node
+    size_t num_phrases_ = 0;
+};
+
+}  // namespace sensevoice
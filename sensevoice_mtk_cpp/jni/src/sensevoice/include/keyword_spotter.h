@@ -0,0 +1,98 @@
+/* Keyword Spotting for SenseVoice
+ *
+ * Scans the CTC posteriors of a model run for a fixed list of phrases
+ * without decoding the utterance. The phrases share one token trie and a
+ * single Viterbi pass over the frames updates the best alignment of every
+ * trie prefix at once, so a few hundred keywords cost one gather per node
+ * and frame on top of the frame's log-softmax normalizer.
+ * A built spotter is immutable and can be shared by concurrent scans.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sensevoice {
+
+class Tokenizer;
+
+// One keyword phrase
+struct Keyword {
+    std::string phrase;
+    std::vector<int64_t> token_ids;  // SentencePiece ids of the phrase
+    float threshold = 0.0f;          // Hit when the alignment log posterior per token >= ln(threshold) (0 = default)
+};
+
+// One detected keyword occurrence
+struct KeywordHit {
+    int32_t keyword = -1;       // Index in the keyword list
+    std::string phrase;
+    float confidence = 0.0f;    // Geometric mean over the keyword tokens of each token's best-frame posterior, >= threshold
+    int32_t start_frame = 0;    // First frame of the first token (output frames, prompt rows excluded)
+    int32_t end_frame = 0;      // Frame of the last token
+    float start_time = 0.0f;    // Seconds, filled by SenseVoice::Spot
+    float end_time = 0.0f;
+};
+
+class KeywordSpotter {
+public:
+    static constexpr float kDefaultThreshold = 0.5f;
+    static constexpr int32_t kMaxTokenGap = 25;  // Blank frames allowed between two keyword tokens (1.5 s)
+
+    KeywordSpotter() = default;
+
+    // Build the trie; phrases without tokens are skipped
+    bool Build(const std::vector<Keyword>& keywords, float default_threshold = kDefaultThreshold);
+
+    // Load a keyword file, one phrase per line (same layout as the hotword list):
+    //   <phrase>[\t<threshold>[\t<id> <id> ...]]
+    // Ids come from SenseVoice_workspace/model_prepare/hotwords2ids.py; lines
+    // without ids are split with the vocabulary (Tokenizer::Encode)
+    bool Load(const std::string& path, const Tokenizer& tokenizer,
+              float default_threshold = kDefaultThreshold);
+
+    // Scan logits [num_frames, vocab_size] (no prompt rows) for the keywords
+    // Output: hits ordered by start frame; overlapping alignments of one
+    // keyword are merged into the most confident one
+    std::vector<KeywordHit> Spot(const float* logits,
+                                 int32_t num_frames,
+                                 int32_t vocab_size,
+                                 int64_t blank_id) const;
+
+    // Spot() on top-k rows [num_frames, 2k] (k log-probs, then their k token
+    // ids as floats). A keyword token can only align to frames that hold it
+    // among the k; a blank outside them scores the mass the k leave over
+    std::vector<KeywordHit> SpotTopK(const float* rows,
+                                     int32_t num_frames,
+                                     int32_t k,
+                                     int64_t blank_id) const;
+
+    bool Empty() const { return keywords_.empty(); }
+    size_t NumKeywords() const { return keywords_.size(); }
+    size_t NumNodes() const { return token_.size(); }
+
+private:
+    // The Viterbi pass; frame_scores(t, log_probs) fills the log-prob of
+    // every node's token at frame t and returns the blank log-prob
+    template <typename FrameScores>
+    std::vector<KeywordHit> Scan(int32_t num_frames, FrameScores frame_scores) const;
+
+    struct Entry {
+        std::string phrase;
+        int32_t end_node;
+        int32_t length;        // Tokens
+        float min_score;       // length * ln(threshold), against the alignment score
+    };
+
+    // Trie in BFS order, one array per field so the frame update is a
+    // straight loop over the nodes; node 0 is the root
+    std::vector<int32_t> parent_;
+    std::vector<int32_t> token_;
+    std::vector<float> enter_;       // 0 if the node can follow its parent's token state directly, -inf on a repeat
+    std::vector<float> start_;       // 0 for the first token of a phrase, -inf otherwise
+    std::vector<Entry> keywords_;
+};
+
+}  // namespace sensevoice
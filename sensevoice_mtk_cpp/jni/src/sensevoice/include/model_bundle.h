@@ -0,0 +1,107 @@
+/* Model Bundle for SenseVoice
+ *
+ * Single-file container holding the compiled DLA, the binary vocabulary and
+ * the model metadata. The file is mapped once; each section is used in place.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sensevoice_config.h"
+
+namespace sensevoice {
+
+// Bundle file (.svb), little-endian:
+//   BundleFileHeader | BundleSection[num_sections] | sections (4 KB aligned)
+// Written by SenseVoice_workspace/model_prepare/make_bundle.py
+struct BundleFileHeader {
+    char magic[4];          // "SVBN"
+    uint32_t version;       // kBundleFileVersion
+    uint32_t num_sections;
+    uint32_t reserved;
+    uint64_t file_bytes;
+    uint64_t reserved2;
+};
+static_assert(sizeof(BundleFileHeader) == 32, "BundleFileHeader layout is fixed");
+
+struct BundleSection {
+    uint32_t type;          // BundleSectionType
+    uint32_t reserved;
+    uint64_t offset;        // From file start
+    uint64_t size;
+};
+static_assert(sizeof(BundleSection) == 24, "BundleSection layout is fixed");
+
+enum BundleSectionType : uint32_t {
+    kSectionDla = 1,        // Compiled network
+    kSectionVocab = 2,      // tokens.bin (VocabFileHeader ...)
+    kSectionMetadata = 3,   // "key=value" lines
+    kSectionCmvn = 4,       // float32 [2, input_feat_dim]: neg_mean, inv_stddev (float16 / int8 inputs)
+};
+
+constexpr uint32_t kBundleFileVersion = 1;
+
+// Model description from the metadata section; 0 / empty = not set
+struct BundleMetadata {
+    std::string name;
+    int32_t input_frames = 0;
+    int32_t vocab_size = 0;
+    int32_t input_feat_dim = 0;
+    int32_t lfr_window_size = 0;
+    int32_t lfr_window_shift = 0;
+    int32_t sample_rate = 0;
+    int32_t num_mel_bins = 0;
+    int32_t batch_size = 0;
+    bool packed = false;
+    std::vector<std::vector<uint32_t>> input_shapes;   // Batch-1 shapes
+    std::vector<std::vector<uint32_t>> output_shapes;
+    std::string input_type = "float32";
+    std::string output_type = "float32";
+    float input_scale = 0.0f;   // int8 inputs: feature step
+};
+
+class ModelBundle {
+public:
+    ModelBundle() = default;
+    ~ModelBundle();
+
+    ModelBundle(const ModelBundle&) = delete;
+    ModelBundle& operator=(const ModelBundle&) = delete;
+
+    // Check the magic without mapping the file
+    static bool IsBundle(const std::string& path);
+
+    // Map the bundle and parse the section table and metadata
+    bool Open(const std::string& path);
+
+    // Section contents inside the mapping, nullptr / 0 if absent
+    const void* SectionData(BundleSectionType type) const;
+    size_t SectionSize(BundleSectionType type) const;
+
+    // Drop the resident pages of a section once it has been consumed
+    // (e.g. the DLA after compilation); the mapping stays valid
+    void Evict(BundleSectionType type);
+
+    const BundleMetadata& Metadata() const { return metadata_; }
+
+    // Overwrite the model constants that the metadata sets
+    void ApplyTo(ModelConfig* model, AudioConfig* audio) const;
+
+    const std::string& Path() const { return path_; }
+
+private:
+    const BundleSection* FindSection(BundleSectionType type) const;
+
+    bool ParseMetadata(const char* data, size_t size);
+
+    std::string path_;
+    void* mapped_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    std::vector<BundleSection> sections_;
+    BundleMetadata metadata_;
+};
+
+}  // namespace sensevoice
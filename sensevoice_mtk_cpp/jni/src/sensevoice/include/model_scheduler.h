@@ -0,0 +1,140 @@
+/* Model Scheduler for SenseVoice
+ *
+ * The model runs one window per execution at a time. Instead of holding it
+ * for a whole request, every request asks for an execution run by run, so a
+ * short interactive query waits for at most one run of a long batch
+ * transcription. A request may wait for several runs at once (the windows
+ * of long audio are dispatched concurrently).
+ * Waiting requests are kept in two lanes:
+ *   - interactive: always first, earliest deadline first
+ *   - batch: earliest deadline (then arrival) first, admitted only when no
+ *     interactive request waits and the run is expected to end before every
+ *     interactive request in progress needs the model to meet its deadline
+ * Run times are estimated per lane from the previous runs.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "sensevoice_config.h"
+
+namespace sensevoice {
+
+// Accounting of one lane
+struct LaneStats {
+    int64_t requests = 0;
+    int64_t runs = 0;
+    int64_t queue_wait_us = 0;      // Total time spent waiting for the model
+    int64_t max_queue_wait_us = 0;  // Longest single wait
+    int64_t deadline_misses = 0;    // Requests finished after the deadline they set
+};
+
+struct SchedulerStats {
+    LaneStats interactive;
+    LaneStats batch;
+    int64_t batch_deferrals = 0;    // Batch runs held back for interactive slack
+};
+
+class ModelScheduler;
+
+// A request admitted by ModelScheduler::Begin(), ended on destruction
+class ScheduledRequest {
+public:
+    ~ScheduledRequest();
+
+    ScheduledRequest(const ScheduledRequest&) = delete;
+    ScheduledRequest& operator=(const ScheduledRequest&) = delete;
+
+    Priority GetPriority() const { return priority_; }
+
+    // Time spent waiting for the model so far
+    int64_t QueueWaitUs() const { return queue_wait_us_; }
+
+    // Model runs made so far
+    int32_t NumRuns() const { return runs_; }
+
+private:
+    friend class ModelScheduler;
+    using Clock = std::chrono::steady_clock;
+
+    ScheduledRequest(ModelScheduler* scheduler, Priority priority,
+                     Clock::time_point deadline, bool has_deadline);
+
+    ModelScheduler* scheduler_;
+    Priority priority_;
+    Clock::time_point deadline_;  // Interactive requests without one get the configured default
+    bool has_deadline_;           // Set by the caller; misses are only counted for these
+    int64_t queue_wait_us_ = 0;
+    int32_t runs_ = 0;
+};
+
+class ModelScheduler {
+public:
+    // num_executions: runs the model can have in flight (SenseVoiceModel::MaxRunsInFlight)
+    explicit ModelScheduler(const SchedulingConfig& config, int32_t num_executions = 1);
+
+    // Admit a request; interactive requests count against batch admission
+    // from now until the handle is destroyed
+    std::unique_ptr<ScheduledRequest> Begin(const RequestOptions& options);
+
+    // One execution of the model for one run: the constructor blocks until
+    // the request is picked, the destructor hands the execution on
+    class Grant {
+    public:
+        Grant(ModelScheduler* scheduler, ScheduledRequest* request);
+        ~Grant();
+
+        Grant(const Grant&) = delete;
+        Grant& operator=(const Grant&) = delete;
+
+    private:
+        ModelScheduler* scheduler_;
+        ScheduledRequest* request_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    SchedulerStats GetStats() const;
+
+private:
+    friend class ScheduledRequest;
+    using Clock = std::chrono::steady_clock;
+
+    // One pending Acquire
+    struct Waiter {
+        ScheduledRequest* request;
+        uint64_t sequence;  // Arrival order
+    };
+
+    void Acquire(ScheduledRequest* request);
+    void Release(ScheduledRequest* request, int64_t run_us);
+    void End(ScheduledRequest* request);
+
+    // Whether the waiter is the one to run now (mutex_ held)
+    bool IsNext(const Waiter* waiter, Clock::time_point now, bool* slack_blocked) const;
+
+    // Whether a batch run started now ends in time for every interactive request
+    bool BatchFits(Clock::time_point now) const;
+
+    LaneStats& Lane(Priority priority) {
+        return priority == Priority::Interactive ? stats_.interactive : stats_.batch;
+    }
+
+    SchedulingConfig config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    const int32_t num_executions_;
+    int32_t running_ = 0;                     // Runs holding an execution
+    uint64_t next_sequence_ = 0;
+    std::vector<ScheduledRequest*> active_;   // Begun and not yet ended
+    std::vector<Waiter*> waiting_;
+    double estimated_run_us_[2] = {0.0, 0.0}; // Per lane, moving average of run times
+    SchedulerStats stats_;
+};
+
+}  // namespace sensevoice
@@ -0,0 +1,117 @@
+/* N-gram Language Model for SenseVoice
+ *
+ * Token-level back-off n-gram model in a quantized trie (.svlm), converted
+ * offline from ARPA. The file is mapped read-only and used in place, so
+ * only the pages touched by the search become resident.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sensevoice {
+
+constexpr uint32_t kLmMaxOrder = 6;
+constexpr uint32_t kLmFileVersion = 1;
+
+// .svlm file, little-endian:
+//   LmFileHeader | codebooks (order x {prob[256], backoff[256]} float, ln) | levels (8-byte aligned)
+// Written by SenseVoice_workspace/model_prepare/arpa2lm.py
+struct LmFileHeader {
+    char magic[4];                         // "SVLM"
+    uint32_t version;                      // kLmFileVersion
+    uint32_t order;
+    uint32_t num_words;                    // Level 1 size (token ids + <s>/</s> if outside the vocab)
+    int32_t bos_id;
+    int32_t eos_id;
+    uint32_t reserved[2];
+    uint64_t level_offset[kLmMaxOrder];    // From file start
+    uint32_t level_count[kLmMaxOrder];     // Entries, without the sentinel
+    uint32_t reserved2[kLmMaxOrder];
+};
+static_assert(sizeof(LmFileHeader) == 128, "LmFileHeader layout is fixed");
+
+// Levels 1 .. order-1; level 1 is indexed by token id. Each level ends with
+// a sentinel so the children of entry i are [first_child(i), first_child(i + 1))
+struct LmEntry {
+    uint16_t word;
+    uint8_t prob;            // Codebook index, kLmAbsent = context only
+    uint8_t backoff;
+    uint32_t first_child;
+};
+static_assert(sizeof(LmEntry) == 8, "LmEntry is part of the LM file format");
+
+// Highest level
+struct LmLeaf {
+    uint16_t word;
+    uint8_t prob;
+    uint8_t reserved;
+};
+static_assert(sizeof(LmLeaf) == 4, "LmLeaf is part of the LM file format");
+
+constexpr uint8_t kLmAbsent = 255;
+
+class NgramLm {
+public:
+    // Context: the last order-1 tokens, oldest first
+    struct State {
+        int32_t words[kLmMaxOrder - 1];
+        int32_t length = 0;
+    };
+
+    NgramLm() = default;
+    ~NgramLm();
+
+    NgramLm(const NgramLm&) = delete;
+    NgramLm& operator=(const NgramLm&) = delete;
+
+    // Map the model; only the header and codebooks are read here
+    bool Load(const std::string& path);
+
+    // Context at the start of an utterance (<s>)
+    State BeginState() const;
+
+    // ln p(token | state) with back-off; *next is the extended context
+    // Tokens outside the model (prompt tokens) score 0 and leave the state unchanged
+    float Score(const State& state, int64_t token, State* next) const;
+
+    // ln p(</s> | state)
+    float FinalScore(const State& state) const;
+
+    // True if the model has a unigram for token
+    bool Contains(int64_t token) const {
+        return token >= 0 && static_cast<uint64_t>(token) < num_words_ &&
+               ProbIndex(1, token) != kLmAbsent;
+    }
+
+    uint32_t Order() const { return order_; }
+    size_t MappedBytes() const { return mapped_bytes_; }
+
+private:
+    // Entry index of the n-gram words[0..n) at level n, -1 if absent
+    int64_t Find(const int32_t* words, uint32_t n) const;
+
+    // Child of entry parent (level n) with word, at level n + 1; -1 if absent
+    int64_t FindChild(uint32_t n, int64_t parent, int32_t word) const;
+
+    // Quantized probability / back-off of an entry at level n (1-based)
+    uint8_t ProbIndex(uint32_t n, int64_t index) const;
+    float Prob(uint32_t n, uint8_t q) const { return prob_codebook_[n - 1][q]; }
+    float Backoff(uint32_t n, int64_t index) const;
+
+    void* mapped_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    uint32_t order_ = 0;
+    uint32_t num_words_ = 0;
+    int32_t bos_id_ = -1;
+    int32_t eos_id_ = -1;
+    const LmEntry* entries_[kLmMaxOrder] = {};  // Levels 1 .. order-1
+    const LmLeaf* leaves_ = nullptr;            // Level order
+    uint32_t level_count_[kLmMaxOrder] = {};
+    float prob_codebook_[kLmMaxOrder][256] = {};
+    float backoff_codebook_[kLmMaxOrder][256] = {};
+};
+
+}  // namespace sensevoice
@@ -0,0 +1,126 @@
+/* Recognition Server for SenseVoice
+ *
+ * Keeps one initialized SenseVoice resident and serves recognition requests
+ * from local clients over a Unix domain socket (framing in server_protocol.h).
+ * Requests wait in a bounded queue for one of max_in_flight execution slots;
+ * Drain() stops accepting work and returns once everything queued is answered.
+ * Clients that attach a shared-memory ring submit PCM without a socket copy;
+ * the pipeline reads their samples in place.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sensevoice.h"
+#include "server_protocol.h"
+
+namespace sensevoice {
+
+struct ServerConfig {
+    std::string socket_path;     // Filesystem path of the listening socket (replaced if stale)
+    int32_t max_in_flight = 1;   // Requests handed to the pipeline at once (see SenseVoice::Submit)
+    int32_t max_queued = 32;     // Waiting requests beyond this are answered Busy
+};
+
+// Request accounting since Start()
+struct ServerStats {
+    int64_t connections = 0;
+    int64_t shm_attached = 0;    // Connections using a shared-memory ring
+    int64_t requests = 0;
+    int64_t completed = 0;
+    int64_t busy = 0;            // Rejected with a full queue
+    int64_t draining = 0;        // Rejected during Drain()
+    int64_t bad_requests = 0;
+};
+
+class RecognitionServer {
+public:
+    // The recognizer must be initialized and outlive the server
+    explicit RecognitionServer(SenseVoice* recognizer);
+
+    // Drains if still running
+    ~RecognitionServer();
+
+    RecognitionServer(const RecognitionServer&) = delete;
+    RecognitionServer& operator=(const RecognitionServer&) = delete;
+
+    // Bind the socket and start the acceptor and execution threads
+    bool Start(const ServerConfig& config);
+
+    // Graceful shutdown: stop accepting connections, answer new requests
+    // Draining, finish queued and running requests, then close every connection
+    void Drain();
+
+    bool IsRunning() const { return running_; }
+
+    ServerStats GetStats() const;
+
+private:
+    struct Connection;
+
+    struct Job {
+        std::shared_ptr<Connection> connection;
+        ServerRequestHeader header;
+        std::vector<int16_t> samples;  // Socket requests
+        int32_t slot = -1;             // Shared-memory requests: ring slot holding the samples
+        std::chrono::steady_clock::time_point enqueue_time;
+    };
+
+    void AcceptLoop();
+    void ReadLoop(std::shared_ptr<Connection> connection);
+    void WorkerLoop();
+
+    // Queue a job unless the queue is full or draining (the job is left untouched then)
+    ServerStatus Enqueue(Job* job);
+
+    // Map a client's ring from an attach message and its descriptors
+    bool AttachSharedMemory(Connection* connection, const ServerShmAttach& attach,
+                            const int* fds, int num_fds);
+
+    // Take submitted ring slots until the client closes the socket
+    void SharedMemoryLoop(const std::shared_ptr<Connection>& connection);
+
+    // Join the reader threads of connections whose peer has gone
+    void ReapConnections();
+
+    // Send one response, on the socket or (slot >= 0) by completing the ring slot;
+    // the text is left out unless status is Ok
+    static bool Reply(Connection* connection,
+                      ServerStatus status,
+                      uint32_t request_id,
+                      const RecognitionResult* result = nullptr,
+                      uint32_t queue_us = 0,
+                      uint32_t run_us = 0,
+                      int32_t slot = -1);
+
+    SenseVoice* recognizer_;
+    ServerConfig config_;
+    int listen_fd_ = -1;
+    bool running_ = false;
+
+    std::thread acceptor_;
+    std::vector<std::thread> workers_;
+
+    std::mutex connections_mutex_;
+    std::vector<std::shared_ptr<Connection>> connections_;
+
+    // Request queue, shared by the readers and the workers
+    mutable std::mutex mutex_;
+    std::condition_variable queue_cv_;  // Job queued or stopping
+    std::condition_variable idle_cv_;   // Queue empty and nothing in flight
+    std::deque<Job> queue_;
+    int32_t in_flight_ = 0;
+    bool draining_ = false;
+    bool stop_ = false;
+    ServerStats stats_;
+};
+
+}  // namespace sensevoice
@@ -6,16 +6,41 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <memory>
+#include "batch_queue.h"
 #include "sensevoice_config.h"
 #include "audio_frontend.h"
 #include "tokenizer.h"
 #include "sensevoice_model.h"
+#include "model_bundle.h"
+#include "model_scheduler.h"
+#include "hotwords.h"
+#include "keyword_spotter.h"
+#include "thread_pool.h"
+#include "vad.h"
 
 namespace sensevoice {
 
+// NPU usage accounting for the VAD front stage
+struct VadStats {
+    int64_t requests = 0;
+    int64_t silent_requests = 0;       // Short-circuited without running the model
+    int64_t npu_runs = 0;              // Model invocations actually made
+    int64_t npu_runs_without_vad = 0;  // Fixed-size windows over the untrimmed audio
+};
+
+// Utterances per NPU call for batch recognition
+struct PackingStats {
+    int64_t segments = 0;  // Speech segments decoded
+    int64_t npu_runs = 0;  // Model invocations (one packed window each)
+};
+
 class SenseVoice {
 public:
     SenseVoice();
@@ -34,15 +59,95 @@ public:
     // Recognize speech from audio samples
     // Input: audio samples (float, normalized to [-1, 1]), 16kHz mono
     // Output: recognition result with text, tokens, and timestamps
+    // Concurrent calls share the model run by run in the order set by their
+    // options (see ModelScheduler)
     RecognitionResult Recognize(const std::vector<float>& samples,
                                 Language language = Language::Auto,
-                                TextNorm text_norm = TextNorm::WithoutITN);
+                                TextNorm text_norm = TextNorm::WithoutITN,
+                                const RequestOptions& options = RequestOptions());
+
+    // Recognize speech from 16-bit PCM samples, 16kHz mono
+    // Input: non-owning view of int16 samples (e.g. straight from the audio HAL);
+    //        the int16 -> float scaling happens inside the fbank stage
+    RecognitionResult Recognize(const int16_t* samples,
+                                size_t num_samples,
+                                Language language = Language::Auto,
+                                TextNorm text_norm = TextNorm::WithoutITN,
+                                const RequestOptions& options = RequestOptions());
+
+    // Recognize several utterances (float samples, 16kHz mono) in as few NPU calls
+    // as possible. With the packed model (sensevoice_packed*.dla) the speech
+    // segments of all utterances are packed into shared windows, with a batch-N
+    // model they fill the batch slots; otherwise every segment takes its own run.
+    // Output: one result per input utterance, in input order
+    std::vector<RecognitionResult> RecognizeBatch(const std::vector<std::vector<float>>& utterances,
+                                                  Language language = Language::Auto,
+                                                  TextNorm text_norm = TextNorm::WithoutITN,
+                                                  const RequestOptions& options = RequestOptions());
+
+    // Classification only: language, emotion and event as Recognize() reports
+    // them (from the first speech segment), without the text. Only the prompt
+    // rows of the model output are read back and nothing else is decoded
+    RecognitionResult Classify(const std::vector<float>& samples,
+                               Language language = Language::Auto,
+                               const RequestOptions& options = RequestOptions());
+
+    // Classification only on 16-bit PCM samples, 16kHz mono
+    RecognitionResult Classify(const int16_t* samples,
+                               size_t num_samples,
+                               Language language = Language::Auto,
+                               const RequestOptions& options = RequestOptions());
+
+    // Queue an utterance for batched recognition (config.batching)
+    // The request runs together with others once a batch is full or its
+    // deadline expires; without batching it is recognized immediately.
+    std::future<RecognitionResult> Submit(std::vector<float> samples,
+                                          Language language = Language::Auto,
+                                          TextNorm text_norm = TextNorm::WithoutITN);
+
+    // Queue 16-bit PCM samples, 16kHz mono, for batched recognition
+    // Input: non-owning view that must stay valid until the future is ready;
+    //        the int16 -> float scaling happens inside the fbank stage
+    std::future<RecognitionResult> Submit(const int16_t* samples,
+                                          size_t num_samples,
+                                          Language language = Language::Auto,
+                                          TextNorm text_norm = TextNorm::WithoutITN);
 
     // Recognize speech from audio file (WAV or PCM)
     RecognitionResult RecognizeFile(const std::string& audio_path,
                                     Language language = Language::Auto,
                                     TextNorm text_norm = TextNorm::WithoutITN);
 
+    // Hotword list for the following requests (nullptr or empty disables biasing)
+    // Can be swapped while other threads recognize; a running request keeps
+    // the list it started with
+    void SetHotwords(std::shared_ptr<const HotwordGraph> hotwords);
+
+    // Build a hotword list from a file (HotwordGraph::Load format) and use it
+    bool LoadHotwords(const std::string& path, float default_boost = HotwordGraph::kDefaultBoost);
+
+    std::shared_ptr<const HotwordGraph> GetHotwords() const;
+
+    // Keyword spotting: run the model over the speech segments and scan the
+    // CTC posteriors for the keyword list, without decoding any text
+    // Output: hits ordered by time (empty without a keyword list)
+    std::vector<KeywordHit> Spot(const std::vector<float>& samples,
+                                 Language language = Language::Auto);
+
+    // Keyword spotting on 16-bit PCM samples, 16kHz mono
+    std::vector<KeywordHit> Spot(const int16_t* samples,
+                                 size_t num_samples,
+                                 Language language = Language::Auto);
+
+    // Keyword list for Spot(); can be swapped while other threads spot
+    void SetKeywords(std::shared_ptr<const KeywordSpotter> keywords);
+
+    // Build a keyword list from a file (KeywordSpotter::Load format) and use it
+    bool LoadKeywords(const std::string& path,
+                      float default_threshold = KeywordSpotter::kDefaultThreshold);
+
+    std::shared_ptr<const KeywordSpotter> GetKeywords() const;
+
     // Get configuration
     const SenseVoiceConfig& GetConfig() const { return config_; }
 
@@ -55,12 +160,124 @@ public:
     // Get model (for advanced usage)
     SenseVoiceModel* GetModel() { return model_.get(); }
 
+    // Get VAD (nullptr when disabled)
+    Vad* GetVad() { return vad_.get(); }
+
+    // NPU invocations made vs. saved by the VAD since initialization
+    VadStats GetVadStats() const {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        return vad_stats_;
+    }
+
+    // Segments per NPU call of RecognizeBatch since initialization
+    PackingStats GetPackingStats() const {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        return packing_stats_;
+    }
+
+    // Queue wait per scheduling lane since initialization
+    SchedulerStats GetSchedulerStats() const {
+        return scheduler_ ? scheduler_->GetStats() : SchedulerStats();
+    }
+
+    // Request queue flush statistics (empty when batching is disabled)
+    BatchQueueStats GetBatchQueueStats() const {
+        return batch_queue_ ? batch_queue_->GetStats() : BatchQueueStats();
+    }
+
 private:
+    // Shared tail of both Recognize overloads: fbank -> VAD -> model -> decode
+    RecognitionResult RecognizeFbank(const std::vector<float>& fbank,
+                                     size_t num_samples,
+                                     Language language,
+                                     TextNorm text_norm,
+                                     ScheduledRequest* request,
+                                     std::chrono::high_resolution_clock::time_point start_time);
+
+    // Shared body of RecognizeBatch and the batch queue: fbank_of(u) computes
+    // the features of utterance u when its turn comes
+    std::vector<RecognitionResult> RecognizeBatchFbank(size_t num_utterances,
+                                                       size_t total_samples,
+                                                       const std::function<std::vector<float>(size_t)>& fbank_of,
+                                                       Language language,
+                                                       TextNorm text_norm,
+                                                       const RequestOptions& options);
+
+    // Shared tail of both Spot overloads: fbank -> VAD -> model -> keyword scan
+    std::vector<KeywordHit> SpotFbank(const std::vector<float>& fbank,
+                                      const KeywordSpotter& keywords,
+                                      Language language,
+                                      std::chrono::high_resolution_clock::time_point start_time);
+
+    // Shared tail of both Classify overloads: fbank -> VAD -> prompt rows of the first segment
+    RecognitionResult ClassifyFbank(const std::vector<float>& fbank,
+                                    Language language,
+                                    ScheduledRequest* request,
+                                    std::chrono::high_resolution_clock::time_point start_time);
+
+    // Run one model window over the LFR features of a segment and decode it
+    // ran (optional) is set when the model run succeeded, for the NPU run stats
+    RecognitionResult RunSegment(const std::vector<float>& features,
+                                 Language language,
+                                 TextNorm text_norm,
+                                 const HotwordGraph* hotwords,
+                                 ScheduledRequest* request,
+                                 bool* ran = nullptr);
+
+    // Whether a request with this hotword list takes block maxima on readback:
+    // always for beam search, for greedy with blank_frame_skip
+    bool UseBlockMax(const HotwordGraph* hotwords) const;
+
+    // Features of one request; the frontend keeps per-call state
+    std::vector<float> ComputeFbank(const std::vector<float>& samples);
+    std::vector<float> ComputeFbank(const int16_t* samples, size_t num_samples);
+
+    // Tokens the decoder may emit for a requested language (nullptr = all)
+    const std::vector<TokenRange>* AllowedTokens(Language language) const;
+
+    // Segments of a request's fbank: the VAD segments, or without VAD
+    // consecutive model windows over the whole input (LFR frames run on
+    // across the windows, so none is dropped or repeated)
+    std::vector<SpeechSegment> FindSegments(const std::vector<float>& fbank) const;
+
+    // LFR features of a range of fbank frames, CMVN-normalized for
+    // float16 / int8 input DLAs
+    std::vector<float> SegmentFeatures(const std::vector<float>& fbank,
+                                       const SpeechSegment& segment) const;
+
+    // CMVN stats for host normalization: bundle section, else cmvn_path / am.mvn
+    bool LoadCmvnStats();
+
+    // Append a segment result, shifting its timestamps by the segment offset
+    static void AppendResult(RecognitionResult* dst,
+                             const RecognitionResult& src,
+                             float time_offset_s);
+
     SenseVoiceConfig config_;
+    std::unique_ptr<ModelBundle> bundle_;  // Outlives the tokenizer and model that use its sections
     std::unique_ptr<AudioFrontend> audio_frontend_;
+    CmvnStats cmvn_;  // Host CMVN for float16 / int8 input DLAs, empty otherwise
     std::unique_ptr<Tokenizer> tokenizer_;
     std::unique_ptr<SenseVoiceModel> model_;
+    std::unique_ptr<Vad> vad_;
+    std::unique_ptr<ModelScheduler> scheduler_;  // Hands out the model between concurrent requests
+    std::unique_ptr<ThreadPool> segment_pool_;   // Windows of long audio, with several executions
+    std::mutex frontend_mutex_;
+    VadStats vad_stats_;
+    PackingStats packing_stats_;
+    mutable std::mutex stats_mutex_;
     bool initialized_ = false;
+
+    // Current hotword list; a request decodes with the one it started with
+    std::shared_ptr<const HotwordGraph> hotwords_;
+    mutable std::mutex hotwords_mutex_;
+
+    // Current keyword list
+    std::shared_ptr<const KeywordSpotter> keywords_;
+    mutable std::mutex keywords_mutex_;
+
+    // Declared last so the worker stops before the pipeline is torn down
+    std::unique_ptr<BatchQueue> batch_queue_;
 };
 
 }  // namespace sensevoice
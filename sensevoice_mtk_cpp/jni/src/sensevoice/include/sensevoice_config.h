@@ -5,18 +5,41 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <cstdint>
 
 namespace sensevoice {
 
+// Executor used to run the model
+enum class ModelBackend {
+    NeuronUsdk = 0,  // Neuron adapter on the NPU (default)
+    NeuronRuntime,   // NeuronRuntime API, needed for dynamic input shapes
+    Host             // CPU stand-in with the same shapes, no NPU required (tests)
+};
+
 // Model configuration
 struct ModelConfig {
     std::string model_path;           // Path to DLA file
     std::string tokens_path;          // Path to tokens.txt file
+    std::string cmvn_path;            // am.mvn for float16 / int8 input DLAs, which leave CMVN to the host
+                                      // (empty: am.mvn next to tokens_path; bundles carry it)
+
+    // Execution
+    ModelBackend backend = ModelBackend::NeuronUsdk;
+    int32_t batch_size = 1;           // Batch dimension the DLA was compiled with
+    int32_t num_executions = 1;       // Executions of the network, runs overlap across them (one per MDLA core)
+    int32_t io_sets = 1;              // I/O buffer sets per execution; 2 = ping-pong, the next run's
+                                      // inputs are written and the last run's outputs read during a compute
+    bool dynamic_shape = false;       // Run the real frame count (DLA with a dynamic frame dim)
+    bool packed = false;              // Packed-batch model (also detected from "sensevoice_packed" in the path)
+    int32_t host_latency_us = 0;      // Host backend: simulated latency per run
+    int32_t host_latency_per_item_us = 0;  // Host backend: extra latency per batch item
+    float input_scale = 8.0f / 127.0f;  // int8 input DLAs: feature step (main.py --int8_clip / 127)
 
     // Model parameters (fixed for SenseVoice Small)
     int32_t vocab_size = 25055;
+    int32_t input_frames = 166;       // LFR frames per model window (~10s)
     int32_t input_feat_dim = 560;     // 80 * 7 (after LFR)
     int32_t encoder_output_dim = 512;
 
@@ -57,7 +80,19 @@ enum class TextNorm {
 struct InferenceConfig {
     Language language = Language::Auto;
     TextNorm text_norm = TextNorm::WithITN;  // Default: with punctuation
-    bool use_greedy_search = true;  // Currently only greedy search is supported
+    bool use_greedy_search = true;  // false: CTC prefix beam search
+    bool blank_frame_skip = false;  // Greedy: settle blank frames against block maxima taken on logits readback (beam search always takes them)
+    bool language_vocab = true;     // With an explicit language, decode only its tokens (Tokenizer::LanguageTokens)
+    int32_t beam_size = 8;          // Beam search: hypotheses kept per frame
+    int32_t beam_top_k = 8;         // Beam search: tokens expanded per frame
+    float beam_prune_threshold = 10.0f;  // Beam search: skip tokens this far (logit) below the frame best
+    std::string hotwords_path;      // Hotword list loaded at init (see HotwordGraph::Load), empty = none
+    float hotword_boost = 1.5f;     // Default bonus per matched hotword token
+    std::string lm_path;            // Token n-gram LM (.svlm) for beam search fusion, empty = none
+    float lm_weight = 0.3f;         // LM fusion weight (ln p_lm)
+    float lm_token_bonus = 0.0f;    // LM fusion: bonus per scored token
+    std::string keywords_path;      // Keyword list for Spot() loaded at init (see KeywordSpotter::Load), empty = none
+    float keyword_threshold = 0.5f; // Default minimum keyword hit confidence
 };
 
 // Audio configuration
@@ -72,11 +107,75 @@ struct AudioConfig {
     bool snip_edges = true;
 };
 
+// VAD configuration
+// Energy-based VAD on the log-mel fbank, used to trim silence and to split
+// long audio into model-sized segments before anything reaches the NPU.
+// Levels are mean log-mel energy in dB (10 * log10 of mel power).
+struct VadConfig {
+    bool enable = true;
+    float silence_threshold_db = -40.0f;  // Frames below this are never speech
+    float speech_floor_db = -20.0f;       // Audio without pauses counts as speech only this loud
+    float start_margin_db = 10.0f;        // Enter speech this far above the noise floor
+    float end_margin_db = 6.0f;           // Stay in speech until below floor + this (hysteresis)
+    float noise_floor_percentile = 0.1f;  // Noise floor = this percentile of frame energies
+    int32_t hangover_frames = 30;         // Keep speech state this many frames after energy drops
+    int32_t padding_frames = 10;          // Context kept around each segment
+    int32_t min_speech_frames = 10;       // Shorter bursts are dropped as clicks
+    int32_t max_segment_lfr_frames = 166; // Model input window (LFR frames)
+};
+
+// Request batching configuration
+// SenseVoice::Submit() queues requests; a batch runs once max_requests are
+// waiting or the oldest request has waited max_wait_ms.
+struct BatchingConfig {
+    bool enable = false;
+    int32_t max_requests = 0;  // 0 = model batch size
+    int32_t max_wait_ms = 20;
+};
+
+// Model scheduling configuration
+// Requests share the model executions run by run (ModelScheduler). Interactive
+// requests go first, earliest deadline first; a batch run only starts when it
+// is expected to finish in time for every interactive request in progress.
+struct SchedulingConfig {
+    int32_t interactive_deadline_ms = 1000;  // Deadline of interactive requests that set none
+};
+
 // Full configuration
 struct SenseVoiceConfig {
     ModelConfig model;
     AudioConfig audio;
     InferenceConfig inference;
+    VadConfig vad;
+    BatchingConfig batching;
+    SchedulingConfig scheduling;
+};
+
+// Scheduling lane of a request
+enum class Priority {
+    Interactive = 0,  // Live queries: latency first
+    Batch = 1         // Bulk transcription: runs in the interactive slack
+};
+
+// Per-request scheduling options
+struct RequestOptions {
+    Priority priority = Priority::Interactive;
+    std::chrono::steady_clock::time_point deadline{};  // Default (epoch) = none
+};
+
+// Rows of one utterance inside a packed-batch logits window
+// (its 4 prompt rows followed by its frames)
+struct PackedSegment {
+    int32_t row_offset = 0;
+    int32_t num_rows = 0;
+};
+
+// Contiguous token ids [begin, end) of a vocabulary subset
+struct TokenRange {
+    int32_t begin = 0;
+    int32_t end = 0;
+
+    bool Contains(int64_t id) const { return id >= begin && id < end; }
 };
 
 // Helper functions
@@ -96,6 +195,14 @@ inline int32_t CalcLfrOutputFrames(int32_t input_frames, int32_t window_size = 7
     return (input_frames - window_size) / window_shift + 1;
 }
 
+// Calculate number of fbank frames needed to produce the given LFR frames
+inline int32_t CalcLfrInputFrames(int32_t lfr_frames, int32_t window_size = 7, int32_t window_shift = 6) {
+    if (lfr_frames <= 0) {
+        return 0;
+    }
+    return (lfr_frames - 1) * window_shift + window_size;
+}
+
 // Calculate number of fbank frames from audio samples
 inline int32_t CalcNumFrames(int64_t num_samples, int32_t sample_rate = 16000,
                              int32_t frame_shift_ms = 10, int32_t frame_length_ms = 25) {
@@ -10,27 +10,135 @@
 #include <memory>
 #include <cstdint>
 #include "sensevoice_config.h"
+#include "model_bundle.h"
 
 namespace sensevoice {
 
+// Input tensors written to the executions, and skipped because the
+// execution already held the same value (prompt ids, packed masks)
+struct InputCopyStats {
+    int64_t written = 0;
+    int64_t skipped = 0;
+    int64_t skipped_bytes = 0;
+};
+
+// Precision of the features input (input 0) of the DLA
+enum class FeatureType {
+    Float32 = 0,  // Raw LFR features, CMVN in the graph
+    Float16,      // CMVN-normalized on the host, IEEE halves (_fp16in)
+    Int8          // CMVN-normalized on the host, int8 steps of ModelConfig::input_scale (_int8in)
+};
+
+// One utterance handed to packed or batched inference
+struct PackedInput {
+    const float* features = nullptr;  // LFR features [num_frames, 560]
+    int32_t num_frames = 0;
+};
+
 class SenseVoiceModel {
 public:
+    static constexpr int32_t kNumPromptTokens = 4;    // language, event, event_type, text_norm
+    static constexpr int32_t kPackedWindowRows = 170; // Rows of one packed window (= model output frames)
+    static constexpr int32_t kPackedGapRows = 5;      // Masked rows between packed utterances (FSMN kernel 11 / 2)
+
     SenseVoiceModel();
     ~SenseVoiceModel();
 
-    // Initialize model from DLA file
-    bool Initialize(const ModelConfig& config);
+    // Initialize model from DLA file, or from the DLA section of a bundle
+    // (shapes then come from the bundle metadata; the bundle must outlive the model)
+    bool Initialize(const ModelConfig& config, ModelBundle* bundle = nullptr);
 
     // Check if model is initialized
     bool IsInitialized() const { return initialized_; }
 
     // Run inference
     // Input: LFR features [num_frames, 560]
-    // Output: logits [num_frames + 4, vocab_size]
+    // Output: logits [num_frames + 4, RowWidth()] (full rows, or top-k rows)
+    // block_max (optional) receives, per output row, its NumMaxBlocks(vocab_size)
+    // block maxima, taken while the rows are copied out (CopyRowBlockMax, for
+    // the Tokenizer searches); left empty for a top-k head
     std::vector<float> Run(const std::vector<float>& features,
                            int32_t num_frames,
                            Language language = Language::Auto,
-                           TextNorm text_norm = TextNorm::WithoutITN);
+                           TextNorm text_norm = TextNorm::WithoutITN,
+                           std::vector<float>* block_max = nullptr);
+
+    // Run() for an fp16-output model, keeping the logits as IEEE halves
+    // (uint16_t bit patterns) for Tokenizer::Decode; plain model only
+    // Output: logits [num_frames + 4, vocab_size], empty unless HalfOutput()
+    std::vector<uint16_t> RunHalf(const std::vector<float>& features,
+                                  int32_t num_frames,
+                                  Language language = Language::Auto,
+                                  TextNorm text_norm = TextNorm::WithoutITN,
+                                  std::vector<float>* block_max = nullptr);
+
+    // Classification only: run one window but read back just its prompt rows
+    // (language, emotion, event, text_norm), not the frame logits
+    // Output: logits [kNumPromptTokens, RowWidth()]
+    std::vector<float> RunPrompt(const std::vector<float>& features,
+                                 int32_t num_frames,
+                                 Language language = Language::Auto,
+                                 TextNorm text_norm = TextNorm::WithoutITN);
+
+    // Check if the DLA is the packed-batch variant (ModelConfig::packed or
+    // file name contains "sensevoice_packed")
+    bool IsPacked() const { return packed_; }
+
+    // Check if the DLA outputs float16 logits (file name contains "_fp16out").
+    // Run(), RunBatch() and RunPacked() widen them to float while copying out
+    bool HalfOutput() const { return half_output_; }
+
+    // k of a top-k output head (file name contains "_top<k>"), 0 for full logits.
+    // Its rows (k log-probs, then their k token ids as floats) are returned as
+    // they are, for the Tokenizer / KeywordSpotter ...TopK entry points
+    int32_t TopK() const { return top_k_; }
+
+    // Values per output row: vocab_size, or 2 * TopK() for a top-k head
+    int32_t RowWidth() const { return top_k_ > 0 ? 2 * top_k_ : config_.vocab_size; }
+
+    // Precision of the features input, from its tensor size. Float16 / Int8
+    // DLAs take CMVN-normalized features (AudioFrontend::ApplyLFR with the
+    // CmvnStats of am.mvn); every run encodes them into the input tensor
+    FeatureType InputType() const { return input_type_; }
+    bool HostCmvn() const { return input_type_ != FeatureType::Float32; }
+
+    // Batch dimension of the model (ModelConfig::batch_size, 1 for the packed model)
+    int32_t BatchSize() const { return batch_size_; }
+
+    // Runs that can be in flight at once (ModelConfig::num_executions, fewer
+    // when the executor can't be duplicated). Run(), RunBatch() and RunPacked()
+    // may be called from that many threads; each takes a free execution
+    int32_t NumExecutions() const { return num_executions_; }
+
+    // Runs that can be in flight at once: NumExecutions() times the I/O sets
+    // per execution (ModelConfig::io_sets, 1 with dynamic shape). Runs beyond
+    // NumExecutions() copy their I/O while another run computes
+    int32_t MaxRunsInFlight() const { return max_runs_in_flight_; }
+
+    // Input copies over all executions since initialization
+    InputCopyStats GetInputCopyStats() const;
+
+    // Batched inference (DLA compiled with batch_size > 1)
+    // Input: up to BatchSize() utterances, unused batch slots are zero-padded
+    // Output: logits per utterance [min(num_frames, input_frames) + 4, RowWidth()]
+    // block_max (optional) receives the block maxima per utterance, as in Run()
+    std::vector<std::vector<float>> RunBatch(const std::vector<PackedInput>& utterances,
+                                             Language language = Language::Auto,
+                                             TextNorm text_norm = TextNorm::WithoutITN,
+                                             std::vector<std::vector<float>>* block_max = nullptr);
+
+    // Packed-batch inference (packed model only)
+    // Several short utterances share one window: each takes [4 prompt rows | its frames]
+    // and neighbours are separated by kPackedGapRows masked rows.
+    // Input: utterances in window order, must fit (see PackedRowsAfter)
+    // Output: logits [used_rows, RowWidth()]; segments receives each utterance's rows
+    std::vector<float> RunPacked(const std::vector<PackedInput>& utterances,
+                                 std::vector<PackedSegment>* segments);
+
+    // Rows used in a packed window after appending an utterance of num_frames
+    static int32_t PackedRowsAfter(int32_t used_rows, int32_t num_frames) {
+        return (used_rows > 0 ? used_rows + kPackedGapRows : 0) + kNumPromptTokens + num_frames;
+    }
 
     // Get model metadata
     const ModelConfig& GetConfig() const { return config_; }
@@ -42,7 +150,7 @@ public:
 
     // Get expected output size for given number of input frames
     size_t GetOutputSize(int32_t num_frames) const {
-        return (num_frames + kNumPromptTokens) * config_.vocab_size;
+        return (num_frames + kNumPromptTokens) * RowWidth();
     }
 
 private:
@@ -51,8 +159,13 @@ private:
 
     ModelConfig config_;
     bool initialized_ = false;
-
-    static constexpr int32_t kNumPromptTokens = 4;  // language, event, event_type, text_norm
+    bool packed_ = false;
+    bool half_output_ = false;
+    FeatureType input_type_ = FeatureType::Float32;
+    int32_t top_k_ = 0;
+    int32_t batch_size_ = 1;
+    int32_t num_executions_ = 1;
+    int32_t max_runs_in_flight_ = 1;
 };
 
 }  // namespace sensevoice
@@ -0,0 +1,250 @@
+/* Recognition Server Protocol
+ *
+ * Binary framing between sensevoice_server and its clients over a Unix
+ * domain stream socket. Little-endian fixed headers, each followed by its
+ * payload. A connection carries any number of requests; responses come back
+ * in completion order and are matched to requests by request_id.
+ *
+ * Instead of copying PCM through the socket, a client can attach a ring in
+ * shared memory (ServerShmAttach): it writes int16 PCM into slots the server
+ * reads in place, and results come back in the same slots through a
+ * completion ring. Two eventfds signal submissions and completions.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace sensevoice {
+
+constexpr uint32_t kServerRequestMagic = 0x51525653;   // "SVRQ"
+constexpr uint32_t kServerResponseMagic = 0x53525653;  // "SVRS"
+constexpr uint16_t kServerProtocolVersion = 1;
+constexpr uint32_t kServerShmAttachMagic = 0x41525653;  // "SVRA"
+constexpr uint32_t kServerMaxSamples = 16000 * 600;    // 10 minutes of 16kHz audio
+constexpr uint32_t kServerMaxShmSlots = 256;
+constexpr uint32_t kServerMaxShmTextBytes = 64 * 1024;
+
+// Request: ServerRequestHeader | int16_t pcm[num_samples] (16kHz mono)
+struct ServerRequestHeader {
+    uint32_t magic;        // kServerRequestMagic
+    uint16_t version;      // kServerProtocolVersion
+    uint8_t language;      // Language value (0 = auto)
+    uint8_t text_norm;     // TextNorm value
+    uint32_t request_id;   // Echoed in the response
+    uint32_t num_samples;
+};
+static_assert(sizeof(ServerRequestHeader) == 16, "ServerRequestHeader is part of the wire format");
+
+enum class ServerStatus : uint8_t {
+    Ok = 0,
+    Busy = 1,        // Request queue full, retry later
+    Draining = 2,    // Server is shutting down, no new requests
+    BadRequest = 3   // Malformed header; the server closes the connection
+};
+
+// Response: ServerResponseHeader | char language[language_length] | char text[text_length]
+struct ServerResponseHeader {
+    uint32_t magic;            // kServerResponseMagic
+    uint8_t status;            // ServerStatus
+    uint8_t language_length;
+    uint16_t reserved;
+    uint32_t request_id;
+    uint32_t text_length;
+    uint32_t queue_us;         // Time spent waiting for a free execution slot
+    uint32_t run_us;           // Time spent in the recognition pipeline
+    float confidence;          // RecognitionResult::confidence
+};
+static_assert(sizeof(ServerResponseHeader) == 28, "ServerResponseHeader is part of the wire format");
+
+// Shared-memory attach: ServerShmAttach, sent with three descriptors
+// (SCM_RIGHTS, in this order): a memfd holding the ring (ShmRingLayout),
+// an eventfd the client signals after submitting, and an eventfd the server
+// signals after completing. Answered by a ServerResponseHeader (Ok or
+// BadRequest, request_id 0). From then on the socket carries no data; closing
+// it detaches the ring
+struct ServerShmAttach {
+    uint32_t magic;         // kServerShmAttachMagic
+    uint16_t version;       // kServerProtocolVersion
+    uint16_t num_slots;     // Requests outstanding at once, up to kServerMaxShmSlots
+    uint32_t slot_samples;  // PCM capacity of a slot, up to kServerMaxSamples
+    uint32_t text_bytes;    // Result capacity of a slot (language tag + text)
+};
+static_assert(sizeof(ServerShmAttach) == sizeof(ServerRequestHeader),
+              "ServerShmAttach is read in place of a request header");
+
+// Ring positions are free-running counters, the entry is at position % num_slots.
+// Each one sits on its own cache line, written by one side only
+struct alignas(64) ShmRingIndex {
+    std::atomic<uint32_t> value;
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Ring indices are shared between processes");
+
+struct ShmRingHeader {
+    ShmRingIndex submit_head;    // Client: slots submitted
+    ShmRingIndex submit_tail;    // Server: slots taken
+    ShmRingIndex complete_head;  // Server: slots completed
+    ShmRingIndex complete_tail;  // Client: completions consumed
+};
+
+// Request fields are written by the client before submitting the slot, result
+// fields by the server before completing it (same meaning as on the socket)
+struct ShmSlotHeader {
+    uint32_t request_id;
+    uint32_t num_samples;
+    uint8_t language;
+    uint8_t text_norm;
+    uint8_t status;            // ServerStatus
+    uint8_t language_length;
+    uint32_t text_length;      // Truncated to the slot's text_bytes
+    uint32_t queue_us;
+    uint32_t run_us;
+    float confidence;
+    uint32_t reserved;
+};
+static_assert(sizeof(ShmSlotHeader) == 32, "ShmSlotHeader is shared between processes");
+
+// Ring memory: ShmRingHeader | uint32_t submit[num_slots] | uint32_t complete[num_slots] |
+//              slot[num_slots] = ShmSlotHeader | int16_t pcm[slot_samples] | char result[text_bytes]
+// (rings hold slot indices; slots start on cache lines)
+struct ShmRingLayout {
+    uint32_t num_slots = 0;
+    uint32_t slot_samples = 0;
+    uint32_t text_bytes = 0;
+
+    static size_t Align(size_t bytes) { return (bytes + 63) & ~static_cast<size_t>(63); }
+
+    size_t SlotStride() const {
+        return Align(sizeof(ShmSlotHeader) + sizeof(int16_t) * slot_samples + text_bytes);
+    }
+    size_t SlotsOffset() const {
+        return Align(sizeof(ShmRingHeader) + 2 * sizeof(uint32_t) * num_slots);
+    }
+    size_t Bytes() const { return SlotsOffset() + num_slots * SlotStride(); }
+
+    ShmRingHeader* Header(void* base) const { return static_cast<ShmRingHeader*>(base); }
+    uint32_t* SubmitRing(void* base) const {
+        return reinterpret_cast<uint32_t*>(static_cast<char*>(base) + sizeof(ShmRingHeader));
+    }
+    uint32_t* CompleteRing(void* base) const { return SubmitRing(base) + num_slots; }
+    ShmSlotHeader* Slot(void* base, uint32_t slot) const {
+        return reinterpret_cast<ShmSlotHeader*>(static_cast<char*>(base) + SlotsOffset() + slot * SlotStride());
+    }
+    int16_t* SlotSamples(void* base, uint32_t slot) const {
+        return reinterpret_cast<int16_t*>(Slot(base, slot) + 1);
+    }
+    char* SlotText(void* base, uint32_t slot) const {
+        return reinterpret_cast<char*>(SlotSamples(base, slot) + slot_samples);
+    }
+};
+
+// Read exactly size bytes; false on EOF or error
+inline bool ReadFull(int fd, void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = recv(fd, p, size, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Write exactly size bytes; false once the peer is gone (no SIGPIPE)
+inline bool WriteFull(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// ReadFull() that also takes the descriptors passed with the data (SCM_RIGHTS)
+// *num_fds is the number received; descriptors beyond max_fds are closed
+inline bool ReadFullWithFds(int fd, void* data, size_t size, int* fds, int max_fds, int* num_fds) {
+    *num_fds = 0;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * 4)];
+    iovec iov = {data, size};
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do {
+        n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        const int count = static_cast<int>((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        for (int i = 0; i < count; ++i) {
+            int received;
+            std::memcpy(&received, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            if (*num_fds < max_fds) {
+                fds[(*num_fds)++] = received;
+            } else {
+                close(received);
+            }
+        }
+    }
+    return ReadFull(fd, static_cast<char*>(data) + n, size - static_cast<size_t>(n));
+}
+
+// Send size bytes with descriptors attached to the first byte (SCM_RIGHTS, up to 4)
+inline bool WriteFullWithFds(int fd, const void* data, size_t size, const int* fds, int num_fds) {
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * 4)];
+    if (num_fds < 1 || num_fds > 4) {
+        return false;
+    }
+    std::memset(control, 0, sizeof(control));
+    iovec iov = {const_cast<void*>(data), size};
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * num_fds);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * num_fds);
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * num_fds);
+
+    ssize_t n;
+    do {
+        n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+    return WriteFull(fd, static_cast<const char*>(data) + n, size - static_cast<size_t>(n));
+}
+
+}  // namespace sensevoice
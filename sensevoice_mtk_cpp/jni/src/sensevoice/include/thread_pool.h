@@ -0,0 +1,51 @@
+/* Thread Pool for SenseVoice
+ *
+ * Fixed set of worker threads for the CPU side of long-audio recognition:
+ * while some windows run on the NPU executions, other workers prepare the
+ * LFR features of the following windows and decode finished ones.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sensevoice {
+
+class ThreadPool {
+public:
+    explicit ThreadPool(int32_t num_threads);
+
+    // Finishes the queued tasks, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int32_t NumThreads() const { return static_cast<int32_t>(workers_.size()); }
+
+    // Run a task on a worker
+    void Post(std::function<void()> task);
+
+    // Call body(i) for i in [0, count), indices taken in order by the caller
+    // and up to NumThreads() workers. The caller takes part, so this returns
+    // even when every worker is busy with other requests
+    void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_ = false;
+};
+
+}  // namespace sensevoice
@@ -5,11 +5,15 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 #include <cstdint>
 #include "sensevoice_config.h"
+#include "ctc_beam_search.h"
+#include "hotwords.h"
+#include "ngram_lm.h"
 
 namespace sensevoice {
 
@@ -18,6 +22,8 @@ struct RecognitionResult {
     std::string text;                      // Final transcription text
     std::vector<std::string> tokens;       // Individual tokens
     std::vector<float> timestamps;         // Timestamp for each token (seconds)
+    std::vector<float> confidences;        // Posterior of each token, [0, 1]
+    float confidence = 0.0f;               // Geometric mean of the token posteriors (0 without tokens)
 
     // Metadata (extracted from first 4 frames)
     std::string language;
@@ -29,52 +35,299 @@ struct RecognitionResult {
 struct CTCDecoderResult {
     std::vector<int64_t> token_ids;
     std::vector<int32_t> frame_indices;
+    std::vector<float> log_probs;          // Log-posterior of each token (empty if not computed)
 };
 
+// One vocabulary slot, indexed by token id
+// Offsets point into the string arena; the display form has the
+// SentencePiece space marker (U+2581) already replaced by ' '
+struct VocabEntry {
+    uint32_t token_offset;
+    uint32_t display_offset;
+    uint16_t token_length;
+    uint16_t display_length;
+    uint32_t flags;
+};
+static_assert(sizeof(VocabEntry) == 16, "VocabEntry is part of the binary vocabulary format");
+
+// Allowed token ids [begin, end) of a language (prompt language id), see
+// Tokenizer::LanguageTokens; sorted by language, then begin
+struct VocabLanguageRange {
+    int32_t language;
+    int32_t begin;
+    int32_t end;
+};
+static_assert(sizeof(VocabLanguageRange) == 12, "VocabLanguageRange is part of the binary vocabulary format");
+
+// Binary vocabulary file (tokens.bin), little-endian, mmapped as is:
+//   VocabFileHeader | VocabEntry[num_entries] | uint32_t index[index_slots] |
+//   VocabLanguageRange[num_language_ranges] | char arena[arena_bytes]
+// index is an FNV-1a open-addressing table of id + 1 (0 = empty).
+// Written by SenseVoice_workspace/model_prepare/tokens2bin.py
+struct VocabFileHeader {
+    char magic[4];           // "SVTK"
+    uint32_t version;        // kVocabFileVersion
+    uint32_t num_entries;    // Dense table size (max id + 1)
+    uint32_t num_tokens;     // Valid entries
+    int32_t blank_id;
+    uint32_t index_slots;    // Power of two
+    uint32_t arena_bytes;
+    uint32_t num_language_ranges;
+};
+static_assert(sizeof(VocabFileHeader) == 32, "VocabFileHeader layout is fixed");
+
+constexpr uint32_t kVocabFileVersion = 2;
+
 class Tokenizer {
 public:
+    static constexpr uint32_t kEntryValid = 1u << 0;    // Id present in the vocabulary
+    static constexpr uint32_t kEntrySpecial = 1u << 1;  // <...> token, dropped from text
+
     Tokenizer();
     ~Tokenizer();
 
-    // Load tokens from file (format: "token id" per line)
+    Tokenizer(const Tokenizer&) = delete;
+    Tokenizer& operator=(const Tokenizer&) = delete;
+
+    // Load tokens from file: binary tokens.bin (mmapped, no parsing) or
+    // text tokens.txt ("token id" per line), detected by the file magic
     bool Load(const std::string& tokens_file);
 
-    // Get token string by ID
-    std::string IdToToken(int64_t id) const;
+    // Use a binary vocabulary that is already in memory (e.g. a bundle section)
+    // The memory is not copied and must outlive the tokenizer
+    bool LoadFromMemory(const void* data, size_t size);
+
+    // True when the vocabulary is served in place from a binary image
+    bool IsMapped() const { return binary_bytes_ != 0; }
+
+    // Get token string by ID ("<unk>" for unknown ids)
+    // The view stays valid until the next Load()
+    std::string_view IdToToken(int64_t id) const;
+
+    // Get display form by ID (space marker replaced, empty for special tokens)
+    std::string_view IdToDisplay(int64_t id) const;
 
-    // Get token ID by string
-    int64_t TokenToId(const std::string& token) const;
+    // Check if token is a special <...> token
+    bool IsSpecial(int64_t id) const;
+
+    // Get token ID by string (-1 if not found)
+    int64_t TokenToId(std::string_view token) const;
+
+    // Split text into token ids by greedy longest match against the vocabulary,
+    // each word starting with the SentencePiece space marker. Approximates the
+    // BPE model's segmentation; characters missing from the vocabulary are dropped
+    std::vector<int64_t> Encode(std::string_view text) const;
 
     // Get vocabulary size
-    int32_t VocabSize() const { return static_cast<int32_t>(id_to_token_.size()); }
+    int32_t VocabSize() const { return num_tokens_; }
+
+    // Bytes held by the vocabulary tables and string arena (heap or mapping)
+    size_t MemoryFootprint() const;
+
+    // Token ids a language can emit, as sorted ranges derived from the
+    // Unicode scripts of each token: tokens whose letters all belong to the
+    // language's scripts (Latin is kept for every language, for code-switched
+    // words), plus digits, punctuation, blank and special tokens. A binary
+    // vocabulary carries them precomputed, a text one derives them at load.
+    // nullptr for Auto / NoSpeech (whole vocabulary)
+    const std::vector<TokenRange>* LanguageTokens(Language language) const;
 
     // Check if token is blank
     bool IsBlank(int64_t id) const { return id == blank_id_; }
+    int64_t BlankId() const { return blank_id_; }
 
     // CTC greedy search decoding
     // Input: logits [num_frames, vocab_size]
-    // Output: decoded token IDs and frame indices
+    // Output: decoded token IDs, frame indices and log-posteriors; the argmax
+    // and the frame's log-softmax normalizer come from one pass over the row,
+    // a token's posterior is its best over the frames it spans
+    // block_max (optional, NumMaxBlocks(vocab_size) per frame, CopyRowBlockMax)
+    // bounds every non-blank logit of the frame; frames whose blank logit lies
+    // above them are blank without scanning the row. The result is the same either way
+    // allowed_tokens (optional, see LanguageTokens) limits the search, and the
+    // posteriors, to those tokens; nullptr scans the whole vocabulary
     CTCDecoderResult CTCGreedySearch(const float* logits,
                                      int32_t num_frames,
-                                     int32_t vocab_size) const;
+                                     int32_t vocab_size,
+                                     const float* block_max = nullptr,
+                                     const std::vector<TokenRange>* allowed_tokens = nullptr) const;
+
+    // Greedy search on fp16 logits (IEEE half bit patterns, SenseVoiceModel::RunHalf)
+    // The rows are scanned in place, never widened to float32 in memory; the
+    // result matches the float32 search on the same values
+    CTCDecoderResult CTCGreedySearch(const uint16_t* logits,
+                                     int32_t num_frames,
+                                     int32_t vocab_size,
+                                     const float* block_max = nullptr,
+                                     const std::vector<TokenRange>* allowed_tokens = nullptr) const;
+
+    // CTC prefix beam search decoding
+    // Input: logits [num_frames, vocab_size]
+    // Output: tokens of the best prefix, the frames where they were first emitted
+    // and their log-posteriors at those frames
+    // hotwords (optional) boosts prefixes matching its phrases; the loaded LM
+    // is fused unless options.lm_weight is 0; allowed_tokens as for greedy
+    // block_max (optional, as for greedy) limits the candidate scan and the
+    // normalizers of the emitting frames to the blocks that can matter
+    CTCDecoderResult CTCPrefixBeamSearch(const float* logits,
+                                         int32_t num_frames,
+                                         int32_t vocab_size,
+                                         const BeamSearchOptions& options,
+                                         const HotwordGraph* hotwords = nullptr,
+                                         const std::vector<TokenRange>* allowed_tokens = nullptr,
+                                         const float* block_max = nullptr) const;
+
+    // Searches on top-k rows [num_frames, 2k] (SenseVoiceModel::TopK() > 0):
+    // k log-probs, then their k token ids as floats, read in place. Only the
+    // k tokens of a frame can be emitted, and their posteriors are the head's
+    // own log-probs (over the whole vocabulary, also with allowed_tokens); a
+    // frame whose k hold no allowed token counts as blank
+    CTCDecoderResult CTCGreedySearchTopK(const float* rows,
+                                         int32_t num_frames,
+                                         int32_t k,
+                                         const std::vector<TokenRange>* allowed_tokens = nullptr) const;
+
+    CTCDecoderResult CTCPrefixBeamSearchTopK(const float* rows,
+                                             int32_t num_frames,
+                                             int32_t k,
+                                             const BeamSearchOptions& options,
+                                             const HotwordGraph* hotwords = nullptr,
+                                             const std::vector<TokenRange>* allowed_tokens = nullptr) const;
+
+    // Search used by Decode() / DecodePacked(): greedy (default) or prefix beam search
+    void SetBeamSearch(bool enable, const BeamSearchOptions& options = BeamSearchOptions());
+    bool UsesBeamSearch() const { return use_beam_search_; }
+
+    // Map a token-level n-gram LM (.svlm from arpa2lm.py) for beam search fusion
+    bool LoadLanguageModel(const std::string& lm_file);
+    const NgramLm* LanguageModel() const { return lm_.get(); }
 
     // Convert CTC result to recognition result
     RecognitionResult ConvertResult(const CTCDecoderResult& ctc_result,
                                     int32_t frame_shift_ms = 10,
                                     int32_t lfr_window_shift = 6) const;
 
+    // Metadata only: language, emotion and event from the prompt rows
+    // (logits [kNumMetadataFrames, vocab_size], SenseVoiceModel::RunPrompt),
+    // one token per row as ConvertResult expects; text and tokens stay empty
+    RecognitionResult DecodePrompt(const float* logits, int32_t vocab_size) const;
+
+    // DecodePrompt() on top-k prompt rows [kNumMetadataFrames, 2k]
+    RecognitionResult DecodePromptTopK(const float* rows, int32_t k) const;
+
     // Full decode pipeline: logits -> RecognitionResult
+    // A non-empty hotword graph selects beam search even when greedy is configured
+    // block_max (optional) is the readback's block maxima, used by either search
     RecognitionResult Decode(const float* logits,
                              int32_t num_frames,
                              int32_t vocab_size,
                              int32_t frame_shift_ms = 10,
-                             int32_t lfr_window_shift = 6) const;
+                             int32_t lfr_window_shift = 6,
+                             const HotwordGraph* hotwords = nullptr,
+                             const float* block_max = nullptr,
+                             const std::vector<TokenRange>* allowed_tokens = nullptr) const;
+
+    // Full decode pipeline on fp16 logits: the greedy search runs on the half
+    // rows; beam search (or hotwords) gets them widened to float32 first, with
+    // their block maxima taken on the way when block_max is not given
+    RecognitionResult Decode(const uint16_t* logits,
+                             int32_t num_frames,
+                             int32_t vocab_size,
+                             int32_t frame_shift_ms = 10,
+                             int32_t lfr_window_shift = 6,
+                             const HotwordGraph* hotwords = nullptr,
+                             const float* block_max = nullptr,
+                             const std::vector<TokenRange>* allowed_tokens = nullptr) const;
+
+    // Full decode pipeline on top-k rows [num_frames, 2k], as Decode()
+    RecognitionResult DecodeTopK(const float* rows,
+                                 int32_t num_frames,
+                                 int32_t k,
+                                 int32_t frame_shift_ms = 10,
+                                 int32_t lfr_window_shift = 6,
+                                 const HotwordGraph* hotwords = nullptr,
+                                 const std::vector<TokenRange>* allowed_tokens = nullptr) const;
+
+    // Decode a packed-batch logits window, one result per utterance
+    // Each segment is decoded on its own rows (prompt rows first), so the
+    // metadata and timestamps of every result are relative to its utterance
+    std::vector<RecognitionResult> DecodePacked(const float* logits,
+                                                const std::vector<PackedSegment>& segments,
+                                                int32_t vocab_size,
+                                                int32_t frame_shift_ms = 10,
+                                                int32_t lfr_window_shift = 6,
+                                                const HotwordGraph* hotwords = nullptr,
+                                                const std::vector<TokenRange>* allowed_tokens = nullptr) const;
+
+    // DecodePacked() on a window of top-k rows [rows, 2k]
+    std::vector<RecognitionResult> DecodePackedTopK(const float* rows,
+                                                    const std::vector<PackedSegment>& segments,
+                                                    int32_t k,
+                                                    int32_t frame_shift_ms = 10,
+                                                    int32_t lfr_window_shift = 6,
+                                                    const HotwordGraph* hotwords = nullptr,
+                                                    const std::vector<TokenRange>* allowed_tokens = nullptr) const;
 
 private:
-    std::unordered_map<int64_t, std::string> id_to_token_;
-    std::unordered_map<std::string, int64_t> token_to_id_;
+    static uint32_t HashToken(std::string_view token);
+
+    // Release the current vocabulary (heap tables or mapping)
+    void Reset();
+
+    // Map a binary vocabulary; *is_binary is false when the magic does not match
+    bool LoadBinary(const std::string& tokens_file, bool* is_binary);
+
+    // Validate a binary vocabulary image and point the views into it
+    bool AttachBinary(const void* data, size_t size, const std::string& name);
+
+    // Parse a text vocabulary into the owned tables
+    bool LoadText(const std::string& tokens_file);
+
+    // Derive the per-language token ranges from the loaded vocabulary (text files)
+    void BuildLanguageTokens();
+
+    // Log the size of each language's token set
+    void LogLanguageTokens(const char* source) const;
+
+    const VocabEntry* Entry(int64_t id) const {
+        if (id < 0 || static_cast<uint64_t>(id) >= num_entries_) {
+            return nullptr;
+        }
+        const VocabEntry& e = entries_[static_cast<size_t>(id)];
+        return (e.flags & kEntryValid) ? &e : nullptr;
+    }
+
+    // Views used by every lookup; point at the owned tables or into the mapping
+    const VocabEntry* entries_ = nullptr;  // Dense, id-indexed
+    size_t num_entries_ = 0;
+    const char* arena_ = nullptr;          // Raw tokens and display forms, back to back
+    const uint32_t* token_index_ = nullptr;  // Hash slots holding id + 1, for TokenToId
+    size_t index_slots_ = 0;
+
+    // Text-loaded storage
+    std::vector<VocabEntry> owned_entries_;
+    std::string owned_arena_;
+    std::vector<uint32_t> owned_index_;
+
+    // Binary-loaded storage (mapped_ is only set when the tokenizer owns the mapping)
+    void* mapped_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    size_t binary_bytes_ = 0;
+
+    int32_t num_tokens_ = 0;
     int64_t blank_id_ = 0;
 
+    // Allowed token ranges per explicit language
+    struct LanguageTokenSet {
+        Language language;
+        std::vector<TokenRange> ranges;
+    };
+    std::vector<LanguageTokenSet> language_tokens_;
+
+    bool use_beam_search_ = false;
+    BeamSearchOptions beam_options_;
+    std::unique_ptr<NgramLm> lm_;
+
     // Special token IDs for SenseVoice metadata
     static constexpr int32_t kNumMetadataFrames = 4;  // language, emotion, event, text_norm
 };
@@ -0,0 +1,56 @@
+/* Voice Activity Detection for SenseVoice
+ *
+ * Lightweight energy VAD on the log-mel fbank computed by AudioFrontend.
+ * Finds speech regions with hysteresis and hangover, drops leading/trailing
+ * silence, splits long speech at pauses so every segment fits in one model
+ * window, and joins neighbouring segments that fit in one window together.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "sensevoice_config.h"
+
+namespace sensevoice {
+
+// Speech segment in fbank frames: [start_frame, end_frame)
+struct SpeechSegment {
+    int32_t start_frame;
+    int32_t end_frame;
+
+    int32_t NumFrames() const { return end_frame - start_frame; }
+};
+
+class Vad {
+public:
+    explicit Vad(const VadConfig& config, int32_t lfr_window_size = 7,
+                 int32_t lfr_window_shift = 6);
+
+    // Detect speech segments
+    // Input: log-mel fbank features [num_frames, feat_dim]
+    // Output: segments ordered by time, each at most one model window long
+    //         (empty if the audio is silence)
+    std::vector<SpeechSegment> Detect(const float* fbank,
+                                      int32_t num_frames,
+                                      int32_t feat_dim) const;
+
+    // Per-frame energy in dB (mean log-mel), exposed for debugging
+    static std::vector<float> FrameEnergyDb(const float* fbank,
+                                            int32_t num_frames,
+                                            int32_t feat_dim);
+
+    const VadConfig& GetConfig() const { return config_; }
+
+private:
+    // Split a segment longer than the model window at the quietest frames
+    void SplitLongSegment(const SpeechSegment& segment,
+                          const std::vector<float>& energy_db,
+                          std::vector<SpeechSegment>* out) const;
+
+    VadConfig config_;
+    int32_t max_segment_frames_;  // Model window in fbank frames
+    int32_t min_segment_frames_;  // Smallest segment that still yields one LFR frame
+};
+
+}  // namespace sensevoice
@@ -4,10 +4,12 @@
  */
 
 #include "audio_frontend.h"
+#include "ctc_math.h"
 #include "kaldi-native-fbank/csrc/feature-fbank.h"
 #include "kaldi-native-fbank/csrc/online-feature.h"
 
 #include <fstream>
+#include <sstream>
 #include <cstring>
 #include <cmath>
 #include <algorithm>
@@ -50,21 +52,28 @@ public:
                                static_cast<int32_t>(samples.size()));
         fbank_->InputFinished();
 
-        // Get number of frames
-        int32_t num_frames = fbank_->NumFramesReady();
-        if (num_frames == 0) {
-            return {};
-        }
+        return CollectFrames();
+    }
 
-        // Extract features
-        std::vector<float> features(num_frames * config_.num_mel_bins);
-        for (int32_t i = 0; i < num_frames; ++i) {
-            const float* frame = fbank_->GetFrame(i);
-            std::copy(frame, frame + config_.num_mel_bins,
-                      features.begin() + i * config_.num_mel_bins);
+    std::vector<float> ComputeFbank(const int16_t* samples, size_t num_samples) {
+        // Reset fbank state
+        fbank_ = std::make_unique<knf::OnlineFbank>(GetOptions());
+
+        // Scale small chunks into a cache-resident scratch buffer right before
+        // the fbank windows them. OnlineFbank keeps the partial frame between
+        // calls, so the frames are identical to feeding the whole signal.
+        const float sample_rate = static_cast<float>(config_.sample_rate);
+        for (size_t offset = 0; offset < num_samples; offset += kPcmChunkSamples) {
+            size_t n = std::min(kPcmChunkSamples, num_samples - offset);
+            const int16_t* src = samples + offset;
+            for (size_t i = 0; i < n; ++i) {
+                pcm_scratch_[i] = src[i] * kInt16Scale;
+            }
+            fbank_->AcceptWaveform(sample_rate, pcm_scratch_, static_cast<int32_t>(n));
         }
+        fbank_->InputFinished();
 
-        return features;
+        return CollectFrames();
     }
 
 private:
@@ -90,8 +99,30 @@ private:
         return opts;
     }
 
+    std::vector<float> CollectFrames() const {
+        // Get number of frames
+        int32_t num_frames = fbank_->NumFramesReady();
+        if (num_frames == 0) {
+            return {};
+        }
+
+        // Extract features
+        std::vector<float> features(num_frames * config_.num_mel_bins);
+        for (int32_t i = 0; i < num_frames; ++i) {
+            const float* frame = fbank_->GetFrame(i);
+            std::copy(frame, frame + config_.num_mel_bins,
+                      features.begin() + i * config_.num_mel_bins);
+        }
+
+        return features;
+    }
+
+    static constexpr size_t kPcmChunkSamples = 1024;
+    static constexpr float kInt16Scale = 1.0f / 32768.0f;
+
     AudioConfig config_;
     std::unique_ptr<knf::OnlineFbank> fbank_;
+    float pcm_scratch_[kPcmChunkSamples];
 };
 
 AudioFrontend::AudioFrontend(const AudioConfig& config)
@@ -104,26 +135,51 @@ std::vector<float> AudioFrontend::ComputeFbank(const std::vector<float>& samples
     return impl_->ComputeFbank(samples);
 }
 
+std::vector<float> AudioFrontend::ComputeFbank(const int16_t* samples, size_t num_samples) {
+    return impl_->ComputeFbank(samples, num_samples);
+}
+
 std::vector<float> AudioFrontend::ApplyLFR(const std::vector<float>& fbank,
                                            int32_t num_frames,
                                            int32_t feat_dim,
                                            int32_t window_size,
-                                           int32_t window_shift) {
+                                           int32_t window_shift,
+                                           const CmvnStats* cmvn) {
+    return ApplyLFR(fbank.data(), num_frames, feat_dim, window_size, window_shift, cmvn);
+}
+
+std::vector<float> AudioFrontend::ApplyLFR(const float* fbank,
+                                           int32_t num_frames,
+                                           int32_t feat_dim,
+                                           int32_t window_size,
+                                           int32_t window_shift,
+                                           const CmvnStats* cmvn) {
     if (num_frames < window_size) {
         return {};
     }
 
     int32_t out_num_frames = (num_frames - window_size) / window_shift + 1;
     int32_t out_feat_dim = feat_dim * window_size;
+    if (cmvn && cmvn->Dim() != out_feat_dim) {
+        return {};
+    }
 
     std::vector<float> lfr_features(out_num_frames * out_feat_dim);
 
-    const float* p_in = fbank.data();
+    const float* p_in = fbank;
     float* p_out = lfr_features.data();
 
     for (int32_t i = 0; i < out_num_frames; ++i) {
-        // Copy window_size consecutive frames
-        std::copy(p_in, p_in + out_feat_dim, p_out);
+        // Copy window_size consecutive frames, normalized on the way when CMVN is given
+        if (cmvn) {
+            const float* neg_mean = cmvn->neg_mean.data();
+            const float* inv_stddev = cmvn->inv_stddev.data();
+            for (int32_t d = 0; d < out_feat_dim; ++d) {
+                p_out[d] = (p_in[d] + neg_mean[d]) * inv_stddev[d];
+            }
+        } else {
+            std::copy(p_in, p_in + out_feat_dim, p_out);
+        }
         p_out += out_feat_dim;
         p_in += window_shift * feat_dim;
     }
@@ -135,6 +191,18 @@ std::vector<float> AudioFrontend::Process(const std::vector<float>& samples,
                                           int32_t* out_num_frames) {
     // Compute fbank features
     std::vector<float> fbank = ComputeFbank(samples);
+    return FbankToLfr(fbank, out_num_frames);
+}
+
+std::vector<float> AudioFrontend::Process(const int16_t* samples, size_t num_samples,
+                                          int32_t* out_num_frames) {
+    // Compute fbank features
+    std::vector<float> fbank = ComputeFbank(samples, num_samples);
+    return FbankToLfr(fbank, out_num_frames);
+}
+
+std::vector<float> AudioFrontend::FbankToLfr(const std::vector<float>& fbank,
+                                             int32_t* out_num_frames) const {
     if (fbank.empty()) {
         if (out_num_frames) *out_num_frames = 0;
         return {};
@@ -158,6 +226,56 @@ std::vector<float> AudioFrontend::Process(const std::vector<float>& samples,
     return lfr;
 }
 
+bool LoadCmvn(const std::string& filename, CmvnStats* cmvn) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string content = buffer.str();
+
+    // The vector follows "<LearnRateCoef> 0 [" after each component tag
+    auto parse = [&content](const char* tag, std::vector<float>* values) {
+        size_t begin = content.find(tag);
+        begin = begin == std::string::npos ? begin : content.find('[', begin);
+        size_t end = begin == std::string::npos ? begin : content.find(']', begin);
+        if (end == std::string::npos) {
+            return false;
+        }
+        std::stringstream numbers(content.substr(begin + 1, end - begin - 1));
+        values->clear();
+        float v;
+        while (numbers >> v) {
+            values->push_back(v);
+        }
+        return !values->empty();
+    };
+
+    CmvnStats stats;
+    if (!parse("<AddShift>", &stats.neg_mean) || !parse("<Rescale>", &stats.inv_stddev) ||
+        stats.neg_mean.size() != stats.inv_stddev.size()) {
+        return false;
+    }
+    *cmvn = std::move(stats);
+    return true;
+}
+
+void FeaturesToHalf(const float* src, size_t count, uint16_t* dst) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = FloatToHalf(src[i]);
+    }
+}
+
+void FeaturesToInt8(const float* src, size_t count, float step, int8_t* dst) {
+    const float inv_step = 1.0f / step;
+    for (size_t i = 0; i < count; ++i) {
+        // Round half away from zero by truncation, which vectorizes (lrint is a libm call)
+        const float q = std::min(std::max(src[i] * inv_step, -127.0f), 127.0f);
+        dst[i] = static_cast<int8_t>(static_cast<int32_t>(q + (q < 0.0f ? -0.5f : 0.5f)));
+    }
+}
+
 // WAV file header structure
 #pragma pack(push, 1)
 struct WavHeader {
@@ -175,20 +293,13 @@ struct WavHeader {
 };
 #pragma pack(pop)
 
-bool LoadWavFile(const std::string& filename,
-                 std::vector<float>* samples,
-                 int32_t* sample_rate) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        return false;
-    }
-
-    WavHeader header;
-    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+// Parse the RIFF header and position the stream at the start of the data chunk
+static bool SeekWavData(std::ifstream& file, WavHeader* header, uint32_t* data_size) {
+    file.read(reinterpret_cast<char*>(header), sizeof(*header));
 
     // Verify RIFF/WAVE format
-    if (std::strncmp(header.riff, "RIFF", 4) != 0 ||
-        std::strncmp(header.wave, "WAVE", 4) != 0) {
+    if (std::strncmp(header->riff, "RIFF", 4) != 0 ||
+        std::strncmp(header->wave, "WAVE", 4) != 0) {
         return false;
     }
 
@@ -210,6 +321,24 @@ bool LoadWavFile(const std::string& filename,
         return false;
     }
 
+    *data_size = chunk_size;
+    return true;
+}
+
+bool LoadWavFile(const std::string& filename,
+                 std::vector<float>* samples,
+                 int32_t* sample_rate) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    WavHeader header;
+    uint32_t chunk_size = 0;
+    if (!SeekWavData(file, &header, &chunk_size)) {
+        return false;
+    }
+
     // Read audio data
     int32_t num_samples = chunk_size / (header.bits_per_sample / 8) / header.num_channels;
     samples->resize(num_samples);
@@ -240,6 +369,38 @@ bool LoadWavFile(const std::string& filename,
     return true;
 }
 
+bool LoadWavFile(const std::string& filename,
+                 std::vector<int16_t>* samples,
+                 int32_t* sample_rate) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    WavHeader header;
+    uint32_t chunk_size = 0;
+    if (!SeekWavData(file, &header, &chunk_size) || header.bits_per_sample != 16) {
+        return false;
+    }
+
+    // Read interleaved data straight into the output, then compact the first
+    // channel in place
+    int32_t num_samples = chunk_size / sizeof(int16_t) / header.num_channels;
+    samples->resize(static_cast<size_t>(num_samples) * header.num_channels);
+    file.read(reinterpret_cast<char*>(samples->data()),
+              samples->size() * sizeof(int16_t));
+
+    if (header.num_channels > 1) {
+        for (int32_t i = 0; i < num_samples; ++i) {
+            (*samples)[i] = (*samples)[i * header.num_channels];
+        }
+        samples->resize(num_samples);
+    }
+
+    *sample_rate = static_cast<int32_t>(header.sample_rate);
+    return true;
+}
+
 bool LoadPcmFile(const std::string& filename,
                  std::vector<float>* samples,
                  int32_t expected_sample_rate) {
@@ -267,4 +428,25 @@ bool LoadPcmFile(const std::string& filename,
     return true;
 }
 
+bool LoadPcmFile(const std::string& filename,
+                 std::vector<int16_t>* samples,
+                 int32_t expected_sample_rate) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    samples->resize(static_cast<size_t>(size / sizeof(int16_t)));
+
+    if (!file.read(reinterpret_cast<char*>(samples->data()),
+                   samples->size() * sizeof(int16_t))) {
+        return false;
+    }
+
+    return true;
+}
+
 }  // namespace sensevoice
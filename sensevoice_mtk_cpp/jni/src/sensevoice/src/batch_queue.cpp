@@ -0,0 +1,139 @@
+/* Batch Queue Implementation
+ *
+ * Size/deadline flushing of queued recognition requests.
+ */
+
+#include "batch_queue.h"
+#include "common/Log.h"
+
+#include <algorithm>
+
+namespace sensevoice {
+
+BatchQueue::BatchQueue(int32_t max_requests, int32_t max_wait_ms, BatchFn run_batch)
+    : max_requests_(static_cast<size_t>(std::max(1, max_requests))),
+      max_wait_(std::max(0, max_wait_ms)),
+      run_batch_(std::move(run_batch)) {
+    worker_ = std::thread(&BatchQueue::WorkerLoop, this);
+}
+
+BatchQueue::~BatchQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+std::future<RecognitionResult> BatchQueue::Submit(std::vector<float> samples,
+                                                  Language language,
+                                                  TextNorm text_norm) {
+    BatchUtterance utterance;
+    utterance.samples = std::move(samples);
+    return Enqueue(std::move(utterance), language, text_norm);
+}
+
+std::future<RecognitionResult> BatchQueue::Submit(const int16_t* samples,
+                                                  size_t num_samples,
+                                                  Language language,
+                                                  TextNorm text_norm) {
+    BatchUtterance utterance;
+    utterance.pcm = samples;
+    utterance.num_pcm = num_samples;
+    return Enqueue(std::move(utterance), language, text_norm);
+}
+
+std::future<RecognitionResult> BatchQueue::Enqueue(BatchUtterance utterance,
+                                                   Language language,
+                                                   TextNorm text_norm) {
+    Request request;
+    request.utterance = std::move(utterance);
+    request.language = language;
+    request.text_norm = text_norm;
+    request.enqueue_time = std::chrono::steady_clock::now();
+    std::future<RecognitionResult> future = request.promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(request));
+        stats_.requests++;
+    }
+    cv_.notify_all();
+    return future;
+}
+
+BatchQueueStats BatchQueue::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+size_t BatchQueue::CountMatching(Language language, TextNorm text_norm) const {
+    size_t count = 0;
+    for (const Request& request : queue_) {
+        count += request.language == language && request.text_norm == text_norm;
+    }
+    return count;
+}
+
+void BatchQueue::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            break;  // stop_ with nothing left
+        }
+
+        // Wait for a full batch of requests with the oldest request's prompts,
+        // but not past its deadline; requests with other prompts do not count
+        const Language language = queue_.front().language;
+        const TextNorm text_norm = queue_.front().text_norm;
+        const auto deadline = queue_.front().enqueue_time + max_wait_;
+        cv_.wait_until(lock, deadline, [&] {
+            return stop_ || CountMatching(language, text_norm) >= max_requests_;
+        });
+
+        // Take up to max_requests of them, in arrival order
+        std::vector<Request> batch;
+        for (auto it = queue_.begin(); it != queue_.end() && batch.size() < max_requests_;) {
+            if (it->language == language && it->text_norm == text_norm) {
+                batch.push_back(std::move(*it));
+                it = queue_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        stats_.batches++;
+        if (batch.size() >= max_requests_) {
+            stats_.full_flushes++;
+        } else {
+            stats_.deadline_flushes++;
+        }
+        const BatchQueueStats stats = stats_;
+        lock.unlock();
+
+        auto waited_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - batch.front().enqueue_time).count();
+        LOG(INFO) << "BatchQueue: flushing " << batch.size() << "/" << max_requests_
+                  << " request(s) after " << waited_ms << " ms ("
+                  << stats.full_flushes << " full, " << stats.deadline_flushes << " deadline)";
+
+        std::vector<BatchUtterance> utterances;
+        utterances.reserve(batch.size());
+        for (auto& request : batch) {
+            utterances.push_back(std::move(request.utterance));
+        }
+
+        std::vector<RecognitionResult> results = run_batch_(utterances, language, text_norm);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            batch[i].promise.set_value(i < results.size() ? std::move(results[i]) : RecognitionResult());
+        }
+
+        lock.lock();
+    }
+}
+
+}  // namespace sensevoice
@@ -0,0 +1,149 @@
+/* SenseVoice Classification Benchmark - prompt-row readback vs full decode
+ *
+ * Usage: sensevoice_classify_bench <model.dla> <tokens.txt> [backend] [runs]
+ *
+ * Runs one full window per call, two ways:
+ *   full    - SenseVoiceModel::Run reads back all 170 x 25055 logits and
+ *             Tokenizer::Decode decodes them (what Recognize() does)
+ *   prompt  - SenseVoiceModel::RunPrompt reads back the 4 prompt rows and
+ *             Tokenizer::DecodePrompt takes language, emotion and event
+ * Reports the time per call and, with the host backend, the time left after
+ * the simulated NPU latency (readback + decode). Both must give the same
+ * language, emotion and event.
+ */
+
+#include "sensevoice.h"
+#include "bench_common.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+
+using sensevoice::bench::ParseBackend;
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedMs(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count() / 1000.0;
+}
+
+}  // namespace
+
+void PrintUsage(const char* program_name) {
+    std::cout << "SenseVoice Classification Benchmark\n\n";
+    std::cout << "Usage: " << program_name << " <model.dla> <tokens.txt> [backend] [runs]\n\n";
+    std::cout << "Arguments:\n";
+    std::cout << "  model.dla   Path to SenseVoice DLA model file, or a .svb bundle (tokens: -)\n";
+    std::cout << "  tokens.txt  Path to tokens file (tokens.txt or tokens.bin)\n";
+    std::cout << "  backend     usdk, runtime or host[:<latency_us>] (CPU stand-in, no NPU) (default: usdk)\n";
+    std::cout << "  runs        Calls per mode (default: 20)\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << program_name << " sensevoice.dla tokens.txt usdk 50\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    sensevoice::SenseVoiceConfig config;
+    config.model.model_path = argv[1];
+    config.model.tokens_path = argv[2];
+    if (argc > 3 && !ParseBackend(argv[3], &config.model)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    const int32_t runs = argc > 4 ? std::max(1, std::atoi(argv[4])) : 20;
+
+    sensevoice::SenseVoice sv;
+    if (!sv.Initialize(config)) {
+        LOG(ERROR) << "Failed to initialize SenseVoice";
+        return 1;
+    }
+    sensevoice::SenseVoiceModel* model = sv.GetModel();
+    sensevoice::Tokenizer* tokenizer = sv.GetTokenizer();
+    const int32_t frames = config.model.input_frames;
+    const int32_t vocab_size = config.model.vocab_size;
+    const int32_t row_width = model->RowWidth();  // 2k values per row for a top-k head
+
+    // A full window of feature-like values; ids in the first column give the
+    // host backend some tokens to emit
+    std::vector<float> features(static_cast<size_t>(frames) * config.model.input_feat_dim);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < features.size(); ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        features[i] = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 4.0f;
+    }
+    for (int32_t f = 0; f < frames; ++f) {
+        features[static_cast<size_t>(f) * config.model.input_feat_dim] = static_cast<float>(100 + f % 50);
+    }
+
+    // The model logs every run; keep the report readable
+    el::Loggers::reconfigureAllLoggers(el::Level::Info, el::ConfigurationType::Enabled, "false");
+
+    double full_ms = 0.0;
+    double prompt_ms = 0.0;
+    sensevoice::RecognitionResult full;
+    sensevoice::RecognitionResult prompt;
+    for (int32_t r = 0; r < runs; ++r) {
+        Clock::time_point start = Clock::now();
+        std::vector<float> bounds;
+        std::vector<float> logits = model->Run(features, frames, sensevoice::Language::Auto,
+                                               sensevoice::TextNorm::WithoutITN, &bounds);
+        if (logits.empty()) {
+            LOG(ERROR) << "Inference failed";
+            return 1;
+        }
+        const int32_t rows = static_cast<int32_t>(logits.size() / row_width);
+        full = model->TopK() > 0
+                   ? tokenizer->DecodeTopK(logits.data(), rows, model->TopK(), config.audio.frame_shift_ms,
+                                           config.model.lfr_window_shift)
+                   : tokenizer->Decode(logits.data(), rows, vocab_size, config.audio.frame_shift_ms,
+                                       config.model.lfr_window_shift, nullptr, bounds.data());
+        full_ms += ElapsedMs(start);
+
+        start = Clock::now();
+        logits = model->RunPrompt(features, frames);
+        if (logits.empty()) {
+            LOG(ERROR) << "Inference failed";
+            return 1;
+        }
+        prompt = model->TopK() > 0 ? tokenizer->DecodePromptTopK(logits.data(), model->TopK())
+                                   : tokenizer->DecodePrompt(logits.data(), vocab_size);
+        prompt_ms += ElapsedMs(start);
+    }
+    el::Loggers::reconfigureAllLoggers(el::Level::Info, el::ConfigurationType::Enabled, "true");
+    full_ms /= runs;
+    prompt_ms /= runs;
+
+    const double npu_ms = config.model.backend == sensevoice::ModelBackend::Host
+                              ? config.model.host_latency_us / 1000.0 : 0.0;
+    const size_t full_bytes = static_cast<size_t>(frames + sensevoice::SenseVoiceModel::kNumPromptTokens) *
+                              row_width * sizeof(float);
+    const size_t prompt_bytes = static_cast<size_t>(sensevoice::SenseVoiceModel::kNumPromptTokens) *
+                                row_width * sizeof(float);
+    std::cout << "full:   " << full_ms << " ms per call, readback " << full_bytes / 1024 << " KB";
+    if (npu_ms > 0.0) {
+        std::cout << ", " << full_ms - npu_ms << " ms after the NPU";
+    }
+    std::cout << "\nprompt: " << prompt_ms << " ms per call, readback " << prompt_bytes / 1024 << " KB";
+    if (npu_ms > 0.0) {
+        std::cout << ", " << prompt_ms - npu_ms << " ms after the NPU";
+    }
+    std::cout << "\n";
+
+    const bool same = full.language == prompt.language && full.emotion == prompt.emotion &&
+                      full.event == prompt.event;
+    std::cout << "metadata: " << prompt.language << " " << prompt.emotion << " " << prompt.event
+              << (same ? " (same as the full decode)" : " (DIFFERS from the full decode)") << "\n";
+    return same ? 0 : 1;
+}
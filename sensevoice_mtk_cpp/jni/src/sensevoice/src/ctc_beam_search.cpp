@@ -0,0 +1,374 @@
+/* CTC Prefix Beam Search Implementation
+ *
+ * Scores are raw logits minus the frame maximum. Every hypothesis consumes
+ * every frame, so the per-frame softmax normalizer is shared by all of them
+ * and dropping it leaves the ranking unchanged; only the vocabulary scan for
+ * the frame best and the candidates is left per frame. With the block maxima
+ * taken on readback that scan reads only the blocks within the prune
+ * threshold of the best. Top-k rows carry log-probs already and only their
+ * k entries are looked at.
+ */
+
+#include "ctc_beam_search.h"
+#include "ctc_math.h"
+#include "hotwords.h"
+#include "tokenizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace sensevoice {
+
+namespace {
+
+constexpr float kNegInf = -std::numeric_limits<float>::infinity();
+
+// log(exp(a) + exp(b))
+inline float LogAdd(float a, float b) {
+    if (a < b) {
+        std::swap(a, b);
+    }
+    if (b == kNegInf) {
+        return a;
+    }
+    return a + std::log1p(std::exp(b - a));
+}
+
+// Keep the k largest values seen in *top, in descending order
+inline void KeepLargest(std::vector<float>* top, size_t k, float x) {
+    if (top->size() == k) {
+        if (x <= top->back()) {
+            return;
+        }
+        top->pop_back();
+    }
+    top->insert(std::upper_bound(top->begin(), top->end(), x, std::greater<float>()), x);
+}
+
+}  // namespace
+
+int32_t PrefixBeamSearch::NewNode(int32_t parent, int32_t token, int32_t frame) {
+    Node node;
+    node.parent = parent;
+    node.token = token;
+    node.frame = frame;
+    node.first_child = -1;
+    node.next_sibling = -1;
+    node.stamp = -1;
+    node.context_state = HotwordGraph::kRoot;
+    node.context_score = 0.0f;
+    node.lm_score = 0.0f;
+    node.blank = kNegInf;
+    node.non_blank = kNegInf;
+    node.next_blank = kNegInf;
+    node.next_non_blank = kNegInf;
+    nodes_.push_back(node);
+    if (lm_) {
+        lm_states_.emplace_back();
+    }
+    return static_cast<int32_t>(nodes_.size() - 1);
+}
+
+int32_t PrefixBeamSearch::Child(int32_t parent, int32_t token, int32_t frame) {
+    for (int32_t c = nodes_[parent].first_child; c >= 0; c = nodes_[c].next_sibling) {
+        if (nodes_[c].token == token) {
+            return c;
+        }
+    }
+    int32_t child = NewNode(parent, token, frame);
+    nodes_[child].next_sibling = nodes_[parent].first_child;
+    nodes_[parent].first_child = child;
+    if (hotwords_) {
+        // The bonus depends only on the prefix, so it is settled once per node
+        uint32_t state = HotwordGraph::kRoot;
+        float delta = hotwords_->Advance(nodes_[parent].context_state, token, &state);
+        nodes_[child].context_state = state;
+        nodes_[child].context_score = nodes_[parent].context_score + delta;
+    }
+    if (lm_) {
+        // Tokens outside the LM (prompt tokens) pass through unscored
+        const NgramLm::State parent_state = lm_states_[parent];
+        float delta = 0.0f;
+        if (lm_->Contains(token)) {
+            delta = lm_weight_ * lm_->Score(parent_state, token, &lm_states_[child]) + lm_token_bonus_;
+        } else {
+            lm_states_[child] = parent_state;
+        }
+        nodes_[child].lm_score = nodes_[parent].lm_score + delta;
+    }
+    return child;
+}
+
+void PrefixBeamSearch::Touch(int32_t node, int32_t t) {
+    Node& n = nodes_[node];
+    if (n.stamp != t) {
+        n.stamp = t;
+        n.next_blank = kNegInf;
+        n.next_non_blank = kNegInf;
+        touched_.push_back(node);
+    }
+}
+
+void PrefixBeamSearch::SelectCandidates(const float* frame_logits, const float* frame_block_max,
+                                        int32_t vocab_size, int64_t blank_id,
+                                        const BeamSearchOptions& options,
+                                        const std::vector<TokenRange>* allowed_tokens) {
+    // Two vectorized passes: the frame best, then the blocks that reach the
+    // cut below it (the row is still in cache for the second). With block
+    // maxima both passes run over them, and only blocks over the cut are read
+    const size_t top_k = static_cast<size_t>(std::max(options.top_k, 1));
+    const int32_t blank = static_cast<int32_t>(blank_id);
+    auto for_each_range = [&](auto scan) {
+        if (allowed_tokens) {
+            for (const TokenRange& range : *allowed_tokens) {
+                scan(std::max(range.begin, 0), std::min(range.end, vocab_size));
+            }
+        } else {
+            scan(0, vocab_size);
+        }
+    };
+    float best = kNegInf;
+    float floor = kNegInf;
+    if (frame_block_max) {
+        for_each_range([&](int32_t begin, int32_t end) {
+            best = BlockRowMax(frame_logits, frame_block_max, vocab_size, blank, begin, end, best);
+        });
+        // Each block maximum is a distinct non-blank token, so the top_k
+        // candidates all reach the top_k-th largest maximum of the whole blocks
+        block_top_.clear();
+        for_each_range([&](int32_t begin, int32_t end) {
+            const MaxBlockSpan span = SplitMaxBlocks(vocab_size, begin, end);
+            RowAtLeast(frame_block_max, span.first, span.last, best - options.prune_threshold,
+                       [&](int32_t, float x) { KeepLargest(&block_top_, top_k, x); });
+        });
+        if (block_top_.size() == top_k) {
+            floor = block_top_.back();
+        }
+    } else {
+        for_each_range([&](int32_t begin, int32_t end) { best = RowMax(frame_logits, begin, end, best); });
+    }
+    const float cut = std::max(best - options.prune_threshold, floor);
+    candidates_.clear();
+    auto keep = [&](int32_t v, float x) {
+        if (v != blank_id) {
+            candidates_.push_back({v, x - best});
+        }
+    };
+    for_each_range([&](int32_t begin, int32_t end) {
+        if (frame_block_max) {
+            BlockRowAtLeast(frame_logits, frame_block_max, vocab_size, blank, begin, end, cut, keep);
+        } else {
+            RowAtLeast(frame_logits, begin, end, cut, keep);
+        }
+    });
+
+    if (candidates_.size() > top_k) {
+        std::nth_element(candidates_.begin(), candidates_.begin() + (top_k - 1), candidates_.end(),
+                         [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+        candidates_.resize(top_k);
+    }
+
+    // Blank is always expanded so every hypothesis survives the frame
+    blank_score_ = (blank_id >= 0 && blank_id < vocab_size) ? frame_logits[blank_id] - best : kNegInf;
+}
+
+void PrefixBeamSearch::SelectTopKCandidates(const float* row, int32_t k, int64_t blank_id,
+                                            const BeamSearchOptions& options,
+                                            const std::vector<TokenRange>* allowed_tokens) {
+    // The row holds log-probs, so blank is scored even when it missed the k
+    const int32_t blank_entry = TopKFind(row, k, static_cast<int32_t>(blank_id));
+    const float blank = blank_entry >= 0 ? row[blank_entry] : TopKTailBound(row, k);
+    float best = blank;
+    candidates_.clear();
+    for (int32_t i = 0; i < k; ++i) {
+        const int32_t id = TopKId(row, k, i);
+        if (id == blank_id || id < 0) {
+            continue;
+        }
+        if (allowed_tokens && std::none_of(allowed_tokens->begin(), allowed_tokens->end(),
+                                           [id](const TokenRange& range) { return range.Contains(id); })) {
+            continue;
+        }
+        best = std::max(best, row[i]);
+        candidates_.push_back({id, row[i]});
+    }
+    const float cut = best - options.prune_threshold;
+    size_t kept = 0;
+    for (const Candidate& c : candidates_) {
+        if (c.score >= cut) {
+            candidates_[kept++] = {c.token, c.score - best};
+        }
+    }
+    candidates_.resize(kept);
+
+    const size_t top_k = static_cast<size_t>(std::max(options.top_k, 1));
+    if (candidates_.size() > top_k) {
+        std::nth_element(candidates_.begin(), candidates_.begin() + (top_k - 1), candidates_.end(),
+                         [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+        candidates_.resize(top_k);
+    }
+    blank_score_ = blank - best;
+}
+
+void PrefixBeamSearch::Search(const float* logits,
+                              int32_t num_frames,
+                              int32_t vocab_size,
+                              int64_t blank_id,
+                              const BeamSearchOptions& options,
+                              const HotwordGraph* hotwords,
+                              const NgramLm* lm,
+                              CTCDecoderResult* result,
+                              const std::vector<TokenRange>* allowed_tokens,
+                              const float* block_max) {
+    Run(logits, num_frames, vocab_size, 0, blank_id, options, hotwords, lm, result, allowed_tokens, block_max);
+}
+
+void PrefixBeamSearch::SearchTopK(const float* rows,
+                                  int32_t num_frames,
+                                  int32_t k,
+                                  int64_t blank_id,
+                                  const BeamSearchOptions& options,
+                                  const HotwordGraph* hotwords,
+                                  const NgramLm* lm,
+                                  CTCDecoderResult* result,
+                                  const std::vector<TokenRange>* allowed_tokens) {
+    Run(rows, num_frames, 2 * k, k, blank_id, options, hotwords, lm, result, allowed_tokens, nullptr);
+}
+
+void PrefixBeamSearch::Run(const float* rows, int32_t num_frames, int32_t row_width, int32_t top_k,
+                           int64_t blank_id, const BeamSearchOptions& options, const HotwordGraph* hotwords,
+                           const NgramLm* lm, CTCDecoderResult* result,
+                           const std::vector<TokenRange>* allowed_tokens, const float* block_max) {
+    result->token_ids.clear();
+    result->frame_indices.clear();
+    if (rows == nullptr || num_frames <= 0 || row_width <= 0) {
+        return;
+    }
+
+    const size_t beam_size = static_cast<size_t>(std::max(options.beam_size, 1));
+    hotwords_ = (hotwords && !hotwords->Empty()) ? hotwords : nullptr;
+    lm_ = lm;
+    lm_weight_ = options.lm_weight;
+    lm_token_bonus_ = options.lm_token_bonus;
+    nodes_.clear();
+    nodes_.reserve(static_cast<size_t>(num_frames) * beam_size * 2 + 1);
+    lm_states_.clear();
+    beam_.clear();
+
+    profile_ = Profile();
+    using ProfileClock = std::chrono::steady_clock;
+    auto elapsed_ms = [](ProfileClock::time_point from, ProfileClock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    ProfileClock::time_point mark;
+
+    const int32_t root = NewNode(-1, -1, -1);
+    nodes_[root].blank = 0.0f;
+    if (lm_) {
+        lm_states_[root] = lm_->BeginState();
+    }
+    beam_.push_back(root);
+
+    // Ranking score: acoustic score plus the hotword bonus and LM score of the prefix
+    auto total = [this](int32_t n) {
+        return LogAdd(nodes_[n].blank, nodes_[n].non_blank) + nodes_[n].context_score +
+               nodes_[n].lm_score;
+    };
+
+    for (int32_t t = 0; t < num_frames; ++t) {
+        if (profile_enabled_) {
+            mark = ProfileClock::now();
+        }
+        const float* row = rows + static_cast<size_t>(t) * row_width;
+        if (top_k > 0) {
+            SelectTopKCandidates(row, top_k, blank_id, options, allowed_tokens);
+        } else {
+            const float* frame_block_max =
+                block_max ? block_max + static_cast<size_t>(t) * NumMaxBlocks(row_width) : nullptr;
+            SelectCandidates(row, frame_block_max, row_width, blank_id, options, allowed_tokens);
+        }
+        if (profile_enabled_) {
+            const ProfileClock::time_point now = ProfileClock::now();
+            profile_.scan_ms += elapsed_ms(mark, now);
+            mark = now;
+        }
+
+        touched_.clear();
+        for (int32_t n : beam_) {
+            // Copy out: Child() may grow the pool and move the nodes
+            const float p_blank = nodes_[n].blank;
+            const float p_non_blank = nodes_[n].non_blank;
+            const float p_total = LogAdd(p_blank, p_non_blank);
+            const int32_t last = nodes_[n].token;
+
+            Touch(n, t);
+            nodes_[n].next_blank = LogAdd(nodes_[n].next_blank, p_total + blank_score_);
+
+            for (const Candidate& c : candidates_) {
+                if (c.token == last) {
+                    // Repeat collapses into the same prefix; a new copy of
+                    // the token needs a blank in between
+                    nodes_[n].next_non_blank = LogAdd(nodes_[n].next_non_blank, p_non_blank + c.score);
+                    if (p_blank == kNegInf) {
+                        continue;
+                    }
+                    const int32_t child = Child(n, c.token, t);
+                    Touch(child, t);
+                    nodes_[child].next_non_blank = LogAdd(nodes_[child].next_non_blank, p_blank + c.score);
+                } else {
+                    const int32_t child = Child(n, c.token, t);
+                    Touch(child, t);
+                    nodes_[child].next_non_blank = LogAdd(nodes_[child].next_non_blank, p_total + c.score);
+                }
+            }
+        }
+
+        for (int32_t n : touched_) {
+            nodes_[n].blank = nodes_[n].next_blank;
+            nodes_[n].non_blank = nodes_[n].next_non_blank;
+        }
+
+        beam_.swap(touched_);
+        if (beam_.size() > beam_size) {
+            std::nth_element(beam_.begin(), beam_.begin() + (beam_size - 1), beam_.end(),
+                             [&](int32_t a, int32_t b) { return total(a) > total(b); });
+            beam_.resize(beam_size);
+        }
+        if (profile_enabled_) {
+            profile_.trie_ms += elapsed_ms(mark, ProfileClock::now());
+        }
+    }
+
+    // A hotword left half-matched at the end does not keep its bonus;
+    // the LM scores the end of the sentence
+    auto final_score = [&](int32_t n) {
+        float score = total(n);
+        if (hotwords_) {
+            score -= hotwords_->PendingScore(nodes_[n].context_state);
+        }
+        if (lm_) {
+            score += lm_weight_ * lm_->FinalScore(lm_states_[n]);
+        }
+        return score;
+    };
+    int32_t best = beam_[0];
+    for (int32_t n : beam_) {
+        if (final_score(n) > final_score(best)) {
+            best = n;
+        }
+    }
+    hotwords_ = nullptr;
+    lm_ = nullptr;
+
+    for (int32_t n = best; nodes_[n].parent >= 0; n = nodes_[n].parent) {
+        result->token_ids.push_back(nodes_[n].token);
+        result->frame_indices.push_back(nodes_[n].frame);
+    }
+    std::reverse(result->token_ids.begin(), result->token_ids.end());
+    std::reverse(result->frame_indices.begin(), result->frame_indices.end());
+}
+
+}  // namespace sensevoice
@@ -0,0 +1,533 @@
+/* SenseVoice Decode Benchmark - greedy vs prefix beam search
+ *
+ * Usage: sensevoice_decode_bench <tokens.txt> <list.txt> [beam_sizes] [hotwords.txt] [lm.svlm] [language]
+ *
+ * list.txt has one utterance per line: "<logits.bin>\t<reference text>"
+ * logits.bin is raw float32 [num_frames, vocab_size] model output
+ * (numpy: logits.astype(np.float32).tofile(path)), prompt rows included.
+ * beam_sizes is a comma separated list (default: 4,8,16).
+ * hotwords.txt (HotwordGraph::Load format) biases the beam search runs, "-" for none.
+ * With lm.svlm ("-" for none) every beam size runs once without and once with LM fusion.
+ * With a language (zh, en, yue, ja, ko) greedy and every beam size run again
+ * on that language's tokens only (Tokenizer::LanguageTokens).
+ * The "argmax only" row is the bare per-frame argmax, the floor that greedy
+ * decoding with token confidences is measured against. "greedy + blank skip"
+ * decodes with the block maxima that SenseVoiceModel records while reading
+ * the logits out (CopyRowBlockMax). The readback rows time that copy against
+ * a memcpy, and readback and greedy decoding together, the way
+ * SenseVoiceModel runs them (one copy out of the output tensor either way):
+ * memcpy + full scan vs block-max copy + blank skip.
+ * The fp16 rows round the logits to IEEE halves, as an _fp16out DLA returns
+ * them, and decode them in place: readback bytes, copy and greedy time, and
+ * the tokens and confidences that change against the float32 greedy search.
+ * The top-k rows keep the k best log-probs and their ids per frame, as a
+ * _top<k> DLA returns them, and decode them in place (Tokenizer::*TopK):
+ * readback bytes, greedy and beam search (beam 8) time, and the results
+ * that change against the full logits.
+ * The beam rows decode with the block maxima, as SenseVoice does for beam
+ * search; each beam size is also split into the per-frame candidate scan
+ * (with and without the block maxima) and the prefix trie bookkeeping
+ * (PrefixBeamSearch profile, no hotwords or LM). The rest of the beam time
+ * normalizes the emitting frames for the token posteriors.
+ */
+
+#include "tokenizer.h"
+#include "ctc_beam_search.h"
+#include "ctc_math.h"
+#include "bench_common.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+
+using sensevoice::bench::LoadLogits;
+
+struct Utterance {
+    std::vector<float> logits;
+    int32_t num_frames = 0;
+    std::string reference;
+    std::vector<float> block_max;  // Block maxima per frame (CopyRowBlockMax)
+};
+
+// Scoring units: whitespace separated words, each CJK (multi-byte) character on its own
+std::vector<std::string> SplitUnits(const std::string& text) {
+    std::vector<std::string> units;
+    std::string word;
+    for (size_t i = 0; i < text.size();) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            if (std::isspace(c) || std::ispunct(c)) {
+                if (!word.empty()) units.push_back(word);
+                word.clear();
+            } else {
+                word += static_cast<char>(std::tolower(c));
+            }
+            ++i;
+            continue;
+        }
+        size_t len = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : 2;
+        if (!word.empty()) units.push_back(word);
+        word.clear();
+        units.push_back(text.substr(i, len));
+        i += len;
+    }
+    if (!word.empty()) units.push_back(word);
+    return units;
+}
+
+size_t EditDistance(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+    std::vector<size_t> row(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); ++j) row[j] = j;
+    for (size_t i = 1; i <= a.size(); ++i) {
+        size_t diag = row[0];
+        row[0] = i;
+        for (size_t j = 1; j <= b.size(); ++j) {
+            size_t up = row[j];
+            row[j] = std::min({row[j] + 1, row[j - 1] + 1, diag + (a[i - 1] == b[j - 1] ? 0 : 1)});
+            diag = up;
+        }
+    }
+    return row[b.size()];
+}
+
+// Copy all rows of an utterance out, recording their block maxima
+void CopyBlockMax(const Utterance& utt, int32_t vocab_size, int32_t blank_id, float* copy,
+                  std::vector<float>* block_max) {
+    const size_t blocks = sensevoice::NumMaxBlocks(vocab_size);
+    block_max->resize(utt.num_frames * blocks);
+    for (int32_t t = 0; t < utt.num_frames; ++t) {
+        const size_t offset = static_cast<size_t>(t) * vocab_size;
+        sensevoice::CopyRowBlockMax(utt.logits.data() + offset, vocab_size, blank_id, copy + offset,
+                                    block_max->data() + t * blocks);
+    }
+}
+
+// Readback alone (memcpy vs the copy that records the block maxima), and
+// readback + greedy decode end to end: memcpy and a full scan, vs the
+// block-max copy and the greedy search that skips on them (fills utt.block_max)
+void RunReadback(const sensevoice::Tokenizer& tokenizer, std::vector<Utterance>* utterances,
+                 int32_t vocab_size) {
+    double copy_ms = 0.0;
+    double block_copy_ms = 0.0;
+    double memcpy_ms = 0.0;
+    double block_ms = 0.0;
+    size_t frames = 0;
+    size_t skipped = 0;
+    const int32_t blank_id = static_cast<int32_t>(tokenizer.BlankId());
+    const size_t blocks = sensevoice::NumMaxBlocks(vocab_size);
+    auto ms = [](std::chrono::high_resolution_clock::time_point from,
+                 std::chrono::high_resolution_clock::time_point to) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count() / 1000.0;
+    };
+    for (auto& utt : *utterances) {
+        std::vector<float> copy(utt.logits.size());
+        auto start = std::chrono::high_resolution_clock::now();
+        std::memcpy(copy.data(), utt.logits.data(), utt.logits.size() * sizeof(float));
+        auto mid = std::chrono::high_resolution_clock::now();
+        CopyBlockMax(utt, vocab_size, blank_id, copy.data(), &utt.block_max);
+        auto end = std::chrono::high_resolution_clock::now();
+        copy_ms += ms(start, mid);
+        block_copy_ms += ms(mid, end);
+
+        start = std::chrono::high_resolution_clock::now();
+        std::memcpy(copy.data(), utt.logits.data(), utt.logits.size() * sizeof(float));
+        tokenizer.CTCGreedySearch(copy.data(), utt.num_frames, vocab_size);
+        mid = std::chrono::high_resolution_clock::now();
+        CopyBlockMax(utt, vocab_size, blank_id, copy.data(), &utt.block_max);
+        tokenizer.CTCGreedySearch(copy.data(), utt.num_frames, vocab_size, utt.block_max.data());
+        end = std::chrono::high_resolution_clock::now();
+        memcpy_ms += ms(start, mid);
+        block_ms += ms(mid, end);
+
+        for (int32_t t = 0; t < utt.num_frames; ++t) {
+            const float bound = sensevoice::RowMax(utt.block_max.data() + t * blocks, 0,
+                                                   static_cast<int32_t>(blocks),
+                                                   -std::numeric_limits<float>::infinity());
+            skipped += utt.logits[static_cast<size_t>(t) * vocab_size + blank_id] > bound;
+        }
+        frames += utt.num_frames;
+    }
+    const size_t n = utterances->size();
+    std::cout << "readback: memcpy " << copy_ms / n << " ms/utt, copy with block maxima "
+              << block_copy_ms / n << " ms/utt\n";
+    std::cout << "readback + greedy: memcpy + full scan " << memcpy_ms / n
+              << " ms/utt, block-max copy + blank skip " << block_ms / n << " ms/utt; "
+              << 100.0 * skipped / frames << "% frames settled as blank\n";
+}
+
+// Per-frame argmax alone, without the normalizer, collapse or text
+void RunArgmax(const sensevoice::Tokenizer& tokenizer, const std::vector<Utterance>& utterances,
+               int32_t vocab_size) {
+    double total_ms = 0.0;
+    size_t frames = 0;
+    size_t blank_frames = 0;
+    for (const auto& utt : utterances) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int32_t t = 0; t < utt.num_frames; ++t) {
+            float max_val;
+            int32_t id = sensevoice::RowArgmax(utt.logits.data() + static_cast<size_t>(t) * vocab_size,
+                                               vocab_size, &max_val);
+            blank_frames += (id == tokenizer.BlankId());
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        total_ms += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+        frames += utt.num_frames;
+    }
+    std::cout << "argmax only: " << total_ms / utterances.size() << " ms/utt, "
+              << 100.0 * blank_frames / frames << "% blank frames\n";
+}
+
+// fp16 logits (rounded from the float32 ones): half the readback bytes, and
+// the greedy search on the half rows against the float32 one
+void RunHalfPrecision(const sensevoice::Tokenizer& tokenizer, const std::vector<Utterance>& utterances,
+                      int32_t vocab_size) {
+    double copy_ms = 0.0;
+    double greedy_ms = 0.0;
+    double skip_ms = 0.0;
+    size_t bytes = 0;
+    size_t errors = 0;
+    size_t ref_units = 0;
+    size_t changed_utts = 0;
+    size_t changed_tokens = 0;
+    size_t tokens = 0;
+    double confidence_delta = 0.0;
+    size_t compared = 0;
+    const int32_t blank_id = static_cast<int32_t>(tokenizer.BlankId());
+    for (const auto& utt : utterances) {
+        std::vector<uint16_t> half(utt.logits.size());
+        for (size_t i = 0; i < half.size(); ++i) {
+            half[i] = sensevoice::FloatToHalf(utt.logits[i]);
+        }
+        bytes += half.size() * sizeof(uint16_t);
+
+        // Readback of the half rows with their block maxima
+        std::vector<uint16_t> copy(half.size());
+        const size_t blocks = sensevoice::NumMaxBlocks(vocab_size);
+        std::vector<float> block_max(utt.num_frames * blocks);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int32_t t = 0; t < utt.num_frames; ++t) {
+            const size_t offset = static_cast<size_t>(t) * vocab_size;
+            sensevoice::CopyRowBlockMax(half.data() + offset, vocab_size, blank_id, copy.data() + offset,
+                                        block_max.data() + t * blocks);
+        }
+        auto mid = std::chrono::high_resolution_clock::now();
+        sensevoice::CTCDecoderResult ctc = tokenizer.CTCGreedySearch(copy.data(), utt.num_frames, vocab_size);
+        auto mid2 = std::chrono::high_resolution_clock::now();
+        tokenizer.CTCGreedySearch(copy.data(), utt.num_frames, vocab_size, block_max.data());
+        auto end = std::chrono::high_resolution_clock::now();
+        copy_ms += std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count() / 1000.0;
+        greedy_ms += std::chrono::duration_cast<std::chrono::microseconds>(mid2 - mid).count() / 1000.0;
+        skip_ms += std::chrono::duration_cast<std::chrono::microseconds>(end - mid2).count() / 1000.0;
+
+        sensevoice::RecognitionResult result = tokenizer.ConvertResult(ctc);
+        std::vector<std::string> ref = SplitUnits(utt.reference);
+        errors += EditDistance(SplitUnits(result.text), ref);
+        ref_units += ref.size();
+
+        // Accuracy delta against the float32 search on the same utterance
+        sensevoice::CTCDecoderResult ref_ctc = tokenizer.CTCGreedySearch(utt.logits.data(), utt.num_frames,
+                                                                         vocab_size);
+        changed_utts += ctc.token_ids != ref_ctc.token_ids;
+        const size_t common = std::min(ctc.token_ids.size(), ref_ctc.token_ids.size());
+        changed_tokens += std::max(ctc.token_ids.size(), ref_ctc.token_ids.size()) - common;
+        for (size_t i = 0; i < common; ++i) {
+            changed_tokens += ctc.token_ids[i] != ref_ctc.token_ids[i];
+            if (i < ctc.log_probs.size() && i < ref_ctc.log_probs.size()) {
+                confidence_delta += std::abs(ctc.log_probs[i] - ref_ctc.log_probs[i]);
+                ++compared;
+            }
+        }
+        tokens += ref_ctc.token_ids.size();
+    }
+    const size_t n = utterances.size();
+    std::cout << "fp16 readback: " << bytes / n / 1024 << " KiB/utt (float32 " << 2 * bytes / n / 1024
+              << " KiB), copy with block maxima " << copy_ms / n << " ms/utt\n";
+    std::cout << "fp16 greedy: " << greedy_ms / n << " ms/utt, + blank skip " << skip_ms / n << " ms/utt";
+    if (ref_units > 0) {
+        std::cout << ", error rate " << 100.0 * errors / ref_units << "% (" << errors << "/" << ref_units << ")";
+    }
+    std::cout << "\n";
+    std::cout << "fp16 vs float32 greedy: " << changed_utts << "/" << n << " utterances differ, "
+              << changed_tokens << "/" << tokens << " tokens changed, mean |log-posterior delta| "
+              << (compared > 0 ? confidence_delta / compared : 0.0) << "\n";
+}
+
+// Tokens and log-posteriors of a search that differ from the reference search
+struct ResultDelta {
+    size_t changed_utts = 0;
+    size_t changed_tokens = 0;
+    size_t tokens = 0;
+    double confidence_delta = 0.0;
+    size_t compared = 0;
+
+    void Add(const sensevoice::CTCDecoderResult& ctc, const sensevoice::CTCDecoderResult& ref) {
+        changed_utts += ctc.token_ids != ref.token_ids;
+        const size_t common = std::min(ctc.token_ids.size(), ref.token_ids.size());
+        changed_tokens += std::max(ctc.token_ids.size(), ref.token_ids.size()) - common;
+        for (size_t i = 0; i < common; ++i) {
+            changed_tokens += ctc.token_ids[i] != ref.token_ids[i];
+            if (i < ctc.log_probs.size() && i < ref.log_probs.size()) {
+                confidence_delta += std::abs(ctc.log_probs[i] - ref.log_probs[i]);
+                ++compared;
+            }
+        }
+        tokens += ref.token_ids.size();
+    }
+};
+
+// Top-k head: each frame reduced to its k best log-probs and their ids on the
+// "device", then decoded straight from those rows
+void RunTopK(const sensevoice::Tokenizer& tokenizer, const std::vector<Utterance>& utterances,
+             int32_t vocab_size, int32_t k) {
+    sensevoice::BeamSearchOptions options;
+    options.lm_weight = 0.0f;
+    double greedy_ms = 0.0;
+    double beam_ms = 0.0;
+    size_t bytes = 0;
+    ResultDelta greedy_delta;
+    ResultDelta beam_delta;
+    std::vector<float> log_probs(vocab_size);
+    std::vector<int32_t> order(vocab_size);
+    for (const auto& utt : utterances) {
+        const size_t width = 2 * static_cast<size_t>(k);
+        std::vector<float> top_k(static_cast<size_t>(utt.num_frames) * width);
+        for (int32_t t = 0; t < utt.num_frames; ++t) {
+            sensevoice::LogSoftmax(utt.logits.data() + static_cast<size_t>(t) * vocab_size, vocab_size,
+                                   log_probs.data());
+            for (int32_t v = 0; v < vocab_size; ++v) {
+                order[v] = v;
+            }
+            std::partial_sort(order.begin(), order.begin() + k, order.end(),
+                              [&](int32_t a, int32_t b) { return log_probs[a] > log_probs[b]; });
+            float* row = top_k.data() + t * width;
+            for (int32_t i = 0; i < k; ++i) {
+                row[i] = log_probs[order[i]];
+                row[k + i] = static_cast<float>(order[i]);
+            }
+        }
+        bytes += top_k.size() * sizeof(float);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        sensevoice::CTCDecoderResult greedy = tokenizer.CTCGreedySearchTopK(top_k.data(), utt.num_frames, k);
+        auto mid = std::chrono::high_resolution_clock::now();
+        sensevoice::CTCDecoderResult beam =
+            tokenizer.CTCPrefixBeamSearchTopK(top_k.data(), utt.num_frames, k, options);
+        auto end = std::chrono::high_resolution_clock::now();
+        greedy_ms += std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count() / 1000.0;
+        beam_ms += std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count() / 1000.0;
+
+        greedy_delta.Add(greedy, tokenizer.CTCGreedySearch(utt.logits.data(), utt.num_frames, vocab_size));
+        beam_delta.Add(beam, tokenizer.CTCPrefixBeamSearch(utt.logits.data(), utt.num_frames, vocab_size, options));
+    }
+    const size_t n = utterances.size();
+    std::cout << "top-" << k << " readback: " << bytes / n << " bytes/utt, greedy " << greedy_ms / n
+              << " ms/utt, beam 8 " << beam_ms / n << " ms/utt\n";
+    for (const auto* delta : {&greedy_delta, &beam_delta}) {
+        std::cout << "  " << (delta == &greedy_delta ? "greedy" : "beam 8") << " vs full logits: "
+                  << delta->changed_utts << "/" << n << " utterances differ, " << delta->changed_tokens
+                  << "/" << delta->tokens << " tokens changed, mean |log-posterior delta| "
+                  << (delta->compared > 0 ? delta->confidence_delta / delta->compared : 0.0) << "\n";
+    }
+}
+
+sensevoice::Language ParseLanguage(const std::string& lang_str) {
+    if (lang_str == "zh") return sensevoice::Language::Chinese;
+    if (lang_str == "en") return sensevoice::Language::English;
+    if (lang_str == "yue") return sensevoice::Language::Cantonese;
+    if (lang_str == "ja") return sensevoice::Language::Japanese;
+    if (lang_str == "ko") return sensevoice::Language::Korean;
+    return sensevoice::Language::Auto;
+}
+
+// Beam search time split into the candidate scan (with the block maxima, and
+// over the full rows) and the trie bookkeeping
+void RunBeamProfile(const sensevoice::Tokenizer& tokenizer, const std::vector<Utterance>& utterances,
+                    int32_t vocab_size, const sensevoice::BeamSearchOptions& options) {
+    sensevoice::PrefixBeamSearch search;
+    search.EnableProfile(true);
+    double scan_ms = 0.0;
+    double full_scan_ms = 0.0;
+    double trie_ms = 0.0;
+    size_t nodes = 0;
+    for (const auto& utt : utterances) {
+        sensevoice::CTCDecoderResult ctc;
+        search.Search(utt.logits.data(), utt.num_frames, vocab_size, tokenizer.BlankId(), options,
+                      nullptr, nullptr, &ctc, nullptr, utt.block_max.data());
+        scan_ms += search.LastProfile().scan_ms;
+        trie_ms += search.LastProfile().trie_ms;
+        nodes += search.NumNodes();
+        search.Search(utt.logits.data(), utt.num_frames, vocab_size, tokenizer.BlankId(), options,
+                      nullptr, nullptr, &ctc);
+        full_scan_ms += search.LastProfile().scan_ms;
+    }
+    const size_t n = utterances.size();
+    std::cout << "  beam " << options.beam_size << " split: candidate scan " << scan_ms / n
+              << " ms/utt (full rows " << full_scan_ms / n << " ms/utt), trie bookkeeping " << trie_ms / n
+              << " ms/utt (" << nodes / n << " nodes/utt)\n";
+}
+
+// Decode every utterance and print the mean decode time, error rate and confidence
+void Run(const sensevoice::Tokenizer& tokenizer, const std::vector<Utterance>& utterances,
+         int32_t vocab_size, int32_t beam_size, const sensevoice::BeamSearchOptions& options,
+         const sensevoice::HotwordGraph* hotwords, bool blank_skip = false,
+         const std::vector<sensevoice::TokenRange>* allowed_tokens = nullptr,
+         const std::string& language = "") {
+    double total_ms = 0.0;
+    size_t errors = 0;
+    size_t ref_units = 0;
+    double confidence = 0.0;
+    for (const auto& utt : utterances) {
+        auto start = std::chrono::high_resolution_clock::now();
+        sensevoice::CTCDecoderResult ctc;
+        if (beam_size > 0) {
+            ctc = tokenizer.CTCPrefixBeamSearch(utt.logits.data(), utt.num_frames, vocab_size, options,
+                                                hotwords, allowed_tokens, utt.block_max.data());
+        } else {
+            ctc = tokenizer.CTCGreedySearch(utt.logits.data(), utt.num_frames, vocab_size,
+                                            blank_skip ? utt.block_max.data() : nullptr, allowed_tokens);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        total_ms += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+
+        sensevoice::RecognitionResult result = tokenizer.ConvertResult(ctc);
+        std::vector<std::string> ref = SplitUnits(utt.reference);
+        errors += EditDistance(SplitUnits(result.text), ref);
+        ref_units += ref.size();
+        confidence += result.confidence;
+    }
+
+    std::string name = beam_size > 0 ? "beam " + std::to_string(beam_size)
+                                     : blank_skip ? "greedy + blank skip" : "greedy";
+    if (beam_size > 0 && options.lm_weight != 0.0f && tokenizer.LanguageModel()) {
+        name += " + LM";
+    }
+    if (allowed_tokens) {
+        name += " + " + language + " vocab";
+    }
+    std::cout << name << ": " << total_ms / utterances.size() << " ms/utt";
+    if (ref_units > 0) {
+        std::cout << ", error rate " << 100.0 * errors / ref_units << "% ("
+                  << errors << "/" << ref_units << ")";
+    }
+    std::cout << ", mean confidence " << confidence / utterances.size() << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0]
+                  << " <tokens.txt> <list.txt> [beam_sizes] [hotwords.txt] [lm.svlm] [language]\n\n";
+        std::cout << "  list.txt     One utterance per line: <logits.bin>\\t<reference text>\n";
+        std::cout << "               (logits.bin: raw float32 [frames, vocab_size])\n";
+        std::cout << "  beam_sizes   Comma separated beam sizes (default: 4,8,16)\n";
+        std::cout << "  hotwords.txt Hotword list applied to the beam search runs (\"-\" for none)\n";
+        std::cout << "  lm.svlm      N-gram LM (arpa2lm.py); beam runs are repeated with LM fusion (\"-\" for none)\n";
+        std::cout << "  language     zh, en, yue, ja or ko; runs are repeated on that language's tokens\n";
+        return 1;
+    }
+
+    sensevoice::Tokenizer tokenizer;
+    if (!tokenizer.Load(argv[1])) {
+        LOG(ERROR) << "Failed to load tokens from: " << argv[1];
+        return 1;
+    }
+    const int32_t vocab_size = sensevoice::ModelConfig().vocab_size;
+
+    std::vector<Utterance> utterances;
+    std::ifstream list(argv[2]);
+    std::string line;
+    while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        size_t tab = line.find('\t');
+        Utterance utt;
+        if (!LoadLogits(line.substr(0, tab), vocab_size, &utt.logits, &utt.num_frames)) {
+            return 1;
+        }
+        if (tab != std::string::npos) {
+            utt.reference = line.substr(tab + 1);
+        }
+        utterances.push_back(std::move(utt));
+    }
+    if (utterances.empty()) {
+        LOG(ERROR) << "No utterances in " << argv[2];
+        return 1;
+    }
+
+    std::vector<int32_t> beam_sizes;
+    std::stringstream sizes((argc > 3) ? argv[3] : "4,8,16");
+    std::string size;
+    while (std::getline(sizes, size, ',')) {
+        if (std::atoi(size.c_str()) > 0) beam_sizes.push_back(std::atoi(size.c_str()));
+    }
+
+    sensevoice::HotwordGraph hotwords;
+    if (argc > 4 && std::string(argv[4]) != "-" && !hotwords.Load(argv[4], tokenizer)) {
+        LOG(ERROR) << "Failed to load hotwords from: " << argv[4];
+        return 1;
+    }
+    if (argc > 5 && std::string(argv[5]) != "-" && !tokenizer.LoadLanguageModel(argv[5])) {
+        LOG(ERROR) << "Failed to load LM from: " << argv[5];
+        return 1;
+    }
+    const std::string language = (argc > 6) ? argv[6] : "";
+    const std::vector<sensevoice::TokenRange>* allowed_tokens = nullptr;
+    if (!language.empty()) {
+        allowed_tokens = tokenizer.LanguageTokens(ParseLanguage(language));
+        if (!allowed_tokens) {
+            LOG(ERROR) << "Unknown language: " << language;
+            return 1;
+        }
+        size_t allowed = 0;
+        for (const auto& range : *allowed_tokens) {
+            allowed += range.end - range.begin;
+        }
+        std::cout << language << " vocab: " << allowed << " tokens in " << allowed_tokens->size()
+                  << " ranges\n";
+    }
+
+    std::cout << utterances.size() << " utterances"
+              << (hotwords.Empty() ? "" : ", beam search with hotwords") << "\n";
+    sensevoice::BeamSearchOptions options;
+    const float lm_weight = options.lm_weight;
+    RunArgmax(tokenizer, utterances, vocab_size);
+    RunReadback(tokenizer, &utterances, vocab_size);
+    Run(tokenizer, utterances, vocab_size, 0, options, nullptr);
+    Run(tokenizer, utterances, vocab_size, 0, options, nullptr, true);
+    RunHalfPrecision(tokenizer, utterances, vocab_size);
+    for (int32_t k : {4, 8, 16}) {
+        RunTopK(tokenizer, utterances, vocab_size, k);
+    }
+    if (allowed_tokens) {
+        Run(tokenizer, utterances, vocab_size, 0, options, nullptr, true, allowed_tokens, language);
+    }
+    for (int32_t beam_size : beam_sizes) {
+        options.beam_size = beam_size;
+        options.lm_weight = 0.0f;
+        Run(tokenizer, utterances, vocab_size, beam_size, options, &hotwords);
+        RunBeamProfile(tokenizer, utterances, vocab_size, options);
+        if (allowed_tokens) {
+            Run(tokenizer, utterances, vocab_size, beam_size, options, &hotwords, false, allowed_tokens, language);
+        }
+        if (tokenizer.LanguageModel()) {
+            options.lm_weight = lm_weight;
+            Run(tokenizer, utterances, vocab_size, beam_size, options, &hotwords);
+        }
+    }
+    return 0;
+}
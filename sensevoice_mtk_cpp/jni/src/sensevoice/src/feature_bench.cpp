@@ -0,0 +1,205 @@
+/* SenseVoice Feature Benchmark - host CMVN and reduced-precision model inputs
+ *
+ * Usage: sensevoice_feature_bench <am.mvn> [audio.wav] [int8_step] [runs]
+ *
+ * float16 / int8 input DLAs (main.py --input_type) leave CMVN to the host:
+ * the frontend normalizes while it gathers the LFR frames and the model
+ * encodes one window into the input tensor. Compares the fused LFR + CMVN
+ * against LFR followed by a separate CMVN pass (time and max difference),
+ * then reports for the float16 and int8 encodings of one window the bytes
+ * written to the input tensor, the encode time and the error against the
+ * fp32 reference features (max, RMS, SNR, int8 values clipped).
+ * Without audio.wav a synthetic speech-like signal is used.
+ */
+
+#include "audio_frontend.h"
+#include "ctc_math.h"
+#include "sensevoice_config.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Speech-like test signal: a few harmonics under a syllable-rate envelope, plus noise
+std::vector<int16_t> SyntheticAudio(float seconds) {
+    const int32_t sample_rate = 16000;
+    std::vector<int16_t> samples(static_cast<size_t>(seconds * sample_rate));
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        float t = static_cast<float>(i) / sample_rate;
+        float envelope = 0.5f + 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 4.0f * t);
+        float voice = std::sin(2.0f * static_cast<float>(M_PI) * 180.0f * t) +
+                      0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 360.0f * t) +
+                      0.25f * std::sin(2.0f * static_cast<float>(M_PI) * 720.0f * t);
+        seed = seed * 1664525u + 1013904223u;
+        float noise = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 0.05f;
+        samples[i] = static_cast<int16_t>(std::max(-1.0f, std::min(1.0f, 0.3f * envelope * voice + noise)) * 32767.0f);
+    }
+    return samples;
+}
+
+double ElapsedUs(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / 1000.0;
+}
+
+// Error of decoded features against the fp32 reference
+struct EncodeError {
+    double max_abs = 0.0;
+    double rms = 0.0;
+    double snr_db = 0.0;
+};
+
+EncodeError Compare(const float* reference, const std::vector<float>& decoded) {
+    EncodeError error;
+    double signal = 0.0;
+    double noise = 0.0;
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        const double diff = static_cast<double>(decoded[i]) - reference[i];
+        error.max_abs = std::max(error.max_abs, std::fabs(diff));
+        signal += static_cast<double>(reference[i]) * reference[i];
+        noise += diff * diff;
+    }
+    if (!decoded.empty()) {
+        error.rms = std::sqrt(noise / decoded.size());
+    }
+    error.snr_db = noise > 0.0 ? 10.0 * std::log10(signal / noise) : INFINITY;
+    return error;
+}
+
+void PrintEncoding(const char* name, size_t bytes, double us, const EncodeError& error) {
+    std::cout << name << ": " << bytes << " bytes/window, encode " << us << " us, max err "
+              << error.max_abs << ", rms " << error.rms << ", SNR " << error.snr_db << " dB\n";
+}
+
+}  // namespace
+
+void PrintUsage(const char* program_name) {
+    std::cout << "SenseVoice Feature Benchmark\n\n";
+    std::cout << "Usage: " << program_name << " <am.mvn> [audio.wav] [int8_step] [runs]\n\n";
+    std::cout << "Arguments:\n";
+    std::cout << "  am.mvn       CMVN stats of the model (SenseVoice_workspace/models/sensevoice-small/am.mvn)\n";
+    std::cout << "  audio.wav    16 kHz mono WAV, - for 10 s of synthetic audio (default: -)\n";
+    std::cout << "  int8_step    Feature step of the int8 input DLA, main.py --int8_clip / 127 (default: 8/127)\n";
+    std::cout << "  runs         Timed repetitions of each path (default: 100)\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << program_name << " am.mvn test.wav\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    sensevoice::CmvnStats cmvn;
+    if (!sensevoice::LoadCmvn(argv[1], &cmvn)) {
+        LOG(ERROR) << "Failed to load CMVN stats from: " << argv[1];
+        return 1;
+    }
+    const sensevoice::ModelConfig model_config;
+    const sensevoice::AudioConfig audio_config;
+    if (cmvn.Dim() != model_config.input_feat_dim) {
+        LOG(ERROR) << "CMVN stats have dim " << cmvn.Dim() << ", expected " << model_config.input_feat_dim;
+        return 1;
+    }
+    float step = argc > 3 ? static_cast<float>(std::atof(argv[3])) : model_config.input_scale;
+    if (step <= 0.0f) {
+        step = model_config.input_scale;
+    }
+    const int32_t runs = argc > 4 ? std::max(1, std::atoi(argv[4])) : 100;
+
+    std::vector<int16_t> audio;
+    int32_t sample_rate = audio_config.sample_rate;
+    if (argc > 2 && std::string(argv[2]) != "-") {
+        if (!sensevoice::LoadWavFile(argv[2], &audio, &sample_rate) || sample_rate != audio_config.sample_rate) {
+            LOG(ERROR) << "Failed to load 16 kHz 16-bit WAV: " << argv[2];
+            return 1;
+        }
+    } else {
+        audio = SyntheticAudio(10.0f);
+    }
+
+    sensevoice::AudioFrontend frontend(audio_config);
+    const std::vector<float> fbank = frontend.ComputeFbank(audio.data(), audio.size());
+    const int32_t mel_bins = audio_config.num_mel_bins;
+    const int32_t num_frames = static_cast<int32_t>(fbank.size() / mel_bins);
+    const int32_t lfr_m = model_config.lfr_window_size;
+    const int32_t lfr_n = model_config.lfr_window_shift;
+    const int32_t dim = model_config.input_feat_dim;
+
+    // Reference: LFR, then a separate CMVN pass over the features
+    std::vector<float> reference;
+    Clock::time_point start = Clock::now();
+    for (int32_t r = 0; r < runs; ++r) {
+        reference = sensevoice::AudioFrontend::ApplyLFR(fbank, num_frames, mel_bins, lfr_m, lfr_n);
+        for (size_t i = 0; i < reference.size(); i += dim) {
+            for (int32_t d = 0; d < dim; ++d) {
+                reference[i + d] = (reference[i + d] + cmvn.neg_mean[d]) * cmvn.inv_stddev[d];
+            }
+        }
+    }
+    const double separate_us = ElapsedUs(start) / runs;
+
+    std::vector<float> fused;
+    start = Clock::now();
+    for (int32_t r = 0; r < runs; ++r) {
+        fused = sensevoice::AudioFrontend::ApplyLFR(fbank, num_frames, mel_bins, lfr_m, lfr_n, &cmvn);
+    }
+    const double fused_us = ElapsedUs(start) / runs;
+    if (fused.size() != reference.size() || fused.empty()) {
+        LOG(ERROR) << "Fused LFR + CMVN returned " << fused.size() << " values, expected " << reference.size();
+        return 1;
+    }
+    const EncodeError fused_error = Compare(reference.data(), fused);
+
+    const int32_t lfr_frames = static_cast<int32_t>(reference.size() / dim);
+    std::cout << "Audio " << audio.size() / static_cast<double>(sample_rate) << " s, " << num_frames
+              << " fbank frames, " << lfr_frames << " LFR frames, " << runs << " runs\n";
+    std::cout << "LFR + separate CMVN: " << separate_us << " us, fused: " << fused_us
+              << " us, max diff " << fused_error.max_abs << "\n";
+
+    // One model window, zero-padded like SenseVoiceModel does
+    const size_t window_values = static_cast<size_t>(model_config.input_frames) * dim;
+    std::vector<float> window(window_values, 0.0f);
+    std::copy(reference.begin(), reference.begin() + std::min(reference.size(), window_values), window.begin());
+    std::cout << "fp32: " << window_values * sizeof(float) << " bytes/window\n";
+
+    std::vector<uint16_t> halves(window_values);
+    start = Clock::now();
+    for (int32_t r = 0; r < runs; ++r) {
+        sensevoice::FeaturesToHalf(window.data(), window_values, halves.data());
+    }
+    const double half_us = ElapsedUs(start) / runs;
+    std::vector<float> decoded(window_values);
+    for (size_t i = 0; i < window_values; ++i) {
+        decoded[i] = sensevoice::HalfToFloat(halves[i]);
+    }
+    PrintEncoding("fp16", window_values * sizeof(uint16_t), half_us, Compare(window.data(), decoded));
+
+    std::vector<int8_t> steps(window_values);
+    start = Clock::now();
+    for (int32_t r = 0; r < runs; ++r) {
+        sensevoice::FeaturesToInt8(window.data(), window_values, step, steps.data());
+    }
+    const double int8_us = ElapsedUs(start) / runs;
+    size_t clipped = 0;
+    for (size_t i = 0; i < window_values; ++i) {
+        decoded[i] = steps[i] * step;
+        clipped += std::fabs(window[i]) > 127.5f * step;
+    }
+    PrintEncoding("int8", window_values, int8_us, Compare(window.data(), decoded));
+    std::cout << "  step " << step << " (clip " << 127.0f * step << "), "
+              << 100.0 * clipped / window_values << "% of values clipped\n";
+    return 0;
+}
@@ -0,0 +1,191 @@
+/* Hotword Biasing Implementation
+ *
+ * The trie is built with maps, then flattened in BFS order into the
+ * compact node array; failure links are filled over the flat layout.
+ *
+ * The bonus a hypothesis holds is the full bonus of every phrase it has
+ * completed plus the pending bonus of the partial match it is in. A node's
+ * output link is the nearest phrase end on its failure chain (its longest
+ * suffix that is a whole phrase); summing the phrase bonuses along those
+ * links gives what arriving at the node completes.
+ */
+
+#include "hotwords.h"
+#include "tokenizer.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace sensevoice {
+
+bool HotwordGraph::Build(const std::vector<Hotword>& hotwords, float default_boost) {
+    nodes_.clear();
+    tokens_.clear();
+    num_phrases_ = 0;
+
+    // Build-time trie
+    struct BuildNode {
+        std::map<int32_t, uint32_t> children;
+        float score = 0.0f;
+        bool is_end = false;
+    };
+    std::vector<BuildNode> build(1);
+    for (const auto& hotword : hotwords) {
+        if (hotword.token_ids.empty()) {
+            LOG(WARNING) << "Hotword without tokens skipped: " << hotword.phrase;
+            continue;
+        }
+        const float boost = hotword.boost > 0.0f ? hotword.boost : default_boost;
+        uint32_t node = 0;
+        float score = 0.0f;
+        for (int64_t id : hotword.token_ids) {
+            score += boost;
+            auto it = build[node].children.find(static_cast<int32_t>(id));
+            if (it == build[node].children.end()) {
+                uint32_t child = static_cast<uint32_t>(build.size());
+                build[node].children.emplace(static_cast<int32_t>(id), child);
+                build.emplace_back();
+                node = child;
+            } else {
+                node = it->second;
+            }
+            // Shared prefixes take the strongest boost
+            build[node].score = std::max(build[node].score, score);
+        }
+        build[node].is_end = true;
+        num_phrases_++;
+    }
+
+    // Flatten in BFS order: the children of a node get consecutive indices
+    nodes_.resize(build.size());
+    tokens_.assign(build.size(), -1);
+    std::vector<uint32_t> order(1, 0);  // Flat index -> build index
+    std::vector<float> score(build.size(), 0.0f);  // Bonus accumulated from the root
+    std::vector<float> end_score(build.size(), 0.0f);  // Of the deepest phrase end on the path, inclusive
+    std::vector<uint8_t> is_end(build.size(), 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        const BuildNode& b = build[order[i]];
+        Node& n = nodes_[i];
+        n.first_child = static_cast<uint32_t>(order.size());
+        n.num_children = static_cast<uint32_t>(b.children.size());
+        n.fail = kRoot;
+        score[i] = b.score;
+        is_end[i] = b.is_end ? 1 : 0;
+        if (b.is_end) {
+            end_score[i] = b.score;
+        }
+        n.pending = score[i] - end_score[i];
+        for (const auto& child : b.children) {
+            tokens_[order.size()] = child.first;
+            end_score[order.size()] = end_score[i];
+            order.push_back(child.second);
+        }
+    }
+
+    // Failure and output links, parents before children; a failure link is
+    // shallower than its node, so its links and output sum are already set
+    std::vector<uint32_t> output_link(nodes_.size(), kRoot);  // Nearest phrase end on the failure chain
+    nodes_[kRoot].output = 0.0f;
+    for (uint32_t node = 0; node < nodes_.size(); ++node) {
+        const Node& n = nodes_[node];
+        for (uint32_t c = n.first_child; c < n.first_child + n.num_children; ++c) {
+            uint32_t fail = kRoot;
+            if (node != kRoot) {
+                uint32_t f = n.fail;
+                while (true) {
+                    uint32_t next = FindChild(f, tokens_[c]);
+                    if (next != kRoot || f == kRoot) {
+                        fail = next;
+                        break;
+                    }
+                    f = nodes_[f].fail;
+                }
+            }
+            nodes_[c].fail = fail;
+            output_link[c] = is_end[fail] ? fail : output_link[fail];
+            nodes_[c].output = (is_end[c] ? score[c] : 0.0f) +
+                               (output_link[c] != kRoot ? nodes_[output_link[c]].output : 0.0f);
+        }
+    }
+
+    LOG(INFO) << "Hotwords: " << num_phrases_ << " phrases, " << nodes_.size()
+              << " trie nodes (" << MemoryFootprint() / 1024 << " KB)";
+    return num_phrases_ > 0;
+}
+
+bool HotwordGraph::Load(const std::string& path, const Tokenizer& tokenizer, float default_boost) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG(ERROR) << "Failed to open hotwords file: " << path;
+        return false;
+    }
+
+    std::vector<Hotword> hotwords;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        Hotword hotword;
+        std::stringstream fields(line);
+        std::string boost;
+        std::string ids;
+        std::getline(fields, hotword.phrase, '\t');
+        std::getline(fields, boost, '\t');
+        std::getline(fields, ids, '\t');
+        hotword.boost = boost.empty() ? 0.0f : std::strtof(boost.c_str(), nullptr);
+
+        if (!ids.empty()) {
+            std::stringstream id_stream(ids);
+            int64_t id;
+            while (id_stream >> id) {
+                hotword.token_ids.push_back(id);
+            }
+        } else {
+            hotword.token_ids = tokenizer.Encode(hotword.phrase);
+        }
+        hotwords.push_back(std::move(hotword));
+    }
+    return Build(hotwords, default_boost);
+}
+
+uint32_t HotwordGraph::FindChild(uint32_t node, int64_t token) const {
+    const Node& n = nodes_[node];
+    const int32_t* begin = tokens_.data() + n.first_child;
+    const int32_t* end = begin + n.num_children;
+    const int32_t* it = std::lower_bound(begin, end, token);
+    if (it != end && *it == token) {
+        return static_cast<uint32_t>(it - tokens_.data());
+    }
+    return kRoot;
+}
+
+float HotwordGraph::Advance(uint32_t state, int64_t token, uint32_t* next) const {
+    uint32_t s = state;
+    uint32_t matched = kRoot;
+    while (true) {
+        matched = FindChild(s, token);
+        if (matched != kRoot || s == kRoot) {
+            break;
+        }
+        s = nodes_[s].fail;
+    }
+
+    // Completed phrases keep their bonus; the pending part of the state is
+    // replaced by that of the node matched
+    *next = matched;
+    return nodes_[matched].output + nodes_[matched].pending - nodes_[state].pending;
+}
+
+size_t HotwordGraph::MemoryFootprint() const {
+    return nodes_.size() * sizeof(Node) + tokens_.size() * sizeof(int32_t);
+}
+
+}  // namespace sensevoice
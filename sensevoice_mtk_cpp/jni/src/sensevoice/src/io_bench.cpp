@@ -0,0 +1,167 @@
+/* SenseVoice I/O Benchmark - sustained throughput with ping-pong I/O sets
+ *
+ * Usage: sensevoice_io_bench <model.dla> <tokens.txt> [backend] [seconds] [clients] [audio_s]
+ *
+ * Several clients send one-window utterances back to back on one execution,
+ * first with a single I/O set (copy in, compute, copy out, one run after the
+ * other), then with two (ModelConfig::io_sets = 2: one run's copies overlap
+ * the compute of the other). Reports requests per second, model runs per
+ * second against the compute-bound limit, request latency and the input
+ * copies skipped because the execution already held them.
+ * Backend host[:<latency_us>] simulates the model on the CPU.
+ */
+
+#include "sensevoice.h"
+#include "bench_common.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+
+using sensevoice::bench::ParseBackend;
+using sensevoice::bench::Percentile;
+
+using Clock = std::chrono::steady_clock;
+
+// Speech-like test signal: a few harmonics under a syllable-rate envelope, plus noise
+std::vector<int16_t> SyntheticAudio(float seconds) {
+    const int32_t sample_rate = 16000;
+    std::vector<int16_t> samples(static_cast<size_t>(seconds * sample_rate));
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        float t = static_cast<float>(i) / sample_rate;
+        float envelope = 0.5f + 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 4.0f * t);
+        float voice = std::sin(2.0f * static_cast<float>(M_PI) * 180.0f * t) +
+                      0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 360.0f * t) +
+                      0.25f * std::sin(2.0f * static_cast<float>(M_PI) * 720.0f * t);
+        seed = seed * 1664525u + 1013904223u;
+        float noise = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 0.05f;
+        samples[i] = static_cast<int16_t>(std::max(-1.0f, std::min(1.0f, 0.3f * envelope * voice + noise)) * 32767.0f);
+    }
+    return samples;
+}
+
+// Returns model runs per second, 0 on failure
+double RunMode(sensevoice::SenseVoiceConfig config, int32_t io_sets, double seconds, int32_t clients,
+               const std::vector<int16_t>& audio, double* requests_per_s) {
+    config.model.io_sets = io_sets;
+    sensevoice::SenseVoice sv;
+    if (!sv.Initialize(config)) {
+        LOG(ERROR) << "Failed to initialize SenseVoice with " << io_sets << " I/O set(s)";
+        return 0.0;
+    }
+    // The pipeline logs every request; keep the report readable
+    el::Loggers::reconfigureAllLoggers(el::Level::Info, el::ConfigurationType::Enabled, "false");
+
+    // One request per client first, so the steady state is measured
+    std::vector<std::thread> threads;
+    for (int32_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&] { sv.Recognize(audio.data(), audio.size()); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+
+    const sensevoice::SchedulerStats before = sv.GetSchedulerStats();
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point end = start + std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000));
+    std::vector<std::vector<double>> latencies(clients);
+    for (int32_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            while (Clock::now() < end) {
+                const Clock::time_point issued = Clock::now();
+                sv.Recognize(audio.data(), audio.size());
+                latencies[c].push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                    Clock::now() - issued).count() / 1000.0);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double wall_s = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start).count() / 1e6;
+    el::Loggers::reconfigureAllLoggers(el::Level::Info, el::ConfigurationType::Enabled, "true");
+
+    std::vector<double> all;
+    for (const auto& client : latencies) {
+        all.insert(all.end(), client.begin(), client.end());
+    }
+    const sensevoice::SchedulerStats after = sv.GetSchedulerStats();
+    const int64_t runs = (after.interactive.runs + after.batch.runs) -
+                         (before.interactive.runs + before.batch.runs);
+    const double runs_per_s = runs / wall_s;
+    *requests_per_s = all.size() / wall_s;
+
+    std::cout << "io_sets " << io_sets << " (" << sv.GetModel()->MaxRunsInFlight()
+              << " runs in flight): " << *requests_per_s << " requests/s, " << runs_per_s
+              << " runs/s, latency p50 " << Percentile(all, 0.50) << " ms, p99 "
+              << Percentile(all, 0.99) << " ms\n";
+    const sensevoice::InputCopyStats copies = sv.GetModel()->GetInputCopyStats();
+    std::cout << "  input copies: " << copies.written << " written, " << copies.skipped
+              << " skipped as unchanged (" << copies.skipped_bytes << " bytes)\n";
+    return runs_per_s;
+}
+
+}  // namespace
+
+void PrintUsage(const char* program_name) {
+    std::cout << "SenseVoice I/O Benchmark\n\n";
+    std::cout << "Usage: " << program_name << " <model.dla> <tokens.txt> [backend] [seconds] [clients] [audio_s]\n\n";
+    std::cout << "Arguments:\n";
+    std::cout << "  model.dla    Path to SenseVoice DLA model file, or a .svb bundle (tokens: -)\n";
+    std::cout << "  tokens.txt   Path to tokens file (tokens.txt or tokens.bin)\n";
+    std::cout << "  backend      usdk, runtime or host[:<latency_us>] (CPU stand-in, no NPU) (default: usdk)\n";
+    std::cout << "  seconds      Duration of each mode (default: 10)\n";
+    std::cout << "  clients      Threads sending requests back to back (default: 2)\n";
+    std::cout << "  audio_s      Length of each utterance, one window up to ~10 s (default: 5)\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << program_name << " sensevoice.dla tokens.txt usdk 20 2\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    sensevoice::SenseVoiceConfig config;
+    config.model.model_path = argv[1];
+    config.model.tokens_path = argv[2];
+    if (argc > 3 && !ParseBackend(argv[3], &config.model)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    const double seconds = argc > 4 ? std::max(1.0, std::atof(argv[4])) : 10.0;
+    const int32_t clients = argc > 5 ? std::max(1, std::atoi(argv[5])) : 2;
+    const float audio_s = argc > 6 ? std::max(0.5f, static_cast<float>(std::atof(argv[6]))) : 5.0f;
+
+    const std::vector<int16_t> audio = SyntheticAudio(audio_s);
+    std::cout << "Utterances " << audio_s << " s, " << clients << " clients, "
+              << seconds << " s per mode\n";
+
+    double single_requests = 0.0;
+    double double_requests = 0.0;
+    const double single_runs = RunMode(config, 1, seconds, clients, audio, &single_requests);
+    const double double_runs = RunMode(config, 2, seconds, clients, audio, &double_requests);
+    if (single_runs <= 0.0 || double_runs <= 0.0) {
+        return 1;
+    }
+    if (config.model.backend == sensevoice::ModelBackend::Host && config.model.host_latency_us > 0) {
+        std::cout << "compute-bound limit: " << 1e6 / config.model.host_latency_us << " runs/s\n";
+    }
+    std::cout << "speedup: " << double_requests / single_requests << "x\n";
+    return 0;
+}
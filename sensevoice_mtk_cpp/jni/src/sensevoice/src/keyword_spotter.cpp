@@ -0,0 +1,299 @@
+/* Keyword Spotting Implementation
+ *
+ * Every trie node has two CTC states: "in the node's token" and "in a blank
+ * after it". A path may enter a first-token state at any frame, so a state
+ * score is the log posterior of the best alignment of its prefix that ends
+ * at the current frame. Text assembly and the vocabulary are never touched.
+ *
+ * That score covers every frame of the alignment (holds and blanks too), so
+ * it gates the hit but is not reported. Alongside it each state carries the
+ * emitting log-probs of its prefix: for every token, its best frame, as in
+ * greedy decoding. The hit confidence is their geometric mean.
+ */
+
+#include "keyword_spotter.h"
+#include "ctc_math.h"
+#include "tokenizer.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+namespace sensevoice {
+
+namespace {
+
+constexpr float kNegInf = -std::numeric_limits<float>::infinity();
+
+}  // namespace
+
+bool KeywordSpotter::Build(const std::vector<Keyword>& keywords, float default_threshold) {
+    parent_.clear();
+    token_.clear();
+    enter_.clear();
+    start_.clear();
+    keywords_.clear();
+
+    // Build-time trie
+    struct BuildNode {
+        std::map<int32_t, uint32_t> children;
+    };
+    std::vector<BuildNode> build(1);
+    std::vector<std::pair<uint32_t, size_t>> ends;  // Build node, keyword index
+    std::vector<Keyword> kept;
+    for (const auto& keyword : keywords) {
+        if (keyword.token_ids.empty()) {
+            LOG(WARNING) << "Keyword without tokens skipped: " << keyword.phrase;
+            continue;
+        }
+        uint32_t node = 0;
+        for (int64_t id : keyword.token_ids) {
+            auto it = build[node].children.find(static_cast<int32_t>(id));
+            if (it == build[node].children.end()) {
+                uint32_t child = static_cast<uint32_t>(build.size());
+                build[node].children.emplace(static_cast<int32_t>(id), child);
+                build.emplace_back();
+                node = child;
+            } else {
+                node = it->second;
+            }
+        }
+        ends.emplace_back(node, kept.size());
+        kept.push_back(keyword);
+    }
+
+    // Flatten in BFS order: parents come before their children
+    std::vector<uint32_t> order(1, 0);  // Flat index -> build index
+    std::vector<int32_t> flat(build.size(), 0);
+    parent_.push_back(-1);
+    token_.push_back(-1);
+    for (size_t i = 0; i < order.size(); ++i) {
+        for (const auto& child : build[order[i]].children) {
+            flat[child.second] = static_cast<int32_t>(order.size());
+            order.push_back(child.second);
+            parent_.push_back(static_cast<int32_t>(i));
+            token_.push_back(child.first);
+        }
+    }
+    enter_.assign(token_.size(), kNegInf);
+    start_.assign(token_.size(), kNegInf);
+    for (size_t n = 1; n < token_.size(); ++n) {
+        enter_[n] = (parent_[n] == 0 || token_[parent_[n]] == token_[n]) ? kNegInf : 0.0f;
+        start_[n] = (parent_[n] == 0) ? 0.0f : kNegInf;
+    }
+
+    for (const auto& end : ends) {
+        const Keyword& keyword = kept[end.second];
+        const float threshold = keyword.threshold > 0.0f ? keyword.threshold : default_threshold;
+        const int32_t length = static_cast<int32_t>(keyword.token_ids.size());
+        keywords_.push_back({keyword.phrase, flat[end.first], length,
+                             length * std::log(std::min(std::max(threshold, 1e-6f), 1.0f))});
+    }
+
+    LOG(INFO) << "Keywords: " << keywords_.size() << " phrases, " << token_.size() << " trie nodes";
+    return !keywords_.empty();
+}
+
+bool KeywordSpotter::Load(const std::string& path, const Tokenizer& tokenizer, float default_threshold) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG(ERROR) << "Failed to open keywords file: " << path;
+        return false;
+    }
+
+    std::vector<Keyword> keywords;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        Keyword keyword;
+        std::stringstream fields(line);
+        std::string threshold;
+        std::string ids;
+        std::getline(fields, keyword.phrase, '\t');
+        std::getline(fields, threshold, '\t');
+        std::getline(fields, ids, '\t');
+        keyword.threshold = threshold.empty() ? 0.0f : std::strtof(threshold.c_str(), nullptr);
+
+        if (!ids.empty()) {
+            std::stringstream id_stream(ids);
+            int64_t id;
+            while (id_stream >> id) {
+                keyword.token_ids.push_back(id);
+            }
+        } else {
+            keyword.token_ids = tokenizer.Encode(keyword.phrase);
+        }
+        keywords.push_back(std::move(keyword));
+    }
+    return Build(keywords, default_threshold);
+}
+
+std::vector<KeywordHit> KeywordSpotter::Spot(const float* logits,
+                                             int32_t num_frames,
+                                             int32_t vocab_size,
+                                             int64_t blank_id) const {
+    const size_t num_nodes = token_.size();
+    for (size_t n = 1; n < num_nodes; ++n) {
+        if (token_[n] < 0 || token_[n] >= vocab_size) {
+            LOG(ERROR) << "Keyword token " << token_[n] << " outside the vocabulary";
+            return {};
+        }
+    }
+
+    return Scan(num_frames, [&](int32_t t, float* log_probs) {
+        const float* frame = logits + static_cast<size_t>(t) * vocab_size;
+        const float norm = LogSumExp(frame, vocab_size);
+        for (size_t n = 1; n < num_nodes; ++n) {
+            log_probs[n] = frame[token_[n]] - norm;
+        }
+        return (blank_id >= 0 && blank_id < vocab_size) ? frame[blank_id] - norm : kNegInf;
+    });
+}
+
+std::vector<KeywordHit> KeywordSpotter::SpotTopK(const float* rows,
+                                                 int32_t num_frames,
+                                                 int32_t k,
+                                                 int64_t blank_id) const {
+    const size_t num_nodes = token_.size();
+    return Scan(num_frames, [&](int32_t t, float* log_probs) {
+        const float* row = rows + static_cast<size_t>(t) * 2 * k;
+        for (size_t n = 1; n < num_nodes; ++n) {
+            const int32_t entry = TopKFind(row, k, token_[n]);
+            log_probs[n] = entry >= 0 ? row[entry] : kNegInf;
+        }
+        const int32_t blank = TopKFind(row, k, static_cast<int32_t>(blank_id));
+        return blank >= 0 ? row[blank] : TopKTailBound(row, k);
+    });
+}
+
+template <typename FrameScores>
+std::vector<KeywordHit> KeywordSpotter::Scan(int32_t num_frames, FrameScores frame_scores) const {
+    std::vector<KeywordHit> hits;
+    if (keywords_.empty() || num_frames <= 0) {
+        return hits;
+    }
+
+    const size_t num_nodes = token_.size();
+    std::vector<float> log_probs(num_nodes, kNegInf);
+
+    // Scores and alignment start of both states, previous and current frame;
+    // the root slot stays at -inf so children of the root only enter via start_
+    std::vector<float> token_score(num_nodes, kNegInf), blank_score(num_nodes, kNegInf);
+    std::vector<float> next_token(num_nodes, kNegInf), next_blank(num_nodes, kNegInf);
+    std::vector<int32_t> token_begin(num_nodes, 0), blank_begin(num_nodes, 0);
+    std::vector<int32_t> next_token_begin(num_nodes, 0), next_blank_begin(num_nodes, 0);
+    std::vector<int32_t> blank_run(num_nodes, 0), next_blank_run(num_nodes, 0);
+    // Emitting log-probs: finished tokens of the token state plus the best frame of its
+    // current token; a blank state holds the total of the token it left
+    std::vector<float> token_emit(num_nodes, 0.0f), token_peak(num_nodes, 0.0f), blank_emit(num_nodes, 0.0f);
+    std::vector<float> next_token_emit(num_nodes, 0.0f), next_token_peak(num_nodes, 0.0f);
+    std::vector<float> next_blank_emit(num_nodes, 0.0f);
+
+    // Best alignment of the occurrence each keyword is currently in
+    std::vector<KeywordHit> pending(keywords_.size());
+
+    for (int32_t t = 0; t < num_frames; ++t) {
+        const float blank = frame_scores(t, log_probs.data());
+
+        for (size_t n = 1; n < num_nodes; ++n) {
+            const int32_t p = parent_[n];
+            const float log_prob = log_probs[n];
+
+            // Token state: stay, start a phrase, or step in from the parent
+            float best = token_score[n];
+            int32_t begin = token_begin[n];
+            float emit = token_emit[n];
+            float peak = std::max(token_peak[n], log_prob);
+            if (start_[n] > best) {
+                best = start_[n];
+                begin = t;
+                emit = 0.0f;
+                peak = log_prob;
+            }
+            if (token_score[p] + enter_[n] > best) {
+                best = token_score[p] + enter_[n];
+                begin = token_begin[p];
+                emit = token_emit[p] + token_peak[p];
+                peak = log_prob;
+            }
+            if (blank_score[p] > best) {
+                best = blank_score[p];
+                begin = blank_begin[p];
+                emit = blank_emit[p];
+                peak = log_prob;
+            }
+            next_token[n] = best + log_prob;
+            next_token_begin[n] = begin;
+            next_token_emit[n] = emit;
+            next_token_peak[n] = peak;
+
+            // Blank state: leave the token or keep waiting, up to kMaxTokenGap frames
+            const bool waiting = blank_score[n] > token_score[n] && blank_run[n] < kMaxTokenGap;
+            next_blank[n] = (waiting ? blank_score[n] : token_score[n]) + blank;
+            next_blank_begin[n] = waiting ? blank_begin[n] : token_begin[n];
+            next_blank_run[n] = waiting ? blank_run[n] + 1 : 1;
+            next_blank_emit[n] = waiting ? blank_emit[n] : token_emit[n] + token_peak[n];
+        }
+        token_score.swap(next_token);
+        blank_score.swap(next_blank);
+        token_begin.swap(next_token_begin);
+        blank_begin.swap(next_blank_begin);
+        blank_run.swap(next_blank_run);
+        token_emit.swap(next_token_emit);
+        token_peak.swap(next_token_peak);
+        blank_emit.swap(next_blank_emit);
+
+        for (size_t k = 0; k < keywords_.size(); ++k) {
+            const Entry& keyword = keywords_[k];
+            const float score = token_score[keyword.end_node];
+            if (score < keyword.min_score) {
+                continue;
+            }
+            KeywordHit& hit = pending[k];
+            const int32_t begin = token_begin[keyword.end_node];
+            // Every frame of the alignment is at most as likely as its token's best frame,
+            // so score >= min_score keeps the confidence at or above the threshold
+            const float confidence =
+                std::exp((token_emit[keyword.end_node] + token_peak[keyword.end_node]) / keyword.length);
+            if (hit.keyword >= 0 && begin <= hit.end_frame) {
+                // Same occurrence, keep the most confident alignment
+                if (confidence > hit.confidence) {
+                    hit.confidence = confidence;
+                    hit.start_frame = begin;
+                    hit.end_frame = t;
+                }
+                continue;
+            }
+            if (hit.keyword >= 0) {
+                hits.push_back(hit);
+            }
+            hit.keyword = static_cast<int32_t>(k);
+            hit.phrase = keyword.phrase;
+            hit.confidence = confidence;
+            hit.start_frame = begin;
+            hit.end_frame = t;
+        }
+    }
+
+    for (const auto& hit : pending) {
+        if (hit.keyword >= 0) {
+            hits.push_back(hit);
+        }
+    }
+    std::sort(hits.begin(), hits.end(), [](const KeywordHit& a, const KeywordHit& b) {
+        return a.start_frame != b.start_frame ? a.start_frame < b.start_frame : a.keyword < b.keyword;
+    });
+    return hits;
+}
+
+}  // namespace sensevoice
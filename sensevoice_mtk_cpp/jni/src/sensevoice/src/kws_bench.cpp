@@ -0,0 +1,235 @@
+/* SenseVoice Keyword Spotting Benchmark - KeywordSpotter vs decode + string match
+ *
+ * Usage: sensevoice_kws_bench <tokens.txt> <list.txt> <keywords.txt>
+ *
+ * Compares KeywordSpotter::Spot with what Recognize() does after the model:
+ * greedy or beam decoding with text assembly, then a search per keyword.
+ *
+ * list.txt has one utterance per line: "<logits.bin>\t<reference text>"
+ * logits.bin is raw float32 [num_frames, vocab_size] model output
+ * (numpy: logits.astype(np.float32).tofile(path)), prompt rows included.
+ * keywords.txt uses the KeywordSpotter::Load format.
+ * All paths start from the same logits, so the model run they share is
+ * left out; occurrences in the reference text count as the expected hits.
+ * The spotter also runs on the top-8 rows a _top8 DLA would return
+ * (KeywordSpotter::SpotTopK), reduced from the logits before timing.
+ */
+
+#include "keyword_spotter.h"
+#include "ctc_math.h"
+#include "sensevoice_model.h"
+#include "tokenizer.h"
+#include "bench_common.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+
+using sensevoice::bench::LoadLogits;
+
+struct Utterance {
+    std::vector<float> logits;
+    int32_t num_frames = 0;
+    std::string reference;
+};
+
+// Matching units, space separated: lower-cased words, each CJK (multi-byte) character on its own
+std::string Normalize(const std::string& text) {
+    std::string units = " ";
+    for (size_t i = 0; i < text.size();) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            if (std::isspace(c) || std::ispunct(c)) {
+                if (units.back() != ' ') units += ' ';
+            } else {
+                units += static_cast<char>(std::tolower(c));
+            }
+            ++i;
+            continue;
+        }
+        size_t len = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : 2;
+        if (units.back() != ' ') units += ' ';
+        units += text.substr(i, len);
+        units += ' ';
+        i += len;
+    }
+    if (units.back() != ' ') units += ' ';
+    return units;
+}
+
+// Non-overlapping occurrences of a normalized phrase in a normalized text
+int32_t CountMatches(const std::string& text, const std::string& phrase) {
+    int32_t count = 0;
+    for (size_t pos = text.find(phrase); pos != std::string::npos;
+         pos = text.find(phrase, pos + phrase.size() - 1)) {
+        count++;
+    }
+    return count;
+}
+
+// Expected occurrences vs reported ones, summed over keywords and utterances
+struct Score {
+    double total_ms = 0.0;
+    int32_t hits = 0;
+    int32_t misses = 0;
+    int32_t false_alarms = 0;
+
+    void Add(int32_t expected, int32_t found) {
+        hits += std::min(expected, found);
+        misses += std::max(expected - found, 0);
+        false_alarms += std::max(found - expected, 0);
+    }
+
+    void Print(const std::string& name, size_t num_utterances) const {
+        std::cout << name << ": " << total_ms / num_utterances << " ms/utt, " << hits << " hits, "
+                  << misses << " misses, " << false_alarms << " false alarms\n";
+    }
+};
+
+// Top-k rows of a _top<k> head: per frame the k best log-probs, then their ids
+std::vector<float> TopKRows(const float* logits, int32_t num_frames, int32_t vocab_size, int32_t k) {
+    std::vector<float> rows(static_cast<size_t>(num_frames) * 2 * k);
+    std::vector<float> log_probs(vocab_size);
+    std::vector<int32_t> order(vocab_size);
+    for (int32_t t = 0; t < num_frames; ++t) {
+        sensevoice::LogSoftmax(logits + static_cast<size_t>(t) * vocab_size, vocab_size, log_probs.data());
+        for (int32_t v = 0; v < vocab_size; ++v) {
+            order[v] = v;
+        }
+        std::partial_sort(order.begin(), order.begin() + k, order.end(),
+                          [&](int32_t a, int32_t b) { return log_probs[a] > log_probs[b]; });
+        float* row = rows.data() + static_cast<size_t>(t) * 2 * k;
+        for (int32_t i = 0; i < k; ++i) {
+            row[i] = log_probs[order[i]];
+            row[k + i] = static_cast<float>(order[i]);
+        }
+    }
+    return rows;
+}
+
+// Full path: decode with text assembly, then a search per keyword
+Score RunDecode(const sensevoice::Tokenizer& tokenizer, const std::vector<Utterance>& utterances,
+                const std::vector<std::string>& phrases, int32_t vocab_size) {
+    Score score;
+    for (const auto& utt : utterances) {
+        auto start = std::chrono::high_resolution_clock::now();
+        sensevoice::RecognitionResult result = tokenizer.Decode(utt.logits.data(), utt.num_frames, vocab_size);
+        const std::string text = Normalize(result.text);
+        std::vector<int32_t> found(phrases.size());
+        for (size_t k = 0; k < phrases.size(); ++k) {
+            found[k] = CountMatches(text, phrases[k]);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        score.total_ms += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+
+        for (size_t k = 0; k < phrases.size(); ++k) {
+            score.Add(CountMatches(utt.reference, phrases[k]), found[k]);
+        }
+    }
+    return score;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cout << "Usage: " << argv[0] << " <tokens.txt> <list.txt> <keywords.txt>\n\n";
+        std::cout << "  list.txt     One utterance per line: <logits.bin>\\t<reference text>\n";
+        std::cout << "               (logits.bin: raw float32 [frames, vocab_size], prompt rows included)\n";
+        std::cout << "  keywords.txt Keyword list, one phrase per line (<phrase>[\\t<threshold>[\\t<ids>]])\n";
+        return 1;
+    }
+
+    sensevoice::Tokenizer tokenizer;
+    if (!tokenizer.Load(argv[1])) {
+        LOG(ERROR) << "Failed to load tokens from: " << argv[1];
+        return 1;
+    }
+    const int32_t vocab_size = sensevoice::ModelConfig().vocab_size;
+    const int32_t prompt_rows = sensevoice::SenseVoiceModel::kNumPromptTokens;
+
+    sensevoice::KeywordSpotter spotter;
+    std::vector<std::string> phrases;
+    {
+        std::ifstream file(argv[3]);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            phrases.push_back(Normalize(line.substr(0, line.find('\t'))));
+        }
+    }
+    if (!spotter.Load(argv[3], tokenizer) || spotter.NumKeywords() != phrases.size()) {
+        LOG(ERROR) << "Failed to load keywords from: " << argv[3];
+        return 1;
+    }
+
+    std::vector<Utterance> utterances;
+    std::ifstream list(argv[2]);
+    std::string line;
+    while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        size_t tab = line.find('\t');
+        Utterance utt;
+        if (!LoadLogits(line.substr(0, tab), vocab_size, &utt.logits, &utt.num_frames) || utt.num_frames <= prompt_rows) {
+            return 1;
+        }
+        if (tab != std::string::npos) {
+            utt.reference = Normalize(line.substr(tab + 1));
+        }
+        utterances.push_back(std::move(utt));
+    }
+    if (utterances.empty()) {
+        LOG(ERROR) << "No utterances in " << argv[2];
+        return 1;
+    }
+
+    tokenizer.SetBeamSearch(false);
+    Score greedy = RunDecode(tokenizer, utterances, phrases, vocab_size);
+    tokenizer.SetBeamSearch(true);
+    Score beam = RunDecode(tokenizer, utterances, phrases, vocab_size);
+
+    constexpr int32_t kTopK = 8;
+    Score spot;
+    Score spot_top_k;
+    for (const auto& utt : utterances) {
+        const int32_t frames = utt.num_frames - prompt_rows;
+        const float* logits = utt.logits.data() + static_cast<size_t>(prompt_rows) * vocab_size;
+        const std::vector<float> top_k = TopKRows(logits, frames, vocab_size, kTopK);
+        for (Score* score : {&spot, &spot_top_k}) {
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<sensevoice::KeywordHit> hits =
+                score == &spot ? spotter.Spot(logits, frames, vocab_size, tokenizer.BlankId())
+                               : spotter.SpotTopK(top_k.data(), frames, kTopK, tokenizer.BlankId());
+            auto end = std::chrono::high_resolution_clock::now();
+            score->total_ms += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+
+            std::vector<int32_t> spotted(phrases.size());
+            for (const auto& hit : hits) {
+                spotted[hit.keyword]++;
+            }
+            for (size_t k = 0; k < phrases.size(); ++k) {
+                score->Add(CountMatches(utt.reference, phrases[k]), spotted[k]);
+            }
+        }
+    }
+
+    std::cout << utterances.size() << " utterances, " << phrases.size() << " keywords ("
+              << spotter.NumNodes() << " trie nodes)\n";
+    greedy.Print("greedy decode + string match", utterances.size());
+    beam.Print("beam " + std::to_string(sensevoice::BeamSearchOptions().beam_size) + " decode + string match",
+               utterances.size());
+    spot.Print("keyword spotter", utterances.size());
+    spot_top_k.Print("keyword spotter, top-" + std::to_string(kTopK) + " rows", utterances.size());
+    return 0;
+}
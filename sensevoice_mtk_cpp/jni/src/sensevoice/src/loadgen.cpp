@@ -0,0 +1,380 @@
+/* SenseVoice Load Generator - closed-loop client for sensevoice_server
+ *
+ * Usage: sensevoice_loadgen <socket_path> [requests] [concurrency] [audio.wav|seconds] [language] [transport]
+ *
+ * Opens one connection per concurrent client; each client sends a request,
+ * waits for its response and sends the next one, until the total is reached.
+ * Reports throughput, p50/p99 latency of successful requests, the
+ * server-side queue/run split and the CPU time per request of both
+ * processes. Without an audio file a synthetic utterance of the given
+ * length (default 5 s) is sent.
+ * Transport: socket (PCM copied through the socket) or shm (each client
+ * attaches a shared-memory ring and writes PCM into its slot).
+ */
+
+#include "audio_frontend.h"
+#include "server_protocol.h"
+#include "sensevoice_config.h"
+#include "bench_common.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <linux/memfd.h>
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+
+using sensevoice::bench::Percentile;
+
+using sensevoice::ServerResponseHeader;
+using sensevoice::ServerStatus;
+
+struct Sample {
+    double latency_ms;
+    uint32_t queue_us;
+    uint32_t run_us;
+    uint8_t status;
+};
+
+int Connect(const std::string& socket_path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size());
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// Speech-like test signal: a few harmonics under a syllable-rate envelope, plus noise
+std::vector<int16_t> SyntheticAudio(float seconds) {
+    const int32_t sample_rate = 16000;
+    std::vector<int16_t> samples(static_cast<size_t>(seconds * sample_rate));
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        float t = static_cast<float>(i) / sample_rate;
+        float envelope = 0.5f + 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 4.0f * t);
+        float voice = std::sin(2.0f * static_cast<float>(M_PI) * 180.0f * t) +
+                      0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 360.0f * t) +
+                      0.25f * std::sin(2.0f * static_cast<float>(M_PI) * 720.0f * t);
+        seed = seed * 1664525u + 1013904223u;
+        float noise = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 0.05f;
+        samples[i] = static_cast<int16_t>(std::max(-1.0f, std::min(1.0f, 0.3f * envelope * voice + noise)) * 32767.0f);
+    }
+    return samples;
+}
+
+// Client end of a shared-memory ring with a single slot (one request outstanding)
+class SharedRing {
+public:
+    ~SharedRing() {
+        if (base_) {
+            munmap(base_, layout_.Bytes());
+        }
+        for (int fd : {memfd_, submit_fd_, complete_fd_}) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    bool Attach(int socket_fd, uint32_t slot_samples) {
+        layout_.num_slots = 1;
+        layout_.slot_samples = slot_samples;
+        layout_.text_bytes = 4096;
+        memfd_ = static_cast<int>(syscall(__NR_memfd_create, "sensevoice_ring", MFD_CLOEXEC));
+        submit_fd_ = eventfd(0, EFD_CLOEXEC);
+        complete_fd_ = eventfd(0, EFD_CLOEXEC);
+        if (memfd_ < 0 || submit_fd_ < 0 || complete_fd_ < 0 ||
+            ftruncate(memfd_, static_cast<off_t>(layout_.Bytes())) != 0) {
+            return false;
+        }
+        base_ = mmap(nullptr, layout_.Bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, memfd_, 0);
+        if (base_ == MAP_FAILED) {
+            base_ = nullptr;
+            return false;
+        }
+
+        sensevoice::ServerShmAttach attach;
+        attach.magic = sensevoice::kServerShmAttachMagic;
+        attach.version = sensevoice::kServerProtocolVersion;
+        attach.num_slots = static_cast<uint16_t>(layout_.num_slots);
+        attach.slot_samples = layout_.slot_samples;
+        attach.text_bytes = layout_.text_bytes;
+        const int fds[3] = {memfd_, submit_fd_, complete_fd_};
+        ServerResponseHeader response;
+        return sensevoice::WriteFullWithFds(socket_fd, &attach, sizeof(attach), fds, 3) &&
+               sensevoice::ReadFull(socket_fd, &response, sizeof(response)) &&
+               response.status == static_cast<uint8_t>(ServerStatus::Ok);
+    }
+
+    // Stands in for the capture path writing straight into the slot
+    int16_t* Samples() { return layout_.SlotSamples(base_, 0); }
+
+    // Submit slot 0 and wait for its completion
+    bool Exchange(const sensevoice::ServerRequestHeader& request, ServerResponseHeader* response,
+                  std::string* payload) {
+        sensevoice::ShmSlotHeader* slot = layout_.Slot(base_, 0);
+        slot->request_id = request.request_id;
+        slot->num_samples = request.num_samples;
+        slot->language = request.language;
+        slot->text_norm = request.text_norm;
+
+        sensevoice::ShmRingHeader* ring = layout_.Header(base_);
+        const uint32_t head = ring->submit_head.value.load(std::memory_order_relaxed);
+        layout_.SubmitRing(base_)[head % layout_.num_slots] = 0;
+        ring->submit_head.value.store(head + 1, std::memory_order_release);
+        uint64_t count = 1;
+        if (write(submit_fd_, &count, sizeof(count)) != sizeof(count)) {
+            return false;
+        }
+
+        const uint32_t tail = ring->complete_tail.value.load(std::memory_order_relaxed);
+        while (ring->complete_head.value.load(std::memory_order_acquire) == tail) {
+            if (read(complete_fd_, &count, sizeof(count)) != sizeof(count)) {
+                return false;
+            }
+        }
+        ring->complete_tail.value.store(tail + 1, std::memory_order_release);
+
+        response->status = slot->status;
+        response->request_id = slot->request_id;
+        response->language_length = slot->language_length;
+        response->text_length = slot->text_length;
+        response->queue_us = slot->queue_us;
+        response->run_us = slot->run_us;
+        response->confidence = slot->confidence;
+        const char* text = layout_.SlotText(base_, 0);
+        payload->assign(text, slot->language_length + slot->text_length);
+        return true;
+    }
+
+private:
+    sensevoice::ShmRingLayout layout_;
+    void* base_ = nullptr;
+    int memfd_ = -1;
+    int submit_fd_ = -1;
+    int complete_fd_ = -1;
+};
+
+// CPU time (user + system) of the process at the other end of a Unix socket, in ms
+double PeerCpuMs(int socket_fd) {
+    ucred cred;
+    socklen_t length = sizeof(cred);
+    if (getsockopt(socket_fd, SOL_SOCKET, SO_PEERCRED, &cred, &length) != 0) {
+        return 0.0;
+    }
+    std::ifstream stat("/proc/" + std::to_string(cred.pid) + "/stat");
+    std::string line;
+    std::getline(stat, line);
+    // Fields after the parenthesized command name: state is field 3, utime 14, stime 15
+    size_t pos = line.rfind(')');
+    if (pos == std::string::npos) {
+        return 0.0;
+    }
+    std::string field;
+    std::istringstream fields(line.substr(pos + 2));
+    double ticks = 0.0;
+    for (int index = 3; index <= 15 && (fields >> field); ++index) {
+        if (index >= 14) {
+            ticks += std::atof(field.c_str());
+        }
+    }
+    return ticks * 1000.0 / sysconf(_SC_CLK_TCK);
+}
+
+double SelfCpuMs() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " <socket_path> [requests] [concurrency] [audio.wav|seconds] [language] [transport]\n\n";
+        std::cout << "  requests     Total requests to send (default: 100)\n";
+        std::cout << "  concurrency  Clients, one connection each, one request outstanding per client (default: 4)\n";
+        std::cout << "  audio        WAV/PCM file (16kHz mono, 16-bit) or seconds of synthetic audio (default: 5)\n";
+        std::cout << "  language     auto, zh, en, yue, ja, ko (default: auto)\n";
+        std::cout << "  transport    socket (PCM copied through the socket) or shm (shared-memory ring) (default: socket)\n";
+        return 1;
+    }
+
+    const std::string socket_path = argv[1];
+    const int32_t total = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 100;
+    const int32_t concurrency = (argc > 3) ? std::max(1, std::atoi(argv[3])) : 4;
+    const std::string audio_arg = (argc > 4) ? argv[4] : "5";
+    const std::string language_str = (argc > 5) ? argv[5] : "auto";
+    const bool use_shm = (argc > 6) && std::string(argv[6]) == "shm";
+
+    std::vector<int16_t> audio;
+    char* end = nullptr;
+    float seconds = std::strtof(audio_arg.c_str(), &end);
+    if (end && *end == '\0' && seconds > 0.0f) {
+        audio = SyntheticAudio(seconds);
+    } else {
+        int32_t sample_rate = 0;
+        bool is_wav = audio_arg.size() > 4 && audio_arg.compare(audio_arg.size() - 4, 4, ".wav") == 0;
+        bool loaded = is_wav ? sensevoice::LoadWavFile(audio_arg, &audio, &sample_rate)
+                             : sensevoice::LoadPcmFile(audio_arg, &audio);
+        if (!loaded || audio.empty()) {
+            LOG(ERROR) << "Failed to load audio: " << audio_arg;
+            return 1;
+        }
+    }
+
+    sensevoice::Language language = sensevoice::Language::Auto;
+    if (language_str == "zh") language = sensevoice::Language::Chinese;
+    else if (language_str == "en") language = sensevoice::Language::English;
+    else if (language_str == "yue") language = sensevoice::Language::Cantonese;
+    else if (language_str == "ja") language = sensevoice::Language::Japanese;
+    else if (language_str == "ko") language = sensevoice::Language::Korean;
+
+    std::atomic<int32_t> next_request(0);
+    std::atomic<int32_t> failed_clients(0);
+    std::mutex samples_mutex;
+    std::vector<Sample> samples;
+    std::string first_text;
+
+    auto client = [&]() {
+        int fd = Connect(socket_path);
+        if (fd < 0) {
+            LOG(ERROR) << "Failed to connect to " << socket_path << ": " << std::strerror(errno);
+            failed_clients++;
+            return;
+        }
+        SharedRing ring;
+        if (use_shm) {
+            if (!ring.Attach(fd, static_cast<uint32_t>(audio.size()))) {
+                LOG(ERROR) << "Failed to attach a shared-memory ring";
+                failed_clients++;
+                close(fd);
+                return;
+            }
+        }
+        std::vector<Sample> local;
+        std::string payload;
+        for (int32_t id = next_request++; id < total; id = next_request++) {
+            sensevoice::ServerRequestHeader request;
+            request.magic = sensevoice::kServerRequestMagic;
+            request.version = sensevoice::kServerProtocolVersion;
+            request.language = static_cast<uint8_t>(language);
+            request.text_norm = static_cast<uint8_t>(sensevoice::TextNorm::WithITN);
+            request.request_id = static_cast<uint32_t>(id);
+            request.num_samples = static_cast<uint32_t>(audio.size());
+
+            auto start = std::chrono::steady_clock::now();
+            ServerResponseHeader response;
+            bool ok;
+            if (use_shm) {
+                std::memcpy(ring.Samples(), audio.data(), sizeof(int16_t) * audio.size());
+                ok = ring.Exchange(request, &response, &payload);
+            } else {
+                ok = sensevoice::WriteFull(fd, &request, sizeof(request)) &&
+                     sensevoice::WriteFull(fd, audio.data(), sizeof(int16_t) * audio.size()) &&
+                     sensevoice::ReadFull(fd, &response, sizeof(response)) &&
+                     response.magic == sensevoice::kServerResponseMagic;
+                if (ok) {
+                    payload.resize(response.language_length + response.text_length);
+                    ok = sensevoice::ReadFull(fd, &payload[0], payload.size());
+                }
+            }
+            if (!ok) {
+                LOG(ERROR) << "Connection lost at request " << id;
+                failed_clients++;
+                break;
+            }
+            auto finish = std::chrono::steady_clock::now();
+
+            local.push_back({std::chrono::duration<double, std::milli>(finish - start).count(),
+                             response.queue_us, response.run_us, response.status});
+            if (id == 0) {
+                std::lock_guard<std::mutex> lock(samples_mutex);
+                first_text = payload.substr(response.language_length);
+            }
+        }
+        close(fd);
+        std::lock_guard<std::mutex> lock(samples_mutex);
+        samples.insert(samples.end(), local.begin(), local.end());
+    };
+
+    // The server's CPU time is read through a probe connection
+    int probe_fd = Connect(socket_path);
+    const double server_cpu_start = probe_fd >= 0 ? PeerCpuMs(probe_fd) : 0.0;
+    const double client_cpu_start = SelfCpuMs();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (int32_t i = 0; i < concurrency; ++i) {
+        clients.emplace_back(client);
+    }
+    for (auto& thread : clients) {
+        thread.join();
+    }
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double client_cpu_ms = SelfCpuMs() - client_cpu_start;
+    const double server_cpu_ms = probe_fd >= 0 ? PeerCpuMs(probe_fd) - server_cpu_start : 0.0;
+    if (probe_fd >= 0) {
+        close(probe_fd);
+    }
+
+    std::vector<double> latencies;
+    double queue_ms = 0.0;
+    double run_ms = 0.0;
+    int32_t counts[4] = {0, 0, 0, 0};
+    for (const auto& s : samples) {
+        counts[std::min<uint8_t>(s.status, 3)]++;
+        if (s.status == static_cast<uint8_t>(ServerStatus::Ok)) {
+            latencies.push_back(s.latency_ms);
+            queue_ms += s.queue_us / 1000.0;
+            run_ms += s.run_us / 1000.0;
+        }
+    }
+    const size_t ok = latencies.size();
+
+    std::cout << samples.size() << " requests over " << (use_shm ? "shm" : "socket") << ", " << concurrency
+              << " clients, " << audio.size() / 16000.0 << " s audio each, " << wall_s << " s\n";
+    std::cout << "status: " << counts[0] << " ok, " << counts[1] << " busy, "
+              << counts[2] << " draining, " << counts[3] << " bad request\n";
+    std::cout << "throughput: " << ok / wall_s << " QPS\n";
+    if (ok > 0) {
+        std::cout << "latency: p50 " << Percentile(latencies, 0.50) << " ms, p99 " << Percentile(latencies, 0.99)
+                  << " ms, max " << Percentile(latencies, 1.0) << " ms\n";
+        std::cout << "server: queue " << queue_ms / ok << " ms, run " << run_ms / ok << " ms (mean)\n";
+        std::cout << "cpu/request: client " << client_cpu_ms / samples.size() << " ms, server "
+                  << server_cpu_ms / samples.size() << " ms\n";
+    }
+    if (!first_text.empty()) {
+        std::cout << "first result: " << first_text << "\n";
+    }
+    return (failed_clients > 0 || ok == 0) ? 1 : 0;
+}
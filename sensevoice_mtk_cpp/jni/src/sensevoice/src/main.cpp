@@ -1,15 +1,20 @@
 /* SenseVoice Main - Speech Recognition Demo
  *
- * Usage: sensevoice_main <model.dla> <tokens.txt> <audio.wav> [language] [text_norm]
+ * Usage: sensevoice_main <model.dla> <tokens.txt> <audio.wav> [language] [text_norm] [decoder] [hotwords.txt]
+ *        sensevoice_main <model.svb> - <audio.wav> [language] [text_norm] [decoder] [hotwords.txt]
  *
  * Language options: auto, zh, en, yue, ja, ko
  * Text norm options: with_itn, without_itn
+ * Decoder options: greedy, beam, beam<N> (e.g. beam4)
+ * Hotwords: one phrase per line, decoded with beam search
  */
 
 #include "sensevoice.h"
 #include "common/Log.h"
 #include "neuron/api/APUWareUtilsLib.h"
 
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <chrono>
@@ -18,17 +23,21 @@ INITIALIZE_EASYLOGGINGPP
 
 void PrintUsage(const char* program_name) {
     std::cout << "SenseVoice Speech Recognition for MTK NPU\n\n";
-    std::cout << "Usage: " << program_name << " <model.dla> <tokens.txt> <audio.wav> [language] [text_norm]\n\n";
+    std::cout << "Usage: " << program_name << " <model.dla> <tokens.txt> <audio.wav> [language] [text_norm] [decoder] [hotwords.txt]\n\n";
     std::cout << "Arguments:\n";
-    std::cout << "  model.dla    Path to SenseVoice DLA model file\n";
-    std::cout << "  tokens.txt   Path to tokens file\n";
+    std::cout << "  model.dla    Path to SenseVoice DLA model file, or a .svb bundle from make_bundle.py\n";
+    std::cout << "  tokens.txt   Path to tokens file (tokens.txt, or tokens.bin from tokens2bin.py;\n";
+    std::cout << "               ignored for a bundle that carries its vocabulary, pass -)\n";
     std::cout << "  audio.wav    Path to audio file (WAV or PCM, 16kHz mono)\n";
     std::cout << "  language     Language hint: auto, zh, en, yue, ja, ko (default: auto)\n";
-    std::cout << "  text_norm    Text normalization: with_itn (punctuation), without_itn (default: with_itn)\n\n";
+    std::cout << "  text_norm    Text normalization: with_itn (punctuation), without_itn (default: with_itn)\n";
+    std::cout << "  decoder      CTC search: greedy, beam (beam 8) or beam<N> (default: greedy)\n";
+    std::cout << "  hotwords.txt Phrases to boost, one per line: <phrase>[\\t<boost>[\\t<ids>]]\n\n";
     std::cout << "Examples:\n";
     std::cout << "  " << program_name << " sensevoice.dla tokens.txt test.wav\n";
     std::cout << "  " << program_name << " sensevoice.dla tokens.txt test.wav zh\n";
     std::cout << "  " << program_name << " sensevoice.dla tokens.txt test.wav auto without_itn\n";
+    std::cout << "  " << program_name << " sensevoice.dla tokens.txt test.wav auto with_itn beam4\n";
 }
 
 sensevoice::Language ParseLanguage(const std::string& lang_str) {
@@ -47,6 +56,18 @@ sensevoice::Language ParseLanguage(const std::string& lang_str) {
     }
 }
 
+// Resident set size of this process in KB (0 if unavailable)
+long ReadVmRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return std::atol(line.c_str() + 6);
+        }
+    }
+    return 0;
+}
+
 sensevoice::TextNorm ParseTextNorm(const std::string& norm_str) {
     if (norm_str == "with_itn" || norm_str == "itn") {
         return sensevoice::TextNorm::WithITN;
@@ -55,7 +76,23 @@ sensevoice::TextNorm ParseTextNorm(const std::string& norm_str) {
     }
 }
 
+// "greedy" -> greedy search, "beam" / "beam<N>" -> prefix beam search
+void ParseDecoder(const std::string& decoder_str, sensevoice::InferenceConfig* inference) {
+    if (decoder_str.compare(0, 4, "beam") != 0) {
+        inference->use_greedy_search = true;
+        return;
+    }
+    inference->use_greedy_search = false;
+    if (decoder_str.size() > 4) {
+        int beam_size = std::atoi(decoder_str.c_str() + 4);
+        if (beam_size > 0) {
+            inference->beam_size = beam_size;
+        }
+    }
+}
+
 int main(int argc, char* argv[]) {
+    auto program_start = std::chrono::high_resolution_clock::now();
     if (argc < 4) {
         PrintUsage(argv[0]);
         return 1;
@@ -66,6 +103,8 @@ int main(int argc, char* argv[]) {
     std::string audio_path = argv[3];
     std::string language_str = (argc > 4) ? argv[4] : "auto";
     std::string text_norm_str = (argc > 5) ? argv[5] : "with_itn";  // Default: enable punctuation
+    std::string decoder_str = (argc > 6) ? argv[6] : "greedy";
+    std::string hotwords_path = (argc > 7) ? argv[7] : "";
 
     sensevoice::Language language = ParseLanguage(language_str);
     sensevoice::TextNorm text_norm = ParseTextNorm(text_norm_str);
@@ -78,6 +117,10 @@ int main(int argc, char* argv[]) {
     LOG(INFO) << "Audio: " << audio_path;
     LOG(INFO) << "Language: " << language_str;
     LOG(INFO) << "Text Norm: " << text_norm_str;
+    LOG(INFO) << "Decoder: " << decoder_str;
+    if (!hotwords_path.empty()) {
+        LOG(INFO) << "Hotwords: " << hotwords_path;
+    }
     LOG(INFO) << "=======================================================";
 
     // Initialize APU power management
@@ -99,7 +142,13 @@ int main(int argc, char* argv[]) {
     LOG(INFO) << "Initializing SenseVoice...";
     auto init_start = std::chrono::high_resolution_clock::now();
 
-    if (!sv.Initialize(model_path, tokens_path)) {
+    sensevoice::SenseVoiceConfig config;
+    config.model.model_path = model_path;
+    config.model.tokens_path = tokens_path;
+    ParseDecoder(decoder_str, &config.inference);
+    config.inference.hotwords_path = hotwords_path;
+
+    if (!sv.Initialize(config)) {
         LOG(ERROR) << "Failed to initialize SenseVoice";
         if (ApuLib.mEnable) {
             ApuLib.releasePerformanceLock(powerHalHandle);
@@ -110,7 +159,8 @@ int main(int argc, char* argv[]) {
     auto init_end = std::chrono::high_resolution_clock::now();
     auto init_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
         init_end - init_start).count();
-    LOG(INFO) << "Initialization completed in " << init_duration << " ms";
+    LOG(INFO) << "Initialization completed in " << init_duration << " ms (RSS "
+              << ReadVmRssKb() << " KB)";
 
     // Recognize speech
     LOG(INFO) << "-------------------------------------------------------";
@@ -118,6 +168,12 @@ int main(int argc, char* argv[]) {
 
     sensevoice::RecognitionResult result = sv.RecognizeFile(audio_path, language, text_norm);
 
+    auto first_result = std::chrono::high_resolution_clock::now();
+    LOG(INFO) << "Time to first result: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     first_result - program_start).count()
+              << " ms (RSS " << ReadVmRssKb() << " KB)";
+
     LOG(INFO) << "-------------------------------------------------------";
     LOG(INFO) << "Recognition Result:";
     LOG(INFO) << "-------------------------------------------------------";
@@ -138,6 +194,9 @@ int main(int argc, char* argv[]) {
         if (!result.event.empty()) {
             LOG(INFO) << "Detected Event: " << result.event;
         }
+        if (!result.confidences.empty()) {
+            LOG(INFO) << "Confidence: " << result.confidence;
+        }
 
         // Print token details if verbose
         if (result.tokens.size() <= 50) {  // Only print if not too many
@@ -145,7 +204,9 @@ int main(int argc, char* argv[]) {
             LOG(INFO) << "Tokens (" << result.tokens.size() << "):";
             for (size_t i = 0; i < result.tokens.size(); ++i) {
                 LOG(INFO) << "  [" << i << "] t=" << result.timestamps[i]
-                          << "s: " << result.tokens[i];
+                          << "s" << (i < result.confidences.size()
+                                     ? " p=" + std::to_string(result.confidences[i]) : std::string())
+                          << ": " << result.tokens[i];
             }
         }
     } else {
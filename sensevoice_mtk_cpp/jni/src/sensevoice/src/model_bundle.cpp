@@ -0,0 +1,255 @@
+/* Model Bundle Implementation
+ *
+ * Maps the bundle read-only and serves its sections in place.
+ */
+
+#include "model_bundle.h"
+#include "common/Log.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace sensevoice {
+
+namespace {
+
+// "1x166x560;1;1" -> {{1, 166, 560}, {1}, {1}}
+bool ParseShapes(const std::string& text, std::vector<std::vector<uint32_t>>* shapes) {
+    shapes->clear();
+    std::stringstream tensors(text);
+    std::string tensor;
+    while (std::getline(tensors, tensor, ';')) {
+        std::vector<uint32_t> dims;
+        std::stringstream dim_stream(tensor);
+        std::string dim;
+        while (std::getline(dim_stream, dim, 'x')) {
+            char* end = nullptr;
+            unsigned long value = std::strtoul(dim.c_str(), &end, 10);
+            if (dim.empty() || *end != '\0' || value == 0) {
+                return false;
+            }
+            dims.push_back(static_cast<uint32_t>(value));
+        }
+        if (dims.empty()) {
+            return false;
+        }
+        shapes->push_back(dims);
+    }
+    return !shapes->empty();
+}
+
+}  // namespace
+
+ModelBundle::~ModelBundle() {
+    if (mapped_) {
+        munmap(mapped_, mapped_bytes_);
+    }
+}
+
+bool ModelBundle::IsBundle(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    char magic[4] = {};
+    bool is_bundle = pread(fd, magic, sizeof(magic), 0) == sizeof(magic) &&
+                     std::memcmp(magic, "SVBN", 4) == 0;
+    close(fd);
+    return is_bundle;
+}
+
+bool ModelBundle::Open(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG(ERROR) << "Failed to open bundle: " << path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(BundleFileHeader)) {
+        LOG(ERROR) << "Bundle too small: " << path;
+        close(fd);
+        return false;
+    }
+
+    // One shared read-only mapping for the whole file; sections are paged in
+    // only when they are touched
+    const size_t file_bytes = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, file_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        LOG(ERROR) << "mmap fail: " << path;
+        return false;
+    }
+    mapped_ = addr;
+    mapped_bytes_ = file_bytes;
+    path_ = path;
+
+    const auto* base = static_cast<const char*>(addr);
+    BundleFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, "SVBN", 4) != 0) {
+        LOG(ERROR) << "Not a model bundle: " << path;
+        return false;
+    }
+    if (header.version != kBundleFileVersion) {
+        LOG(ERROR) << "Bundle " << path << " has version " << header.version
+                   << ", expected " << kBundleFileVersion << " (re-run make_bundle.py)";
+        return false;
+    }
+    const uint64_t table_end = sizeof(BundleFileHeader) +
+                               uint64_t(header.num_sections) * sizeof(BundleSection);
+    if (header.file_bytes != file_bytes || table_end > file_bytes) {
+        LOG(ERROR) << "Bundle " << path << " is truncated or corrupt";
+        return false;
+    }
+
+    sections_.resize(header.num_sections);
+    std::memcpy(sections_.data(), base + sizeof(BundleFileHeader),
+                sections_.size() * sizeof(BundleSection));
+    for (const auto& section : sections_) {
+        if (section.offset < table_end || section.offset > file_bytes ||
+            section.size > file_bytes - section.offset) {
+            LOG(ERROR) << "Bundle " << path << " has an out-of-range section " << section.type;
+            return false;
+        }
+    }
+
+    const BundleSection* meta = FindSection(kSectionMetadata);
+    if (meta == nullptr || !ParseMetadata(base + meta->offset, meta->size)) {
+        LOG(ERROR) << "Bundle " << path << " has no valid metadata";
+        return false;
+    }
+    if (FindSection(kSectionDla) == nullptr) {
+        LOG(ERROR) << "Bundle " << path << " has no DLA section";
+        return false;
+    }
+
+    LOG(INFO) << "Model bundle " << path << ": " << metadata_.name << ", "
+              << sections_.size() << " sections, " << file_bytes / 1024 << " KB";
+    return true;
+}
+
+const BundleSection* ModelBundle::FindSection(BundleSectionType type) const {
+    for (const auto& section : sections_) {
+        if (section.type == type) {
+            return &section;
+        }
+    }
+    return nullptr;
+}
+
+const void* ModelBundle::SectionData(BundleSectionType type) const {
+    const BundleSection* section = FindSection(type);
+    if (section == nullptr || mapped_ == nullptr) {
+        return nullptr;
+    }
+    return static_cast<const char*>(mapped_) + section->offset;
+}
+
+size_t ModelBundle::SectionSize(BundleSectionType type) const {
+    const BundleSection* section = FindSection(type);
+    return section ? static_cast<size_t>(section->size) : 0;
+}
+
+void ModelBundle::Evict(BundleSectionType type) {
+    const BundleSection* section = FindSection(type);
+    if (section == nullptr || mapped_ == nullptr) {
+        return;
+    }
+    // Shrink to whole pages inside the section so neighbours stay resident
+    const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t begin = (section->offset + page - 1) / page * page;
+    uint64_t end = (section->offset + section->size) / page * page;
+    if (end > begin) {
+        madvise(static_cast<char*>(mapped_) + begin, end - begin, MADV_DONTNEED);
+    }
+}
+
+bool ModelBundle::ParseMetadata(const char* data, size_t size) {
+    metadata_ = BundleMetadata();
+    std::stringstream lines(std::string(data, size));
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            continue;
+        }
+        const std::string key = line.substr(0, eq);
+        const std::string value = line.substr(eq + 1);
+        const int32_t number = std::atoi(value.c_str());
+
+        if (key == "name") {
+            metadata_.name = value;
+        } else if (key == "input_frames") {
+            metadata_.input_frames = number;
+        } else if (key == "vocab_size") {
+            metadata_.vocab_size = number;
+        } else if (key == "input_feat_dim") {
+            metadata_.input_feat_dim = number;
+        } else if (key == "lfr_window_size") {
+            metadata_.lfr_window_size = number;
+        } else if (key == "lfr_window_shift") {
+            metadata_.lfr_window_shift = number;
+        } else if (key == "sample_rate") {
+            metadata_.sample_rate = number;
+        } else if (key == "num_mel_bins") {
+            metadata_.num_mel_bins = number;
+        } else if (key == "batch_size") {
+            metadata_.batch_size = number;
+        } else if (key == "packed") {
+            metadata_.packed = number != 0;
+        } else if (key == "input_shapes") {
+            if (!ParseShapes(value, &metadata_.input_shapes)) {
+                LOG(ERROR) << "Bad input_shapes in bundle metadata: " << value;
+                return false;
+            }
+        } else if (key == "output_shapes") {
+            if (!ParseShapes(value, &metadata_.output_shapes)) {
+                LOG(ERROR) << "Bad output_shapes in bundle metadata: " << value;
+                return false;
+            }
+        } else if (key == "input_type") {
+            metadata_.input_type = value;
+        } else if (key == "output_type") {
+            metadata_.output_type = value;
+        } else if (key == "input_scale") {
+            metadata_.input_scale = std::strtof(value.c_str(), nullptr);
+        }
+        // Unknown keys are ignored so newer bundles stay loadable
+    }
+    return !metadata_.input_shapes.empty() && !metadata_.output_shapes.empty();
+}
+
+void ModelBundle::ApplyTo(ModelConfig* model, AudioConfig* audio) const {
+    const BundleMetadata& m = metadata_;
+    if (m.input_frames > 0) model->input_frames = m.input_frames;
+    if (m.vocab_size > 0) model->vocab_size = m.vocab_size;
+    if (m.input_feat_dim > 0) model->input_feat_dim = m.input_feat_dim;
+    if (m.lfr_window_size > 0) model->lfr_window_size = m.lfr_window_size;
+    if (m.lfr_window_shift > 0) model->lfr_window_shift = m.lfr_window_shift;
+    if (m.batch_size > 0) model->batch_size = m.batch_size;
+    if (m.input_scale > 0.0f) model->input_scale = m.input_scale;
+    model->packed = m.packed;
+    if (m.sample_rate > 0) {
+        model->sample_rate = m.sample_rate;
+        audio->sample_rate = m.sample_rate;
+    }
+    if (m.num_mel_bins > 0) {
+        model->num_mel_bins = m.num_mel_bins;
+        audio->num_mel_bins = m.num_mel_bins;
+    }
+}
+
+}  // namespace sensevoice
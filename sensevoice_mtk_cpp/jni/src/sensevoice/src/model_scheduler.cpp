@@ -0,0 +1,175 @@
+/* Model Scheduler Implementation
+ *
+ * Lane selection, slack-based batch admission and queue-wait accounting.
+ */
+
+#include "model_scheduler.h"
+
+#include <algorithm>
+
+namespace sensevoice {
+
+namespace {
+
+// Weight of the newest run in the run-time estimates
+constexpr double kRunTimeSmoothing = 0.2;
+
+size_t LaneIndex(Priority priority) {
+    return priority == Priority::Interactive ? 0 : 1;
+}
+
+}  // namespace
+
+ScheduledRequest::ScheduledRequest(ModelScheduler* scheduler, Priority priority,
+                                   Clock::time_point deadline, bool has_deadline)
+    : scheduler_(scheduler), priority_(priority), deadline_(deadline), has_deadline_(has_deadline) {}
+
+ScheduledRequest::~ScheduledRequest() {
+    scheduler_->End(this);
+}
+
+ModelScheduler::ModelScheduler(const SchedulingConfig& config, int32_t num_executions)
+    : config_(config), num_executions_(std::max(1, num_executions)) {}
+
+std::unique_ptr<ScheduledRequest> ModelScheduler::Begin(const RequestOptions& options) {
+    const bool has_deadline = options.deadline != Clock::time_point();
+    Clock::time_point deadline = options.deadline;
+    if (!has_deadline) {
+        deadline = options.priority == Priority::Interactive
+                       ? Clock::now() + std::chrono::milliseconds(config_.interactive_deadline_ms)
+                       : Clock::time_point::max();
+    }
+    std::unique_ptr<ScheduledRequest> request(
+        new ScheduledRequest(this, options.priority, deadline, has_deadline));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_.push_back(request.get());
+    Lane(options.priority).requests++;
+    return request;
+}
+
+void ModelScheduler::End(ScheduledRequest* request) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_.erase(std::remove(active_.begin(), active_.end(), request), active_.end());
+        if (request->has_deadline_ && Clock::now() > request->deadline_) {
+            Lane(request->priority_).deadline_misses++;
+        }
+    }
+    // A finished interactive request may free the slack a batch run waits for
+    cv_.notify_all();
+}
+
+ModelScheduler::Grant::Grant(ModelScheduler* scheduler, ScheduledRequest* request)
+    : scheduler_(scheduler), request_(request) {
+    scheduler_->Acquire(request_);
+    start_ = std::chrono::steady_clock::now();
+}
+
+ModelScheduler::Grant::~Grant() {
+    scheduler_->Release(request_, std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_).count());
+}
+
+void ModelScheduler::Acquire(ScheduledRequest* request) {
+    const Clock::time_point enqueue_time = Clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    Waiter waiter = {request, next_sequence_++};
+    waiting_.push_back(&waiter);
+
+    bool deferred = false;
+    cv_.wait(lock, [&] {
+        bool slack_blocked = false;
+        if (running_ < num_executions_ && IsNext(&waiter, Clock::now(), &slack_blocked)) {
+            return true;
+        }
+        if (slack_blocked && !deferred) {
+            deferred = true;
+            stats_.batch_deferrals++;
+        }
+        return false;
+    });
+
+    running_++;
+    waiting_.erase(std::find(waiting_.begin(), waiting_.end(), &waiter));
+    const int64_t wait_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - enqueue_time).count();
+    request->queue_wait_us_ += wait_us;
+    LaneStats& lane = Lane(request->priority_);
+    lane.queue_wait_us += wait_us;
+    lane.max_queue_wait_us = std::max(lane.max_queue_wait_us, wait_us);
+
+    // The next waiter may take another free execution
+    if (running_ < num_executions_ && !waiting_.empty()) {
+        cv_.notify_all();
+    }
+}
+
+void ModelScheduler::Release(ScheduledRequest* request, int64_t run_us) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_--;
+        request->runs_++;
+        Lane(request->priority_).runs++;
+        double& estimate = estimated_run_us_[LaneIndex(request->priority_)];
+        estimate = estimate > 0.0 ? estimate + kRunTimeSmoothing * (run_us - estimate)
+                                  : static_cast<double>(run_us);
+    }
+    cv_.notify_all();
+}
+
+bool ModelScheduler::IsNext(const Waiter* waiter, Clock::time_point now,
+                            bool* slack_blocked) const {
+    // Earliest deadline first within a lane, arrival order on ties
+    auto before = [](const Waiter* a, const Waiter* b) {
+        return a->request->deadline_ != b->request->deadline_
+                   ? a->request->deadline_ < b->request->deadline_
+                   : a->sequence < b->sequence;
+    };
+
+    const Waiter* first_interactive = nullptr;
+    const Waiter* first_batch = nullptr;
+    for (const Waiter* other : waiting_) {
+        const Waiter*& first =
+            other->request->priority_ == Priority::Interactive ? first_interactive : first_batch;
+        if (!first || before(other, first)) {
+            first = other;
+        }
+    }
+
+    if (first_interactive) {
+        return waiter == first_interactive;
+    }
+    if (waiter != first_batch) {
+        return false;
+    }
+    if (!BatchFits(now)) {
+        *slack_blocked = true;
+        return false;
+    }
+    return true;
+}
+
+bool ModelScheduler::BatchFits(Clock::time_point now) const {
+    // Another execution stays free for an interactive request
+    if (running_ + 1 < num_executions_) {
+        return true;
+    }
+    const auto batch_run = std::chrono::microseconds(static_cast<int64_t>(estimated_run_us_[1]));
+    const auto interactive_run = std::chrono::microseconds(static_cast<int64_t>(estimated_run_us_[0]));
+    for (const ScheduledRequest* other : active_) {
+        // An interactive request in progress needs at least one more run
+        if (other->priority_ == Priority::Interactive &&
+            now + batch_run + interactive_run > other->deadline_) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SchedulerStats ModelScheduler::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+}  // namespace sensevoice
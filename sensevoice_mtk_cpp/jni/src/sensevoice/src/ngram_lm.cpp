@@ -0,0 +1,198 @@
+/* N-gram Language Model Implementation
+ *
+ * Back-off lookups walk the trie from the oldest context word; children
+ * are found by binary search over the sorted word ids of a level.
+ */
+
+#include "ngram_lm.h"
+#include "common/Log.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace sensevoice {
+
+NgramLm::~NgramLm() {
+    if (mapped_) {
+        munmap(mapped_, mapped_bytes_);
+    }
+}
+
+bool NgramLm::Load(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG(ERROR) << "Failed to open LM: " << path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(LmFileHeader)) {
+        LOG(ERROR) << "LM file too small: " << path;
+        close(fd);
+        return false;
+    }
+    const size_t file_bytes = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, file_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        LOG(ERROR) << "mmap fail: " << path;
+        return false;
+    }
+    // Lookups jump around the levels; read-ahead would only inflate RSS
+    madvise(addr, file_bytes, MADV_RANDOM);
+    mapped_ = addr;
+    mapped_bytes_ = file_bytes;
+
+    const auto* base = static_cast<const char*>(addr);
+    LmFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, "SVLM", 4) != 0) {
+        LOG(ERROR) << "Not an LM file: " << path;
+        return false;
+    }
+    if (header.version != kLmFileVersion) {
+        LOG(ERROR) << "LM " << path << " has version " << header.version
+                   << ", expected " << kLmFileVersion << " (re-run arpa2lm.py)";
+        return false;
+    }
+    if (header.order == 0 || header.order > kLmMaxOrder ||
+        header.level_count[0] != header.num_words) {
+        LOG(ERROR) << "LM " << path << " has a bad header";
+        return false;
+    }
+
+    const size_t codebook_bytes = header.order * 2 * 256 * sizeof(float);
+    if (sizeof(LmFileHeader) + codebook_bytes > file_bytes) {
+        LOG(ERROR) << "LM " << path << " is truncated";
+        return false;
+    }
+    const char* codebooks = base + sizeof(LmFileHeader);
+    for (uint32_t n = 0; n < header.order; ++n) {
+        std::memcpy(prob_codebook_[n], codebooks + (2 * n) * 256 * sizeof(float), 256 * sizeof(float));
+        std::memcpy(backoff_codebook_[n], codebooks + (2 * n + 1) * 256 * sizeof(float),
+                    256 * sizeof(float));
+    }
+
+    for (uint32_t n = 1; n <= header.order; ++n) {
+        const bool leaf = (n == header.order);
+        const uint64_t count = uint64_t(header.level_count[n - 1]) + (leaf ? 0 : 1);
+        const uint64_t bytes = count * (leaf ? sizeof(LmLeaf) : sizeof(LmEntry));
+        const uint64_t offset = header.level_offset[n - 1];
+        if (offset % 8 != 0 || offset > file_bytes || bytes > file_bytes - offset) {
+            LOG(ERROR) << "LM " << path << " has an out-of-range level " << n;
+            return false;
+        }
+        if (leaf) {
+            leaves_ = reinterpret_cast<const LmLeaf*>(base + offset);
+        } else {
+            entries_[n - 1] = reinterpret_cast<const LmEntry*>(base + offset);
+        }
+        level_count_[n - 1] = header.level_count[n - 1];
+    }
+
+    order_ = header.order;
+    num_words_ = header.num_words;
+    bos_id_ = header.bos_id;
+    eos_id_ = header.eos_id;
+
+    LOG(INFO) << "LM " << path << ": order " << order_ << ", " << num_words_ << " words, "
+              << file_bytes / 1024 << " KB mapped";
+    return true;
+}
+
+uint8_t NgramLm::ProbIndex(uint32_t n, int64_t index) const {
+    return n == order_ ? leaves_[index].prob : entries_[n - 1][index].prob;
+}
+
+float NgramLm::Backoff(uint32_t n, int64_t index) const {
+    return n < order_ ? backoff_codebook_[n - 1][entries_[n - 1][index].backoff] : 0.0f;
+}
+
+int64_t NgramLm::FindChild(uint32_t n, int64_t parent, int32_t word) const {
+    const LmEntry* level = entries_[n - 1];
+    uint32_t begin = level[parent].first_child;
+    uint32_t end = level[parent + 1].first_child;
+    if (n + 1 == order_) {
+        const LmLeaf* it = std::lower_bound(leaves_ + begin, leaves_ + end, word,
+                                            [](const LmLeaf& e, int32_t w) { return e.word < w; });
+        return (it != leaves_ + end && it->word == word) ? it - leaves_ : -1;
+    }
+    const LmEntry* next = entries_[n];
+    const LmEntry* it = std::lower_bound(next + begin, next + end, word,
+                                         [](const LmEntry& e, int32_t w) { return e.word < w; });
+    return (it != next + end && it->word == word) ? it - next : -1;
+}
+
+int64_t NgramLm::Find(const int32_t* words, uint32_t n) const {
+    if (words[0] < 0 || static_cast<uint32_t>(words[0]) >= num_words_) {
+        return -1;
+    }
+    int64_t index = words[0];
+    for (uint32_t j = 1; j < n && index >= 0; ++j) {
+        index = FindChild(j, index, words[j]);
+    }
+    return index;
+}
+
+NgramLm::State NgramLm::BeginState() const {
+    State state;
+    if (order_ > 1 && bos_id_ >= 0 && static_cast<uint32_t>(bos_id_) < num_words_) {
+        state.words[0] = bos_id_;
+        state.length = 1;
+    }
+    return state;
+}
+
+float NgramLm::Score(const State& state, int64_t token, State* next) const {
+    if (!Contains(token)) {
+        *next = state;
+        return 0.0f;
+    }
+
+    // context words followed by the token
+    int32_t words[kLmMaxOrder];
+    const uint32_t length = static_cast<uint32_t>(state.length);
+    std::copy(state.words, state.words + length, words);
+    words[length] = static_cast<int32_t>(token);
+
+    // Longest context first; each missing n-gram adds the back-off of its context
+    float score = 0.0f;
+    float backoff = 0.0f;
+    for (uint32_t start = 0; start <= length; ++start) {
+        const uint32_t n = length - start;
+        if (n == 0) {
+            score = backoff + Prob(1, ProbIndex(1, token));
+            break;
+        }
+        int64_t context = Find(words + start, n);
+        if (context < 0) {
+            continue;
+        }
+        int64_t gram = FindChild(n, context, static_cast<int32_t>(token));
+        if (gram >= 0) {
+            uint8_t q = ProbIndex(n + 1, gram);
+            if (q != kLmAbsent) {
+                score = backoff + Prob(n + 1, q);
+                break;
+            }
+        }
+        backoff += Backoff(n, context);
+    }
+
+    // Keep the last order-1 tokens
+    const uint32_t keep = std::min(length + 1, order_ - 1);
+    next->length = static_cast<int32_t>(keep);
+    std::copy(words + (length + 1 - keep), words + length + 1, next->words);
+    return score;
+}
+
+float NgramLm::FinalScore(const State& state) const {
+    State next;
+    return Score(state, eos_id_, &next);
+}
+
+}  // namespace sensevoice
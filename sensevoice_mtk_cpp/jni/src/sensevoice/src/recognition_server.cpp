@@ -0,0 +1,563 @@
+/* Recognition Server Implementation
+ *
+ * One acceptor thread, one reader thread per connection and max_in_flight
+ * execution threads sharing a bounded request queue. The reader of a
+ * shared-memory connection waits on the client's submit eventfd instead.
+ */
+
+#include "recognition_server.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace sensevoice {
+
+namespace {
+
+bool IsValidLanguage(uint8_t value) {
+    switch (static_cast<Language>(value)) {
+        case Language::Auto:
+        case Language::Chinese:
+        case Language::English:
+        case Language::Cantonese:
+        case Language::Japanese:
+        case Language::Korean:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool IsValidTextNorm(uint8_t value) {
+    return static_cast<TextNorm>(value) == TextNorm::WithITN ||
+           static_cast<TextNorm>(value) == TextNorm::WithoutITN;
+}
+
+uint32_t ElapsedUs(std::chrono::steady_clock::time_point from,
+                   std::chrono::steady_clock::time_point to) {
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+}
+
+}  // namespace
+
+struct RecognitionServer::Connection {
+    explicit Connection(int socket_fd) : fd(socket_fd) {}
+    ~Connection() {
+        if (shm) {
+            munmap(shm, layout.Bytes());
+        }
+        if (submit_fd >= 0) {
+            close(submit_fd);
+        }
+        if (complete_fd >= 0) {
+            close(complete_fd);
+        }
+        close(fd);
+    }
+
+    int fd;
+    std::mutex write_mutex;  // Responses from different workers must not interleave
+    std::thread reader;
+    std::atomic<bool> closed{false};
+
+    // Shared-memory ring (nullptr for socket transport)
+    void* shm = nullptr;
+    ShmRingLayout layout;    // From the attach message, never re-read from the ring
+    int submit_fd = -1;
+    int complete_fd = -1;
+    std::vector<uint8_t> slot_busy;  // Slots taken and not yet completed, under write_mutex
+};
+
+RecognitionServer::RecognitionServer(SenseVoice* recognizer)
+    : recognizer_(recognizer) {}
+
+RecognitionServer::~RecognitionServer() {
+    Drain();
+}
+
+bool RecognitionServer::Start(const ServerConfig& config) {
+    if (running_) {
+        LOG(ERROR) << "Recognition server already running";
+        return false;
+    }
+    if (!recognizer_ || !recognizer_->IsInitialized()) {
+        LOG(ERROR) << "Recognition server needs an initialized SenseVoice";
+        return false;
+    }
+
+    config_ = config;
+    config_.max_in_flight = std::max(1, config_.max_in_flight);
+    config_.max_queued = std::max(1, config_.max_queued);
+
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (config_.socket_path.empty() || config_.socket_path.size() >= sizeof(addr.sun_path)) {
+        LOG(ERROR) << "Invalid socket path: " << config_.socket_path;
+        return false;
+    }
+    std::memcpy(addr.sun_path, config_.socket_path.c_str(), config_.socket_path.size());
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        LOG(ERROR) << "socket() failed: " << std::strerror(errno);
+        return false;
+    }
+
+    // A leftover socket file from a previous run is replaced, a live server is not
+    if (connect(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+        LOG(ERROR) << "Another server is listening on " << config_.socket_path;
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    close(listen_fd_);
+    unlink(config_.socket_path.c_str());
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0 ||
+        bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listen_fd_, SOMAXCONN) != 0) {
+        LOG(ERROR) << "Failed to listen on " << config_.socket_path << ": " << std::strerror(errno);
+        if (listen_fd_ >= 0) {
+            close(listen_fd_);
+            listen_fd_ = -1;
+        }
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        draining_ = false;
+        stop_ = false;
+        in_flight_ = 0;
+        stats_ = ServerStats();
+    }
+    running_ = true;
+
+    for (int32_t i = 0; i < config_.max_in_flight; ++i) {
+        workers_.emplace_back(&RecognitionServer::WorkerLoop, this);
+    }
+    acceptor_ = std::thread(&RecognitionServer::AcceptLoop, this);
+
+    LOG(INFO) << "Recognition server listening on " << config_.socket_path
+              << " (in-flight " << config_.max_in_flight << ", queue " << config_.max_queued << ")";
+    return true;
+}
+
+void RecognitionServer::Drain() {
+    if (!running_) {
+        return;
+    }
+
+    // Stop taking new work; readers now answer Draining
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        draining_ = true;
+    }
+    shutdown(listen_fd_, SHUT_RDWR);  // Wakes the acceptor
+    if (acceptor_.joinable()) {
+        acceptor_.join();
+    }
+    close(listen_fd_);
+    listen_fd_ = -1;
+    unlink(config_.socket_path.c_str());
+
+    // Let queued and running requests finish
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        LOG(INFO) << "Draining " << queue_.size() << " queued, " << in_flight_ << " running requests";
+        idle_cv_.wait(lock, [this] { return queue_.empty() && in_flight_ == 0; });
+        stop_ = true;
+    }
+    queue_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    // Every response is out: close the connections and wait for their readers
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    for (auto& connection : connections_) {
+        shutdown(connection->fd, SHUT_RDWR);
+    }
+    for (auto& connection : connections_) {
+        connection->reader.join();
+    }
+    connections_.clear();
+
+    running_ = false;
+    ServerStats stats = GetStats();
+    LOG(INFO) << "Recognition server drained: " << stats.completed << " completed, "
+              << stats.busy << " busy, " << stats.draining << " draining, "
+              << stats.bad_requests << " bad requests";
+}
+
+ServerStats RecognitionServer::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void RecognitionServer::AcceptLoop() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (draining_) {
+                break;
+            }
+            lock.unlock();
+            LOG(WARNING) << "accept() failed: " << std::strerror(errno);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        ReapConnections();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.connections++;
+        }
+        auto connection = std::make_shared<Connection>(fd);
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connection->reader = std::thread(&RecognitionServer::ReadLoop, this, connection);
+        connections_.push_back(std::move(connection));
+    }
+}
+
+void RecognitionServer::ReapConnections() {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    auto it = std::remove_if(connections_.begin(), connections_.end(),
+                             [](const std::shared_ptr<Connection>& connection) {
+                                 if (!connection->closed) {
+                                     return false;
+                                 }
+                                 connection->reader.join();
+                                 return true;
+                             });
+    connections_.erase(it, connections_.end());
+}
+
+void RecognitionServer::ReadLoop(std::shared_ptr<Connection> connection) {
+    while (true) {
+        ServerRequestHeader header;
+        int fds[3];
+        int num_fds = 0;
+        if (!ReadFullWithFds(connection->fd, &header, sizeof(header), fds, 3, &num_fds)) {
+            for (int i = 0; i < num_fds; ++i) {
+                close(fds[i]);
+            }
+            break;  // Peer closed, or shut down by Drain()
+        }
+        if (header.magic == kServerShmAttachMagic && !connection->shm) {
+            ServerShmAttach attach;
+            std::memcpy(&attach, &header, sizeof(attach));
+            const bool attached = AttachSharedMemory(connection.get(), attach, fds, num_fds);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                attached ? stats_.shm_attached++ : stats_.bad_requests++;
+            }
+            if (!Reply(connection.get(), attached ? ServerStatus::Ok : ServerStatus::BadRequest, 0) ||
+                !attached) {
+                break;
+            }
+            SharedMemoryLoop(connection);
+            break;
+        }
+        for (int i = 0; i < num_fds; ++i) {
+            close(fds[i]);
+        }
+        if (header.magic != kServerRequestMagic || header.version != kServerProtocolVersion ||
+            header.num_samples > kServerMaxSamples || !IsValidLanguage(header.language) ||
+            !IsValidTextNorm(header.text_norm)) {
+            // The framing can't be trusted past a bad header
+            LOG(WARNING) << "Bad request header, closing connection";
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.bad_requests++;
+            }
+            Reply(connection.get(), ServerStatus::BadRequest, header.request_id);
+            break;
+        }
+
+        Job job;
+        job.samples.resize(header.num_samples);
+        if (!ReadFull(connection->fd, job.samples.data(), sizeof(int16_t) * header.num_samples)) {
+            break;
+        }
+
+        job.connection = connection;
+        job.header = header;
+        ServerStatus status = Enqueue(&job);
+        if (status != ServerStatus::Ok) {
+            Reply(connection.get(), status, header.request_id);
+        }
+    }
+    connection->closed = true;
+}
+
+ServerStatus RecognitionServer::Enqueue(Job* job) {
+    ServerStatus status = ServerStatus::Ok;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.requests++;
+        if (draining_) {
+            status = ServerStatus::Draining;
+            stats_.draining++;
+        } else if (queue_.size() >= static_cast<size_t>(config_.max_queued)) {
+            status = ServerStatus::Busy;
+            stats_.busy++;
+        } else {
+            job->enqueue_time = std::chrono::steady_clock::now();
+            queue_.push_back(std::move(*job));
+        }
+    }
+    if (status == ServerStatus::Ok) {
+        queue_cv_.notify_one();
+    }
+    return status;
+}
+
+bool RecognitionServer::AttachSharedMemory(Connection* connection,
+                                           const ServerShmAttach& attach,
+                                           const int* fds,
+                                           int num_fds) {
+    const bool valid = num_fds == 3 && attach.version == kServerProtocolVersion &&
+                       attach.num_slots > 0 && attach.num_slots <= kServerMaxShmSlots &&
+                       attach.slot_samples <= kServerMaxSamples &&
+                       attach.text_bytes <= kServerMaxShmTextBytes;
+    ShmRingLayout layout;
+    layout.num_slots = attach.num_slots;
+    layout.slot_samples = attach.slot_samples;
+    layout.text_bytes = attach.text_bytes;
+
+    // The memfd must really hold the ring it claims
+    struct stat st;
+    void* shm = MAP_FAILED;
+    if (valid && fstat(fds[0], &st) == 0 && static_cast<size_t>(st.st_size) >= layout.Bytes()) {
+        shm = mmap(nullptr, layout.Bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    }
+    for (int i = 0; i < num_fds; ++i) {
+        if (i == 0 || shm == MAP_FAILED) {
+            close(fds[i]);  // The mapping keeps the memory
+        }
+    }
+    if (shm == MAP_FAILED) {
+        LOG(WARNING) << "Rejected shared-memory attach (" << num_fds << " descriptors, "
+                     << attach.num_slots << " slots of " << attach.slot_samples << " samples)";
+        return false;
+    }
+
+    connection->shm = shm;
+    connection->layout = layout;
+    connection->submit_fd = fds[1];
+    connection->complete_fd = fds[2];
+    connection->slot_busy.assign(layout.num_slots, 0);
+    LOG(INFO) << "Shared-memory ring attached: " << layout.num_slots << " slots of "
+              << layout.slot_samples << " samples (" << layout.Bytes() / 1024 << " KB)";
+    return true;
+}
+
+void RecognitionServer::SharedMemoryLoop(const std::shared_ptr<Connection>& connection) {
+    const ShmRingLayout& layout = connection->layout;
+    ShmRingHeader* ring = layout.Header(connection->shm);
+    const uint32_t* submit_ring = layout.SubmitRing(connection->shm);
+
+    pollfd fds[2] = {{connection->fd, POLLIN, 0}, {connection->submit_fd, POLLIN, 0}};
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[0].revents) {
+            break;  // Closed by the client or by Drain(); the socket carries no data after attach
+        }
+        if (!(fds[1].revents & POLLIN)) {
+            continue;
+        }
+        uint64_t count;
+        if (read(connection->submit_fd, &count, sizeof(count)) != sizeof(count)) {
+            continue;
+        }
+
+        const uint32_t head = ring->submit_head.value.load(std::memory_order_acquire);
+        uint32_t tail = ring->submit_tail.value.load(std::memory_order_relaxed);
+        if (head - tail > layout.num_slots) {
+            LOG(WARNING) << "Corrupt submit ring (head " << head << ", tail " << tail << "), detaching";
+            break;
+        }
+        for (; tail != head; ++tail) {
+            const uint32_t slot = submit_ring[tail % layout.num_slots];
+            ring->submit_tail.value.store(tail + 1, std::memory_order_release);
+
+            // Copy the request fields once; the client may write the slot at any time
+            ShmSlotHeader request;
+            bool valid = slot < layout.num_slots;
+            if (valid) {
+                std::memcpy(&request, layout.Slot(connection->shm, slot), sizeof(request));
+                std::lock_guard<std::mutex> lock(connection->write_mutex);
+                valid = !connection->slot_busy[slot];
+                connection->slot_busy[slot] = 1;
+            }
+            if (!valid) {
+                LOG(WARNING) << "Ignoring submitted slot " << slot << " (out of range or in flight)";
+                continue;
+            }
+
+            Job job;
+            job.header.magic = kServerRequestMagic;
+            job.header.version = kServerProtocolVersion;
+            job.header.language = request.language;
+            job.header.text_norm = request.text_norm;
+            job.header.request_id = request.request_id;
+            job.header.num_samples = request.num_samples;
+            job.slot = static_cast<int32_t>(slot);
+
+            ServerStatus status;
+            if (request.num_samples > layout.slot_samples || !IsValidLanguage(request.language) ||
+                !IsValidTextNorm(request.text_norm)) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.bad_requests++;
+                status = ServerStatus::BadRequest;
+            } else {
+                job.connection = connection;
+                status = Enqueue(&job);
+            }
+            if (status != ServerStatus::Ok) {
+                Reply(connection.get(), status, request.request_id, nullptr, 0, 0, static_cast<int32_t>(slot));
+            }
+        }
+    }
+}
+
+void RecognitionServer::WorkerLoop() {
+    const bool batching = recognizer_->GetConfig().batching.enable;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            break;  // stop_ with nothing left
+        }
+        Job job = std::move(queue_.front());
+        queue_.pop_front();
+        in_flight_++;
+        lock.unlock();
+
+        const auto start = std::chrono::steady_clock::now();
+        const Language language = static_cast<Language>(job.header.language);
+        const TextNorm text_norm = static_cast<TextNorm>(job.header.text_norm);
+        RecognitionResult result;
+        // Ring slots are read in place
+        const int16_t* pcm = job.slot >= 0
+                                 ? job.connection->layout.SlotSamples(job.connection->shm, job.slot)
+                                 : job.samples.data();
+        const size_t num_samples = job.header.num_samples;
+        if (batching) {
+            // The batch queue groups concurrent requests into one model run;
+            // the PCM stays in place until the result is back
+            result = recognizer_->Submit(pcm, num_samples, language, text_norm).get();
+        } else {
+            result = recognizer_->Recognize(pcm, num_samples, language, text_norm);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        Reply(job.connection.get(), ServerStatus::Ok, job.header.request_id, &result,
+              ElapsedUs(job.enqueue_time, start), ElapsedUs(start, end), job.slot);
+        job.connection.reset();
+
+        lock.lock();
+        in_flight_--;
+        stats_.completed++;
+        if (queue_.empty() && in_flight_ == 0) {
+            idle_cv_.notify_all();
+        }
+    }
+}
+
+bool RecognitionServer::Reply(Connection* connection,
+                              ServerStatus status,
+                              uint32_t request_id,
+                              const RecognitionResult* result,
+                              uint32_t queue_us,
+                              uint32_t run_us,
+                              int32_t slot) {
+    if (slot >= 0) {
+        const ShmRingLayout& layout = connection->layout;
+        ShmSlotHeader* response = layout.Slot(connection->shm, static_cast<uint32_t>(slot));
+        char* text = layout.SlotText(connection->shm, static_cast<uint32_t>(slot));
+        response->status = static_cast<uint8_t>(status);
+        response->language_length = 0;
+        response->text_length = 0;
+        response->queue_us = queue_us;
+        response->run_us = run_us;
+        response->confidence = 0.0f;
+        if (status == ServerStatus::Ok && result) {
+            const size_t language_length = std::min<size_t>({result->language.size(), 255, layout.text_bytes});
+            const size_t text_length = std::min<size_t>(result->text.size(), layout.text_bytes - language_length);
+            std::memcpy(text, result->language.data(), language_length);
+            std::memcpy(text + language_length, result->text.data(), text_length);
+            response->language_length = static_cast<uint8_t>(language_length);
+            response->text_length = static_cast<uint32_t>(text_length);
+            response->confidence = result->confidence;
+        }
+
+        std::lock_guard<std::mutex> lock(connection->write_mutex);
+        connection->slot_busy[slot] = 0;
+        ShmRingHeader* ring = layout.Header(connection->shm);
+        const uint32_t head = ring->complete_head.value.load(std::memory_order_relaxed);
+        if (head - ring->complete_tail.value.load(std::memory_order_acquire) >= layout.num_slots) {
+            LOG(WARNING) << "Completion ring full, dropping response " << request_id;
+            return false;
+        }
+        layout.CompleteRing(connection->shm)[head % layout.num_slots] = static_cast<uint32_t>(slot);
+        ring->complete_head.value.store(head + 1, std::memory_order_release);
+        const uint64_t one = 1;
+        return write(connection->complete_fd, &one, sizeof(one)) == sizeof(one);
+    }
+
+    ServerResponseHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kServerResponseMagic;
+    header.status = static_cast<uint8_t>(status);
+    header.request_id = request_id;
+    header.queue_us = queue_us;
+    header.run_us = run_us;
+
+    size_t language_length = 0;
+    if (status == ServerStatus::Ok && result) {
+        language_length = std::min<size_t>(result->language.size(), 255);
+        header.language_length = static_cast<uint8_t>(language_length);
+        header.text_length = static_cast<uint32_t>(result->text.size());
+        header.confidence = result->confidence;
+    }
+
+    // One buffer, so a response is a single write in the common case
+    std::string message(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (header.text_length > 0 || language_length > 0) {
+        message.append(result->language, 0, language_length);
+        message.append(result->text);
+    }
+
+    std::lock_guard<std::mutex> lock(connection->write_mutex);
+    if (!WriteFull(connection->fd, message.data(), message.size())) {
+        LOG(WARNING) << "Client went away before response " << request_id;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace sensevoice
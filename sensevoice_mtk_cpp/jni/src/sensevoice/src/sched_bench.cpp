@@ -0,0 +1,205 @@
+/* SenseVoice Scheduling Benchmark - interactive latency under batch load
+ *
+ * Usage: sensevoice_sched_bench <model.dla> <tokens.txt> [backend] [seconds] [batch_audio_s] [interval_ms] [deadline_ms]
+ *
+ * One thread transcribes long utterances back to back (Priority::Batch) while
+ * another issues a short command every interval (Priority::Interactive, with
+ * a deadline). Runs twice on the same recognizer:
+ *   serialized - every request holds the model for its whole duration
+ *                (a bench-side lock around Recognize, as before ModelScheduler)
+ *   scheduled  - requests share the model run by run through ModelScheduler
+ * Reports interactive latency, queue wait and deadline misses, and batch
+ * throughput. Backend host[:<latency_us>] simulates the model on the CPU.
+ */
+
+#include "sensevoice.h"
+#include "bench_common.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+
+using sensevoice::bench::ParseBackend;
+using sensevoice::bench::Percentile;
+
+using Clock = std::chrono::steady_clock;
+
+// Speech-like test signal: a few harmonics under a syllable-rate envelope, plus noise
+std::vector<int16_t> SyntheticAudio(float seconds) {
+    const int32_t sample_rate = 16000;
+    std::vector<int16_t> samples(static_cast<size_t>(seconds * sample_rate));
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        float t = static_cast<float>(i) / sample_rate;
+        float envelope = 0.5f + 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 4.0f * t);
+        float voice = std::sin(2.0f * static_cast<float>(M_PI) * 180.0f * t) +
+                      0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 360.0f * t) +
+                      0.25f * std::sin(2.0f * static_cast<float>(M_PI) * 720.0f * t);
+        seed = seed * 1664525u + 1013904223u;
+        float noise = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 0.05f;
+        samples[i] = static_cast<int16_t>(std::max(-1.0f, std::min(1.0f, 0.3f * envelope * voice + noise)) * 32767.0f);
+    }
+    return samples;
+}
+
+struct BenchOptions {
+    double seconds = 20.0;
+    float batch_audio_s = 60.0f;
+    float command_audio_s = 2.0f;
+    int32_t interval_ms = 500;
+    int32_t deadline_ms = 1000;
+};
+
+void RunMode(sensevoice::SenseVoice* sv, bool serialized, const BenchOptions& options,
+             const std::vector<int16_t>& batch_audio, const std::vector<int16_t>& command_audio) {
+    std::mutex whole_request_mutex;
+    std::atomic<bool> stop{false};
+    const sensevoice::SchedulerStats before = sv->GetSchedulerStats();
+
+    int64_t batch_requests = 0;
+    std::thread batch([&] {
+        sensevoice::RequestOptions request;
+        request.priority = sensevoice::Priority::Batch;
+        while (!stop) {
+            std::unique_lock<std::mutex> lock(whole_request_mutex, std::defer_lock);
+            if (serialized) {
+                lock.lock();
+            }
+            sv->Recognize(batch_audio.data(), batch_audio.size(), sensevoice::Language::Auto,
+                          sensevoice::TextNorm::WithoutITN, request);
+            batch_requests++;
+        }
+    });
+
+    std::vector<double> latencies;
+    int64_t misses = 0;
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point end = start + std::chrono::milliseconds(static_cast<int64_t>(options.seconds * 1000));
+    Clock::time_point next = start + std::chrono::milliseconds(options.interval_ms);
+    while (next < end) {
+        std::this_thread::sleep_until(next);
+        const Clock::time_point issued = Clock::now();
+        sensevoice::RequestOptions request;
+        request.priority = sensevoice::Priority::Interactive;
+        request.deadline = issued + std::chrono::milliseconds(options.deadline_ms);
+        {
+            std::unique_lock<std::mutex> lock(whole_request_mutex, std::defer_lock);
+            if (serialized) {
+                lock.lock();
+            }
+            sv->Recognize(command_audio.data(), command_audio.size(), sensevoice::Language::Auto,
+                          sensevoice::TextNorm::WithoutITN, request);
+        }
+        const double latency_ms = std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - issued).count() / 1000.0;
+        latencies.push_back(latency_ms);
+        if (latency_ms > options.deadline_ms) {
+            misses++;
+        }
+        next = std::max(next + std::chrono::milliseconds(options.interval_ms), Clock::now());
+    }
+    stop = true;
+    batch.join();
+    const double wall_s = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - start).count() / 1000.0;
+
+    const sensevoice::SchedulerStats after = sv->GetSchedulerStats();
+    const int64_t interactive_runs = after.interactive.runs - before.interactive.runs;
+    const int64_t batch_runs = after.batch.runs - before.batch.runs;
+
+    std::cout << (serialized ? "serialized" : "scheduled") << ":\n";
+    std::cout << "  interactive: " << latencies.size() << " requests, latency p50 "
+              << Percentile(latencies, 0.50) << " ms, p99 " << Percentile(latencies, 0.99)
+              << " ms, max " << Percentile(latencies, 1.0) << " ms, " << misses
+              << " over the " << options.deadline_ms << " ms deadline\n";
+    if (interactive_runs > 0) {
+        std::cout << "  interactive queue wait: "
+                  << (after.interactive.queue_wait_us - before.interactive.queue_wait_us) / 1000.0 / interactive_runs
+                  << " ms per run";
+        if (!serialized) {
+            std::cout << ", max " << after.interactive.max_queue_wait_us / 1000.0 << " ms";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "  batch: " << batch_requests << " requests, " << batch_runs << " runs, "
+              << (batch_requests * options.batch_audio_s / wall_s) << " s of audio per second, "
+              << (after.batch_deferrals - before.batch_deferrals) << " runs deferred\n";
+}
+
+}  // namespace
+
+void PrintUsage(const char* program_name) {
+    std::cout << "SenseVoice Scheduling Benchmark\n\n";
+    std::cout << "Usage: " << program_name << " <model.dla> <tokens.txt> [backend] [seconds] [batch_audio_s] [interval_ms] [deadline_ms]\n\n";
+    std::cout << "Arguments:\n";
+    std::cout << "  model.dla      Path to SenseVoice DLA model file, or a .svb bundle (tokens: -)\n";
+    std::cout << "  tokens.txt     Path to tokens file (tokens.txt or tokens.bin)\n";
+    std::cout << "  backend        usdk, runtime or host[:<latency_us>] (CPU stand-in, no NPU) (default: usdk)\n";
+    std::cout << "  seconds        Duration of each mode (default: 20)\n";
+    std::cout << "  batch_audio_s  Length of the batch utterances (default: 60)\n";
+    std::cout << "  interval_ms    Time between interactive commands (default: 500)\n";
+    std::cout << "  deadline_ms    Deadline of an interactive command (default: 1000)\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << program_name << " host tokens.txt host:20000 10\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    sensevoice::SenseVoiceConfig config;
+    config.model.model_path = argv[1];
+    config.model.tokens_path = argv[2];
+    if (argc > 3 && !ParseBackend(argv[3], &config.model)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    BenchOptions options;
+    if (argc > 4) {
+        options.seconds = std::max(1.0, std::atof(argv[4]));
+    }
+    if (argc > 5) {
+        options.batch_audio_s = std::max(1.0f, static_cast<float>(std::atof(argv[5])));
+    }
+    if (argc > 6) {
+        options.interval_ms = std::max(1, std::atoi(argv[6]));
+    }
+    if (argc > 7) {
+        options.deadline_ms = std::max(1, std::atoi(argv[7]));
+    }
+    config.scheduling.interactive_deadline_ms = options.deadline_ms;
+
+    sensevoice::SenseVoice sv;
+    if (!sv.Initialize(config)) {
+        LOG(ERROR) << "Failed to initialize SenseVoice";
+        return 1;
+    }
+
+    // The pipeline logs every request; keep the report readable
+    el::Loggers::reconfigureAllLoggers(el::Level::Info, el::ConfigurationType::Enabled, "false");
+
+    const std::vector<int16_t> batch_audio = SyntheticAudio(options.batch_audio_s);
+    const std::vector<int16_t> command_audio = SyntheticAudio(options.command_audio_s);
+    std::cout << "Batch utterances " << options.batch_audio_s << " s, commands "
+              << options.command_audio_s << " s every " << options.interval_ms << " ms, "
+              << options.seconds << " s per mode\n";
+
+    RunMode(&sv, true, options, batch_audio, command_audio);
+    RunMode(&sv, false, options, batch_audio, command_audio);
+    return 0;
+}
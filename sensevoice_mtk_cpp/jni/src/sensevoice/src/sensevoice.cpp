@@ -4,9 +4,13 @@
  */
 
 #include "sensevoice.h"
+#include "ctc_math.h"
 #include "common/Log.h"
 
+#include <algorithm>
+#include <cctype>
 #include <chrono>
+#include <cmath>
 
 namespace sensevoice {
 
@@ -21,31 +25,141 @@ SenseVoice::~SenseVoice() = default;
 bool SenseVoice::Initialize(const SenseVoiceConfig& config) {
     config_ = config;
 
+    // Model bundle: one mapping provides the DLA, the vocabulary and the model constants
+    bundle_.reset();
+    if (ModelBundle::IsBundle(config.model.model_path)) {
+        bundle_ = std::make_unique<ModelBundle>();
+        if (!bundle_->Open(config.model.model_path)) {
+            LOG(ERROR) << "Failed to open model bundle: " << config.model.model_path;
+            return false;
+        }
+        bundle_->ApplyTo(&config_.model, &config_.audio);
+        config_.vad.max_segment_lfr_frames =
+            std::min(config_.vad.max_segment_lfr_frames, config_.model.input_frames);
+    }
+
     // Initialize audio frontend
-    audio_frontend_ = std::make_unique<AudioFrontend>(config.audio);
+    audio_frontend_ = std::make_unique<AudioFrontend>(config_.audio);
     if (!audio_frontend_) {
         LOG(ERROR) << "Failed to create audio frontend";
         return false;
     }
     LOG(INFO) << "Audio frontend initialized";
 
+    // Initialize VAD
+    if (config_.vad.enable) {
+        vad_ = std::make_unique<Vad>(config_.vad, config_.model.lfr_window_size,
+                                     config_.model.lfr_window_shift);
+        LOG(INFO) << "VAD enabled (max segment: " << config_.vad.max_segment_lfr_frames
+                  << " LFR frames)";
+    } else {
+        vad_.reset();
+    }
+
     // Initialize tokenizer
+    auto tokens_start = std::chrono::high_resolution_clock::now();
     tokenizer_ = std::make_unique<Tokenizer>();
-    if (!tokenizer_->Load(config.model.tokens_path)) {
-        LOG(ERROR) << "Failed to load tokens from: " << config.model.tokens_path;
+    if (bundle_ && bundle_->SectionData(kSectionVocab) != nullptr) {
+        // Vocabulary used in place from the bundle mapping
+        if (!tokenizer_->LoadFromMemory(bundle_->SectionData(kSectionVocab),
+                                        bundle_->SectionSize(kSectionVocab))) {
+            LOG(ERROR) << "Failed to load tokens from bundle: " << config_.model.model_path;
+            return false;
+        }
+    } else if (!tokenizer_->Load(config_.model.tokens_path)) {
+        LOG(ERROR) << "Failed to load tokens from: " << config_.model.tokens_path;
+        return false;
+    }
+    auto tokens_end = std::chrono::high_resolution_clock::now();
+    auto tokens_ms = std::chrono::duration_cast<std::chrono::microseconds>(
+        tokens_end - tokens_start).count() / 1000.0;
+    LOG(INFO) << "Tokenizer loaded with " << tokenizer_->VocabSize() << " tokens in "
+              << tokens_ms << " ms (" << tokenizer_->MemoryFootprint() / 1024 << " KB)";
+
+    // Language model for shallow fusion: mapped, pages come in as the search touches them
+    if (!config_.inference.lm_path.empty() &&
+        !tokenizer_->LoadLanguageModel(config_.inference.lm_path)) {
+        LOG(ERROR) << "Failed to load LM from: " << config_.inference.lm_path;
+        return false;
+    }
+
+    // Beam options also apply when hotwords switch a request to beam search
+    BeamSearchOptions beam;
+    beam.beam_size = config_.inference.beam_size;
+    beam.top_k = config_.inference.beam_top_k;
+    beam.prune_threshold = config_.inference.beam_prune_threshold;
+    beam.lm_weight = config_.inference.lm_weight;
+    beam.lm_token_bonus = config_.inference.lm_token_bonus;
+    const bool use_beam = !config_.inference.use_greedy_search || tokenizer_->LanguageModel();
+    tokenizer_->SetBeamSearch(use_beam, beam);
+    if (use_beam) {
+        LOG(INFO) << "CTC prefix beam search (beam " << beam.beam_size << ", top-k "
+                  << beam.top_k << ", threshold " << beam.prune_threshold << ")"
+                  << (tokenizer_->LanguageModel() ? ", LM weight " + std::to_string(beam.lm_weight) : "");
+    }
+
+    if (!config_.inference.hotwords_path.empty() &&
+        !LoadHotwords(config_.inference.hotwords_path, config_.inference.hotword_boost)) {
+        LOG(ERROR) << "Failed to load hotwords from: " << config_.inference.hotwords_path;
+        return false;
+    }
+
+    if (!config_.inference.keywords_path.empty() &&
+        !LoadKeywords(config_.inference.keywords_path, config_.inference.keyword_threshold)) {
+        LOG(ERROR) << "Failed to load keywords from: " << config_.inference.keywords_path;
         return false;
     }
-    LOG(INFO) << "Tokenizer loaded with " << tokenizer_->VocabSize() << " tokens";
 
     // Initialize model
     model_ = std::make_unique<SenseVoiceModel>();
-    if (!model_->Initialize(config.model)) {
+    if (!model_->Initialize(config_.model, bundle_.get())) {
         LOG(ERROR) << "Failed to initialize model";
         return false;
     }
     LOG(INFO) << "Model initialized";
 
+    // float16 / int8 input DLAs take CMVN-normalized features
+    cmvn_ = CmvnStats();
+    if (model_->HostCmvn() && !LoadCmvnStats()) {
+        return false;
+    }
+
+    scheduler_ = std::make_unique<ModelScheduler>(config_.scheduling, model_->MaxRunsInFlight());
+
+    // Segment workers: one per run in flight next to the calling thread, so
+    // the features of the next window are ready when an execution frees up
+    segment_pool_.reset();
+    if (model_->MaxRunsInFlight() > 1) {
+        segment_pool_ = std::make_unique<ThreadPool>(model_->MaxRunsInFlight());
+        LOG(INFO) << "Long audio: " << model_->MaxRunsInFlight() << " windows in flight";
+    }
+
     initialized_ = true;
+
+    // Request batching
+    batch_queue_.reset();
+    if (config_.batching.enable) {
+        int32_t max_requests = config_.batching.max_requests > 0 ? config_.batching.max_requests
+                                                                 : model_->BatchSize();
+        batch_queue_ = std::make_unique<BatchQueue>(
+            max_requests, config_.batching.max_wait_ms,
+            [this](const std::vector<BatchUtterance>& utterances, Language language,
+                   TextNorm text_norm) {
+                size_t total_samples = 0;
+                for (const auto& utterance : utterances) {
+                    total_samples += utterance.NumSamples();
+                }
+                auto fbank = [&](size_t u) {
+                    const BatchUtterance& utterance = utterances[u];
+                    return utterance.pcm ? ComputeFbank(utterance.pcm, utterance.num_pcm)
+                                         : ComputeFbank(utterance.samples);
+                };
+                return RecognizeBatchFbank(utterances.size(), total_samples, fbank, language,
+                                           text_norm, RequestOptions());
+            });
+        LOG(INFO) << "Request batching enabled (max " << max_requests << " requests, "
+                  << config_.batching.max_wait_ms << " ms)";
+    }
     return true;
 }
 
@@ -61,26 +175,286 @@ bool SenseVoice::IsInitialized() const {
     return initialized_;
 }
 
+void SenseVoice::SetHotwords(std::shared_ptr<const HotwordGraph> hotwords) {
+    std::lock_guard<std::mutex> lock(hotwords_mutex_);
+    hotwords_ = std::move(hotwords);
+}
+
+bool SenseVoice::LoadHotwords(const std::string& path, float default_boost) {
+    if (!tokenizer_) {
+        LOG(ERROR) << "Tokenizer must be loaded before hotwords";
+        return false;
+    }
+    auto hotwords = std::make_shared<HotwordGraph>();
+    if (!hotwords->Load(path, *tokenizer_, default_boost)) {
+        return false;
+    }
+    SetHotwords(std::move(hotwords));
+    return true;
+}
+
+std::shared_ptr<const HotwordGraph> SenseVoice::GetHotwords() const {
+    std::lock_guard<std::mutex> lock(hotwords_mutex_);
+    return hotwords_;
+}
+
+void SenseVoice::SetKeywords(std::shared_ptr<const KeywordSpotter> keywords) {
+    std::lock_guard<std::mutex> lock(keywords_mutex_);
+    keywords_ = std::move(keywords);
+}
+
+bool SenseVoice::LoadKeywords(const std::string& path, float default_threshold) {
+    if (!tokenizer_) {
+        LOG(ERROR) << "Tokenizer must be loaded before keywords";
+        return false;
+    }
+    auto keywords = std::make_shared<KeywordSpotter>();
+    if (!keywords->Load(path, *tokenizer_, default_threshold)) {
+        return false;
+    }
+    SetKeywords(std::move(keywords));
+    return true;
+}
+
+std::shared_ptr<const KeywordSpotter> SenseVoice::GetKeywords() const {
+    std::lock_guard<std::mutex> lock(keywords_mutex_);
+    return keywords_;
+}
+
+RecognitionResult SenseVoice::Classify(const std::vector<float>& samples,
+                                       Language language,
+                                       const RequestOptions& options) {
+    if (!initialized_) {
+        LOG(ERROR) << "SenseVoice not initialized";
+        return {};
+    }
+
+    std::unique_ptr<ScheduledRequest> request = scheduler_->Begin(options);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<float> fbank = ComputeFbank(samples);
+    return ClassifyFbank(fbank, language, request.get(), start_time);
+}
+
+RecognitionResult SenseVoice::Classify(const int16_t* samples,
+                                       size_t num_samples,
+                                       Language language,
+                                       const RequestOptions& options) {
+    if (!initialized_) {
+        LOG(ERROR) << "SenseVoice not initialized";
+        return {};
+    }
+
+    std::unique_ptr<ScheduledRequest> request = scheduler_->Begin(options);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<float> fbank = ComputeFbank(samples, num_samples);
+    return ClassifyFbank(fbank, language, request.get(), start_time);
+}
+
+RecognitionResult SenseVoice::ClassifyFbank(const std::vector<float>& fbank,
+                                            Language language,
+                                            ScheduledRequest* request,
+                                            std::chrono::high_resolution_clock::time_point start_time) {
+    const int32_t num_mel_bins = config_.audio.num_mel_bins;
+    const int32_t num_fbank_frames = static_cast<int32_t>(fbank.size()) / num_mel_bins;
+    if (num_fbank_frames == 0) {
+        LOG(ERROR) << "Failed to extract features";
+        return {};
+    }
+
+    // Recognize() takes the metadata from the first segment, so does this
+    std::vector<SpeechSegment> segments = FindSegments(fbank);
+    if (segments.empty()) {
+        LOG(INFO) << "VAD: no speech detected, skipping classification";
+        return {};
+    }
+    const SpeechSegment segment = segments[0];
+
+    std::vector<float> features = SegmentFeatures(fbank, segment);
+    const int32_t num_lfr_frames = static_cast<int32_t>(features.size()) / config_.model.input_feat_dim;
+    if (num_lfr_frames == 0) {
+        LOG(ERROR) << "Failed to apply LFR to segment";
+        return {};
+    }
+
+    std::vector<float> logits;
+    {
+        ModelScheduler::Grant grant(scheduler_.get(), request);
+        logits = model_->RunPrompt(features, num_lfr_frames, language, TextNorm::WithoutITN);
+    }
+    if (logits.empty()) {
+        LOG(ERROR) << "Inference failed";
+        return {};
+    }
+
+    RecognitionResult result = model_->TopK() > 0 ? tokenizer_->DecodePromptTopK(logits.data(), model_->TopK())
+                                                  : tokenizer_->DecodePrompt(logits.data(), config_.model.vocab_size);
+    auto total_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start_time).count();
+    LOG(INFO) << "Classification: " << result.language << " " << result.emotion << " "
+              << result.event << ", " << total_duration << " ms";
+    return result;
+}
+
+std::vector<KeywordHit> SenseVoice::Spot(const std::vector<float>& samples, Language language) {
+    if (!initialized_) {
+        LOG(ERROR) << "SenseVoice not initialized";
+        return {};
+    }
+    std::shared_ptr<const KeywordSpotter> keywords = GetKeywords();
+    if (!keywords || keywords->Empty()) {
+        LOG(WARNING) << "Spot called without a keyword list";
+        return {};
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<float> fbank = ComputeFbank(samples);
+    return SpotFbank(fbank, *keywords, language, start_time);
+}
+
+std::vector<KeywordHit> SenseVoice::Spot(const int16_t* samples, size_t num_samples, Language language) {
+    if (!initialized_) {
+        LOG(ERROR) << "SenseVoice not initialized";
+        return {};
+    }
+    std::shared_ptr<const KeywordSpotter> keywords = GetKeywords();
+    if (!keywords || keywords->Empty()) {
+        LOG(WARNING) << "Spot called without a keyword list";
+        return {};
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<float> fbank = ComputeFbank(samples, num_samples);
+    return SpotFbank(fbank, *keywords, language, start_time);
+}
+
+std::vector<KeywordHit> SenseVoice::SpotFbank(const std::vector<float>& fbank,
+                                              const KeywordSpotter& keywords,
+                                              Language language,
+                                              std::chrono::high_resolution_clock::time_point start_time) {
+    std::vector<KeywordHit> hits;
+    const int32_t num_mel_bins = config_.audio.num_mel_bins;
+    const int32_t num_fbank_frames = static_cast<int32_t>(fbank.size()) / num_mel_bins;
+    if (num_fbank_frames == 0) {
+        LOG(ERROR) << "Failed to extract features";
+        return hits;
+    }
+
+    // Each segment is one model window; hits are shifted to request time
+    std::vector<SpeechSegment> segments = FindSegments(fbank);
+
+    std::unique_ptr<ScheduledRequest> request = scheduler_->Begin(RequestOptions());
+    const int32_t row_width = model_->RowWidth();
+    const float frame_shift_s = config_.audio.frame_shift_ms / 1000.0f;
+    const float lfr_shift_s = frame_shift_s * config_.model.lfr_window_shift;
+    double scan_ms = 0.0;
+    for (const auto& seg : segments) {
+        std::vector<float> features = SegmentFeatures(fbank, seg);
+        const int32_t num_lfr_frames = static_cast<int32_t>(features.size()) / config_.model.input_feat_dim;
+        if (num_lfr_frames == 0) {
+            continue;
+        }
+        // Text normalization only changes the prompt rows, which are not scanned
+        std::vector<float> logits;
+        {
+            ModelScheduler::Grant grant(scheduler_.get(), request.get());
+            logits = model_->Run(features, num_lfr_frames, language, TextNorm::WithoutITN);
+        }
+        if (logits.empty()) {
+            LOG(ERROR) << "Inference failed";
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            vad_stats_.npu_runs++;
+        }
+
+        auto scan_start = std::chrono::high_resolution_clock::now();
+        const int32_t frames = std::min(num_lfr_frames, config_.model.input_frames);
+        const float* rows = logits.data() + static_cast<size_t>(SenseVoiceModel::kNumPromptTokens) * row_width;
+        std::vector<KeywordHit> seg_hits =
+            model_->TopK() > 0 ? keywords.SpotTopK(rows, frames, model_->TopK(), tokenizer_->BlankId())
+                               : keywords.Spot(rows, frames, row_width, tokenizer_->BlankId());
+        scan_ms += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - scan_start).count() / 1000.0;
+
+        const float offset_s = seg.start_frame * frame_shift_s;
+        for (auto& hit : seg_hits) {
+            hit.start_time = offset_s + hit.start_frame * lfr_shift_s;
+            hit.end_time = offset_s + (hit.end_frame + 1) * lfr_shift_s;
+            hits.push_back(std::move(hit));
+        }
+    }
+
+    auto total_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start_time).count();
+    LOG(INFO) << "Keyword spotting: " << segments.size() << " segment(s), " << hits.size()
+              << " hit(s), scan " << scan_ms << " ms, total " << total_duration << " ms";
+    for (const auto& hit : hits) {
+        LOG(INFO) << "  " << hit.phrase << " [" << hit.start_time << "s - " << hit.end_time
+                  << "s] confidence " << hit.confidence;
+    }
+    return hits;
+}
+
 RecognitionResult SenseVoice::Recognize(const std::vector<float>& samples,
                                         Language language,
-                                        TextNorm text_norm) {
-    RecognitionResult result;
-
+                                        TextNorm text_norm,
+                                        const RequestOptions& options) {
     if (!initialized_) {
         LOG(ERROR) << "SenseVoice not initialized";
-        return result;
+        return {};
     }
 
+    std::unique_ptr<ScheduledRequest> request = scheduler_->Begin(options);
     auto start_time = std::chrono::high_resolution_clock::now();
 
     // Step 1: Extract features
     LOG(INFO) << "Processing audio: " << samples.size() << " samples ("
               << (samples.size() / 16000.0f) << " seconds)";
 
-    int32_t num_lfr_frames = 0;
-    std::vector<float> features = audio_frontend_->Process(samples, &num_lfr_frames);
+    std::vector<float> fbank = ComputeFbank(samples);
 
-    if (features.empty() || num_lfr_frames == 0) {
+    return RecognizeFbank(fbank, samples.size(), language, text_norm, request.get(), start_time);
+}
+
+RecognitionResult SenseVoice::Recognize(const int16_t* samples,
+                                        size_t num_samples,
+                                        Language language,
+                                        TextNorm text_norm,
+                                        const RequestOptions& options) {
+    if (!initialized_) {
+        LOG(ERROR) << "SenseVoice not initialized";
+        return {};
+    }
+
+    std::unique_ptr<ScheduledRequest> request = scheduler_->Begin(options);
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // Step 1: Extract features (int16 scaling is folded into the fbank input)
+    LOG(INFO) << "Processing int16 audio: " << num_samples << " samples ("
+              << (num_samples / 16000.0f) << " seconds)";
+
+    std::vector<float> fbank = ComputeFbank(samples, num_samples);
+
+    return RecognizeFbank(fbank, num_samples, language, text_norm, request.get(), start_time);
+}
+
+RecognitionResult SenseVoice::RecognizeFbank(const std::vector<float>& fbank,
+                                             size_t num_samples,
+                                             Language language,
+                                             TextNorm text_norm,
+                                             ScheduledRequest* request,
+                                             std::chrono::high_resolution_clock::time_point start_time) {
+    RecognitionResult result;
+    std::shared_ptr<const HotwordGraph> hotwords = GetHotwords();
+
+    const int32_t num_mel_bins = config_.audio.num_mel_bins;
+    const int32_t num_fbank_frames = static_cast<int32_t>(fbank.size()) / num_mel_bins;
+    const int32_t num_lfr_frames = CalcLfrOutputFrames(num_fbank_frames,
+                                                       config_.model.lfr_window_size,
+                                                       config_.model.lfr_window_shift);
+
+    if (fbank.empty() || num_lfr_frames == 0) {
         LOG(ERROR) << "Failed to extract features";
         return result;
     }
@@ -88,67 +462,570 @@ RecognitionResult SenseVoice::Recognize(const std::vector<float>& samples,
     auto feature_time = std::chrono::high_resolution_clock::now();
     auto feature_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
         feature_time - start_time).count();
-    LOG(INFO) << "Feature extraction: " << num_lfr_frames << " frames, "
-              << feature_duration << " ms";
+    LOG(INFO) << "Feature extraction: " << num_fbank_frames << " fbank frames ("
+              << num_lfr_frames << " LFR frames), " << feature_duration << " ms";
 
-    // Step 2: Run model inference
-    std::vector<float> logits = model_->Run(features, num_lfr_frames, language, text_norm);
+    // Step 2: Find speech segments (model windows without VAD)
+    std::vector<SpeechSegment> segments = FindSegments(fbank);
 
-    if (logits.empty()) {
+    const int32_t window = config_.vad.max_segment_lfr_frames;
+    VadStats vad_stats;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        vad_stats_.requests++;
+        vad_stats_.npu_runs_without_vad += std::max(1, (num_lfr_frames + window - 1) / window);
+        if (segments.empty()) {
+            vad_stats_.silent_requests++;
+        }
+        vad_stats = vad_stats_;
+    }
+
+    if (segments.empty()) {
+        LOG(INFO) << "VAD: no speech detected, skipping inference";
+        LOG(INFO) << "VAD stats: " << vad_stats.npu_runs << " NPU runs, "
+                  << vad_stats.npu_runs_without_vad << " without VAD, "
+                  << vad_stats.silent_requests << "/" << vad_stats.requests
+                  << " requests silent";
+        return result;
+    }
+
+    if (vad_) {
+        int32_t speech_frames = 0;
+        for (const auto& seg : segments) {
+            speech_frames += seg.NumFrames();
+        }
+        LOG(INFO) << "VAD: " << segments.size() << " segment(s), " << speech_frames
+                  << "/" << num_fbank_frames << " fbank frames kept";
+    }
+
+    // Step 3: Run model + decode per segment. The windows are independent
+    // runs: with several executions they are dispatched concurrently and the
+    // results put back in order
+    const float frame_shift_s = config_.audio.frame_shift_ms / 1000.0f;
+    std::vector<RecognitionResult> seg_results(segments.size());
+    std::vector<uint8_t> seg_ran(segments.size(), 0);
+    auto run_segment = [&](size_t i) {
+        bool ran = false;
+        seg_results[i] = RunSegment(SegmentFeatures(fbank, segments[i]), language, text_norm,
+                                    hotwords.get(), request, &ran);
+        seg_ran[i] = ran;
+    };
+    if (segment_pool_ && segments.size() > 1) {
+        segment_pool_->ParallelFor(segments.size(), run_segment);
+    } else {
+        for (size_t i = 0; i < segments.size(); ++i) {
+            run_segment(i);
+        }
+    }
+    for (size_t i = 0; i < segments.size(); ++i) {
+        AppendResult(&result, seg_results[i], segments[i].start_frame * frame_shift_s);
+    }
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        vad_stats_.npu_runs += std::count(seg_ran.begin(), seg_ran.end(), 1);
+        vad_stats = vad_stats_;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto total_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        end_time - start_time).count();
+    float audio_duration = num_samples / 16000.0f;
+    float rtf = total_duration / 1000.0f / audio_duration;
+
+    LOG(INFO) << "VAD stats: " << vad_stats.npu_runs << " NPU runs, "
+              << vad_stats.npu_runs_without_vad << " without VAD, "
+              << vad_stats.silent_requests << "/" << vad_stats.requests
+              << " requests silent";
+    LOG(INFO) << "Queue wait: " << request->QueueWaitUs() / 1000.0 << " ms over "
+              << request->NumRuns() << " model run(s)";
+    LOG(INFO) << "Total time: " << total_duration << " ms, RTF: " << rtf;
+    LOG(INFO) << "Result: " << result.text;
+
+    return result;
+}
+
+std::vector<RecognitionResult> SenseVoice::RecognizeBatch(
+        const std::vector<std::vector<float>>& utterances,
+        Language language,
+        TextNorm text_norm,
+        const RequestOptions& options) {
+    size_t total_samples = 0;
+    for (const auto& samples : utterances) {
+        total_samples += samples.size();
+    }
+    return RecognizeBatchFbank(utterances.size(), total_samples,
+                               [&](size_t u) { return ComputeFbank(utterances[u]); },
+                               language, text_norm, options);
+}
+
+std::vector<RecognitionResult> SenseVoice::RecognizeBatchFbank(
+        size_t num_utterances,
+        size_t total_samples,
+        const std::function<std::vector<float>(size_t)>& fbank_of,
+        Language language,
+        TextNorm text_norm,
+        const RequestOptions& options) {
+    std::vector<RecognitionResult> results(num_utterances);
+    if (!initialized_) {
+        LOG(ERROR) << "SenseVoice not initialized";
+        return results;
+    }
+
+    std::unique_ptr<ScheduledRequest> request = scheduler_->Begin(options);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::shared_ptr<const HotwordGraph> hotwords = GetHotwords();
+
+    // Step 1: Features + VAD per utterance, LFR per speech segment
+    struct BatchSegment {
+        size_t utterance;
+        int32_t start_frame;  // fbank frame offset inside the utterance
+        std::vector<float> features;
+        int32_t num_frames;   // LFR frames, at most one window
+    };
+    std::vector<BatchSegment> batch_segments;
+
+    const int32_t num_mel_bins = config_.audio.num_mel_bins;
+    const int32_t feat_dim = config_.model.input_feat_dim;
+    const int32_t window = config_.vad.max_segment_lfr_frames;
+    const int32_t max_frames = SenseVoiceModel::kPackedWindowRows - SenseVoiceModel::kNumPromptTokens;
+
+    for (size_t u = 0; u < num_utterances; ++u) {
+        std::vector<float> fbank = fbank_of(u);
+        const int32_t num_fbank_frames = static_cast<int32_t>(fbank.size()) / num_mel_bins;
+        const int32_t num_lfr_frames = CalcLfrOutputFrames(num_fbank_frames,
+                                                           config_.model.lfr_window_size,
+                                                           config_.model.lfr_window_shift);
+
+        std::vector<SpeechSegment> segments;
+        if (num_lfr_frames == 0) {
+            LOG(WARNING) << "Utterance " << u << " too short for feature extraction";
+        } else {
+            segments = FindSegments(fbank);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            vad_stats_.requests++;
+            vad_stats_.npu_runs_without_vad += std::max(1, (num_lfr_frames + window - 1) / window);
+            if (segments.empty()) {
+                vad_stats_.silent_requests++;
+            }
+        }
+        if (segments.empty()) {
+            continue;
+        }
+
+        for (const auto& seg : segments) {
+            BatchSegment item;
+            item.utterance = u;
+            item.start_frame = seg.start_frame;
+            item.features = SegmentFeatures(fbank, seg);
+            item.num_frames = static_cast<int32_t>(item.features.size()) / feat_dim;
+            if (item.num_frames == 0) {
+                continue;
+            }
+            if (item.num_frames > max_frames) {
+                LOG(WARNING) << "Segment truncated from " << item.num_frames << " to "
+                             << max_frames << " frames";
+                item.num_frames = max_frames;
+            }
+            batch_segments.push_back(std::move(item));
+        }
+    }
+
+    // Step 2: Run model + decode, packing consecutive segments into shared windows
+    const float frame_shift_s = config_.audio.frame_shift_ms / 1000.0f;
+    int64_t runs = 0;
+    const size_t batch_size = static_cast<size_t>(model_->BatchSize());
+
+    if (batch_size > 1) {
+        // Batch-N model: segments fill the batch slots in order
+        for (size_t first = 0; first < batch_segments.size(); first += batch_size) {
+            const size_t count = std::min(batch_size, batch_segments.size() - first);
+            std::vector<PackedInput> slot_inputs;
+            for (size_t j = 0; j < count; ++j) {
+                slot_inputs.push_back({batch_segments[first + j].features.data(),
+                                       batch_segments[first + j].num_frames});
+            }
+
+            std::vector<std::vector<float>> block_max;
+            std::vector<std::vector<float>> logits;
+            {
+                ModelScheduler::Grant grant(scheduler_.get(), request.get());
+                logits = model_->RunBatch(slot_inputs, language, text_norm,
+                                          UseBlockMax(hotwords.get()) ? &block_max : nullptr);
+            }
+            if (logits.size() != count) {
+                LOG(ERROR) << "Batched inference failed for " << count << " segment(s)";
+                continue;
+            }
+            runs++;
+            {
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                vad_stats_.npu_runs++;
+                packing_stats_.npu_runs++;
+                packing_stats_.segments += static_cast<int64_t>(count);
+            }
+
+            for (size_t j = 0; j < count; ++j) {
+                const BatchSegment& item = batch_segments[first + j];
+                const int32_t num_rows = static_cast<int32_t>(logits[j].size() / model_->RowWidth());
+                RecognitionResult seg_result =
+                    model_->TopK() > 0
+                        ? tokenizer_->DecodeTopK(logits[j].data(), num_rows, model_->TopK(),
+                                                 config_.audio.frame_shift_ms, config_.model.lfr_window_shift,
+                                                 hotwords.get(), AllowedTokens(language))
+                        : tokenizer_->Decode(logits[j].data(), num_rows, config_.model.vocab_size,
+                                             config_.audio.frame_shift_ms, config_.model.lfr_window_shift,
+                                             hotwords.get(),
+                                             j < block_max.size() ? block_max[j].data() : nullptr,
+                                             AllowedTokens(language));
+                AppendResult(&results[item.utterance], seg_result, item.start_frame * frame_shift_s);
+            }
+        }
+    } else if (!model_->IsPacked()) {
+        for (const auto& item : batch_segments) {
+            bool ran = false;
+            RecognitionResult seg_result = RunSegment(item.features, language, text_norm,
+                                                      hotwords.get(), request.get(), &ran);
+            if (ran) {
+                runs++;
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                vad_stats_.npu_runs++;
+                packing_stats_.npu_runs++;
+                packing_stats_.segments++;
+            }
+            AppendResult(&results[item.utterance], seg_result, item.start_frame * frame_shift_s);
+        }
+    } else {
+        size_t next = 0;
+        while (next < batch_segments.size()) {
+            const size_t first = next;
+            std::vector<PackedInput> window_inputs;
+            int32_t used_rows = 0;
+            while (next < batch_segments.size()) {
+                const BatchSegment& item = batch_segments[next];
+                int32_t rows = SenseVoiceModel::PackedRowsAfter(used_rows, item.num_frames);
+                if (rows > SenseVoiceModel::kPackedWindowRows) {
+                    break;
+                }
+                window_inputs.push_back({item.features.data(), item.num_frames});
+                used_rows = rows;
+                ++next;
+            }
+
+            std::vector<PackedSegment> rows;
+            std::vector<float> logits;
+            {
+                ModelScheduler::Grant grant(scheduler_.get(), request.get());
+                logits = model_->RunPacked(window_inputs, &rows);
+            }
+            if (logits.empty()) {
+                LOG(ERROR) << "Packed inference failed for " << window_inputs.size() << " segment(s)";
+                continue;
+            }
+            runs++;
+            {
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                vad_stats_.npu_runs++;
+                packing_stats_.npu_runs++;
+                packing_stats_.segments += static_cast<int64_t>(window_inputs.size());
+            }
+
+            std::vector<RecognitionResult> decoded =
+                model_->TopK() > 0
+                    ? tokenizer_->DecodePackedTopK(logits.data(), rows, model_->TopK(),
+                                                   config_.audio.frame_shift_ms, config_.model.lfr_window_shift,
+                                                   hotwords.get(), AllowedTokens(language))
+                    : tokenizer_->DecodePacked(logits.data(), rows, config_.model.vocab_size,
+                                               config_.audio.frame_shift_ms, config_.model.lfr_window_shift,
+                                               hotwords.get(), AllowedTokens(language));
+            for (size_t j = 0; j < decoded.size(); ++j) {
+                const BatchSegment& item = batch_segments[first + j];
+                AppendResult(&results[item.utterance], decoded[j], item.start_frame * frame_shift_s);
+            }
+        }
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto total_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        end_time - start_time).count();
+    const PackingStats packing_stats = GetPackingStats();
+    float audio_duration = total_samples / 16000.0f;
+
+    LOG(INFO) << "Batch: " << num_utterances << " utterance(s), " << batch_segments.size()
+              << " segment(s) in " << runs << " NPU call(s)"
+              << (model_->IsPacked() ? " (packed)" : batch_size > 1 ? " (batched)" : "");
+    if (runs > 0) {
+        LOG(INFO) << "Batch: " << (static_cast<float>(batch_segments.size()) / runs)
+                  << " segments per NPU call, " << total_duration << " ms, RTF: "
+                  << (total_duration / 1000.0f / std::max(audio_duration, 1e-3f));
+        LOG(INFO) << "Queue wait: " << request->QueueWaitUs() / 1000.0 << " ms over "
+                  << request->NumRuns() << " model run(s)";
+    }
+    if (packing_stats.npu_runs > 0) {
+        LOG(INFO) << "Packing stats: " << packing_stats.segments << " segments / "
+                  << packing_stats.npu_runs << " NPU calls = "
+                  << (static_cast<float>(packing_stats.segments) / packing_stats.npu_runs)
+                  << " per call";
+    }
+
+    return results;
+}
+
+std::future<RecognitionResult> SenseVoice::Submit(std::vector<float> samples,
+                                                  Language language,
+                                                  TextNorm text_norm) {
+    if (batch_queue_) {
+        return batch_queue_->Submit(std::move(samples), language, text_norm);
+    }
+
+    std::promise<RecognitionResult> promise;
+    promise.set_value(Recognize(samples, language, text_norm));
+    return promise.get_future();
+}
+
+std::future<RecognitionResult> SenseVoice::Submit(const int16_t* samples,
+                                                  size_t num_samples,
+                                                  Language language,
+                                                  TextNorm text_norm) {
+    if (batch_queue_) {
+        return batch_queue_->Submit(samples, num_samples, language, text_norm);
+    }
+
+    std::promise<RecognitionResult> promise;
+    promise.set_value(Recognize(samples, num_samples, language, text_norm));
+    return promise.get_future();
+}
+
+std::vector<float> SenseVoice::ComputeFbank(const std::vector<float>& samples) {
+    std::lock_guard<std::mutex> lock(frontend_mutex_);
+    return audio_frontend_->ComputeFbank(samples);
+}
+
+std::vector<float> SenseVoice::ComputeFbank(const int16_t* samples, size_t num_samples) {
+    std::lock_guard<std::mutex> lock(frontend_mutex_);
+    return audio_frontend_->ComputeFbank(samples, num_samples);
+}
+
+std::vector<SpeechSegment> SenseVoice::FindSegments(const std::vector<float>& fbank) const {
+    const int32_t num_mel_bins = config_.audio.num_mel_bins;
+    const int32_t num_fbank_frames = static_cast<int32_t>(fbank.size()) / num_mel_bins;
+    if (vad_) {
+        return vad_->Detect(fbank.data(), num_fbank_frames, num_mel_bins);
+    }
+
+    // Window k takes LFR frames [k * window, (k + 1) * window) of the input
+    const int32_t window = std::min(config_.vad.max_segment_lfr_frames, config_.model.input_frames);
+    const int32_t stride = window * config_.model.lfr_window_shift;
+    const int32_t span = CalcLfrInputFrames(window, config_.model.lfr_window_size, config_.model.lfr_window_shift);
+    std::vector<SpeechSegment> segments = {{0, std::min(span, num_fbank_frames)}};
+    for (int32_t start = stride; start + config_.model.lfr_window_size <= num_fbank_frames; start += stride) {
+        segments.push_back({start, std::min(start + span, num_fbank_frames)});
+    }
+    return segments;
+}
+
+std::vector<float> SenseVoice::SegmentFeatures(const std::vector<float>& fbank,
+                                               const SpeechSegment& segment) const {
+    return AudioFrontend::ApplyLFR(
+        fbank.data() + static_cast<size_t>(segment.start_frame) * config_.audio.num_mel_bins,
+        segment.NumFrames(), config_.audio.num_mel_bins,
+        config_.model.lfr_window_size, config_.model.lfr_window_shift,
+        model_->HostCmvn() ? &cmvn_ : nullptr);
+}
+
+bool SenseVoice::LoadCmvnStats() {
+    const int32_t dim = config_.model.input_feat_dim;
+    if (bundle_ && bundle_->SectionData(kSectionCmvn) != nullptr) {
+        // float32 [2, dim]: neg_mean, inv_stddev
+        const size_t size = bundle_->SectionSize(kSectionCmvn);
+        if (size != 2 * static_cast<size_t>(dim) * sizeof(float)) {
+            LOG(ERROR) << "Bundle CMVN section has " << size << " bytes, expected "
+                       << 2 * dim * sizeof(float);
+            return false;
+        }
+        const float* stats = static_cast<const float*>(bundle_->SectionData(kSectionCmvn));
+        cmvn_.neg_mean.assign(stats, stats + dim);
+        cmvn_.inv_stddev.assign(stats + dim, stats + 2 * dim);
+        LOG(INFO) << "CMVN on the host, from the bundle";
+        return true;
+    }
+
+    // am.mvn next to the tokens unless set
+    std::string path = config_.model.cmvn_path;
+    if (path.empty()) {
+        const size_t slash = config_.model.tokens_path.find_last_of('/');
+        path = slash == std::string::npos ? "am.mvn"
+                                          : config_.model.tokens_path.substr(0, slash + 1) + "am.mvn";
+    }
+    if (!LoadCmvn(path, &cmvn_)) {
+        LOG(ERROR) << "Failed to load CMVN stats from: " << path;
+        return false;
+    }
+    if (cmvn_.Dim() != dim) {
+        LOG(ERROR) << "CMVN stats have dim " << cmvn_.Dim() << ", model features " << dim;
+        return false;
+    }
+    LOG(INFO) << "CMVN on the host, from " << path;
+    return true;
+}
+
+RecognitionResult SenseVoice::RunSegment(const std::vector<float>& features,
+                                         Language language,
+                                         TextNorm text_norm,
+                                         const HotwordGraph* hotwords,
+                                         ScheduledRequest* request,
+                                         bool* ran) {
+    RecognitionResult result;
+    if (ran) {
+        *ran = false;
+    }
+
+    int32_t num_lfr_frames = static_cast<int32_t>(features.size()) / config_.model.input_feat_dim;
+
+    if (features.empty() || num_lfr_frames == 0) {
+        LOG(ERROR) << "Failed to apply LFR to segment";
+        return result;
+    }
+
+    // Run model inference once the scheduler hands over the model; the search
+    // gets the block maxima from the readback. fp16 logits of the plain model
+    // stay half and are decoded as such
+    const bool half = model_->HalfOutput() && !model_->IsPacked();
+    std::vector<float> block_max;
+    std::vector<float> logits;
+    std::vector<uint16_t> half_logits;
+    std::chrono::high_resolution_clock::time_point segment_start;
+    {
+        ModelScheduler::Grant grant(scheduler_.get(), request);
+        segment_start = std::chrono::high_resolution_clock::now();
+        if (half) {
+            half_logits = model_->RunHalf(features, num_lfr_frames, language, text_norm,
+                                          UseBlockMax(hotwords) ? &block_max : nullptr);
+        } else {
+            logits = model_->Run(features, num_lfr_frames, language, text_norm,
+                                 UseBlockMax(hotwords) ? &block_max : nullptr);
+        }
+    }
+
+    if (logits.empty() && half_logits.empty()) {
         LOG(ERROR) << "Inference failed";
         return result;
     }
+    if (ran) {
+        *ran = true;
+    }
 
     auto inference_time = std::chrono::high_resolution_clock::now();
     auto inference_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-        inference_time - feature_time).count();
+        inference_time - segment_start).count();
 
     // Calculate actual output frames based on model's fixed input size
-    static constexpr int32_t kModelInputFrames = 166;
-    int32_t actual_input_frames = std::min(num_lfr_frames, kModelInputFrames);
+    int32_t actual_input_frames = std::min(num_lfr_frames, config_.model.input_frames);
     int32_t output_frames = actual_input_frames + 4;  // +4 for prompt tokens
     LOG(INFO) << "Inference: " << output_frames << " output frames, "
               << inference_duration << " ms";
 
     // Debug: print first few frames' argmax
+    const int32_t top_k = model_->TopK();
     LOG(INFO) << "Debug: First 10 frames argmax:";
     for (int f = 0; f < 10 && f < output_frames; ++f) {
-        const float* frame_logits = logits.data() + f * config_.model.vocab_size;
-        int max_idx = 0;
-        float max_val = frame_logits[0];
-        for (int v = 1; v < config_.model.vocab_size; ++v) {
-            if (frame_logits[v] > max_val) {
-                max_val = frame_logits[v];
-                max_idx = v;
-            }
+        const size_t offset = static_cast<size_t>(f) * model_->RowWidth();
+        float max_val;
+        int max_idx;
+        if (top_k > 0) {
+            const int32_t entry = TopKArgmax(logits.data() + offset, top_k, [](int32_t) { return true; });
+            max_idx = TopKId(logits.data() + offset, top_k, entry);
+            max_val = logits[offset + entry];
+        } else {
+            max_idx = half ? RowArgmax(half_logits.data() + offset, config_.model.vocab_size, &max_val)
+                           : RowArgmax(logits.data() + offset, config_.model.vocab_size, &max_val);
         }
         LOG(INFO) << "  Frame " << f << ": argmax=" << max_idx << ", value=" << max_val;
     }
 
-    // Step 3: Decode CTC output
-    result = tokenizer_->Decode(
-        logits.data(),
-        output_frames,
-        config_.model.vocab_size,
-        config_.audio.frame_shift_ms,
-        config_.model.lfr_window_shift
-    );
+    // Decode CTC output; top-k rows are read as they are
+    auto decode = [&](const auto* rows) {
+        return tokenizer_->Decode(
+            rows,
+            output_frames,
+            config_.model.vocab_size,
+            config_.audio.frame_shift_ms,
+            config_.model.lfr_window_shift,
+            hotwords,
+            block_max.size() >= static_cast<size_t>(output_frames) * NumMaxBlocks(config_.model.vocab_size)
+                ? block_max.data()
+                : nullptr,
+            AllowedTokens(language)
+        );
+    };
+    if (top_k > 0) {
+        result = tokenizer_->DecodeTopK(logits.data(), output_frames, top_k, config_.audio.frame_shift_ms,
+                                        config_.model.lfr_window_shift, hotwords, AllowedTokens(language));
+    } else {
+        result = half ? decode(half_logits.data()) : decode(logits.data());
+    }
 
     auto decode_time = std::chrono::high_resolution_clock::now();
-    auto decode_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-        decode_time - inference_time).count();
-    LOG(INFO) << "Decoding: " << result.tokens.size() << " tokens, "
-              << decode_duration << " ms";
+    auto decode_duration = std::chrono::duration_cast<std::chrono::microseconds>(
+        decode_time - inference_time).count() / 1000.0;
+    const bool biased = hotwords && !hotwords->Empty();
+    LOG(INFO) << "Decoding (" << (biased ? "beam + hotwords"
+                                  : tokenizer_->UsesBeamSearch() ? "beam" : "greedy") << "): "
+              << result.tokens.size() << " tokens, " << decode_duration << " ms";
 
-    auto total_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-        decode_time - start_time).count();
-    float audio_duration = samples.size() / 16000.0f;
-    float rtf = total_duration / 1000.0f / audio_duration;
+    return result;
+}
 
-    LOG(INFO) << "Total time: " << total_duration << " ms, RTF: " << rtf;
-    LOG(INFO) << "Result: " << result.text;
+bool SenseVoice::UseBlockMax(const HotwordGraph* hotwords) const {
+    const bool biased = hotwords && !hotwords->Empty();
+    return model_->TopK() == 0 && (config_.inference.blank_frame_skip || tokenizer_->UsesBeamSearch() || biased);
+}
 
-    return result;
+const std::vector<TokenRange>* SenseVoice::AllowedTokens(Language language) const {
+    return config_.inference.language_vocab ? tokenizer_->LanguageTokens(language) : nullptr;
+}
+
+void SenseVoice::AppendResult(RecognitionResult* dst,
+                              const RecognitionResult& src,
+                              float time_offset_s) {
+    // Metadata comes from the first segment that produced any
+    if (dst->language.empty()) {
+        dst->language = src.language;
+        dst->emotion = src.emotion;
+        dst->event = src.event;
+    }
+
+    for (size_t i = 0; i < src.tokens.size(); ++i) {
+        dst->tokens.push_back(src.tokens[i]);
+        dst->timestamps.push_back(src.timestamps[i] + time_offset_s);
+    }
+
+    // Token posteriors; the utterance confidence is their geometric mean again
+    if (!src.confidences.empty()) {
+        const size_t prev = dst->confidences.size();
+        dst->confidences.insert(dst->confidences.end(), src.confidences.begin(), src.confidences.end());
+        float sum = std::log(src.confidence) * src.confidences.size();
+        if (prev > 0) {
+            sum += std::log(dst->confidence) * prev;
+        }
+        dst->confidence = std::exp(sum / dst->confidences.size());
+    }
+
+    if (src.text.empty()) {
+        return;
+    }
+
+    // Segment texts are trimmed; put a space back between two ASCII words
+    if (!dst->text.empty()) {
+        unsigned char last = static_cast<unsigned char>(dst->text.back());
+        unsigned char first = static_cast<unsigned char>(src.text.front());
+        if (last < 0x80 && !std::isspace(last) && first < 0x80 && std::isalnum(first)) {
+            dst->text += ' ';
+        }
+    }
+    dst->text += src.text;
 }
 
 RecognitionResult SenseVoice::RecognizeFile(const std::string& audio_path,
@@ -157,14 +1034,18 @@ RecognitionResult SenseVoice::RecognizeFile(const std::string& audio_path,
     RecognitionResult result;
 
     // Determine file type and load
+    // 16-bit audio stays int16 and goes through the int16 pipeline; only
+    // 32-bit float WAV files are loaded as float
+    std::vector<int16_t> pcm;
     std::vector<float> samples;
-    int32_t sample_rate;
+    int32_t sample_rate = config_.audio.sample_rate;
 
     // Try WAV first
     if (audio_path.size() > 4 &&
         (audio_path.substr(audio_path.size() - 4) == ".wav" ||
          audio_path.substr(audio_path.size() - 4) == ".WAV")) {
-        if (!LoadWavFile(audio_path, &samples, &sample_rate)) {
+        if (!LoadWavFile(audio_path, &pcm, &sample_rate) &&
+            !LoadWavFile(audio_path, &samples, &sample_rate)) {
             LOG(ERROR) << "Failed to load WAV file: " << audio_path;
             return result;
         }
@@ -181,16 +1062,18 @@ RecognitionResult SenseVoice::RecognizeFile(const std::string& audio_path,
     else if (audio_path.size() > 4 &&
              (audio_path.substr(audio_path.size() - 4) == ".pcm" ||
               audio_path.substr(audio_path.size() - 4) == ".raw")) {
-        if (!LoadPcmFile(audio_path, &samples, config_.audio.sample_rate)) {
+        if (!LoadPcmFile(audio_path, &pcm, config_.audio.sample_rate)) {
             LOG(ERROR) << "Failed to load PCM file: " << audio_path;
             return result;
         }
     }
     else {
         // Try WAV format first
-        if (LoadWavFile(audio_path, &samples, &sample_rate)) {
+        if (LoadWavFile(audio_path, &pcm, &sample_rate)) {
             // OK
-        } else if (LoadPcmFile(audio_path, &samples, config_.audio.sample_rate)) {
+        } else if (LoadWavFile(audio_path, &samples, &sample_rate)) {
+            // OK
+        } else if (LoadPcmFile(audio_path, &pcm, config_.audio.sample_rate)) {
             // OK
         } else {
             LOG(ERROR) << "Failed to load audio file: " << audio_path;
@@ -198,15 +1081,19 @@ RecognitionResult SenseVoice::RecognizeFile(const std::string& audio_path,
         }
     }
 
-    if (samples.empty()) {
+    size_t num_samples = pcm.empty() ? samples.size() : pcm.size();
+    if (num_samples == 0) {
         LOG(ERROR) << "Empty audio file: " << audio_path;
         return result;
     }
 
     LOG(INFO) << "Loaded audio file: " << audio_path;
-    LOG(INFO) << "  Samples: " << samples.size();
-    LOG(INFO) << "  Duration: " << (samples.size() / 16000.0f) << " seconds";
+    LOG(INFO) << "  Samples: " << num_samples << (pcm.empty() ? " (float)" : " (int16)");
+    LOG(INFO) << "  Duration: " << (num_samples / 16000.0f) << " seconds";
 
+    if (!pcm.empty()) {
+        return Recognize(pcm.data(), pcm.size(), language, text_norm);
+    }
     return Recognize(samples, language, text_norm);
 }
 
@@ -4,33 +4,102 @@
  */
 
 #include "sensevoice_model.h"
+#include "audio_frontend.h"
+#include "ctc_math.h"
 #include "executor/ExecutorFactory.h"
 #include "executor/Executor.h"
+#include "executor/HostExecutor.h"
 #include "common/Log.h"
 
-#include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
 
 namespace sensevoice {
 
-// Fixed model input size (as compiled in DLA)
-static constexpr int32_t kModelInputFrames = 166;
-static constexpr int32_t kModelOutputFrames = 170;  // 166 + 4 prompt tokens
+// Executor data type named in bundle metadata
+static bool ParseDataType(const std::string& name, mtk::neuropilot::ExecutorDataType* type) {
+    if (name == "float32") {
+        *type = mtk::neuropilot::kFloat32;
+    } else if (name == "float16") {
+        *type = mtk::neuropilot::kFloat16;
+    } else if (name == "int32") {
+        *type = mtk::neuropilot::kInt32;
+    } else if (name == "int16") {
+        *type = mtk::neuropilot::kInt16;
+    } else if (name == "int8") {
+        *type = mtk::neuropilot::kInt8;
+    } else {
+        return false;
+    }
+    return true;
+}
 
 class SenseVoiceModel::Impl {
 public:
     Impl() = default;
     ~Impl() = default;
 
-    bool Initialize(const ModelConfig& config) {
+    bool Initialize(const ModelConfig& config, ModelBundle* bundle) {
         config_ = config;
+        packed_ = config.packed ||
+                  mtk::neuropilot::ModelFileName(config.model_path).find("sensevoice_packed") != std::string::npos;
+        input_frames_ = config.input_frames;
+        output_frames_ = input_frames_ + kNumPromptTokens;
+        if (packed_ && output_frames_ != kPackedWindowRows) {
+            LOG(ERROR) << "Packed model needs " << kPackedWindowRows - kNumPromptTokens
+                       << " input frames, got " << input_frames_;
+            return false;
+        }
+        batch_size_ = std::max(1, config.batch_size);
+        if (packed_ && batch_size_ > 1) {
+            LOG(WARNING) << "Packed model is batch 1, ignoring batch_size " << batch_size_;
+            batch_size_ = 1;
+        }
+
+        dynamic_ = config.dynamic_shape;
+        if (dynamic_ && (packed_ || batch_size_ > 1)) {
+            LOG(WARNING) << "Dynamic shape only applies to the batch-1 plain model, disabled";
+            dynamic_ = false;
+        }
+
+        mtk::neuropilot::ExecutorType type = mtk::neuropilot::ExecutorType::NeuronUsdk;
+        if (config.backend == ModelBackend::NeuronRuntime) {
+            type = mtk::neuropilot::ExecutorType::NeuronRuntime;
+        } else if (config.backend == ModelBackend::Host) {
+            type = mtk::neuropilot::ExecutorType::Host;
+        }
+
+        // Bundle: the DLA is used straight from the mapping and the shapes come
+        // from its metadata instead of the file-name lookup in GetModelInfo
+        mtk::neuropilot::ModelBlob blob;
+        if (bundle != nullptr) {
+            const BundleMetadata& meta = bundle->Metadata();
+            blob.data = bundle->SectionData(kSectionDla);
+            blob.size = bundle->SectionSize(kSectionDla);
+            blob.inputShape = meta.input_shapes;
+            blob.outputShape = meta.output_shapes;
+            if (!ParseDataType(meta.input_type, &blob.inputType) ||
+                !ParseDataType(meta.output_type, &blob.outputType)) {
+                LOG(ERROR) << "Unsupported tensor type in bundle: " << meta.input_type
+                           << " / " << meta.output_type;
+                return false;
+            }
+        }
 
         // Create executor using factory
         mtk::neuropilot::ExecutorFactory factory;
         executor_ = factory.CreateExecutor(
-            mtk::neuropilot::ExecutorType::NeuronUsdk,
+            type,
             "SenseVoice",
-            config.model_path
+            config.model_path,
+            "",
+            {},
+            static_cast<uint32_t>(batch_size_),
+            bundle != nullptr ? &blob : nullptr
         );
 
         if (!executor_ || !executor_->Initialized()) {
@@ -38,11 +107,115 @@ public:
             return false;
         }
 
+        if (auto* host = dynamic_cast<mtk::neuropilot::HostExecutor*>(executor_.get())) {
+            host->SetSimulatedLatency(config.host_latency_us, config.host_latency_per_item_us);
+            LOG(INFO) << "  Host backend (simulated latency " << config.host_latency_us << " us + "
+                      << config.host_latency_per_item_us << " us per item)";
+        }
+
+        // More executions of the same network, so windows of long audio can
+        // run on both MDLA cores; a clone shares the loaded network, the
+        // fallback loads it again
+        idle_.push_back(executor_.get());
+        for (int32_t i = 1; i < config.num_executions; ++i) {
+            std::unique_ptr<mtk::neuropilot::Executor> execution = executor_->Clone();
+            if (!execution) {
+                execution = factory.CreateExecutor(type, "SenseVoice", config.model_path, "", {},
+                                                   static_cast<uint32_t>(batch_size_),
+                                                   bundle != nullptr ? &blob : nullptr);
+            }
+            if (!execution || !execution->Initialized()) {
+                LOG(WARNING) << "Could not create execution " << i + 1 << ", running with " << i;
+                break;
+            }
+            if (auto* host = dynamic_cast<mtk::neuropilot::HostExecutor*>(execution.get())) {
+                host->SetSimulatedLatency(config.host_latency_us, config.host_latency_per_item_us);
+            }
+            idle_.push_back(execution.get());
+            clones_.push_back(std::move(execution));
+        }
+
+        // Ping-pong I/O: every extra set is one more lease on its execution.
+        // fp16-output DLA (_fp16out): the logits are read back as halves, half
+        // the bytes of the float32 variant
+        const size_t half_bytes = static_cast<size_t>(batch_size_) * output_frames_ *
+                                  config.vocab_size * sizeof(uint16_t);
+        half_output_ = executor_->GetOutputTensorSize(0) == half_bytes;
+
+        // Top-k head (_top<k>): rows of k log-probs and their k token ids,
+        // handed to the decoders as they are
+        const size_t row_bytes = static_cast<size_t>(batch_size_) * output_frames_ * sizeof(float);
+        const size_t output_bytes = executor_->GetOutputTensorSize(0);
+        if (!half_output_ && output_bytes % row_bytes == 0) {
+            const size_t width = output_bytes / row_bytes;
+            if (width % 2 == 0 && width < static_cast<size_t>(config.vocab_size)) {
+                top_k_ = static_cast<int32_t>(width / 2);
+            }
+        }
+
+        // float16 / int8 input DLA (_fp16in / _int8in): features come CMVN-normalized
+        // and are encoded as they are written to the input tensor
+        const size_t feature_values = static_cast<size_t>(batch_size_) *
+                                      (packed_ ? output_frames_ : input_frames_) * config.input_feat_dim;
+        const size_t input_bytes = executor_->GetInputTensorSize(0);
+        if (input_bytes == feature_values * sizeof(uint16_t)) {
+            input_type_ = FeatureType::Float16;
+        } else if (input_bytes == feature_values) {
+            input_type_ = FeatureType::Int8;
+        }
+
+        // The active shape is per execution, so dynamic shape keeps one set
+        const int32_t num_executions = static_cast<int32_t>(idle_.size());
+        if (config.io_sets > 1 && dynamic_) {
+            LOG(WARNING) << "I/O sets need a fixed input shape, using one per execution";
+        } else if (config.io_sets > 1) {
+            for (int32_t i = 0; i < num_executions; ++i) {
+                mtk::neuropilot::Executor* execution = idle_[i];
+                if (!execution->SetNumIOSets(static_cast<uint32_t>(config.io_sets))) {
+                    LOG(WARNING) << "Executor keeps a single I/O set";
+                    continue;
+                }
+                idle_.insert(idle_.end(), config.io_sets - 1, execution);
+            }
+        }
+
         LOG(INFO) << "SenseVoice model initialized successfully";
         LOG(INFO) << "  Model path: " << config.model_path;
         LOG(INFO) << "  Vocab size: " << config.vocab_size;
         LOG(INFO) << "  Input dim: " << config.input_feat_dim;
-        LOG(INFO) << "  Fixed input frames: " << kModelInputFrames;
+        LOG(INFO) << "  Fixed input frames: " << input_frames_;
+        if (packed_) {
+            LOG(INFO) << "  Packed-batch model: " << output_frames_ << " rows per window";
+        }
+        if (batch_size_ > 1) {
+            LOG(INFO) << "  Batch size: " << batch_size_;
+        }
+        if (dynamic_) {
+            LOG(INFO) << "  Dynamic input shape: up to " << input_frames_ << " frames";
+        }
+        if (half_output_) {
+            LOG(INFO) << "  Output logits: float16";
+        }
+        if (top_k_ > 0) {
+            LOG(INFO) << "  Output: top-" << top_k_ << " log-probs per row";
+        }
+        if (input_type_ == FeatureType::Float16) {
+            LOG(INFO) << "  Features input: float16, CMVN on the host";
+        } else if (input_type_ == FeatureType::Int8) {
+            LOG(INFO) << "  Features input: int8 (step " << config.input_scale << "), CMVN on the host";
+        }
+        if (num_executions > 1) {
+            LOG(INFO) << "  Executions: " << num_executions;
+        }
+        if (static_cast<int32_t>(idle_.size()) > num_executions) {
+            LOG(INFO) << "  Runs in flight: " << idle_.size();
+        }
+        max_runs_in_flight_ = static_cast<int32_t>(idle_.size());
+
+        // The network has been compiled, its pages are no longer needed
+        if (bundle != nullptr) {
+            bundle->Evict(kSectionDla);
+        }
 
         // Log tensor sizes
         for (int i = 0; i < 5; ++i) {
@@ -62,17 +235,91 @@ public:
     std::vector<float> Run(const std::vector<float>& features,
                            int32_t num_frames,
                            Language language,
-                           TextNorm text_norm) {
+                           TextNorm text_norm,
+                           std::vector<float>* block_max) {
+        if (block_max) {
+            block_max->clear();
+        }
         if (!executor_ || !executor_->Initialized()) {
             LOG(ERROR) << "Executor not initialized";
             return {};
         }
 
-        // Pad or truncate features to match model's fixed input size
-        std::vector<float> padded_features(kModelInputFrames * config_.input_feat_dim, 0.0f);
+        // The packed model runs a single utterance as a window of one
+        if (packed_) {
+            if (features.size() < static_cast<size_t>(num_frames) * config_.input_feat_dim) {
+                LOG(ERROR) << "Features size mismatch! Got " << features.size()
+                           << " but expected " << (num_frames * config_.input_feat_dim);
+                return {};
+            }
+            if (num_frames > input_frames_) {
+                LOG(WARNING) << "Input truncated from " << num_frames << " to " << input_frames_ << " frames";
+            }
+            std::vector<PackedSegment> segments;
+            return RunPacked({{features.data(), std::min(num_frames, input_frames_)}}, &segments);
+        }
+
+        // A batch-N model runs a single utterance in slot 0
+        if (batch_size_ > 1) {
+            if (features.size() < static_cast<size_t>(num_frames) * config_.input_feat_dim) {
+                LOG(ERROR) << "Features size mismatch! Got " << features.size()
+                           << " but expected " << (num_frames * config_.input_feat_dim);
+                return {};
+            }
+            std::vector<std::vector<float>> slot_block_max;
+            std::vector<std::vector<float>> logits = RunBatch({{features.data(), num_frames}}, language,
+                                                              text_norm, block_max ? &slot_block_max : nullptr);
+            if (block_max && !slot_block_max.empty()) {
+                *block_max = std::move(slot_block_max[0]);
+            }
+            return logits.empty() ? std::vector<float>() : std::move(logits[0]);
+        }
 
-        int32_t frames_to_copy = std::min(num_frames, kModelInputFrames);
-        size_t bytes_to_copy = frames_to_copy * config_.input_feat_dim * sizeof(float);
+        // fp16 logits are widened as the valid rows are read out
+        std::vector<float> output;
+        if (RunWindow(features, num_frames, language, text_norm, &output, block_max) < 0) {
+            return {};
+        }
+        return output;
+    }
+
+    std::vector<uint16_t> RunHalf(const std::vector<float>& features,
+                                  int32_t num_frames,
+                                  Language language,
+                                  TextNorm text_norm,
+                                  std::vector<float>* block_max) {
+        if (block_max) {
+            block_max->clear();
+        }
+        if (!executor_ || !executor_->Initialized()) {
+            LOG(ERROR) << "Executor not initialized";
+            return {};
+        }
+        if (!half_output_ || packed_) {
+            LOG(ERROR) << "RunHalf needs a plain model with float16 logits";
+            return {};
+        }
+
+        std::vector<uint16_t> output;
+        if (RunWindow(features, num_frames, language, text_norm, &output, block_max) < 0) {
+            return {};
+        }
+        return output;
+    }
+
+    // Run the plain model on one window (batch slot 0, the other slots stay
+    // zero). The valid rows are read straight out of the output tensor into
+    // *output (Out = float, or uint16_t to keep an fp16 DLA's halves), and
+    // block_max (optional) receives their block maxima (CopyRowBlockMax)
+    // from that same pass. Returns the valid rows, -1 on failure
+    template <typename Out>
+    int32_t RunWindow(const std::vector<float>& features,
+                      int32_t num_frames,
+                      Language language,
+                      TextNorm text_norm,
+                      std::vector<Out>* output,
+                      std::vector<float>* block_max) {
+        int32_t frames_to_copy = std::min(num_frames, input_frames_);
 
         // Debug: check input data
         LOG(INFO) << "Debug: features.size()=" << features.size()
@@ -85,7 +332,7 @@ public:
         if (features.size() < expected_size) {
             LOG(ERROR) << "Features size mismatch! Got " << features.size()
                        << " but expected " << expected_size;
-            return {};
+            return -1;
         }
 
         // Debug: print feature values at different positions
@@ -135,124 +382,622 @@ public:
         LOG(INFO) << "Debug: Feature stats: min=" << min_val << ", max=" << max_val
                   << ", NaN=" << nan_count << ", Inf=" << inf_count;
 
-        std::memcpy(padded_features.data(), features.data(), bytes_to_copy);
+        // Pad or truncate features to match model's fixed input size (batch slot 0),
+        // encoded into the DLA's input precision on the way
+        std::vector<uint8_t> storage;
+        mtk::neuropilot::TensorBuffer input =
+            FeatureBuffer(static_cast<size_t>(batch_size_) * input_frames_ * config_.input_feat_dim, &storage);
+        EncodeFeatures(features.data(), static_cast<size_t>(frames_to_copy) * config_.input_feat_dim, 0, input);
+
+        Lease execution(this);
 
-        if (num_frames < kModelInputFrames) {
-            LOG(INFO) << "Input padded from " << num_frames << " to " << kModelInputFrames << " frames";
-        } else if (num_frames > kModelInputFrames) {
-            LOG(WARNING) << "Input truncated from " << num_frames << " to " << kModelInputFrames << " frames";
+        // Dynamic shape: only the real frames go in and only their logits come back
+        const bool dynamic = dynamic_ && SetActiveFrames(execution.get(), frames_to_copy);
+        const int32_t run_frames = dynamic ? frames_to_copy : input_frames_;
+
+        if (dynamic) {
+            LOG(INFO) << "Dynamic input shape: " << frames_to_copy << " frames";
+        } else if (num_frames < input_frames_) {
+            LOG(INFO) << "Input padded from " << num_frames << " to " << input_frames_ << " frames";
+        }
+        if (num_frames > input_frames_) {
+            LOG(WARNING) << "Input truncated from " << num_frames << " to " << input_frames_ << " frames";
             LOG(WARNING) << "Audio longer than ~10s will be truncated. Consider processing in chunks.";
         }
 
-        // Prepare prompt tokens (as float for compatibility)
-        std::vector<float> language_tensor = {static_cast<float>(GetLanguageId(language))};
-        std::vector<float> event_tensor = {1.0f};       // Fixed event ID
-        std::vector<float> event_type_tensor = {2.0f};  // Fixed event type ID
-        std::vector<float> text_norm_tensor = {static_cast<float>(GetTextNormId(text_norm))};
+        // Valid rows: min(num_frames, input_frames_) + 4 prompt tokens, all
+        // within the run's rows; only slot 0 is read back
+        const int32_t rows = frames_to_copy + kNumPromptTokens;
+        output->resize(static_cast<size_t>(rows) * RowWidth());
+        const mtk::neuropilot::OutputReader read = [&](const void* src) {
+            ReadRows(src, rows, output->data(), block_max);
+        };
 
-        // Prepare output buffer (fixed size based on model)
-        std::vector<float> output(kModelOutputFrames * config_.vocab_size, 0.0f);
+        if (dynamic) {
+            input.bytes = static_cast<size_t>(run_frames) * config_.input_feat_dim * InputElementBytes();
+        }
+        if (!Execute(execution.get(), input, language, text_norm, read, static_cast<size_t>(rows) * RowWidth())) {
+            return -1;
+        }
 
-        // Create tensor buffers
-        std::vector<mtk::neuropilot::TensorBuffer> inputs(5);
+        // Debug: check output values
+        LOG(INFO) << "Debug: Output buffer stats:";
+        int out_nan_count = 0, out_inf_count = 0;
+        float out_min = ToFloat((*output)[0]), out_max = ToFloat((*output)[0]);
+        for (size_t i = 0; i < output->size(); ++i) {
+            const float v = ToFloat((*output)[i]);
+            if (std::isnan(v)) out_nan_count++;
+            if (std::isinf(v)) out_inf_count++;
+            if (!std::isnan(v) && !std::isinf(v)) {
+                if (v < out_min) out_min = v;
+                if (v > out_max) out_max = v;
+            }
+        }
+        LOG(INFO) << "  Output size: " << output->size() << " elements";
+        LOG(INFO) << "  Output stats: min=" << out_min << ", max=" << out_max
+                  << ", NaN=" << out_nan_count << ", Inf=" << out_inf_count;
 
-        // Input 0: Audio features [166, 560]
-        inputs[0].data = padded_features.data();
-        inputs[0].bytes = padded_features.size() * sizeof(float);
-        inputs[0].type = mtk::neuropilot::kFloat32;
+        // Debug: check first few output values of frame 0
+        LOG(INFO) << "  Frame 0 first 10 logits:";
+        for (int i = 0; i < 10 && i < RowWidth(); ++i) {
+            LOG(INFO) << "    [" << i << "] = " << ToFloat((*output)[i]);
+        }
 
-        // Input 1: Language ID
-        inputs[1].data = language_tensor.data();
-        inputs[1].bytes = language_tensor.size() * sizeof(float);
-        inputs[1].type = mtk::neuropilot::kFloat32;
+        return rows;
+    }
 
-        // Input 2: Event ID
-        inputs[2].data = event_tensor.data();
-        inputs[2].bytes = event_tensor.size() * sizeof(float);
-        inputs[2].type = mtk::neuropilot::kFloat32;
+    std::vector<float> RunPrompt(const std::vector<float>& features,
+                                 int32_t num_frames,
+                                 Language language,
+                                 TextNorm text_norm) {
+        if (!executor_ || !executor_->Initialized()) {
+            LOG(ERROR) << "Executor not initialized";
+            return {};
+        }
+        const int32_t dim = config_.input_feat_dim;
+        if (num_frames <= 0 || features.size() < static_cast<size_t>(num_frames) * dim) {
+            LOG(ERROR) << "Features size mismatch! Got " << features.size()
+                       << " but expected " << (static_cast<size_t>(num_frames) * dim);
+            return {};
+        }
+        const int32_t frames = std::min(num_frames, input_frames_);
+
+        // The prompt rows lead the output in every layout (packed window row 0,
+        // batch slot 0), so the readback stops after them
+        if (packed_) {
+            std::vector<PackedSegment> segments;
+            return RunPacked({{features.data(), frames}}, &segments, kNumPromptTokens);
+        }
 
-        // Input 3: Event Type ID
-        inputs[3].data = event_type_tensor.data();
-        inputs[3].bytes = event_type_tensor.size() * sizeof(float);
-        inputs[3].type = mtk::neuropilot::kFloat32;
+        std::vector<uint8_t> storage;
+        mtk::neuropilot::TensorBuffer input = FeatureBuffer(static_cast<size_t>(batch_size_) * input_frames_ * dim, &storage);
+        EncodeFeatures(features.data(), static_cast<size_t>(frames) * dim, 0, input);
+        std::vector<float> output(static_cast<size_t>(kNumPromptTokens) * RowWidth());
+        const mtk::neuropilot::OutputReader read = [&](const void* src) {
+            ReadRows(src, kNumPromptTokens, output.data(), nullptr);
+        };
+
+        Lease execution(this);
+        const bool dynamic = dynamic_ && SetActiveFrames(execution.get(), frames);
+        if (dynamic) {
+            input.bytes = static_cast<size_t>(frames) * dim * InputElementBytes();
+        }
+        if (!Execute(execution.get(), input, language, text_norm, read,
+                     static_cast<size_t>(kNumPromptTokens) * RowWidth())) {
+            return {};
+        }
+        return output;
+    }
 
-        // Input 4: Text Norm ID
-        inputs[4].data = text_norm_tensor.data();
-        inputs[4].bytes = text_norm_tensor.size() * sizeof(float);
-        inputs[4].type = mtk::neuropilot::kFloat32;
+    // Run the plain model: features [batch, frames, 560] (a FeatureBuffer) +
+    // 4 prompt scalars -> logits [batch, frames + 4, RowWidth()], float or,
+    // for an fp16-output DLA, uint16_t halves. read gets the first
+    // output_count values straight from the output tensor
+    bool Execute(mtk::neuropilot::Executor* executor,
+                 const mtk::neuropilot::TensorBuffer& features,
+                 Language language,
+                 TextNorm text_norm,
+                 const mtk::neuropilot::OutputReader& read,
+                 size_t output_count) {
+        // Prompt tokens (as float for compatibility); the executor only
+        // writes the ones that differ from its previous run
+        float prompt[kNumPromptTokens] = {
+            static_cast<float>(GetLanguageId(language)),
+            1.0f,  // Fixed event ID
+            2.0f,  // Fixed event type ID
+            static_cast<float>(GetTextNormId(text_norm)),
+        };
+
+        // Input 0: Audio features [batch, 166, 560]
+        // Input 1-4: language, event, event type, text norm IDs [1]
+        // All in the DLA's input precision
+        std::vector<uint8_t> prompt_staging;
+        std::vector<mtk::neuropilot::TensorBuffer> inputs(1 + kNumPromptTokens);
+        inputs[0] = features;
+        const mtk::neuropilot::TensorBuffer prompts = EncodeInput(prompt, kNumPromptTokens, 1.0f, &prompt_staging);
+        const size_t prompt_bytes = prompts.bytes / kNumPromptTokens;
+        for (int32_t p = 0; p < kNumPromptTokens; ++p) {
+            inputs[1 + p].data = static_cast<uint8_t*>(prompts.data) + p * prompt_bytes;
+            inputs[1 + p].bytes = prompt_bytes;
+            inputs[1 + p].type = prompts.type;
+        }
 
-        // Output buffer
+        // Output: read in place, no intermediate buffer
         std::vector<mtk::neuropilot::TensorBuffer> outputs(1);
-        outputs[0].data = output.data();
-        outputs[0].bytes = output.size() * sizeof(float);
-        outputs[0].type = mtk::neuropilot::kFloat32;
+        outputs[0].data = nullptr;
+        outputs[0].bytes = output_count * OutputElementBytes();
+        outputs[0].type = half_output_ ? mtk::neuropilot::kFloat16 : mtk::neuropilot::kFloat32;
+        outputs[0].reader = &read;
 
         // Run inference
-        bool success = executor_->RunForMultipleInputsOutputs(inputs, outputs);
+        bool success = executor->RunForMultipleInputsOutputs(inputs, outputs);
         if (!success) {
             LOG(ERROR) << "Inference failed";
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<std::vector<float>> RunBatch(const std::vector<PackedInput>& utterances,
+                                             Language language,
+                                             TextNorm text_norm,
+                                             std::vector<std::vector<float>>* block_max) {
+        if (block_max) {
+            block_max->clear();
+        }
+        if (!executor_ || !executor_->Initialized()) {
+            LOG(ERROR) << "Executor not initialized";
+            return {};
+        }
+        if (packed_) {
+            LOG(ERROR) << "RunBatch is not supported by the packed model, use RunPacked";
+            return {};
+        }
+        if (utterances.empty() || static_cast<int32_t>(utterances.size()) > batch_size_) {
+            LOG(ERROR) << "RunBatch got " << utterances.size() << " utterances, batch size is "
+                       << batch_size_;
             return {};
         }
 
-        // Debug: check raw output values
-        LOG(INFO) << "Debug: Raw output buffer stats:";
-        int out_nan_count = 0, out_inf_count = 0;
-        float out_min = output[0], out_max = output[0];
-        for (size_t i = 0; i < output.size(); ++i) {
-            if (std::isnan(output[i])) out_nan_count++;
-            if (std::isinf(output[i])) out_inf_count++;
-            if (!std::isnan(output[i]) && !std::isinf(output[i])) {
-                if (output[i] < out_min) out_min = output[i];
-                if (output[i] > out_max) out_max = output[i];
+        const int32_t dim = config_.input_feat_dim;
+        const size_t slot_inputs = static_cast<size_t>(input_frames_) * dim;
+        const size_t slot_outputs = static_cast<size_t>(output_frames_) * RowWidth();
+
+        // Slot b holds utterance b, padded or truncated to 166 frames
+        std::vector<uint8_t> storage;
+        const mtk::neuropilot::TensorBuffer batch_features = FeatureBuffer(batch_size_ * slot_inputs, &storage);
+        std::vector<int32_t> frames(utterances.size());
+        for (size_t b = 0; b < utterances.size(); ++b) {
+            frames[b] = std::min(utterances[b].num_frames, input_frames_);
+            if (utterances[b].features == nullptr || frames[b] <= 0) {
+                LOG(ERROR) << "Invalid utterance " << b << " in batch";
+                return {};
             }
+            if (utterances[b].num_frames > input_frames_) {
+                LOG(WARNING) << "Batch slot " << b << " truncated from " << utterances[b].num_frames
+                             << " to " << input_frames_ << " frames";
+            }
+            EncodeFeatures(utterances[b].features, static_cast<size_t>(frames[b]) * dim, b * slot_inputs,
+                           batch_features);
         }
-        LOG(INFO) << "  Output size: " << output.size() << " elements";
-        LOG(INFO) << "  Output stats: min=" << out_min << ", max=" << out_max
-                  << ", NaN=" << out_nan_count << ", Inf=" << out_inf_count;
 
-        // Debug: check first few output values of frame 0
-        LOG(INFO) << "  Frame 0 first 10 logits:";
-        for (int i = 0; i < 10 && i < config_.vocab_size; ++i) {
-            LOG(INFO) << "    [" << i << "] = " << output[i];
+        // Valid rows per slot: prompt rows + real frames, read out of the
+        // used slots only (fp16 logits are widened on the way)
+        std::vector<std::vector<float>> logits(utterances.size());
+        if (block_max) {
+            block_max->resize(utterances.size());
+        }
+        for (size_t b = 0; b < utterances.size(); ++b) {
+            logits[b].resize(static_cast<size_t>(frames[b] + kNumPromptTokens) * RowWidth());
+        }
+        const mtk::neuropilot::OutputReader read = [&](const void* src) {
+            const uint8_t* slots = static_cast<const uint8_t*>(src);
+            for (size_t b = 0; b < utterances.size(); ++b) {
+                ReadRows(slots + b * slot_outputs * OutputElementBytes(), frames[b] + kNumPromptTokens,
+                         logits[b].data(), block_max ? &(*block_max)[b] : nullptr);
+            }
+        };
+        {
+            Lease execution(this);
+            if (!Execute(execution.get(), batch_features, language, text_norm, read,
+                         utterances.size() * slot_outputs)) {
+                if (block_max) {
+                    block_max->clear();
+                }
+                return {};
+            }
+        }
+
+        LOG(INFO) << "Batch: " << utterances.size() << "/" << batch_size_ << " slots used";
+        return logits;
+    }
+
+    // readback_rows > 0: copy only the first rows of the window out
+    std::vector<float> RunPacked(const std::vector<PackedInput>& utterances,
+                                 std::vector<PackedSegment>* segments,
+                                 int32_t readback_rows = 0) {
+        segments->clear();
+
+        if (!executor_ || !executor_->Initialized()) {
+            LOG(ERROR) << "Executor not initialized";
+            return {};
+        }
+        if (!packed_) {
+            LOG(ERROR) << "RunPacked needs the packed model (sensevoice_packed*.dla)";
+            return {};
+        }
+        if (utterances.empty()) {
+            return {};
+        }
+
+        const int32_t dim = config_.input_feat_dim;
+
+        // Lay out [4 prompt rows | frames] per utterance, gap rows stay masked (id 0)
+        std::vector<uint8_t> staging[3];
+        const mtk::neuropilot::TensorBuffer features = FeatureBuffer(static_cast<size_t>(output_frames_) * dim, &staging[0]);
+        std::vector<float> segment_ids(output_frames_, 0.0f);
+        std::vector<float> prompt_role(output_frames_ * kNumPromptTokens, 0.0f);
+
+        int32_t used_rows = 0;
+        for (size_t k = 0; k < utterances.size(); ++k) {
+            const PackedInput& utt = utterances[k];
+            int32_t next_rows = SenseVoiceModel::PackedRowsAfter(used_rows, utt.num_frames);
+            if (utt.features == nullptr || utt.num_frames <= 0 || next_rows > output_frames_) {
+                LOG(ERROR) << "Utterance " << k << " (" << utt.num_frames
+                           << " frames) does not fit into the packed window";
+                segments->clear();
+                return {};
+            }
+
+            int32_t row = next_rows - kNumPromptTokens - utt.num_frames;
+            const float id = static_cast<float>(k + 1);
+            for (int32_t p = 0; p < kNumPromptTokens; ++p) {
+                prompt_role[(row + p) * kNumPromptTokens + p] = 1.0f;
+            }
+            std::fill(segment_ids.begin() + row, segment_ids.begin() + next_rows, id);
+            EncodeFeatures(utt.features, static_cast<size_t>(utt.num_frames) * dim,
+                           static_cast<size_t>(row + kNumPromptTokens) * dim, features);
+
+            segments->push_back({row, kNumPromptTokens + utt.num_frames});
+            used_rows = next_rows;
+        }
+
+        // Rows past the last utterance are padding and stay on the device
+        const int32_t output_rows = readback_rows > 0 ? std::min(readback_rows, output_frames_) : output_frames_;
+        const int32_t valid_rows = std::min(used_rows, output_rows);
+        std::vector<float> output(static_cast<size_t>(valid_rows) * RowWidth());
+        const mtk::neuropilot::OutputReader read = [&](const void* src) {
+            ReadRows(src, valid_rows, output.data(), nullptr);
+        };
+
+        // Input 0: features [170, 560], 1: segment ids [170], 2: prompt roles [170, 4],
+        // all in the DLA's input precision
+        std::vector<mtk::neuropilot::TensorBuffer> inputs(3);
+        inputs[0] = features;
+        inputs[1] = EncodeInput(segment_ids.data(), segment_ids.size(), 1.0f, &staging[1]);
+        inputs[2] = EncodeInput(prompt_role.data(), prompt_role.size(), 1.0f, &staging[2]);
+
+        std::vector<mtk::neuropilot::TensorBuffer> outputs(1);
+        outputs[0].data = nullptr;
+        outputs[0].bytes = static_cast<size_t>(valid_rows) * RowWidth() * OutputElementBytes();
+        outputs[0].type = half_output_ ? mtk::neuropilot::kFloat16 : mtk::neuropilot::kFloat32;
+        outputs[0].reader = &read;
+
+        bool success;
+        {
+            Lease execution(this);
+            success = execution.get()->RunForMultipleInputsOutputs(inputs, outputs);
+        }
+        if (!success) {
+            LOG(ERROR) << "Packed inference failed";
+            segments->clear();
+            return {};
         }
 
-        // Return only the valid portion of output based on actual input frames
-        // Output frames = min(input_frames, kModelInputFrames) + 4 prompt tokens
-        int32_t valid_output_frames = frames_to_copy + kNumPromptTokens;
-        std::vector<float> valid_output(valid_output_frames * config_.vocab_size);
-        std::memcpy(valid_output.data(), output.data(),
-                    valid_output_frames * config_.vocab_size * sizeof(float));
+        LOG(INFO) << "Packed " << utterances.size() << " utterance(s) into "
+                  << used_rows << "/" << output_frames_ << " rows";
+        return output;
+    }
+
+    // An input tensor in the DLA's input precision: float32 is passed as is,
+    // float16 / int8 (steps of step) are encoded into staging
+    mtk::neuropilot::TensorBuffer EncodeInput(float* values, size_t count, float step,
+                                              std::vector<uint8_t>* staging) const {
+        mtk::neuropilot::TensorBuffer buffer;
+        if (input_type_ == FeatureType::Float16) {
+            staging->resize(count * sizeof(uint16_t));
+            FeaturesToHalf(values, count, reinterpret_cast<uint16_t*>(staging->data()));
+            buffer.data = staging->data();
+            buffer.bytes = staging->size();
+            buffer.type = mtk::neuropilot::kFloat16;
+        } else if (input_type_ == FeatureType::Int8) {
+            staging->resize(count);
+            FeaturesToInt8(values, count, step, reinterpret_cast<int8_t*>(staging->data()));
+            buffer.data = staging->data();
+            buffer.bytes = staging->size();
+            buffer.type = mtk::neuropilot::kInt8;
+        } else {
+            buffer.data = values;
+            buffer.bytes = count * sizeof(float);
+            buffer.type = mtk::neuropilot::kFloat32;
+        }
+        return buffer;
+    }
+
+    // A zero (padding) features input of count values in the DLA's input
+    // precision, held by storage; EncodeFeatures fills in the real frames
+    mtk::neuropilot::TensorBuffer FeatureBuffer(size_t count, std::vector<uint8_t>* storage) const {
+        storage->assign(count * InputElementBytes(), 0);
+        mtk::neuropilot::TensorBuffer buffer;
+        buffer.data = storage->data();
+        buffer.bytes = storage->size();
+        buffer.type = input_type_ == FeatureType::Float16 ? mtk::neuropilot::kFloat16
+                    : input_type_ == FeatureType::Int8    ? mtk::neuropilot::kInt8
+                                                          : mtk::neuropilot::kFloat32;
+        return buffer;
+    }
+
+    // Encode count CMVN-normalized feature values into a FeatureBuffer at
+    // value offset: the only copy between the LFR features and the executor
+    void EncodeFeatures(const float* values, size_t count, size_t offset,
+                        const mtk::neuropilot::TensorBuffer& buffer) const {
+        if (buffer.type == mtk::neuropilot::kFloat16) {
+            FeaturesToHalf(values, count, static_cast<uint16_t*>(buffer.data) + offset);
+        } else if (buffer.type == mtk::neuropilot::kInt8) {
+            FeaturesToInt8(values, count, config_.input_scale, static_cast<int8_t*>(buffer.data) + offset);
+        } else {
+            std::memcpy(static_cast<float*>(buffer.data) + offset, values, count * sizeof(float));
+        }
+    }
+
+    size_t InputElementBytes() const {
+        return input_type_ == FeatureType::Float16 ? sizeof(uint16_t)
+             : input_type_ == FeatureType::Int8    ? sizeof(int8_t)
+                                                   : sizeof(float);
+    }
+
+    // Values per output row: the vocabulary, or k log-probs + k ids for a top-k head
+    int32_t RowWidth() const {
+        return top_k_ > 0 ? 2 * top_k_ : config_.vocab_size;
+    }
+
+    size_t OutputElementBytes() const {
+        return half_output_ ? sizeof(uint16_t) : sizeof(float);
+    }
+
+    // Read rows of the output tensor (float, fp16 or top-k layout) into dst:
+    // the one pass over the readback. Halves only stay halves for Out = uint16_t;
+    // top-k rows are copied as they are and have no block maxima
+    template <typename Out>
+    void ReadRows(const void* src, int32_t rows, Out* dst, std::vector<float>* block_max) const {
+        if (top_k_ > 0) {
+            if constexpr (std::is_same<Out, float>::value) {
+                std::memcpy(dst, src, static_cast<size_t>(rows) * RowWidth() * sizeof(float));
+            }
+            if (block_max) {
+                block_max->clear();
+            }
+        } else if (half_output_) {
+            CopyRows(static_cast<const uint16_t*>(src), rows, dst, block_max);
+        } else if constexpr (std::is_same<Out, float>::value) {
+            CopyRows(static_cast<const float*>(src), rows, dst, block_max);
+        }
+    }
+
+    // Copy logit rows out of the output tensor, recording each row's block
+    // maxima when block_max is set; fp16 rows are widened on the way if Out is float
+    template <typename In, typename Out>
+    void CopyRows(const In* src, int32_t rows, Out* dst, std::vector<float>* block_max) const {
+        const size_t vocab = static_cast<size_t>(config_.vocab_size);
+        if (!block_max) {
+            if constexpr (std::is_same<In, Out>::value) {
+                std::memcpy(dst, src, rows * vocab * sizeof(In));
+            } else {
+                for (int32_t r = 0; r < rows; ++r) {
+                    CopyRowMax(src + r * vocab, config_.vocab_size, dst + r * vocab);
+                }
+            }
+            return;
+        }
+        const size_t blocks = static_cast<size_t>(NumMaxBlocks(config_.vocab_size));
+        block_max->resize(rows * blocks);
+        for (int32_t r = 0; r < rows; ++r) {
+            CopyRowBlockMax(src + r * vocab, config_.vocab_size, config_.blank_id, dst + r * vocab,
+                            block_max->data() + r * blocks);
+        }
+    }
 
-        return valid_output;
+    // Set the input shape to the real frame count; on rejection restore the
+    // compiled shape so this request runs padded
+    bool SetActiveFrames(mtk::neuropilot::Executor* executor, int32_t num_frames) {
+        const uint32_t dim = static_cast<uint32_t>(config_.input_feat_dim);
+        if (executor->SetInputShape(0, {1, static_cast<uint32_t>(num_frames), dim})) {
+            dynamic_accepted_ = true;
+            return true;
+        }
+
+        executor->SetInputShape(0, {1, static_cast<uint32_t>(input_frames_), dim});
+        if (!dynamic_accepted_) {
+            // Never accepted: the DLA has a static shape, stop trying
+            LOG(WARNING) << "Dynamic input shape not supported, falling back to padded input";
+            dynamic_ = false;
+        } else {
+            LOG(WARNING) << "Dynamic input shape of " << num_frames
+                         << " frames rejected, padding this request";
+        }
+        return false;
+    }
+
+    bool IsPacked() const {
+        return packed_;
+    }
+
+    bool HalfOutput() const {
+        return half_output_;
+    }
+
+    FeatureType InputType() const {
+        return input_type_;
+    }
+
+    int32_t TopK() const {
+        return top_k_;
+    }
+
+    int32_t BatchSize() const {
+        return batch_size_;
     }
 
     int32_t GetMaxInputFrames() const {
-        return kModelInputFrames;
+        return input_frames_;
+    }
+
+    int32_t NumExecutions() const {
+        return static_cast<int32_t>(clones_.size()) + 1;
+    }
+
+    int32_t MaxRunsInFlight() const {
+        return max_runs_in_flight_;
+    }
+
+    InputCopyStats GetInputCopyStats() const {
+        InputCopyStats stats;
+        std::vector<mtk::neuropilot::Executor*> executions = {executor_.get()};
+        for (const auto& clone : clones_) {
+            executions.push_back(clone.get());
+        }
+        for (mtk::neuropilot::Executor* execution : executions) {
+            if (execution) {
+                const mtk::neuropilot::InputCopyStats copies = execution->GetInputCopyStats();
+                stats.written += static_cast<int64_t>(copies.written);
+                stats.skipped += static_cast<int64_t>(copies.skipped);
+                stats.skipped_bytes += static_cast<int64_t>(copies.skippedBytes);
+            }
+        }
+        return stats;
     }
 
 private:
+    // A free execution, held for one run
+    class Lease {
+    public:
+        explicit Lease(Impl* impl) : impl_(impl) {
+            std::unique_lock<std::mutex> lock(impl_->idle_mutex_);
+            impl_->idle_cv_.wait(lock, [this] { return !impl_->idle_.empty(); });
+            executor_ = impl_->idle_.back();
+            impl_->idle_.pop_back();
+        }
+
+        ~Lease() {
+            {
+                std::lock_guard<std::mutex> lock(impl_->idle_mutex_);
+                impl_->idle_.push_back(executor_);
+            }
+            impl_->idle_cv_.notify_one();
+        }
+
+        mtk::neuropilot::Executor* get() const { return executor_; }
+
+    private:
+        Impl* impl_;
+        mtk::neuropilot::Executor* executor_;
+    };
+
     ModelConfig config_;
+    int32_t input_frames_ = 166;   // LFR frames per window, as compiled in the DLA
+    int32_t output_frames_ = 170;  // input_frames_ + 4 prompt tokens
     std::unique_ptr<mtk::neuropilot::Executor> executor_;
+    std::vector<std::unique_ptr<mtk::neuropilot::Executor>> clones_;  // Destroyed before executor_
+    std::vector<mtk::neuropilot::Executor*> idle_;  // Free leases, one per I/O set of each execution
+    int32_t max_runs_in_flight_ = 1;
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+    bool packed_ = false;
+    bool half_output_ = false;  // Logits come back as IEEE halves
+    int32_t top_k_ = 0;         // Top-k head: 2 * top_k_ floats per output row
+    FeatureType input_type_ = FeatureType::Float32;
+    int32_t batch_size_ = 1;
+    std::atomic<bool> dynamic_{false};
+    std::atomic<bool> dynamic_accepted_{false};
 };
 
 SenseVoiceModel::SenseVoiceModel() : impl_(std::make_unique<Impl>()) {}
 SenseVoiceModel::~SenseVoiceModel() = default;
 
-bool SenseVoiceModel::Initialize(const ModelConfig& config) {
+bool SenseVoiceModel::Initialize(const ModelConfig& config, ModelBundle* bundle) {
     config_ = config;
-    initialized_ = impl_->Initialize(config);
+    initialized_ = impl_->Initialize(config, bundle);
+    packed_ = initialized_ && impl_->IsPacked();
+    half_output_ = initialized_ && impl_->HalfOutput();
+    input_type_ = initialized_ ? impl_->InputType() : FeatureType::Float32;
+    top_k_ = initialized_ ? impl_->TopK() : 0;
+    batch_size_ = initialized_ ? impl_->BatchSize() : 1;
+    num_executions_ = initialized_ ? impl_->NumExecutions() : 1;
+    max_runs_in_flight_ = initialized_ ? impl_->MaxRunsInFlight() : 1;
     return initialized_;
 }
 
 std::vector<float> SenseVoiceModel::Run(const std::vector<float>& features,
                                         int32_t num_frames,
                                         Language language,
-                                        TextNorm text_norm) {
+                                        TextNorm text_norm,
+                                        std::vector<float>* block_max) {
+    if (!initialized_) {
+        LOG(ERROR) << "Model not initialized";
+        return {};
+    }
+    return impl_->Run(features, num_frames, language, text_norm, block_max);
+}
+
+std::vector<uint16_t> SenseVoiceModel::RunHalf(const std::vector<float>& features,
+                                               int32_t num_frames,
+                                               Language language,
+                                               TextNorm text_norm,
+                                               std::vector<float>* block_max) {
+    if (!initialized_) {
+        LOG(ERROR) << "Model not initialized";
+        return {};
+    }
+    return impl_->RunHalf(features, num_frames, language, text_norm, block_max);
+}
+
+std::vector<float> SenseVoiceModel::RunPrompt(const std::vector<float>& features,
+                                              int32_t num_frames,
+                                              Language language,
+                                              TextNorm text_norm) {
+    if (!initialized_) {
+        LOG(ERROR) << "Model not initialized";
+        return {};
+    }
+    return impl_->RunPrompt(features, num_frames, language, text_norm);
+}
+
+std::vector<std::vector<float>> SenseVoiceModel::RunBatch(const std::vector<PackedInput>& utterances,
+                                                         Language language,
+                                                         TextNorm text_norm,
+                                                         std::vector<std::vector<float>>* block_max) {
+    if (!initialized_) {
+        LOG(ERROR) << "Model not initialized";
+        return {};
+    }
+    return impl_->RunBatch(utterances, language, text_norm, block_max);
+}
+
+InputCopyStats SenseVoiceModel::GetInputCopyStats() const {
+    if (!initialized_) {
+        return {};
+    }
+    return impl_->GetInputCopyStats();
+}
+
+std::vector<float> SenseVoiceModel::RunPacked(const std::vector<PackedInput>& utterances,
+                                              std::vector<PackedSegment>* segments) {
     if (!initialized_) {
         LOG(ERROR) << "Model not initialized";
+        segments->clear();
         return {};
     }
-    return impl_->Run(features, num_frames, language, text_norm);
+    return impl_->RunPacked(utterances, segments);
 }
 
 }  // namespace sensevoice
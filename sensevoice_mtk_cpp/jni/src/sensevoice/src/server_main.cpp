@@ -0,0 +1,100 @@
+/* SenseVoice Server - resident recognition daemon
+ *
+ * Usage: sensevoice_server <model.dla> <tokens.txt> <socket_path> [in_flight] [max_queued] [backend] [batch_size]
+ *
+ * Keeps one initialized SenseVoice and answers requests on a Unix domain
+ * socket (framing in server_protocol.h, client in loadgen.cpp).
+ * SIGINT / SIGTERM drain: queued requests are finished, new ones refused.
+ * Backend options: usdk (default), runtime, host[:<latency_us>]
+ * (host runs a CPU stand-in for the model, for testing without an NPU)
+ * No APU performance lock is held: an idle daemon should not pin the clocks
+ */
+
+#include "recognition_server.h"
+#include "bench_common.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <pthread.h>
+#include <string>
+
+INITIALIZE_EASYLOGGINGPP
+
+using sensevoice::bench::ParseBackend;
+
+void PrintUsage(const char* program_name) {
+    std::cout << "SenseVoice Recognition Server for MTK NPU\n\n";
+    std::cout << "Usage: " << program_name << " <model.dla> <tokens.txt> <socket_path> [in_flight] [max_queued] [backend] [batch_size]\n\n";
+    std::cout << "Arguments:\n";
+    std::cout << "  model.dla    Path to SenseVoice DLA model file, or a .svb bundle (tokens: -)\n";
+    std::cout << "  tokens.txt   Path to tokens file (tokens.txt or tokens.bin)\n";
+    std::cout << "  socket_path  Unix domain socket to listen on\n";
+    std::cout << "  in_flight    Requests executed at once; above 1 they go through the batch queue (default: 1)\n";
+    std::cout << "  max_queued   Waiting requests before new ones are answered busy (default: 32)\n";
+    std::cout << "  backend      usdk, runtime or host[:<latency_us>] (CPU stand-in, no NPU) (default: usdk)\n";
+    std::cout << "  batch_size   Batch dimension the DLA was compiled with (default: 1)\n\n";
+    std::cout << "Examples:\n";
+    std::cout << "  " << program_name << " sensevoice.dla tokens.txt /data/local/tmp/sensevoice.sock\n";
+    std::cout << "  " << program_name << " sensevoice_b4.dla tokens.txt /data/local/tmp/sensevoice.sock 4 64 usdk 4\n";
+    std::cout << "  " << program_name << " host tokens.txt /tmp/sensevoice.sock 2 32 host:20000\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    sensevoice::SenseVoiceConfig config;
+    config.model.model_path = argv[1];
+    config.model.tokens_path = argv[2];
+
+    sensevoice::ServerConfig server_config;
+    server_config.socket_path = argv[3];
+    if (argc > 4) {
+        server_config.max_in_flight = std::max(1, std::atoi(argv[4]));
+    }
+    if (argc > 5) {
+        server_config.max_queued = std::max(1, std::atoi(argv[5]));
+    }
+    if (argc > 6 && !ParseBackend(argv[6], &config.model)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    if (argc > 7) {
+        config.model.batch_size = std::max(1, std::atoi(argv[7]));
+    }
+
+    // Concurrent requests share model runs through the batch queue
+    // (max_requests 0 = the model's batch size)
+    config.batching.enable = server_config.max_in_flight > 1;
+
+    // Block the shutdown signals before any thread starts, so they all
+    // inherit the mask and only sigwait() below sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    sensevoice::SenseVoice sv;
+    if (!sv.Initialize(config)) {
+        LOG(ERROR) << "Failed to initialize SenseVoice";
+        return 1;
+    }
+
+    sensevoice::RecognitionServer server(&sv);
+    if (!server.Start(server_config)) {
+        return 1;
+    }
+
+    int signal_number = 0;
+    sigwait(&signals, &signal_number);
+    LOG(INFO) << "Received signal " << signal_number << ", draining";
+
+    server.Drain();
+    return 0;
+}
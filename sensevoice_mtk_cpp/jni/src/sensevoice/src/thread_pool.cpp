@@ -0,0 +1,91 @@
+/* Thread Pool Implementation
+ *
+ * Worker threads and the shared-index ParallelFor.
+ */
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace sensevoice {
+
+ThreadPool::ThreadPool(int32_t num_threads) {
+    for (int32_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Helpers that only start after the last index was taken find nothing to
+    // do and never touch body, so the state they share outlives this call
+    struct State {
+        std::atomic<size_t> next{0};
+        size_t count = 0;
+        size_t done = 0;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto state = std::make_shared<State>();
+    state->count = count;
+    const std::function<void(size_t)>* work_body = &body;
+    auto work = [state, work_body] {
+        for (size_t i = state->next++; i < state->count; i = state->next++) {
+            (*work_body)(i);
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (++state->done == state->count) {
+                state->cv.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(count - 1, workers_.size());
+    for (size_t h = 0; h < helpers; ++h) {
+        Post(work);
+    }
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done == state->count; });
+}
+
+void ThreadPool::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+            break;  // stop_ with nothing left
+        }
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+}  // namespace sensevoice
@@ -4,25 +4,431 @@
  */
 
 #include "tokenizer.h"
+#include "ctc_math.h"
+#include "common/Log.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <cmath>
+#include <cstdint>
 
 namespace sensevoice {
 
 Tokenizer::Tokenizer() = default;
-Tokenizer::~Tokenizer() = default;
+
+Tokenizer::~Tokenizer() {
+    Reset();
+}
+
+void Tokenizer::Reset() {
+    if (mapped_) {
+        munmap(mapped_, mapped_bytes_);
+        mapped_ = nullptr;
+        mapped_bytes_ = 0;
+    }
+    binary_bytes_ = 0;
+    owned_entries_.clear();
+    owned_arena_.clear();
+    owned_index_.clear();
+    entries_ = nullptr;
+    num_entries_ = 0;
+    arena_ = nullptr;
+    token_index_ = nullptr;
+    index_slots_ = 0;
+    num_tokens_ = 0;
+    blank_id_ = 0;
+    language_tokens_.clear();
+}
+
+namespace {
+
+// Largest id accepted from tokens.txt, guards the dense table against bad lines
+constexpr int64_t kMaxTokenId = 1 << 22;
+
+// Append the token with the SentencePiece space marker (U+2581, E2 96 81) replaced by ' '
+void AppendDisplay(std::string_view token, std::string* out) {
+    std::string& display = *out;
+    for (size_t j = 0; j < token.size(); ++j) {
+        if (j + 2 < token.size() &&
+            static_cast<unsigned char>(token[j]) == 0xE2 &&
+            static_cast<unsigned char>(token[j+1]) == 0x96 &&
+            static_cast<unsigned char>(token[j+2]) == 0x81) {
+            display += ' ';
+            j += 2;
+        } else {
+            display += token[j];
+        }
+    }
+}
+
+// Letter scripts of the vocabulary; digits, punctuation and symbols have none
+constexpr uint32_t kScriptLatin = 1u << 0;
+constexpr uint32_t kScriptHan = 1u << 1;
+constexpr uint32_t kScriptKana = 1u << 2;
+constexpr uint32_t kScriptHangul = 1u << 3;
+
+uint32_t CodepointScript(uint32_t c) {
+    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+        (c >= 0xC0 && c <= 0x24F && c != 0xD7 && c != 0xF7) ||    // Latin-1 letters, Latin Extended
+        (c >= 0xFF21 && c <= 0xFF3A) || (c >= 0xFF41 && c <= 0xFF5A)) {  // Fullwidth Latin
+        return kScriptLatin;
+    }
+    if ((c >= 0x4E00 && c <= 0x9FFF) || (c >= 0x3400 && c <= 0x4DBF) ||
+        (c >= 0xF900 && c <= 0xFAFF) || (c >= 0x20000 && c <= 0x2FFFF) ||
+        (c >= 0x3005 && c <= 0x3007)) {  // 々 〆 〇
+        return kScriptHan;
+    }
+    if ((c >= 0x3040 && c <= 0x30FF) || (c >= 0x31F0 && c <= 0x31FF) || (c >= 0xFF66 && c <= 0xFF9F)) {
+        return kScriptKana;
+    }
+    if ((c >= 0xAC00 && c <= 0xD7AF) || (c >= 0x1100 && c <= 0x11FF) || (c >= 0x3130 && c <= 0x318F)) {
+        return kScriptHangul;
+    }
+    return 0;
+}
+
+// Union of the scripts of a UTF-8 string
+uint32_t TextScripts(std::string_view text) {
+    uint32_t scripts = 0;
+    for (size_t i = 0; i < text.size();) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        const size_t len = (c < 0x80) ? 1 : (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : 2;
+        uint32_t cp = (len == 1) ? c : (len == 2) ? (c & 0x1F) : (len == 3) ? (c & 0x0F) : (c & 0x07);
+        for (size_t k = 1; k < len && i + k < text.size(); ++k) {
+            cp = (cp << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+        }
+        scripts |= CodepointScript(cp);
+        i += len;
+    }
+    return scripts;
+}
+
+// Scripts a language is transcribed in; Latin covers code-switched words
+constexpr struct {
+    Language language;
+    uint32_t scripts;
+} kLanguageScripts[] = {
+    {Language::Chinese, kScriptHan | kScriptLatin},
+    {Language::English, kScriptLatin},
+    {Language::Cantonese, kScriptHan | kScriptLatin},
+    {Language::Japanese, kScriptHan | kScriptKana | kScriptLatin},
+    {Language::Korean, kScriptHangul | kScriptLatin},
+};
+
+// Argmax and log-sum-exp over the allowed ranges of a frame of n logits
+template <typename T>
+float AllowedArgmaxLogSumExp(const T* x, int32_t n, const std::vector<TokenRange>& ranges, int32_t* argmax) {
+    ArgmaxLogSumExpState state;
+    for (const TokenRange& range : ranges) {
+        ArgmaxLogSumExpRange(x, std::max(range.begin, 0), std::min(range.end, n), &state);
+    }
+    *argmax = state.argmax;
+    return state.max_val + std::log(state.sum);
+}
+
+// Log-sum-exp of a frame of n logits from its block maxima (CopyRowBlockMax),
+// over the allowed ranges when given: blocks far below the maximum are not read
+float BlockLogSumExp(const float* x, const float* block_max, int32_t n, int64_t blank_id,
+                     const std::vector<TokenRange>* ranges) {
+    const int32_t blank = static_cast<int32_t>(blank_id);
+    auto for_each_range = [&](auto fold) {
+        if (ranges) {
+            for (const TokenRange& range : *ranges) {
+                fold(std::max(range.begin, 0), std::min(range.end, n));
+            }
+        } else {
+            fold(0, n);
+        }
+    };
+    ArgmaxLogSumExpState state;
+    for_each_range([&](int32_t begin, int32_t end) {
+        state.max_val = BlockRowMax(x, block_max, n, blank, begin, end, state.max_val);
+    });
+    for_each_range([&](int32_t begin, int32_t end) {
+        BlockLogSumExpRange(x, block_max, n, blank, begin, end, &state);
+    });
+    return state.max_val + std::log(state.sum);
+}
+
+// Greedy search over float or fp16 rows (see Tokenizer::CTCGreedySearch)
+template <typename T>
+CTCDecoderResult GreedySearch(const T* logits,
+                              int32_t num_frames,
+                              int32_t vocab_size,
+                              int64_t blank_id,
+                              const float* block_max,
+                              const std::vector<TokenRange>* allowed_tokens) {
+    CTCDecoderResult result;
+
+    int64_t prev_id = -1;
+    const bool skip_blank = block_max != nullptr && blank_id >= 0 && blank_id < vocab_size;
+    const int32_t blocks = NumMaxBlocks(vocab_size);
+
+    for (int32_t t = 0; t < num_frames; ++t) {
+        const T* frame_logits = logits + static_cast<size_t>(t) * vocab_size;
+
+        // Strictly above every other logit: the argmax is blank (a tie takes the full scan)
+        if (skip_blank && ToFloat(frame_logits[blank_id]) >
+                              RowMax(block_max + static_cast<size_t>(t) * blocks, 0, blocks,
+                                     -std::numeric_limits<float>::infinity())) {
+            prev_id = blank_id;
+            continue;
+        }
+
+        // Argmax and normalizer in one pass
+        int32_t argmax = 0;
+        const float norm = allowed_tokens ? AllowedArgmaxLogSumExp(frame_logits, vocab_size, *allowed_tokens, &argmax)
+                                          : ArgmaxLogSumExp(frame_logits, vocab_size, &argmax);
+        const int64_t max_id = argmax;
+        const float log_prob = ToFloat(frame_logits[argmax]) - norm;
+
+        // Skip blank and consecutive duplicates; a repeat can only raise the token's posterior
+        if (max_id != blank_id && max_id != prev_id) {
+            result.token_ids.push_back(max_id);
+            result.frame_indices.push_back(t);
+            result.log_probs.push_back(log_prob);
+        } else if (max_id != blank_id) {
+            result.log_probs.back() = std::max(result.log_probs.back(), log_prob);
+        }
+
+        prev_id = max_id;
+    }
+
+    return result;
+}
+
+// Greedy search over top-k rows (see Tokenizer::CTCGreedySearchTopK)
+CTCDecoderResult GreedySearchTopK(const float* rows,
+                                  int32_t num_frames,
+                                  int32_t k,
+                                  int64_t blank_id,
+                                  const std::vector<TokenRange>* allowed_tokens) {
+    CTCDecoderResult result;
+    auto allowed = [&](int32_t id) {
+        return id >= 0 && (!allowed_tokens || id == blank_id ||
+                           std::any_of(allowed_tokens->begin(), allowed_tokens->end(),
+                                       [id](const TokenRange& range) { return range.Contains(id); }));
+    };
+
+    int64_t prev_id = -1;
+    for (int32_t t = 0; t < num_frames; ++t) {
+        const float* row = rows + static_cast<size_t>(t) * 2 * k;
+        const int32_t entry = TopKArgmax(row, k, allowed);
+        const int64_t max_id = entry >= 0 ? TopKId(row, k, entry) : blank_id;
+
+        if (max_id != blank_id && max_id != prev_id) {
+            result.token_ids.push_back(max_id);
+            result.frame_indices.push_back(t);
+            result.log_probs.push_back(row[entry]);
+        } else if (max_id != blank_id) {
+            result.log_probs.back() = std::max(result.log_probs.back(), row[entry]);
+        }
+
+        prev_id = max_id;
+    }
+
+    return result;
+}
+
+}  // namespace
 
 bool Tokenizer::Load(const std::string& tokens_file) {
+    Reset();
+
+    // A binary vocabulary carries its language ranges, only text is scanned
+    bool is_binary = false;
+    if (LoadBinary(tokens_file, &is_binary) || is_binary) {
+        return num_tokens_ > 0;
+    }
+    if (!LoadText(tokens_file)) {
+        return false;
+    }
+    BuildLanguageTokens();
+    return true;
+}
+
+bool Tokenizer::LoadBinary(const std::string& tokens_file, bool* is_binary) {
+    *is_binary = false;
+
+    int fd = open(tokens_file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(VocabFileHeader)) {
+        close(fd);
+        return false;
+    }
+
+    // Shared read-only mapping: pages come from the page cache and are
+    // shared by every process that loads the same file
+    const size_t file_bytes = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, file_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    if (file_bytes < 4 || std::memcmp(addr, "SVTK", 4) != 0) {
+        munmap(addr, file_bytes);
+        return false;  // Not binary, caller falls back to text
+    }
+    *is_binary = true;
+
+    if (!AttachBinary(addr, file_bytes, tokens_file)) {
+        munmap(addr, file_bytes);
+        return false;
+    }
+    mapped_ = addr;
+    mapped_bytes_ = file_bytes;
+    return true;
+}
+
+bool Tokenizer::LoadFromMemory(const void* data, size_t size) {
+    Reset();
+    return AttachBinary(data, size, "<memory>") && num_tokens_ > 0;
+}
+
+void Tokenizer::BuildLanguageTokens() {
+    language_tokens_.clear();
+    std::vector<uint32_t> scripts(num_entries_, 0);
+    for (size_t id = 0; id < num_entries_; ++id) {
+        if (!IsSpecial(static_cast<int64_t>(id)) && static_cast<int64_t>(id) != blank_id_) {
+            scripts[id] = TextScripts(IdToDisplay(static_cast<int64_t>(id)));
+        }
+    }
+
+    // The vocabulary is grouped by script, so each set is a handful of ranges
+    for (const auto& entry : kLanguageScripts) {
+        LanguageTokenSet set{entry.language, {}};
+        for (size_t id = 0; id < num_entries_; ++id) {
+            if (scripts[id] & ~entry.scripts) {
+                continue;
+            }
+            const int32_t token = static_cast<int32_t>(id);
+            if (!set.ranges.empty() && set.ranges.back().end == token) {
+                set.ranges.back().end = token + 1;
+            } else {
+                set.ranges.push_back({token, token + 1});
+            }
+        }
+        language_tokens_.push_back(std::move(set));
+    }
+    LogLanguageTokens("derived from the token scripts");
+}
+
+void Tokenizer::LogLanguageTokens(const char* source) const {
+    std::ostringstream summary;
+    for (const auto& set : language_tokens_) {
+        int32_t allowed = 0;
+        for (const auto& range : set.ranges) {
+            allowed += range.end - range.begin;
+        }
+        summary << " " << GetLanguageId(set.language) << ":" << allowed << "/" << set.ranges.size();
+    }
+    LOG(INFO) << "Language vocab (language id:tokens/ranges, " << source << "):" << summary.str();
+}
+
+const std::vector<TokenRange>* Tokenizer::LanguageTokens(Language language) const {
+    for (const auto& set : language_tokens_) {
+        if (set.language == language) {
+            return &set.ranges;
+        }
+    }
+    return nullptr;
+}
+
+bool Tokenizer::AttachBinary(const void* data, size_t size, const std::string& name) {
+    const auto* base = static_cast<const char*>(data);
+    if (size < sizeof(VocabFileHeader)) {
+        LOG(ERROR) << "Vocabulary " << name << " is truncated";
+        return false;
+    }
+    VocabFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, "SVTK", 4) != 0) {
+        LOG(ERROR) << "Vocabulary " << name << " is not a binary vocabulary";
+        return false;
+    }
+    if (header.version != kVocabFileVersion) {
+        LOG(ERROR) << "Vocabulary " << name << " has version " << header.version
+                   << ", expected " << kVocabFileVersion << " (re-run tokens2bin.py)";
+        return false;
+    }
+
+    const uint64_t expected = sizeof(VocabFileHeader) +
+                              uint64_t(header.num_entries) * sizeof(VocabEntry) +
+                              uint64_t(header.index_slots) * sizeof(uint32_t) +
+                              uint64_t(header.num_language_ranges) * sizeof(VocabLanguageRange) +
+                              header.arena_bytes;
+    const bool slots_ok = header.index_slots != 0 &&
+                          (header.index_slots & (header.index_slots - 1)) == 0 &&
+                          header.index_slots >= 2ull * header.num_tokens;
+    if (expected != size || !slots_ok || header.num_tokens > header.num_entries ||
+        reinterpret_cast<uintptr_t>(base) % alignof(VocabEntry) != 0) {
+        LOG(ERROR) << "Vocabulary " << name << " is truncated or corrupt";
+        return false;
+    }
+
+    const auto* entries = reinterpret_cast<const VocabEntry*>(base + sizeof(VocabFileHeader));
+    const auto* index = reinterpret_cast<const uint32_t*>(entries + header.num_entries);
+    const auto* language_ranges = reinterpret_cast<const VocabLanguageRange*>(index + header.index_slots);
+    const char* arena = reinterpret_cast<const char*>(language_ranges + header.num_language_ranges);
+
+    // Bounds check the offsets once so lookups can trust them
+    for (uint32_t i = 0; i < header.num_entries; ++i) {
+        const VocabEntry& e = entries[i];
+        if (uint64_t(e.token_offset) + e.token_length > header.arena_bytes ||
+            uint64_t(e.display_offset) + e.display_length > header.arena_bytes) {
+            LOG(ERROR) << "Vocabulary " << name << " has an out-of-range entry " << i;
+            return false;
+        }
+    }
+
+    // Language ranges come grouped by language; they are few, so they are copied
+    std::vector<LanguageTokenSet> language_tokens;
+    for (uint32_t i = 0; i < header.num_language_ranges; ++i) {
+        const VocabLanguageRange& range = language_ranges[i];
+        if (range.begin < 0 || range.begin >= range.end || uint64_t(range.end) > header.num_entries) {
+            LOG(ERROR) << "Vocabulary " << name << " has an out-of-range language range " << i;
+            return false;
+        }
+        const Language language = static_cast<Language>(range.language);
+        if (language_tokens.empty() || language_tokens.back().language != language) {
+            language_tokens.push_back({language, {}});
+        }
+        language_tokens.back().ranges.push_back({range.begin, range.end});
+    }
+
+    binary_bytes_ = size;
+    entries_ = entries;
+    num_entries_ = header.num_entries;
+    index_slots_ = header.index_slots;
+    token_index_ = index;
+    arena_ = arena;
+    num_tokens_ = static_cast<int32_t>(header.num_tokens);
+    blank_id_ = header.blank_id;
+    language_tokens_ = std::move(language_tokens);
+    LogLanguageTokens("from the vocabulary file");
+    return true;
+}
+
+bool Tokenizer::LoadText(const std::string& tokens_file) {
     std::ifstream file(tokens_file);
     if (!file.is_open()) {
         return false;
     }
 
-    id_to_token_.clear();
-    token_to_id_.clear();
+    owned_arena_.reserve(1 << 18);
 
     std::string line;
     while (std::getline(file, line)) {
@@ -39,86 +445,276 @@ bool Tokenizer::Load(const std::string& tokens_file) {
             continue;  // Invalid line
         }
 
-        std::string token = line.substr(0, last_space);
-        std::string id_str = line.substr(last_space + 1);
+        std::string_view token(line.data(), last_space);
+        std::string_view id_str(line.data() + last_space + 1, line.size() - last_space - 1);
 
         // Trim whitespace
         while (!token.empty() && (token.back() == ' ' || token.back() == '\t')) {
-            token.pop_back();
+            token.remove_suffix(1);
         }
         while (!id_str.empty() && (id_str.front() == ' ' || id_str.front() == '\t')) {
-            id_str.erase(0, 1);
+            id_str.remove_prefix(1);
         }
 
-        try {
-            int64_t id = std::stoll(id_str);
-            id_to_token_[id] = token;
-            token_to_id_[token] = id;
-        } catch (...) {
+        int64_t id = 0;
+        auto parsed = std::from_chars(id_str.data(), id_str.data() + id_str.size(), id);
+        if (parsed.ec != std::errc()) {
             continue;  // Skip invalid lines
         }
+        if (id < 0 || id >= kMaxTokenId || token.size() > UINT16_MAX) {
+            continue;
+        }
+
+        // Special tokens never reach the text, so they get an empty display form
+        const bool special = token.empty() || token[0] == '<';
+
+        if (id >= static_cast<int64_t>(owned_entries_.size())) {
+            owned_entries_.resize(static_cast<size_t>(id) + 1, VocabEntry{0, 0, 0, 0, 0});
+        }
+        VocabEntry& e = owned_entries_[static_cast<size_t>(id)];
+        if (!(e.flags & kEntryValid)) {
+            num_tokens_++;
+        }
+        e.token_offset = static_cast<uint32_t>(owned_arena_.size());
+        e.token_length = static_cast<uint16_t>(token.size());
+        owned_arena_ += token;
+        e.display_offset = static_cast<uint32_t>(owned_arena_.size());
+        if (!special) {
+            AppendDisplay(token, &owned_arena_);
+        }
+        e.display_length = static_cast<uint16_t>(owned_arena_.size() - e.display_offset);
+        e.flags = kEntryValid | (special ? kEntrySpecial : 0u);
+    }
+    owned_entries_.shrink_to_fit();
+    owned_arena_.shrink_to_fit();
+    entries_ = owned_entries_.data();
+    num_entries_ = owned_entries_.size();
+    arena_ = owned_arena_.data();
+
+    // Reverse lookup: open-addressing table of id + 1 (0 = empty), load factor <= 0.5
+    size_t slots = 1;
+    while (slots < static_cast<size_t>(num_tokens_) * 2) {
+        slots <<= 1;
+    }
+    owned_index_.assign(slots, 0);
+    for (size_t id = 0; id < owned_entries_.size(); ++id) {
+        if (!(owned_entries_[id].flags & kEntryValid)) {
+            continue;
+        }
+        std::string_view token = IdToToken(static_cast<int64_t>(id));
+        size_t slot = HashToken(token) & (slots - 1);
+        while (owned_index_[slot] != 0 &&
+               IdToToken(static_cast<int64_t>(owned_index_[slot]) - 1) != token) {
+            slot = (slot + 1) & (slots - 1);
+        }
+        // A duplicated token maps to its largest id
+        owned_index_[slot] = static_cast<uint32_t>(id) + 1;
     }
+    token_index_ = owned_index_.data();
+    index_slots_ = owned_index_.size();
 
     // Set blank_id (usually 0, but verify)
-    if (token_to_id_.count("<blank>")) {
-        blank_id_ = token_to_id_["<blank>"];
-    } else if (token_to_id_.count("<blk>")) {
-        blank_id_ = token_to_id_["<blk>"];
+    if (TokenToId("<blank>") >= 0) {
+        blank_id_ = TokenToId("<blank>");
+    } else if (TokenToId("<blk>") >= 0) {
+        blank_id_ = TokenToId("<blk>");
     } else {
         blank_id_ = 0;  // Default
     }
 
-    return !id_to_token_.empty();
+    return num_tokens_ > 0;
 }
 
-std::string Tokenizer::IdToToken(int64_t id) const {
-    auto it = id_to_token_.find(id);
-    if (it != id_to_token_.end()) {
-        return it->second;
+std::string_view Tokenizer::IdToToken(int64_t id) const {
+    const VocabEntry* e = Entry(id);
+    if (e) {
+        return std::string_view(arena_ + e->token_offset, e->token_length);
     }
     return "<unk>";
 }
 
-int64_t Tokenizer::TokenToId(const std::string& token) const {
-    auto it = token_to_id_.find(token);
-    if (it != token_to_id_.end()) {
-        return it->second;
+std::string_view Tokenizer::IdToDisplay(int64_t id) const {
+    const VocabEntry* e = Entry(id);
+    if (e) {
+        return std::string_view(arena_ + e->display_offset, e->display_length);
     }
-    return -1;
+    return {};
 }
 
-CTCDecoderResult Tokenizer::CTCGreedySearch(const float* logits,
-                                            int32_t num_frames,
-                                            int32_t vocab_size) const {
-    CTCDecoderResult result;
+bool Tokenizer::IsSpecial(int64_t id) const {
+    const VocabEntry* e = Entry(id);
+    return !e || (e->flags & kEntrySpecial);
+}
 
-    int64_t prev_id = -1;
+int64_t Tokenizer::TokenToId(std::string_view token) const {
+    if (index_slots_ == 0) {
+        return -1;
+    }
+    const size_t mask = index_slots_ - 1;
+    for (size_t slot = HashToken(token) & mask; token_index_[slot] != 0; slot = (slot + 1) & mask) {
+        const int64_t id = static_cast<int64_t>(token_index_[slot]) - 1;
+        if (IdToToken(id) == token) {
+            return id;
+        }
+    }
+    return -1;
+}
 
-    for (int32_t t = 0; t < num_frames; ++t) {
-        // Find argmax
-        const float* frame_logits = logits + t * vocab_size;
-        int64_t max_id = 0;
-        float max_val = frame_logits[0];
-
-        for (int32_t v = 1; v < vocab_size; ++v) {
-            if (frame_logits[v] > max_val) {
-                max_val = frame_logits[v];
-                max_id = v;
+std::vector<int64_t> Tokenizer::Encode(std::string_view text) const {
+    // Longest piece tried; SentencePiece pieces are far shorter
+    constexpr size_t kMaxPieceBytes = 48;
+    static const std::string kSpaceMarker = "\xE2\x96\x81";  // U+2581
+
+    auto char_length = [](unsigned char c) -> size_t {
+        return c < 0x80 ? 1 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+    };
+
+    std::vector<int64_t> ids;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        // Next whitespace-separated word
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+        size_t end = pos;
+        while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end]))) {
+            ++end;
+        }
+        if (end == pos) {
+            break;
+        }
+        const std::string word = kSpaceMarker + std::string(text.substr(pos, end - pos));
+        pos = end;
+
+        size_t begin = 0;
+        while (begin < word.size()) {
+            // Candidate piece ends on UTF-8 character boundaries, longest first
+            std::vector<size_t> ends;
+            for (size_t e = begin; e < word.size() && e - begin < kMaxPieceBytes;) {
+                e += char_length(static_cast<unsigned char>(word[e]));
+                ends.push_back(std::min(e, word.size()));
+            }
+            size_t matched = 0;
+            for (auto it = ends.rbegin(); it != ends.rend(); ++it) {
+                int64_t id = TokenToId(std::string_view(word).substr(begin, *it - begin));
+                if (id >= 0 && !IsSpecial(id)) {
+                    ids.push_back(id);
+                    matched = *it;
+                    break;
+                }
             }
+            begin = matched ? matched : ends.front();
         }
+    }
+    return ids;
+}
 
-        // Skip blank and consecutive duplicates
-        if (max_id != blank_id_ && max_id != prev_id) {
-            result.token_ids.push_back(max_id);
-            result.frame_indices.push_back(t);
-        }
+uint32_t Tokenizer::HashToken(std::string_view token) {
+    // FNV-1a, fixed so the table layout does not depend on the standard library
+    uint32_t hash = 2166136261u;
+    for (char c : token) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
 
-        prev_id = max_id;
+size_t Tokenizer::MemoryFootprint() const {
+    if (binary_bytes_) {
+        return binary_bytes_;
     }
+    return owned_entries_.capacity() * sizeof(VocabEntry) + owned_arena_.capacity() +
+           owned_index_.capacity() * sizeof(uint32_t);
+}
 
+CTCDecoderResult Tokenizer::CTCGreedySearch(const float* logits,
+                                            int32_t num_frames,
+                                            int32_t vocab_size,
+                                            const float* block_max,
+                                            const std::vector<TokenRange>* allowed_tokens) const {
+    return GreedySearch(logits, num_frames, vocab_size, blank_id_, block_max, allowed_tokens);
+}
+
+CTCDecoderResult Tokenizer::CTCGreedySearch(const uint16_t* logits,
+                                            int32_t num_frames,
+                                            int32_t vocab_size,
+                                            const float* block_max,
+                                            const std::vector<TokenRange>* allowed_tokens) const {
+    return GreedySearch(logits, num_frames, vocab_size, blank_id_, block_max, allowed_tokens);
+}
+
+CTCDecoderResult Tokenizer::CTCPrefixBeamSearch(const float* logits,
+                                                int32_t num_frames,
+                                                int32_t vocab_size,
+                                                const BeamSearchOptions& options,
+                                                const HotwordGraph* hotwords,
+                                                const std::vector<TokenRange>* allowed_tokens,
+                                                const float* block_max) const {
+    // One decoder per thread keeps the trie pool warm without locking
+    thread_local PrefixBeamSearch search;
+    CTCDecoderResult result;
+    const NgramLm* lm = options.lm_weight != 0.0f ? lm_.get() : nullptr;
+    search.Search(logits, num_frames, vocab_size, blank_id_, options, hotwords, lm, &result, allowed_tokens,
+                  block_max);
+
+    // The search ranks on unnormalized scores; normalize only the emitting frames
+    result.log_probs.resize(result.token_ids.size());
+    const size_t blocks = NumMaxBlocks(vocab_size);
+    for (size_t i = 0; i < result.token_ids.size(); ++i) {
+        const size_t frame = static_cast<size_t>(result.frame_indices[i]);
+        const float* frame_logits = logits + frame * vocab_size;
+        int32_t argmax = 0;
+        const float norm =
+            block_max ? BlockLogSumExp(frame_logits, block_max + frame * blocks, vocab_size, blank_id_, allowed_tokens)
+            : allowed_tokens ? AllowedArgmaxLogSumExp(frame_logits, vocab_size, *allowed_tokens, &argmax)
+                             : LogSumExp(frame_logits, vocab_size);
+        result.log_probs[i] = frame_logits[result.token_ids[i]] - norm;
+    }
+    return result;
+}
+
+CTCDecoderResult Tokenizer::CTCGreedySearchTopK(const float* rows,
+                                                int32_t num_frames,
+                                                int32_t k,
+                                                const std::vector<TokenRange>* allowed_tokens) const {
+    return GreedySearchTopK(rows, num_frames, k, blank_id_, allowed_tokens);
+}
+
+CTCDecoderResult Tokenizer::CTCPrefixBeamSearchTopK(const float* rows,
+                                                    int32_t num_frames,
+                                                    int32_t k,
+                                                    const BeamSearchOptions& options,
+                                                    const HotwordGraph* hotwords,
+                                                    const std::vector<TokenRange>* allowed_tokens) const {
+    thread_local PrefixBeamSearch search;
+    CTCDecoderResult result;
+    const NgramLm* lm = options.lm_weight != 0.0f ? lm_.get() : nullptr;
+    search.SearchTopK(rows, num_frames, k, blank_id_, options, hotwords, lm, &result, allowed_tokens);
+
+    // Emitted tokens are among their frame's k, whose values are log-posteriors
+    result.log_probs.resize(result.token_ids.size());
+    for (size_t i = 0; i < result.token_ids.size(); ++i) {
+        const float* row = rows + static_cast<size_t>(result.frame_indices[i]) * 2 * k;
+        const int32_t entry = TopKFind(row, k, static_cast<int32_t>(result.token_ids[i]));
+        result.log_probs[i] = entry >= 0 ? row[entry] : TopKTailBound(row, k);
+    }
     return result;
 }
 
+void Tokenizer::SetBeamSearch(bool enable, const BeamSearchOptions& options) {
+    use_beam_search_ = enable;
+    beam_options_ = options;
+}
+
+bool Tokenizer::LoadLanguageModel(const std::string& lm_file) {
+    auto lm = std::make_unique<NgramLm>();
+    if (!lm->Load(lm_file)) {
+        return false;
+    }
+    lm_ = std::move(lm);
+    return true;
+}
+
 RecognitionResult Tokenizer::ConvertResult(const CTCDecoderResult& ctc_result,
                                            int32_t frame_shift_ms,
                                            int32_t lfr_window_shift) const {
@@ -132,9 +728,9 @@ RecognitionResult Tokenizer::ConvertResult(const CTCDecoderResult& ctc_result,
     int32_t start_idx = 0;
     if (ctc_result.token_ids.size() >= 4) {
         // First 4 frames contain: language, emotion, event, text_norm
-        result.language = IdToToken(ctc_result.token_ids[0]);
-        result.emotion = IdToToken(ctc_result.token_ids[1]);
-        result.event = IdToToken(ctc_result.token_ids[2]);
+        result.language = std::string(IdToToken(ctc_result.token_ids[0]));
+        result.emotion = std::string(IdToToken(ctc_result.token_ids[1]));
+        result.event = std::string(IdToToken(ctc_result.token_ids[2]));
         // token_ids[3] is text_norm, we skip it
         start_idx = kNumMetadataFrames;
     }
@@ -142,37 +738,33 @@ RecognitionResult Tokenizer::ConvertResult(const CTCDecoderResult& ctc_result,
     // Convert remaining tokens to text
     std::string text;
     float frame_shift_s = static_cast<float>(frame_shift_ms) / 1000.0f * lfr_window_shift;
+    const bool has_log_probs = ctc_result.log_probs.size() == ctc_result.token_ids.size();
+    float log_prob_sum = 0.0f;
 
     for (size_t i = start_idx; i < ctc_result.token_ids.size(); ++i) {
-        std::string token = IdToToken(ctc_result.token_ids[i]);
-
-        // Handle special tokens
-        if (token.empty() || token[0] == '<') {
-            continue;  // Skip special tokens like <unk>, <sos>, etc.
-        }
-
-        // SenseVoice uses SentencePiece-like encoding
-        // Replace special unicode character for space
-        std::string processed_token;
-        for (size_t j = 0; j < token.size(); ++j) {
-            // Check for SentencePiece space marker (U+2581)
-            if (j + 2 < token.size() &&
-                static_cast<unsigned char>(token[j]) == 0xE2 &&
-                static_cast<unsigned char>(token[j+1]) == 0x96 &&
-                static_cast<unsigned char>(token[j+2]) == 0x81) {
-                processed_token += ' ';
-                j += 2;
-            } else {
-                processed_token += token[j];
-            }
+        const int64_t id = ctc_result.token_ids[i];
+
+        // Skip special tokens like <unk>, <sos>, etc.
+        if (IsSpecial(id)) {
+            continue;
         }
 
-        text += processed_token;
-        result.tokens.push_back(processed_token);
+        // Display form already has the SentencePiece space marker replaced
+        std::string_view display = IdToDisplay(id);
+        text += display;
+        result.tokens.emplace_back(display);
 
         // Calculate timestamp
         float timestamp = frame_shift_s * (ctc_result.frame_indices[i] - start_idx);
         result.timestamps.push_back(std::max(0.0f, timestamp));
+
+        if (has_log_probs) {
+            result.confidences.push_back(std::exp(ctc_result.log_probs[i]));
+            log_prob_sum += ctc_result.log_probs[i];
+        }
+    }
+    if (!result.confidences.empty()) {
+        result.confidence = std::exp(log_prob_sum / result.confidences.size());
     }
 
     // Trim leading/trailing whitespace
@@ -187,13 +779,125 @@ RecognitionResult Tokenizer::ConvertResult(const CTCDecoderResult& ctc_result,
     return result;
 }
 
+RecognitionResult Tokenizer::DecodePrompt(const float* logits, int32_t vocab_size) const {
+    CTCDecoderResult ctc_result;
+    for (int32_t row = 0; row < kNumMetadataFrames; ++row) {
+        float max_val;
+        ctc_result.token_ids.push_back(RowArgmax(logits + static_cast<size_t>(row) * vocab_size,
+                                                 vocab_size, &max_val));
+        ctc_result.frame_indices.push_back(row);
+    }
+    return ConvertResult(ctc_result);
+}
+
+RecognitionResult Tokenizer::DecodePromptTopK(const float* rows, int32_t k) const {
+    CTCDecoderResult ctc_result;
+    for (int32_t row = 0; row < kNumMetadataFrames; ++row) {
+        const float* x = rows + static_cast<size_t>(row) * 2 * k;
+        const int32_t entry = TopKArgmax(x, k, [](int32_t) { return true; });
+        ctc_result.token_ids.push_back(entry >= 0 ? TopKId(x, k, entry) : blank_id_);
+        ctc_result.frame_indices.push_back(row);
+    }
+    return ConvertResult(ctc_result);
+}
+
 RecognitionResult Tokenizer::Decode(const float* logits,
                                     int32_t num_frames,
                                     int32_t vocab_size,
                                     int32_t frame_shift_ms,
-                                    int32_t lfr_window_shift) const {
-    CTCDecoderResult ctc_result = CTCGreedySearch(logits, num_frames, vocab_size);
+                                    int32_t lfr_window_shift,
+                                    const HotwordGraph* hotwords,
+                                    const float* block_max,
+                                    const std::vector<TokenRange>* allowed_tokens) const {
+    const bool biased = hotwords && !hotwords->Empty();
+    CTCDecoderResult ctc_result =
+        (use_beam_search_ || biased)
+            ? CTCPrefixBeamSearch(logits, num_frames, vocab_size, beam_options_, hotwords, allowed_tokens, block_max)
+            : CTCGreedySearch(logits, num_frames, vocab_size, block_max, allowed_tokens);
+    return ConvertResult(ctc_result, frame_shift_ms, lfr_window_shift);
+}
+
+RecognitionResult Tokenizer::Decode(const uint16_t* logits,
+                                    int32_t num_frames,
+                                    int32_t vocab_size,
+                                    int32_t frame_shift_ms,
+                                    int32_t lfr_window_shift,
+                                    const HotwordGraph* hotwords,
+                                    const float* block_max,
+                                    const std::vector<TokenRange>* allowed_tokens) const {
+    const bool biased = hotwords && !hotwords->Empty();
+    if (!use_beam_search_ && !biased) {
+        return ConvertResult(CTCGreedySearch(logits, num_frames, vocab_size, block_max, allowed_tokens),
+                             frame_shift_ms, lfr_window_shift);
+    }
+
+    // The beam search reads rows more than once; widen once for it, taking
+    // the block maxima on the way unless the readback recorded them
+    std::vector<float> widened(static_cast<size_t>(num_frames) * vocab_size);
+    std::vector<float> widened_block_max;
+    if (!block_max) {
+        widened_block_max.resize(static_cast<size_t>(num_frames) * NumMaxBlocks(vocab_size));
+    }
+    for (int32_t t = 0; t < num_frames; ++t) {
+        const size_t offset = static_cast<size_t>(t) * vocab_size;
+        if (block_max) {
+            CopyRowMax(logits + offset, vocab_size, widened.data() + offset);
+        } else {
+            CopyRowBlockMax(logits + offset, vocab_size, static_cast<int32_t>(blank_id_), widened.data() + offset,
+                            widened_block_max.data() + static_cast<size_t>(t) * NumMaxBlocks(vocab_size));
+        }
+    }
+    return Decode(widened.data(), num_frames, vocab_size, frame_shift_ms, lfr_window_shift, hotwords,
+                  block_max ? block_max : widened_block_max.data(), allowed_tokens);
+}
+
+RecognitionResult Tokenizer::DecodeTopK(const float* rows,
+                                        int32_t num_frames,
+                                        int32_t k,
+                                        int32_t frame_shift_ms,
+                                        int32_t lfr_window_shift,
+                                        const HotwordGraph* hotwords,
+                                        const std::vector<TokenRange>* allowed_tokens) const {
+    const bool biased = hotwords && !hotwords->Empty();
+    CTCDecoderResult ctc_result =
+        (use_beam_search_ || biased)
+            ? CTCPrefixBeamSearchTopK(rows, num_frames, k, beam_options_, hotwords, allowed_tokens)
+            : CTCGreedySearchTopK(rows, num_frames, k, allowed_tokens);
     return ConvertResult(ctc_result, frame_shift_ms, lfr_window_shift);
 }
 
+std::vector<RecognitionResult> Tokenizer::DecodePacked(const float* logits,
+                                                       const std::vector<PackedSegment>& segments,
+                                                       int32_t vocab_size,
+                                                       int32_t frame_shift_ms,
+                                                       int32_t lfr_window_shift,
+                                                       const HotwordGraph* hotwords,
+                                                       const std::vector<TokenRange>* allowed_tokens) const {
+    std::vector<RecognitionResult> results;
+    results.reserve(segments.size());
+    for (const auto& seg : segments) {
+        results.push_back(Decode(logits + static_cast<size_t>(seg.row_offset) * vocab_size,
+                                 seg.num_rows, vocab_size, frame_shift_ms, lfr_window_shift, hotwords,
+                                 nullptr, allowed_tokens));
+    }
+    return results;
+}
+
+std::vector<RecognitionResult> Tokenizer::DecodePackedTopK(const float* rows,
+                                                           const std::vector<PackedSegment>& segments,
+                                                           int32_t k,
+                                                           int32_t frame_shift_ms,
+                                                           int32_t lfr_window_shift,
+                                                           const HotwordGraph* hotwords,
+                                                           const std::vector<TokenRange>* allowed_tokens) const {
+    std::vector<RecognitionResult> results;
+    results.reserve(segments.size());
+    for (const auto& seg : segments) {
+        results.push_back(DecodeTopK(rows + static_cast<size_t>(seg.row_offset) * 2 * k,
+                                     seg.num_rows, k, frame_shift_ms, lfr_window_shift, hotwords,
+                                     allowed_tokens));
+    }
+    return results;
+}
+
 }  // namespace sensevoice
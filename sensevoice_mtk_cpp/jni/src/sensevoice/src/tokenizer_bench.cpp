@@ -0,0 +1,266 @@
+/* SenseVoice Tokenizer Benchmark - arena vocabulary vs the id/token hash maps
+ *
+ * Usage: sensevoice_tokenizer_bench <tokens.txt> [runs]
+ *
+ * Loads the vocabulary both ways and compares:
+ *   maps   - the previous layout: std::unordered_map<int64_t, std::string>
+ *            plus its inverse, IdToToken by value, and a ConvertResult that
+ *            rescans every token for the U+2581 marker
+ *   arena  - Tokenizer: id-indexed VocabEntry table over one string arena with
+ *            precomputed display forms, lookups as std::string_view
+ * Reports load time, heap footprint (the maps are measured with a counting
+ * allocator, the arena with Tokenizer::MemoryFootprint) and ConvertResult time
+ * on a fixed 170-token result (4 metadata tokens + 166 text tokens). Both
+ * must produce the same text.
+ */
+
+#include "tokenizer.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedUs(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / 1000.0;
+}
+
+// Heap bytes currently held through CountingAllocator
+size_t g_map_bytes = 0;
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+    T* allocate(size_t n) {
+        g_map_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        g_map_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+using MapString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+struct MapStringHash {
+    size_t operator()(const MapString& s) const {
+        return std::hash<std::string_view>()(std::string_view(s.data(), s.size()));
+    }
+};
+
+// The vocabulary as it was kept before the arena: two hash maps
+class MapVocab {
+public:
+    bool Load(const std::string& tokens_file) {
+        std::ifstream file(tokens_file);
+        if (!file.is_open()) {
+            return false;
+        }
+        id_to_token_.clear();
+        token_to_id_.clear();
+
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty()) continue;
+            size_t last_space = line.rfind(' ');
+            if (last_space == std::string::npos) {
+                last_space = line.rfind('\t');
+            }
+            if (last_space == std::string::npos) {
+                continue;
+            }
+            std::string token = line.substr(0, last_space);
+            std::string id_str = line.substr(last_space + 1);
+            while (!token.empty() && (token.back() == ' ' || token.back() == '\t')) {
+                token.pop_back();
+            }
+            while (!id_str.empty() && (id_str.front() == ' ' || id_str.front() == '\t')) {
+                id_str.erase(0, 1);
+            }
+            try {
+                int64_t id = std::stoll(id_str);
+                MapString key(token.data(), token.size());
+                id_to_token_[id] = key;
+                token_to_id_[key] = id;
+            } catch (...) {
+                continue;
+            }
+        }
+        return !id_to_token_.empty();
+    }
+
+    std::string IdToToken(int64_t id) const {
+        auto it = id_to_token_.find(id);
+        if (it != id_to_token_.end()) {
+            return std::string(it->second.data(), it->second.size());
+        }
+        return "<unk>";
+    }
+
+    // Text part of the previous ConvertResult: special tokens skipped, every
+    // token rescanned for the SentencePiece space marker
+    sensevoice::RecognitionResult ConvertResult(const sensevoice::CTCDecoderResult& ctc) const {
+        sensevoice::RecognitionResult result;
+        size_t start_idx = 0;
+        if (ctc.token_ids.size() >= 4) {
+            result.language = IdToToken(ctc.token_ids[0]);
+            result.emotion = IdToToken(ctc.token_ids[1]);
+            result.event = IdToToken(ctc.token_ids[2]);
+            start_idx = 4;
+        }
+        std::string text;
+        for (size_t i = start_idx; i < ctc.token_ids.size(); ++i) {
+            std::string token = IdToToken(ctc.token_ids[i]);
+            if (token.empty() || token[0] == '<') {
+                continue;
+            }
+            std::string processed_token;
+            for (size_t j = 0; j < token.size(); ++j) {
+                if (j + 2 < token.size() &&
+                    static_cast<unsigned char>(token[j]) == 0xE2 &&
+                    static_cast<unsigned char>(token[j + 1]) == 0x96 &&
+                    static_cast<unsigned char>(token[j + 2]) == 0x81) {
+                    processed_token += ' ';
+                    j += 2;
+                } else {
+                    processed_token += token[j];
+                }
+            }
+            text += processed_token;
+            result.tokens.push_back(processed_token);
+            result.timestamps.push_back(0.06f * (ctc.frame_indices[i] - static_cast<int32_t>(start_idx)));
+        }
+        size_t first = text.find_first_not_of(" \t\n\r");
+        size_t last = text.find_last_not_of(" \t\n\r");
+        result.text = first != std::string::npos ? text.substr(first, last - first + 1) : text;
+        return result;
+    }
+
+private:
+    std::unordered_map<int64_t, MapString, std::hash<int64_t>, std::equal_to<int64_t>,
+                       CountingAllocator<std::pair<const int64_t, MapString>>> id_to_token_;
+    std::unordered_map<MapString, int64_t, MapStringHash, std::equal_to<MapString>,
+                       CountingAllocator<std::pair<const MapString, int64_t>>> token_to_id_;
+};
+
+// A 170-token result: the 4 prompt tags, then 166 text tokens spread over the vocabulary
+sensevoice::CTCDecoderResult MakeResult(const sensevoice::Tokenizer& tokenizer) {
+    sensevoice::CTCDecoderResult ctc;
+    for (const char* tag : {"<|en|>", "<|NEUTRAL|>", "<|Speech|>", "<|woitn|>"}) {
+        ctc.token_ids.push_back(std::max<int64_t>(tokenizer.TokenToId(tag), 0));
+        ctc.frame_indices.push_back(static_cast<int32_t>(ctc.frame_indices.size()));
+    }
+    const int64_t vocab = static_cast<int64_t>(tokenizer.VocabSize());
+    uint32_t seed = 12345;
+    while (ctc.token_ids.size() < 170) {
+        seed = seed * 1664525u + 1013904223u;
+        const int64_t id = static_cast<int64_t>(seed >> 8) % vocab;
+        if (tokenizer.IdToToken(id).empty() || tokenizer.IdToToken(id)[0] == '<') {
+            continue;
+        }
+        ctc.token_ids.push_back(id);
+        ctc.frame_indices.push_back(static_cast<int32_t>(ctc.frame_indices.size()));
+    }
+    return ctc;
+}
+
+}  // namespace
+
+void PrintUsage(const char* program_name) {
+    std::cout << "SenseVoice Tokenizer Benchmark\n\n";
+    std::cout << "Usage: " << program_name << " <tokens.txt> [runs]\n\n";
+    std::cout << "Arguments:\n";
+    std::cout << "  tokens.txt   Text vocabulary (\"<token> <id>\" per line)\n";
+    std::cout << "  runs         Loads of each layout; ConvertResult runs 100x as often (default: 20)\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << program_name << " tokens.txt\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    const std::string tokens_path = argv[1];
+    const int32_t runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+    const int32_t convert_runs = runs * 100;
+
+    // Load: a fresh instance per run, as at startup
+    double map_load_us = 0.0;
+    size_t map_bytes = 0;
+    auto maps = std::make_unique<MapVocab>();
+    for (int32_t r = 0; r < runs; ++r) {
+        maps = std::make_unique<MapVocab>();
+        const size_t before = g_map_bytes;
+        const Clock::time_point start = Clock::now();
+        if (!maps->Load(tokens_path)) {
+            LOG(ERROR) << "Failed to load tokens from: " << tokens_path;
+            return 1;
+        }
+        map_load_us += ElapsedUs(start);
+        map_bytes = g_map_bytes - before;
+    }
+
+    double arena_load_us = 0.0;
+    auto tokenizer = std::make_unique<sensevoice::Tokenizer>();
+    for (int32_t r = 0; r < runs; ++r) {
+        tokenizer = std::make_unique<sensevoice::Tokenizer>();
+        const Clock::time_point start = Clock::now();
+        if (!tokenizer->Load(tokens_path)) {
+            LOG(ERROR) << "Failed to load tokens from: " << tokens_path;
+            return 1;
+        }
+        arena_load_us += ElapsedUs(start);
+    }
+
+    // ConvertResult on the same result
+    const sensevoice::CTCDecoderResult ctc = MakeResult(*tokenizer);
+    std::string map_text;
+    std::string arena_text;
+    Clock::time_point start = Clock::now();
+    for (int32_t r = 0; r < convert_runs; ++r) {
+        map_text = maps->ConvertResult(ctc).text;
+    }
+    const double map_convert_us = ElapsedUs(start) / convert_runs;
+    start = Clock::now();
+    for (int32_t r = 0; r < convert_runs; ++r) {
+        arena_text = tokenizer->ConvertResult(ctc).text;
+    }
+    const double arena_convert_us = ElapsedUs(start) / convert_runs;
+
+    std::cout << tokenizer->VocabSize() << " tokens, " << runs << " loads, " << convert_runs
+              << " ConvertResult calls on " << ctc.token_ids.size() << " tokens\n";
+    std::cout << "load:          maps " << map_load_us / runs / 1000.0 << " ms, arena "
+              << arena_load_us / runs / 1000.0 << " ms\n";
+    std::cout << "heap:          maps " << map_bytes / 1024 << " KB, arena "
+              << tokenizer->MemoryFootprint() / 1024 << " KB\n";
+    std::cout << "ConvertResult: maps " << map_convert_us << " us, arena " << arena_convert_us << " us\n";
+    if (map_text != arena_text) {
+        std::cout << "text differs:\n  maps:  " << map_text << "\n  arena: " << arena_text << "\n";
+        return 1;
+    }
+    std::cout << "text identical (" << arena_text.size() << " bytes)\n";
+    return 0;
+}
@@ -0,0 +1,176 @@
+/* Voice Activity Detection Implementation
+ *
+ * Log-mel energy VAD with an adaptive noise floor, hysteresis and hangover.
+ */
+
+#include "vad.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sensevoice {
+
+// 10 / ln(10): natural-log mel power -> dB
+static constexpr float kLogToDb = 4.3429448f;
+
+Vad::Vad(const VadConfig& config, int32_t lfr_window_size, int32_t lfr_window_shift)
+    : config_(config),
+      max_segment_frames_(CalcLfrInputFrames(config.max_segment_lfr_frames,
+                                             lfr_window_size, lfr_window_shift)),
+      min_segment_frames_(lfr_window_size) {
+}
+
+std::vector<float> Vad::FrameEnergyDb(const float* fbank,
+                                      int32_t num_frames,
+                                      int32_t feat_dim) {
+    std::vector<float> energy(num_frames);
+    const float scale = kLogToDb / static_cast<float>(feat_dim);
+    for (int32_t t = 0; t < num_frames; ++t) {
+        const float* frame = fbank + static_cast<size_t>(t) * feat_dim;
+        float sum = 0.0f;
+        for (int32_t d = 0; d < feat_dim; ++d) {
+            sum += frame[d];
+        }
+        energy[t] = sum * scale;
+    }
+    return energy;
+}
+
+std::vector<SpeechSegment> Vad::Detect(const float* fbank,
+                                       int32_t num_frames,
+                                       int32_t feat_dim) const {
+    std::vector<SpeechSegment> segments;
+    if (num_frames <= 0) {
+        return segments;
+    }
+
+    std::vector<float> energy = FrameEnergyDb(fbank, num_frames, feat_dim);
+
+    // Adaptive noise floor from a low percentile of the frame energies
+    std::vector<float> sorted = energy;
+    size_t floor_idx = static_cast<size_t>(config_.noise_floor_percentile * (num_frames - 1));
+    std::nth_element(sorted.begin(), sorted.begin() + floor_idx, sorted.end());
+    float noise_floor = sorted[floor_idx];
+    float max_energy = *std::max_element(energy.begin(), energy.end());
+
+    // Pure silence: nothing ever rises above the absolute threshold
+    if (max_energy < config_.silence_threshold_db) {
+        return segments;
+    }
+
+    // Hysteresis: harder to enter speech than to stay in it
+    float start_threshold = std::max(noise_floor + config_.start_margin_db,
+                                     config_.silence_threshold_db +
+                                     (config_.start_margin_db - config_.end_margin_db));
+    float end_threshold = std::max(noise_floor + config_.end_margin_db,
+                                   config_.silence_threshold_db);
+
+    std::vector<SpeechSegment> raw;
+    auto close_segment = [&](int32_t start, int32_t end) {
+        if (end - start >= config_.min_speech_frames) {
+            raw.push_back({start, end});
+        }
+    };
+
+    bool in_speech = false;
+    int32_t seg_start = 0;
+    int32_t last_voiced = 0;
+    for (int32_t t = 0; t < num_frames; ++t) {
+        if (!in_speech) {
+            if (energy[t] >= start_threshold) {
+                in_speech = true;
+                seg_start = t;
+                last_voiced = t;
+            }
+        } else if (energy[t] >= end_threshold) {
+            last_voiced = t;
+        } else if (t - last_voiced > config_.hangover_frames) {
+            close_segment(seg_start, last_voiced + 1);
+            in_speech = false;
+        }
+    }
+    if (in_speech) {
+        close_segment(seg_start, last_voiced + 1);
+    }
+
+    // Loud audio without any detectable pause: the floor is speech itself,
+    // so keep everything rather than risk dropping words. A quieter floor
+    // without anything rising above it is steady background noise
+    if (raw.empty()) {
+        if (noise_floor >= config_.speech_floor_db) {
+            raw.push_back({0, num_frames});
+        } else {
+            return segments;
+        }
+    }
+
+    // Add context padding and merge segments that now touch
+    std::vector<SpeechSegment> merged;
+    for (const auto& seg : raw) {
+        SpeechSegment padded = {std::max(0, seg.start_frame - config_.padding_frames),
+                                std::min(num_frames, seg.end_frame + config_.padding_frames)};
+        if (!merged.empty() && padded.start_frame <= merged.back().end_frame) {
+            merged.back().end_frame = std::max(merged.back().end_frame, padded.end_frame);
+        } else {
+            merged.push_back(padded);
+        }
+    }
+
+    std::vector<SpeechSegment> split;
+    for (const auto& seg : merged) {
+        if (seg.NumFrames() > max_segment_frames_) {
+            SplitLongSegment(seg, energy, &split);
+        } else {
+            split.push_back(seg);
+        }
+    }
+
+    // Every segment costs a model run: join neighbours whose span, pause
+    // included, still fits in one window
+    for (const auto& seg : split) {
+        if (!segments.empty() && seg.end_frame - segments.back().start_frame <= max_segment_frames_) {
+            segments.back().end_frame = seg.end_frame;
+        } else {
+            segments.push_back(seg);
+        }
+    }
+
+    // Every segment must produce at least one LFR frame
+    for (auto& seg : segments) {
+        if (seg.NumFrames() < min_segment_frames_) {
+            seg.end_frame = std::min(num_frames, seg.start_frame + min_segment_frames_);
+            seg.start_frame = std::max(0, seg.end_frame - min_segment_frames_);
+        }
+    }
+
+    return segments;
+}
+
+void Vad::SplitLongSegment(const SpeechSegment& segment,
+                           const std::vector<float>& energy_db,
+                           std::vector<SpeechSegment>* out) const {
+    int32_t cursor = segment.start_frame;
+    const int32_t end = segment.end_frame;
+
+    while (end - cursor > max_segment_frames_) {
+        // Cut at the quietest frame in the second half of the window, leaving
+        // enough frames for the remainder to form an LFR frame
+        int32_t search_begin = cursor + max_segment_frames_ / 2;
+        int32_t search_end = std::min(cursor + max_segment_frames_, end - min_segment_frames_);
+
+        int32_t cut = search_end - 1;
+        float min_energy = energy_db[search_end - 1];
+        for (int32_t t = search_end - 1; t >= search_begin; --t) {
+            if (energy_db[t] < min_energy) {
+                min_energy = energy_db[t];
+                cut = t;
+            }
+        }
+
+        out->push_back({cursor, cut});
+        cursor = cut;
+    }
+    out->push_back({cursor, end});
+}
+
+}  // namespace sensevoice
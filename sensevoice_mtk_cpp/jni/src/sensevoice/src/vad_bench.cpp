@@ -0,0 +1,234 @@
+/* SenseVoice VAD Benchmark - NPU runs saved on a corpus
+ *
+ * Usage: sensevoice_vad_bench <model.dla> <tokens.txt> [backend] [wav_list.txt|utterances]
+ *
+ * Recognizes every utterance of a corpus with the VAD front stage and
+ * reports SenseVoice::GetVadStats(): the model runs made against the fixed
+ * 166-frame windows the untrimmed audio would have taken. The counts come
+ * from the host-side VAD, so backend host gives the same numbers as the NPU.
+ *
+ * Without a WAV list a seeded synthetic corpus is used, in three parts:
+ *   noise      - background noise only (false wakes)
+ *   commands   - one short phrase between leading and trailing silence
+ *   dictation  - 20-60 s of phrases separated by pauses
+ */
+
+#include "sensevoice.h"
+#include "bench_common.h"
+#include "common/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+
+using sensevoice::bench::ParseBackend;
+
+constexpr int32_t kSampleRate = 16000;
+
+struct Utterance {
+    std::string group;
+    std::vector<int16_t> samples;
+    double speech_s = 0.0;  // Synthetic corpus only
+};
+
+// Deterministic corpus generator: speech-like phrases (a harmonic series up to
+// ~4 kHz under a syllable-rate envelope, about -20 dBFS) and pauses, all over
+// the same -55 dBFS background noise
+class CorpusGenerator {
+public:
+    float Uniform(float lo, float hi) {
+        seed_ = seed_ * 1664525u + 1013904223u;
+        return lo + (hi - lo) * static_cast<float>(seed_ >> 8) / 16777216.0f;
+    }
+
+    void Pause(float seconds, std::vector<int16_t>* out) { Append(seconds, 0.0f, out); }
+
+    void Phrase(float seconds, std::vector<int16_t>* out) { Append(seconds, Uniform(110.0f, 260.0f), out); }
+
+private:
+    void Append(float seconds, float pitch_hz, std::vector<int16_t>* out) {
+        const size_t count = static_cast<size_t>(seconds * kSampleRate);
+        const float two_pi = 2.0f * static_cast<float>(M_PI);
+        for (size_t i = 0; i < count; ++i) {
+            float t = static_cast<float>(i) / kSampleRate;
+            float sample = Uniform(-0.5f, 0.5f) * 0.006f;
+            if (pitch_hz > 0.0f) {
+                float envelope = 0.5f + 0.5f * std::sin(two_pi * 4.0f * t);
+                float voice = 0.0f;
+                for (int32_t k = 1; k * pitch_hz < 4000.0f; ++k) {
+                    voice += std::sin(two_pi * k * pitch_hz * t) / k;
+                }
+                sample += 0.1f * envelope * voice;
+            }
+            out->push_back(static_cast<int16_t>(std::max(-1.0f, std::min(1.0f, sample)) * 32767.0f));
+        }
+    }
+
+    uint32_t seed_ = 2024;
+};
+
+std::vector<Utterance> SyntheticCorpus(int32_t count) {
+    CorpusGenerator gen;
+    std::vector<Utterance> corpus;
+    for (int32_t i = 0; i < count; ++i) {
+        Utterance utt;
+        // 15% noise, 60% commands, 25% dictation
+        const int32_t kind = i % 20;
+        if (kind < 3) {
+            utt.group = "noise";
+            gen.Pause(gen.Uniform(1.0f, 5.0f), &utt.samples);
+        } else if (kind < 15) {
+            utt.group = "commands";
+            gen.Pause(gen.Uniform(0.3f, 1.5f), &utt.samples);
+            utt.speech_s = gen.Uniform(1.0f, 4.0f);
+            gen.Phrase(static_cast<float>(utt.speech_s), &utt.samples);
+            gen.Pause(gen.Uniform(0.5f, 2.5f), &utt.samples);
+        } else {
+            utt.group = "dictation";
+            const float length_s = gen.Uniform(20.0f, 60.0f);
+            gen.Pause(gen.Uniform(0.3f, 1.5f), &utt.samples);
+            while (utt.samples.size() < length_s * kSampleRate) {
+                float phrase_s = gen.Uniform(2.0f, 8.0f);
+                utt.speech_s += phrase_s;
+                gen.Phrase(phrase_s, &utt.samples);
+                gen.Pause(gen.Uniform(0.4f, 2.0f), &utt.samples);
+            }
+        }
+        corpus.push_back(std::move(utt));
+    }
+    return corpus;
+}
+
+bool LoadCorpus(const std::string& list_path, std::vector<Utterance>* corpus) {
+    std::ifstream list(list_path);
+    if (!list) {
+        LOG(ERROR) << "Failed to open WAV list: " << list_path;
+        return false;
+    }
+    std::string path;
+    while (std::getline(list, path)) {
+        if (path.empty() || path[0] == '#') {
+            continue;
+        }
+        Utterance utt;
+        utt.group = "corpus";
+        int32_t sample_rate = 0;
+        if (!sensevoice::LoadWavFile(path, &utt.samples, &sample_rate) || sample_rate != kSampleRate) {
+            LOG(ERROR) << "Need a 16 kHz 16-bit WAV file: " << path;
+            return false;
+        }
+        corpus->push_back(std::move(utt));
+    }
+    return !corpus->empty();
+}
+
+void PrintStats(const std::string& group, int32_t utterances, double audio_s, double speech_s,
+                const sensevoice::VadStats& stats) {
+    const int64_t saved = stats.npu_runs_without_vad - stats.npu_runs;
+    std::cout << group << ": " << utterances << " utterances, " << audio_s << " s audio";
+    if (speech_s > 0.0) {
+        std::cout << " (" << speech_s << " s speech)";
+    }
+    std::cout << ", " << stats.silent_requests << " silent\n"
+              << "  NPU runs: " << stats.npu_runs << " with VAD, " << stats.npu_runs_without_vad
+              << " without, " << saved << " saved ("
+              << (stats.npu_runs_without_vad > 0 ? 100.0 * saved / stats.npu_runs_without_vad : 0.0)
+              << "%)\n";
+}
+
+sensevoice::VadStats Delta(const sensevoice::VadStats& after, const sensevoice::VadStats& before) {
+    sensevoice::VadStats delta;
+    delta.requests = after.requests - before.requests;
+    delta.silent_requests = after.silent_requests - before.silent_requests;
+    delta.npu_runs = after.npu_runs - before.npu_runs;
+    delta.npu_runs_without_vad = after.npu_runs_without_vad - before.npu_runs_without_vad;
+    return delta;
+}
+
+}  // namespace
+
+void PrintUsage(const char* program_name) {
+    std::cout << "SenseVoice VAD Benchmark\n\n";
+    std::cout << "Usage: " << program_name << " <model.dla> <tokens.txt> [backend] [wav_list.txt|utterances]\n\n";
+    std::cout << "Arguments:\n";
+    std::cout << "  model.dla     Path to SenseVoice DLA model file, or a .svb bundle (tokens: -)\n";
+    std::cout << "  tokens.txt    Path to tokens file (tokens.txt or tokens.bin)\n";
+    std::cout << "  backend       usdk, runtime or host[:<latency_us>] (CPU stand-in, no NPU) (default: usdk)\n";
+    std::cout << "  wav_list.txt  One 16 kHz 16-bit WAV path per line, or a number of synthetic\n";
+    std::cout << "                utterances (default: 200)\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << program_name << " sensevoice.dla tokens.txt host:0 corpus.txt\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    sensevoice::SenseVoiceConfig config;
+    config.model.model_path = argv[1];
+    config.model.tokens_path = argv[2];
+    if (argc > 3 && !ParseBackend(argv[3], &config.model)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Utterance> corpus;
+    const std::string source = argc > 4 ? argv[4] : "200";
+    char* end = nullptr;
+    const long count = std::strtol(source.c_str(), &end, 10);
+    if (end != source.c_str() && *end == '\0') {
+        corpus = SyntheticCorpus(static_cast<int32_t>(std::max(1L, count)));
+    } else if (!LoadCorpus(source, &corpus)) {
+        return 1;
+    }
+    // Group order for the report
+    std::stable_sort(corpus.begin(), corpus.end(), [](const Utterance& a, const Utterance& b) {
+        return a.group < b.group;
+    });
+
+    sensevoice::SenseVoice sv;
+    if (!sv.Initialize(config)) {
+        LOG(ERROR) << "Failed to initialize SenseVoice";
+        return 1;
+    }
+    // The pipeline logs every request; keep the report readable
+    el::Loggers::reconfigureAllLoggers(el::Level::Info, el::ConfigurationType::Enabled, "false");
+
+    auto start = std::chrono::steady_clock::now();
+    double total_audio_s = 0.0;
+    double total_speech_s = 0.0;
+    size_t i = 0;
+    while (i < corpus.size()) {
+        const std::string& group = corpus[i].group;
+        const sensevoice::VadStats before = sv.GetVadStats();
+        double audio_s = 0.0;
+        double speech_s = 0.0;
+        int32_t utterances = 0;
+        for (; i < corpus.size() && corpus[i].group == group; ++i, ++utterances) {
+            sv.Recognize(corpus[i].samples.data(), corpus[i].samples.size());
+            audio_s += static_cast<double>(corpus[i].samples.size()) / kSampleRate;
+            speech_s += corpus[i].speech_s;
+        }
+        PrintStats(group, utterances, audio_s, speech_s, Delta(sv.GetVadStats(), before));
+        total_audio_s += audio_s;
+        total_speech_s += speech_s;
+    }
+    double elapsed_s = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count() / 1000.0;
+    el::Loggers::reconfigureAllLoggers(el::Level::Info, el::ConfigurationType::Enabled, "true");
+
+    PrintStats("total", static_cast<int32_t>(corpus.size()), total_audio_s, total_speech_s, sv.GetVadStats());
+    std::cout << "wall clock: " << elapsed_s << " s\n";
+    return 0;
+}
@@ -39,6 +39,7 @@
 #include <cmath>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <random>
 #include <vector>
 